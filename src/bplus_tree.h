@@ -0,0 +1,522 @@
+#pragma once
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * Represents an in-memory B+tree that maps keys to values, where multiple values can have the same key.
+ * Entries are stored in wide leaf nodes that are linked together in both directions for range scans.
+ * The interface follows std::multimap: entries with the same key are kept in insertion order.
+ * Erased entries are removed from their leaf without rebalancing the tree.
+ * @tparam Key The type of the key
+ * @tparam Value The type of the value
+ * @tparam LeafCapacity The maximum number of entries in a leaf node
+ * @tparam InternalCapacity The maximum number of children of an internal node
+ */
+template<typename Key, typename Value, std::size_t LeafCapacity = 128, std::size_t InternalCapacity = 128>
+class BPlusTree {
+	static_assert(LeafCapacity >= 2, "Leaf nodes must hold at least two entries.");
+	static_assert(InternalCapacity >= 3, "Internal nodes must have at least three children.");
+public:
+	using key_type = Key;
+	using mapped_type = Value;
+	using value_type = std::pair<Key, Value>;
+private:
+	struct Node {};
+
+	struct LeafNode : public Node {
+		std::size_t size = 0;
+		LeafNode* previous = nullptr;
+		LeafNode* next = nullptr;
+		value_type entries[LeafCapacity];
+	};
+
+	struct InternalNode : public Node {
+		// The number of children. Key i is the smallest key in child i + 1 when it was created.
+		std::size_t size = 0;
+		Key keys[InternalCapacity - 1];
+		Node* children[InternalCapacity];
+	};
+
+	// The tree can never become deeper than this, since each level multiplies the number of entries by at least two
+	static constexpr std::size_t MAX_HEIGHT = 64;
+
+	std::vector<std::unique_ptr<LeafNode>> mLeafNodes;
+	std::vector<std::unique_ptr<InternalNode>> mInternalNodes;
+
+	Node* mRoot = nullptr;
+	LeafNode* mFirstLeaf = nullptr;
+	LeafNode* mLastLeaf = nullptr;
+	std::size_t mHeight = 0;
+	std::size_t mSize = 0;
+
+	LeafNode* createLeafNode() {
+		mLeafNodes.push_back(std::make_unique<LeafNode>());
+		return mLeafNodes.back().get();
+	}
+
+	InternalNode* createInternalNode() {
+		mInternalNodes.push_back(std::make_unique<InternalNode>());
+		return mInternalNodes.back().get();
+	}
+
+	static bool entryKeyLess(const value_type& entry, const Key& key) {
+		return entry.first < key;
+	}
+
+	static bool keyEntryLess(const Key& key, const value_type& entry) {
+		return key < entry.first;
+	}
+
+	/**
+	 * Returns the child to descend into
+	 * @param node The node
+	 * @param key The key
+	 * @param upper Indicates if searching for the first key greater than the given key
+	 */
+	static std::size_t findChild(const InternalNode* node, const Key& key, bool upper) {
+		auto keysEnd = node->keys + (node->size - 1);
+		if (upper) {
+			return (std::size_t)(std::upper_bound(node->keys, keysEnd, key) - node->keys);
+		} else {
+			return (std::size_t)(std::lower_bound(node->keys, keysEnd, key) - node->keys);
+		}
+	}
+
+	/**
+	 * Returns the leaf that can contain the given key
+	 * @param key The key
+	 * @param upper Indicates if searching for the first key greater than the given key
+	 */
+	const LeafNode* findLeaf(const Key& key, bool upper) const {
+		auto node = mRoot;
+		for (std::size_t level = 0; level < mHeight; level++) {
+			auto internalNode = static_cast<const InternalNode*>(node);
+			node = internalNode->children[findChild(internalNode, key, upper)];
+		}
+
+		return static_cast<const LeafNode*>(node);
+	}
+
+	/**
+	 * Inserts the given child into the given node at the given position
+	 */
+	static void insertChild(InternalNode* node, std::size_t position, const Key& key, Node* child) {
+		std::move_backward(node->children + position, node->children + node->size, node->children + node->size + 1);
+		std::move_backward(node->keys + position - 1, node->keys + node->size - 1, node->keys + node->size);
+		node->children[position] = child;
+		node->keys[position - 1] = key;
+		node->size++;
+	}
+public:
+	/**
+	 * A bidirectional iterator over the entries in key order
+	 */
+	class const_iterator {
+	private:
+		friend class BPlusTree;
+
+		const BPlusTree* mTree = nullptr;
+		const LeafNode* mLeaf = nullptr;
+		std::size_t mIndex = 0;
+
+		const_iterator(const BPlusTree* tree, const LeafNode* leaf, std::size_t index)
+			: mTree(tree), mLeaf(leaf), mIndex(index) {
+			skipEmpty();
+		}
+
+		void skipEmpty() {
+			while (mLeaf != nullptr && mIndex >= mLeaf->size) {
+				mLeaf = mLeaf->next;
+				mIndex = 0;
+			}
+		}
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type = BPlusTree::value_type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const value_type*;
+		using reference = const value_type&;
+
+		const_iterator() = default;
+
+		const value_type& operator*() const {
+			return mLeaf->entries[mIndex];
+		}
+
+		const value_type* operator->() const {
+			return &mLeaf->entries[mIndex];
+		}
+
+		const_iterator& operator++() {
+			mIndex++;
+			skipEmpty();
+			return *this;
+		}
+
+		const_iterator operator++(int) {
+			auto current = *this;
+			++(*this);
+			return current;
+		}
+
+		const_iterator& operator--() {
+			// The end iterator has no leaf, so start from the last leaf
+			if (mLeaf == nullptr) {
+				mLeaf = mTree->mLastLeaf;
+				mIndex = mLeaf->size;
+			}
+
+			while (mIndex == 0) {
+				mLeaf = mLeaf->previous;
+				mIndex = mLeaf->size;
+			}
+
+			mIndex--;
+			return *this;
+		}
+
+		const_iterator operator--(int) {
+			auto current = *this;
+			--(*this);
+			return current;
+		}
+
+		bool operator==(const const_iterator& other) const {
+			return mLeaf == other.mLeaf && mIndex == other.mIndex;
+		}
+
+		bool operator!=(const const_iterator& other) const {
+			return !(*this == other);
+		}
+	};
+
+	using iterator = const_iterator;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+	using reverse_iterator = const_reverse_iterator;
+
+	BPlusTree() = default;
+
+	BPlusTree(const BPlusTree&) = delete;
+	BPlusTree& operator=(const BPlusTree&) = delete;
+
+	BPlusTree(BPlusTree&&) = default;
+	BPlusTree& operator=(BPlusTree&&) = default;
+
+	/**
+	 * Returns the number of entries
+	 */
+	std::size_t size() const {
+		return mSize;
+	}
+
+	/**
+	 * Indicates if the tree is empty
+	 */
+	bool empty() const {
+		return mSize == 0;
+	}
+
+	/**
+	 * Returns the number of bytes used by the nodes of the tree
+	 */
+	std::size_t memoryUsage() const {
+		return mLeafNodes.size() * sizeof(LeafNode) + mInternalNodes.size() * sizeof(InternalNode);
+	}
+
+	/**
+	 * Returns an iterator to the first entry
+	 */
+	const_iterator begin() const {
+		return const_iterator(this, mFirstLeaf, 0);
+	}
+
+	/**
+	 * Returns an iterator past the last entry
+	 */
+	const_iterator end() const {
+		return const_iterator(this, nullptr, 0);
+	}
+
+	/**
+	 * Returns a reverse iterator to the last entry
+	 */
+	const_reverse_iterator rbegin() const {
+		return const_reverse_iterator(end());
+	}
+
+	/**
+	 * Returns a reverse iterator before the first entry
+	 */
+	const_reverse_iterator rend() const {
+		return const_reverse_iterator(begin());
+	}
+
+	/**
+	 * Returns an iterator to the first entry with a key not less than the given key
+	 * @param key The key
+	 */
+	const_iterator lower_bound(const Key& key) const {
+		if (mRoot == nullptr) {
+			return end();
+		}
+
+		auto leaf = findLeaf(key, false);
+		auto position = std::lower_bound(leaf->entries, leaf->entries + leaf->size, key, entryKeyLess);
+		return const_iterator(this, leaf, (std::size_t)(position - leaf->entries));
+	}
+
+	/**
+	 * Returns an iterator to the first entry with a key greater than the given key
+	 * @param key The key
+	 */
+	const_iterator upper_bound(const Key& key) const {
+		if (mRoot == nullptr) {
+			return end();
+		}
+
+		auto leaf = findLeaf(key, true);
+		auto position = std::upper_bound(leaf->entries, leaf->entries + leaf->size, key, keyEntryLess);
+		return const_iterator(this, leaf, (std::size_t)(position - leaf->entries));
+	}
+
+	/**
+	 * Returns the range of entries with the given key
+	 * @param key The key
+	 */
+	std::pair<const_iterator, const_iterator> equal_range(const Key& key) const {
+		return std::make_pair(lower_bound(key), upper_bound(key));
+	}
+
+	/**
+	 * Inserts the given entry after all the entries with the same key
+	 * @param key The key
+	 * @param value The value
+	 */
+	void emplace(const Key& key, const Value& value) {
+		if (mRoot == nullptr) {
+			mFirstLeaf = createLeafNode();
+			mLastLeaf = mFirstLeaf;
+			mRoot = mFirstLeaf;
+		}
+
+		// Find the leaf, and remember the path to it for splitting
+		InternalNode* path[MAX_HEIGHT];
+		std::size_t pathChildIndex[MAX_HEIGHT];
+
+		auto node = mRoot;
+		for (std::size_t level = 0; level < mHeight; level++) {
+			auto internalNode = static_cast<InternalNode*>(node);
+			auto childIndex = findChild(internalNode, key, true);
+			path[level] = internalNode;
+			pathChildIndex[level] = childIndex;
+			node = internalNode->children[childIndex];
+		}
+
+		auto leaf = static_cast<LeafNode*>(node);
+		auto position = (std::size_t)(std::upper_bound(leaf->entries, leaf->entries + leaf->size, key, keyEntryLess) - leaf->entries);
+		mSize++;
+
+		if (leaf->size < LeafCapacity) {
+			std::move_backward(leaf->entries + position, leaf->entries + leaf->size, leaf->entries + leaf->size + 1);
+			leaf->entries[position] = value_type(key, value);
+			leaf->size++;
+			return;
+		}
+
+		// Split the leaf. When appending to the last leaf, the full leaf is kept as is which keeps sequential inserts dense.
+		auto newLeaf = createLeafNode();
+		auto splitIndex = LeafCapacity / 2;
+		if (leaf->next == nullptr && position == LeafCapacity) {
+			splitIndex = LeafCapacity;
+		}
+
+		std::move(leaf->entries + splitIndex, leaf->entries + LeafCapacity, newLeaf->entries);
+		newLeaf->size = LeafCapacity - splitIndex;
+		leaf->size = splitIndex;
+		newLeaf->previous = leaf;
+		newLeaf->next = leaf->next;
+		if (leaf->next == nullptr) {
+			mLastLeaf = newLeaf;
+		} else {
+			leaf->next->previous = newLeaf;
+		}
+
+		leaf->next = newLeaf;
+
+		auto insertLeaf = leaf;
+		if (position >= splitIndex) {
+			insertLeaf = newLeaf;
+			position -= splitIndex;
+		}
+
+		std::move_backward(insertLeaf->entries + position, insertLeaf->entries + insertLeaf->size, insertLeaf->entries + insertLeaf->size + 1);
+		insertLeaf->entries[position] = value_type(key, value);
+		insertLeaf->size++;
+
+		// Insert the new node into the parents, splitting them if needed
+		Key separator = newLeaf->entries[0].first;
+		Node* newNode = newLeaf;
+
+		for (std::size_t level = mHeight; level-- > 0;) {
+			auto parent = path[level];
+			auto childPosition = pathChildIndex[level] + 1;
+
+			if (parent->size < InternalCapacity) {
+				insertChild(parent, childPosition, separator, newNode);
+				return;
+			}
+
+			Key keys[InternalCapacity];
+			Node* children[InternalCapacity + 1];
+			std::copy(parent->keys, parent->keys + (InternalCapacity - 1), keys);
+			std::copy(parent->children, parent->children + InternalCapacity, children);
+			std::move_backward(children + childPosition, children + InternalCapacity, children + InternalCapacity + 1);
+			std::move_backward(keys + childPosition - 1, keys + (InternalCapacity - 1), keys + InternalCapacity);
+			children[childPosition] = newNode;
+			keys[childPosition - 1] = separator;
+
+			auto numLeftChildren = (InternalCapacity + 1) / 2;
+			auto newParent = createInternalNode();
+
+			parent->size = numLeftChildren;
+			std::copy(children, children + numLeftChildren, parent->children);
+			std::copy(keys, keys + (numLeftChildren - 1), parent->keys);
+
+			newParent->size = InternalCapacity + 1 - numLeftChildren;
+			std::copy(children + numLeftChildren, children + InternalCapacity + 1, newParent->children);
+			std::copy(keys + numLeftChildren, keys + InternalCapacity, newParent->keys);
+
+			separator = keys[numLeftChildren - 1];
+			newNode = newParent;
+		}
+
+		// The root was split
+		auto newRoot = createInternalNode();
+		newRoot->size = 2;
+		newRoot->children[0] = mRoot;
+		newRoot->children[1] = newNode;
+		newRoot->keys[0] = separator;
+		mRoot = newRoot;
+		mHeight++;
+	}
+
+	/**
+	 * Inserts the given entries, which must be sorted by key.
+	 * The entries are merged with the existing entries in one pass and the tree is built again bottom up.
+	 * Entries with the same key as existing entries are placed after them.
+	 * @param entries The entries
+	 */
+	void insertSorted(const std::vector<value_type>& entries) {
+		if (entries.empty()) {
+			return;
+		}
+
+		std::vector<value_type> allEntries;
+		allEntries.reserve(mSize + entries.size());
+
+		auto newEntry = entries.begin();
+		for (auto it = begin(); it != end(); ++it) {
+			while (newEntry != entries.end() && newEntry->first < it->first) {
+				allEntries.push_back(*newEntry);
+				++newEntry;
+			}
+
+			allEntries.push_back(*it);
+		}
+
+		allEntries.insert(allEntries.end(), newEntry, entries.end());
+		build(allEntries);
+	}
+
+	/**
+	 * Replaces the entries of the tree with the given entries, which must be sorted by key.
+	 * The entries are spread evenly over as few leaves as possible.
+	 * @param entries The entries
+	 */
+	void build(const std::vector<value_type>& entries) {
+		clear();
+		if (entries.empty()) {
+			return;
+		}
+
+		// The nodes of the level being built, and the smallest key in each of them
+		std::vector<Node*> levelNodes;
+		std::vector<Key> levelKeys;
+
+		auto numLeaves = (entries.size() + LeafCapacity - 1) / LeafCapacity;
+		for (std::size_t leafIndex = 0; leafIndex < numLeaves; leafIndex++) {
+			auto startIndex = leafIndex * entries.size() / numLeaves;
+			auto endIndex = (leafIndex + 1) * entries.size() / numLeaves;
+
+			auto leaf = createLeafNode();
+			std::copy(entries.begin() + startIndex, entries.begin() + endIndex, leaf->entries);
+			leaf->size = endIndex - startIndex;
+			leaf->previous = mLastLeaf;
+			if (mLastLeaf == nullptr) {
+				mFirstLeaf = leaf;
+			} else {
+				mLastLeaf->next = leaf;
+			}
+
+			mLastLeaf = leaf;
+			levelNodes.push_back(leaf);
+			levelKeys.push_back(leaf->entries[0].first);
+		}
+
+		// Spreading the children evenly gives every internal node at least two children
+		while (levelNodes.size() > 1) {
+			std::vector<Node*> parentNodes;
+			std::vector<Key> parentKeys;
+
+			auto numParents = (levelNodes.size() + InternalCapacity - 1) / InternalCapacity;
+			for (std::size_t parentIndex = 0; parentIndex < numParents; parentIndex++) {
+				auto startIndex = parentIndex * levelNodes.size() / numParents;
+				auto endIndex = (parentIndex + 1) * levelNodes.size() / numParents;
+
+				auto parent = createInternalNode();
+				parent->size = endIndex - startIndex;
+				std::copy(levelNodes.begin() + startIndex, levelNodes.begin() + endIndex, parent->children);
+				std::copy(levelKeys.begin() + startIndex + 1, levelKeys.begin() + endIndex, parent->keys);
+
+				parentNodes.push_back(parent);
+				parentKeys.push_back(levelKeys[startIndex]);
+			}
+
+			levelNodes = std::move(parentNodes);
+			levelKeys = std::move(parentKeys);
+			mHeight++;
+		}
+
+		mRoot = levelNodes[0];
+		mSize = entries.size();
+	}
+
+	/**
+	 * Erases the entry at the given position
+	 * @param position The position
+	 * @return Iterator to the entry after the erased entry
+	 */
+	const_iterator erase(const_iterator position) {
+		auto leaf = const_cast<LeafNode*>(position.mLeaf);
+		std::move(leaf->entries + position.mIndex + 1, leaf->entries + leaf->size, leaf->entries + position.mIndex);
+		leaf->size--;
+		mSize--;
+		return const_iterator(this, leaf, position.mIndex);
+	}
+
+	/**
+	 * Removes all the entries
+	 */
+	void clear() {
+		mLeafNodes.clear();
+		mInternalNodes.clear();
+		mRoot = nullptr;
+		mFirstLeaf = nullptr;
+		mLastLeaf = nullptr;
+		mHeight = 0;
+		mSize = 0;
+	}
+};
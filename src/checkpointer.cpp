@@ -0,0 +1,55 @@
+#include "checkpointer.h"
+#include "database_engine.h"
+
+#include <iostream>
+
+Checkpointer::Checkpointer(DatabaseEngine& databaseEngine)
+	: mDatabaseEngine(databaseEngine),
+	  mThread([this]() { run(); }) {
+
+}
+
+Checkpointer::~Checkpointer() {
+	{
+		std::lock_guard<std::mutex> guard(mMutex);
+		mStopped = true;
+	}
+
+	mChanged.notify_one();
+	mThread.join();
+}
+
+void Checkpointer::request() {
+	{
+		std::lock_guard<std::mutex> guard(mMutex);
+		if (mRequested) {
+			return;
+		}
+
+		mRequested = true;
+	}
+
+	mChanged.notify_one();
+}
+
+void Checkpointer::run() {
+	std::unique_lock<std::mutex> lock(mMutex);
+	while (true) {
+		mChanged.wait(lock, [&]() { return mRequested || mStopped; });
+		if (mStopped) {
+			return;
+		}
+
+		// Changes made during the checkpoint can request the next one
+		mRequested = false;
+		lock.unlock();
+
+		try {
+			mDatabaseEngine.checkpoint();
+		} catch (const std::exception& e) {
+			std::cerr << "Checkpoint failed: " << e.what() << std::endl;
+		}
+
+		lock.lock();
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+class DatabaseEngine;
+
+/**
+ * The metrics of a checkpoint
+ */
+struct CheckpointMetrics {
+	// The position in the write-ahead log that the checkpoint contains the records up to
+	std::uint64_t walPosition = 0;
+
+	// The number of rows and bytes written to the table files
+	std::size_t numRows = 0;
+	std::size_t numBytes = 0;
+
+	// The number of bytes removed from the write-ahead log
+	std::uint64_t numWalBytesRemoved = 0;
+
+	// The durations in milliseconds. Changes wait only while the columns are copied.
+	double snapshotTime = 0.0;
+	double writeTime = 0.0;
+	double truncateTime = 0.0;
+	double totalTime = 0.0;
+};
+
+/**
+ * Checkpoints a database on a background thread when requested
+ */
+class Checkpointer {
+private:
+	DatabaseEngine& mDatabaseEngine;
+	std::mutex mMutex;
+	std::condition_variable mChanged;
+	bool mRequested = false;
+	bool mStopped = false;
+	std::thread mThread;
+
+	void run();
+public:
+	/**
+	 * Starts the background thread
+	 * @param databaseEngine The database
+	 */
+	explicit Checkpointer(DatabaseEngine& databaseEngine);
+
+	/**
+	 * Stops the background thread, after the checkpoint that is running
+	 */
+	~Checkpointer();
+
+	Checkpointer(const Checkpointer&) = delete;
+	Checkpointer& operator=(const Checkpointer&) = delete;
+
+	/**
+	 * Requests a checkpoint, unless one is already requested
+	 */
+	void request();
+};
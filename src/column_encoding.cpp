@@ -0,0 +1,307 @@
+#include "column_encoding.h"
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <memory>
+#include <utility>
+
+namespace {
+	template<std::size_t BitWidth>
+	inline std::uint32_t unpackValue(const std::uint64_t* words, std::size_t index) {
+		// The words are padded by one, which lets each value be read from two words without branching
+		auto bitIndex = index * BitWidth;
+		auto wordIndex = bitIndex / 64;
+		auto bitOffset = bitIndex % 64;
+		auto value = (words[wordIndex] >> bitOffset) | ((words[wordIndex + 1] << 1) << (63 - bitOffset));
+		return (std::uint32_t)(value & ((1ull << BitWidth) - 1));
+	}
+
+	template<std::size_t BitWidth, std::size_t... Indices>
+	inline void unpackGroup(const std::uint64_t* words, std::uint32_t* values, std::index_sequence<Indices...>) {
+		// Expanded for each value, which makes every shift a constant
+		int expand[] = { (values[Indices] = unpackValue<BitWidth>(words, Indices), 0)... };
+		(void)expand;
+	}
+
+	template<std::size_t BitWidth>
+	void unpackWithWidth(const std::uint64_t* words, std::size_t startIndex, std::size_t count, std::uint32_t* values) {
+		std::size_t i = 0;
+		for (; i < count && (startIndex + i) % 64 != 0; i++) {
+			values[i] = unpackValue<BitWidth>(words, startIndex + i);
+		}
+
+		// A group of 64 values fills BitWidth words, which makes the position of each value in the group constant
+		for (; i + 64 <= count; i += 64) {
+			unpackGroup<BitWidth>(words + (startIndex + i) / 64 * BitWidth, values + i, std::make_index_sequence<64>());
+		}
+
+		for (; i < count; i++) {
+			values[i] = unpackValue<BitWidth>(words, startIndex + i);
+		}
+	}
+
+	template<std::size_t... BitWidths>
+	std::array<void (*)(const std::uint64_t*, std::size_t, std::size_t, std::uint32_t*), sizeof...(BitWidths)>
+	makeUnpackFunctions(std::index_sequence<BitWidths...>) {
+		return { { &unpackWithWidth<BitWidths>... } };
+	}
+
+	/**
+	 * A hash set of at most MAX_DICTIONARY_SIZE values, which maps each value to its index in the dictionary
+	 */
+	class DictionaryBuilder {
+	private:
+		static constexpr std::size_t NUM_SLOTS_BITS = 10;
+		static constexpr std::size_t NUM_SLOTS = 1 << NUM_SLOTS_BITS;
+
+		std::int32_t mValues[NUM_SLOTS];
+		std::uint32_t mIndices[NUM_SLOTS];
+		bool mUsed[NUM_SLOTS] = {};
+		std::size_t mSize = 0;
+
+		std::size_t findSlot(std::int32_t value) const {
+			auto slot = ((std::uint32_t)value * 2654435761u) >> (32 - NUM_SLOTS_BITS);
+			while (mUsed[slot] && mValues[slot] != value) {
+				slot = (slot + 1) % NUM_SLOTS;
+			}
+
+			return slot;
+		}
+	public:
+		/**
+		 * Adds the given value, and returns false if there are too many values
+		 */
+		bool insert(std::int32_t value) {
+			auto slot = findSlot(value);
+			if (!mUsed[slot]) {
+				if (mSize == EncodedSegment::MAX_DICTIONARY_SIZE) {
+					return false;
+				}
+
+				mUsed[slot] = true;
+				mValues[slot] = value;
+				mSize++;
+			}
+
+			return true;
+		}
+
+		/**
+		 * Returns the sorted values, and maps each value to its index
+		 */
+		std::vector<std::int32_t> build() {
+			std::vector<std::int32_t> dictionary;
+			for (std::size_t slot = 0; slot < NUM_SLOTS; slot++) {
+				if (mUsed[slot]) {
+					dictionary.push_back(mValues[slot]);
+				}
+			}
+
+			std::sort(dictionary.begin(), dictionary.end());
+			for (std::size_t index = 0; index < dictionary.size(); index++) {
+				mIndices[findSlot(dictionary[index])] = (std::uint32_t)index;
+			}
+
+			return dictionary;
+		}
+
+		/**
+		 * Returns the index of the given value, which must have been added
+		 */
+		std::uint32_t indexOf(std::int32_t value) const {
+			return mIndices[findSlot(value)];
+		}
+	};
+}
+
+BitPackedArray::BitPackedArray(const std::vector<std::uint32_t>& values, std::size_t bitWidth)
+	: mBitWidth(bitWidth), mSize(values.size()), mWords((values.size() * bitWidth + 63) / 64 + 1, 0) {
+	if (mBitWidth == 0) {
+		return;
+	}
+
+	for (std::size_t i = 0; i < values.size(); i++) {
+		auto bitIndex = i * mBitWidth;
+		auto wordIndex = bitIndex / 64;
+		auto bitOffset = bitIndex % 64;
+		mWords[wordIndex] |= (std::uint64_t)values[i] << bitOffset;
+		if (bitOffset + mBitWidth > 64) {
+			mWords[wordIndex + 1] |= (std::uint64_t)values[i] >> (64 - bitOffset);
+		}
+	}
+}
+
+std::size_t BitPackedArray::bitWidth() const {
+	return mBitWidth;
+}
+
+std::size_t BitPackedArray::size() const {
+	return mSize;
+}
+
+std::size_t BitPackedArray::numBytes() const {
+	return mWords.size() * sizeof(std::uint64_t);
+}
+
+void BitPackedArray::unpack(std::size_t startIndex, std::size_t count, std::uint32_t* values) const {
+	if (mBitWidth == 0) {
+		std::fill(values, values + count, 0);
+		return;
+	}
+
+	// Each width has its own loop, as a constant width makes the shifts cheaper
+	static const auto unpackFunctions = makeUnpackFunctions(std::make_index_sequence<33>());
+	unpackFunctions[mBitWidth](mWords.data(), startIndex, count, values);
+}
+
+std::size_t BitPackedArray::bitWidthOf(std::uint32_t value) {
+	std::size_t bitWidth = 0;
+	while (value != 0) {
+		bitWidth++;
+		value >>= 1;
+	}
+
+	return bitWidth;
+}
+
+EncodedSegment EncodedSegment::encode(const std::int32_t* values, std::size_t count) {
+	EncodedSegment segment;
+	segment.numRows = count;
+	if (count == 0) {
+		return segment;
+	}
+
+	segment.min = values[0];
+	segment.max = values[0];
+	std::size_t numRuns = 1;
+	bool isIncreasing = true;
+	for (std::size_t i = 1; i < count; i++) {
+		segment.min = std::min(segment.min, values[i]);
+		segment.max = std::max(segment.max, values[i]);
+		if (values[i] != values[i - 1]) {
+			numRuns++;
+		}
+
+		if (values[i] <= values[i - 1]) {
+			isIncreasing = false;
+		}
+	}
+
+	// The sizes of the encodings decide which one is used
+	auto frameBitWidth = BitPackedArray::bitWidthOf((std::uint32_t)((std::int64_t)segment.max - segment.min));
+	auto plainSize = count * sizeof(std::int32_t);
+	auto frameSize = (count * frameBitWidth + 7) / 8;
+	auto runLengthSize = numRuns * (sizeof(std::int32_t) + sizeof(std::uint32_t));
+
+	// A dictionary is only smaller than the differences when few values repeat over a wide range
+	std::unique_ptr<DictionaryBuilder> dictionaryBuilder;
+	std::vector<std::int32_t> dictionary;
+	auto dictionarySize = std::numeric_limits<std::size_t>::max();
+	if (!isIncreasing && frameBitWidth > 8) {
+		dictionaryBuilder = std::make_unique<DictionaryBuilder>();
+		bool fits = true;
+		for (std::size_t i = 0; i < count && fits; i++) {
+			fits = dictionaryBuilder->insert(values[i]);
+		}
+
+		if (fits) {
+			dictionary = dictionaryBuilder->build();
+			auto indexBitWidth = BitPackedArray::bitWidthOf((std::uint32_t)(dictionary.size() - 1));
+			dictionarySize = dictionary.size() * sizeof(std::int32_t) + (count * indexBitWidth + 7) / 8;
+		}
+	}
+
+	// The plain values are preferred when nothing is smaller, as they are compared without decoding
+	auto bestSize = std::min({ plainSize, frameSize, runLengthSize, dictionarySize });
+	if (bestSize == plainSize) {
+		segment.encoding = SegmentEncoding::Plain;
+		segment.values.assign(values, values + count);
+	} else if (bestSize == runLengthSize) {
+		segment.encoding = SegmentEncoding::RunLength;
+		for (std::size_t i = 0; i < count; i++) {
+			if (i == 0 || values[i] != values[i - 1]) {
+				segment.values.push_back(values[i]);
+				segment.runEnds.push_back((std::uint32_t)i);
+			}
+
+			segment.runEnds.back() = (std::uint32_t)(i + 1);
+		}
+	} else if (bestSize == frameSize) {
+		segment.encoding = SegmentEncoding::FrameOfReference;
+		std::vector<std::uint32_t> differences(count);
+		for (std::size_t i = 0; i < count; i++) {
+			differences[i] = (std::uint32_t)((std::int64_t)values[i] - segment.min);
+		}
+
+		segment.packed = BitPackedArray(differences, frameBitWidth);
+	} else if (bestSize == dictionarySize) {
+		segment.encoding = SegmentEncoding::Dictionary;
+		std::vector<std::uint32_t> indices(count);
+		for (std::size_t i = 0; i < count; i++) {
+			indices[i] = dictionaryBuilder->indexOf(values[i]);
+		}
+
+		segment.packed = BitPackedArray(indices, BitPackedArray::bitWidthOf((std::uint32_t)(dictionary.size() - 1)));
+		segment.values = std::move(dictionary);
+	}
+
+	return segment;
+}
+
+std::int32_t EncodedSegment::decode(std::size_t index) const {
+	switch (encoding) {
+		case SegmentEncoding::Plain:
+			return values[index];
+		case SegmentEncoding::Dictionary:
+			return values[packed.get(index)];
+		case SegmentEncoding::RunLength:
+			return values[std::upper_bound(runEnds.begin(), runEnds.end(), (std::uint32_t)index) - runEnds.begin()];
+		case SegmentEncoding::FrameOfReference:
+			return (std::int32_t)((std::int64_t)min + packed.get(index));
+	}
+
+	return 0;
+}
+
+void EncodedSegment::decode(std::size_t startIndex, std::size_t count, std::int32_t* values) const {
+	switch (encoding) {
+		case SegmentEncoding::Plain:
+			std::copy(this->values.begin() + startIndex, this->values.begin() + startIndex + count, values);
+			break;
+		case SegmentEncoding::Dictionary: {
+			// The indices are unpacked in place of the values
+			auto indices = reinterpret_cast<std::uint32_t*>(values);
+			packed.unpack(startIndex, count, indices);
+			for (std::size_t i = 0; i < count; i++) {
+				values[i] = this->values[indices[i]];
+			}
+
+			break;
+		}
+		case SegmentEncoding::RunLength: {
+			auto runIndex = std::upper_bound(runEnds.begin(), runEnds.end(), (std::uint32_t)startIndex) - runEnds.begin();
+			for (std::size_t i = 0; i < count; runIndex++) {
+				auto runEndIndex = std::min((std::size_t)runEnds[runIndex] - startIndex, count);
+				std::fill(values + i, values + runEndIndex, this->values[runIndex]);
+				i = runEndIndex;
+			}
+
+			break;
+		}
+		case SegmentEncoding::FrameOfReference: {
+			auto differences = reinterpret_cast<std::uint32_t*>(values);
+			packed.unpack(startIndex, count, differences);
+			for (std::size_t i = 0; i < count; i++) {
+				values[i] = (std::int32_t)((std::int64_t)min + differences[i]);
+			}
+
+			break;
+		}
+	}
+}
+
+std::size_t EncodedSegment::numBytes() const {
+	return values.size() * sizeof(std::int32_t) + runEnds.size() * sizeof(std::uint32_t) + packed.numBytes();
+}
+
+constexpr std::size_t EncodedSegment::MAX_DICTIONARY_SIZE;
@@ -0,0 +1,135 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Represents an array of unsigned integers that are stored with the given number of bits each
+ */
+class BitPackedArray {
+private:
+	std::size_t mBitWidth = 0;
+	std::size_t mSize = 0;
+	std::vector<std::uint64_t> mWords;
+public:
+	/**
+	 * Creates an empty array
+	 */
+	BitPackedArray() = default;
+
+	/**
+	 * Packs the given values
+	 * @param values The values, which must fit in the bit width
+	 * @param bitWidth The number of bits per value, at most 32
+	 */
+	BitPackedArray(const std::vector<std::uint32_t>& values, std::size_t bitWidth);
+
+	/**
+	 * Returns the number of bits per value
+	 */
+	std::size_t bitWidth() const;
+
+	/**
+	 * Returns the number of values
+	 */
+	std::size_t size() const;
+
+	/**
+	 * Returns the number of bytes used by the values
+	 */
+	std::size_t numBytes() const;
+
+	/**
+	 * Returns the value at the given index
+	 * @param index The index
+	 */
+	inline std::uint32_t get(std::size_t index) const {
+		if (mBitWidth == 0) {
+			return 0;
+		}
+
+		auto bitIndex = index * mBitWidth;
+		auto wordIndex = bitIndex / 64;
+		auto bitOffset = bitIndex % 64;
+		auto value = (mWords[wordIndex] >> bitOffset) | ((mWords[wordIndex + 1] << 1) << (63 - bitOffset));
+		return (std::uint32_t)(value & ((1ull << mBitWidth) - 1));
+	}
+
+	/**
+	 * Unpacks the given range of values
+	 * @param startIndex The index of the first value
+	 * @param count The number of values
+	 * @param values The unpacked values. Must have room for count values
+	 */
+	void unpack(std::size_t startIndex, std::size_t count, std::uint32_t* values) const;
+
+	/**
+	 * Returns the number of bits needed to store the given value
+	 * @param value The value
+	 */
+	static std::size_t bitWidthOf(std::uint32_t value);
+};
+
+/**
+ * How the values of a segment are encoded
+ */
+enum class SegmentEncoding {
+	// The values as they are
+	Plain,
+	// Sorted distinct values, and for each row the bit packed index of its value
+	Dictionary,
+	// The value of each run of equal values, and the row that the run ends at
+	RunLength,
+	// The minimum value, and for each row the bit packed difference to the minimum
+	FrameOfReference
+};
+
+/**
+ * Represents the values of a segment of an int32 column, in the encoding that stores them in the fewest bytes
+ */
+struct EncodedSegment {
+	/**
+	 * The largest number of distinct values that are stored in a dictionary
+	 */
+	static constexpr std::size_t MAX_DICTIONARY_SIZE = 256;
+
+	SegmentEncoding encoding = SegmentEncoding::Plain;
+	std::size_t numRows = 0;
+	std::int32_t min = 0;
+	std::int32_t max = 0;
+
+	// The plain values, the dictionary, or the value of each run
+	std::vector<std::int32_t> values;
+
+	// The row after the end of each run, relative to the start of the segment
+	std::vector<std::uint32_t> runEnds;
+
+	// The dictionary indices, or the differences to the minimum
+	BitPackedArray packed;
+
+	/**
+	 * Encodes the given values
+	 * @param values The values
+	 * @param count The number of values
+	 */
+	static EncodedSegment encode(const std::int32_t* values, std::size_t count);
+
+	/**
+	 * Returns the value of the given row
+	 * @param index The row, relative to the start of the segment
+	 */
+	std::int32_t decode(std::size_t index) const;
+
+	/**
+	 * Decodes the given range of rows
+	 * @param startIndex The first row, relative to the start of the segment
+	 * @param count The number of rows
+	 * @param values The decoded values. Must have room for count values
+	 */
+	void decode(std::size_t startIndex, std::size_t count, std::int32_t* values) const;
+
+	/**
+	 * Returns the number of bytes used by the encoded values
+	 */
+	std::size_t numBytes() const;
+};
@@ -153,4 +153,15 @@ enum class MathOperator {
 	Sub,
 	Mul,
 	Div
+};
+
+/**
+ * The aggregate functions
+ */
+enum class AggregateFunction {
+	Count,
+	Sum,
+	Min,
+	Max,
+	Average
 };
\ No newline at end of file
@@ -2,6 +2,9 @@
 #include "query.h"
 #include "execution/executor.h"
 #include "query_parser/parser.h"
+#include "prepared_statement.h"
+#include "database_files.h"
+#include "helpers.h"
 
 #include <iostream>
 #include <stack>
@@ -11,12 +14,125 @@ DatabaseEngine::DatabaseEngine(DatabaseConfiguration config)
 
 }
 
+DatabaseEngine::~DatabaseEngine() = default;
+
 const DatabaseConfiguration& DatabaseEngine::config() const {
 	return mConfig;
 }
 
+DatabaseConfiguration& DatabaseEngine::config() {
+	return mConfig;
+}
+
 void DatabaseEngine::addTable(std::string name, std::unique_ptr<Table> table) {
-	mTables.insert(std::make_pair(name, std::move(table)));
+	std::uint64_t walPosition = 0;
+	{
+		std::lock_guard<std::mutex> guard(mWriteMutex);
+		if (mWriteAheadLog) {
+			// Tables are created empty, which lets later records fill them
+			walPosition = mWriteAheadLog->logCreateTable(name, table->schema());
+		}
+
+		mTables.insert(std::make_pair(name, std::move(table)));
+
+		// The indices of a table are created with it
+		mCatalogVersion++;
+	}
+
+	if (mWriteAheadLog) {
+		commit(walPosition);
+	}
+}
+
+void DatabaseEngine::save(const std::string& directory) {
+	std::lock_guard<std::mutex> checkpointGuard(mCheckpointMutex);
+	std::lock_guard<std::mutex> guard(mWriteMutex);
+	auto walPosition = mWriteAheadLog ? mWriteAheadLog->position() : 0;
+	DatabaseFiles::write(mTables, directory, walPosition);
+
+	if (mWriteAheadLog && directory == mDirectory) {
+		mWriteAheadLog->truncate(walPosition);
+	}
+}
+
+void DatabaseEngine::open(const std::string& directory) {
+	if (mWriteAheadLog) {
+		throw std::runtime_error("A directory has already been opened.");
+	}
+
+	std::uint64_t walPosition = 0;
+	for (auto& table : DatabaseFiles::open(directory, walPosition)) {
+		addTable(table.first, std::move(table.second));
+	}
+
+	auto walPath = directory + "/wal";
+	WriteAheadLog::replay(walPath, walPosition, *this);
+	mWriteAheadLog = std::make_unique<WriteAheadLog>(walPath, mConfig.walSyncMode, walPosition);
+	mDirectory = directory;
+
+	if (mConfig.checkpointWalSize > 0) {
+		mCheckpointer = std::make_unique<Checkpointer>(*this);
+	}
+}
+
+CheckpointMetrics DatabaseEngine::checkpoint() {
+	if (!mWriteAheadLog) {
+		throw std::runtime_error("Only an opened database can be checkpointed.");
+	}
+
+	std::lock_guard<std::mutex> checkpointGuard(mCheckpointMutex);
+	CheckpointMetrics metrics;
+	auto startTime = Helpers::timeNow();
+
+	// Changes wait while the columns are copied, while queries keep running
+	DatabaseFiles::Snapshot snapshot;
+	{
+		std::lock_guard<std::mutex> guard(mWriteMutex);
+		metrics.walPosition = mWriteAheadLog->position();
+		snapshot = DatabaseFiles::snapshot(mTables);
+	}
+
+	auto snapshotTime = Helpers::timeNow();
+	metrics.numBytes = DatabaseFiles::write(snapshot, mDirectory, metrics.walPosition);
+	for (auto& entry : snapshot) {
+		if (!entry.second.columns.empty()) {
+			metrics.numRows += entry.second.columns[0].size();
+		}
+	}
+
+	auto writeTime = Helpers::timeNow();
+	metrics.numWalBytesRemoved = mWriteAheadLog->truncate(metrics.walPosition);
+
+	auto endTime = Helpers::timeNow();
+	metrics.snapshotTime = Helpers::durationMilliseconds(snapshotTime, startTime);
+	metrics.writeTime = Helpers::durationMilliseconds(writeTime, snapshotTime);
+	metrics.truncateTime = Helpers::durationMilliseconds(endTime, writeTime);
+	metrics.totalTime = Helpers::durationMilliseconds(endTime, startTime);
+
+	std::lock_guard<std::mutex> guard(mCheckpointMetricsMutex);
+	mCheckpointMetrics.push_back(metrics);
+	return metrics;
+}
+
+std::vector<CheckpointMetrics> DatabaseEngine::checkpointMetrics() const {
+	std::lock_guard<std::mutex> guard(mCheckpointMetricsMutex);
+	return mCheckpointMetrics;
+}
+
+WriteAheadLog* DatabaseEngine::writeAheadLog() const {
+	return mWriteAheadLog.get();
+}
+
+void DatabaseEngine::commit(std::uint64_t walPosition) {
+	mWriteAheadLog->commit(walPosition);
+
+	if (mCheckpointer && mWriteAheadLog->size() >= mConfig.checkpointWalSize) {
+		mCheckpointer->request();
+	}
+}
+
+std::mutex& DatabaseEngine::writeMutex() {
+	return mWriteMutex;
 }
 
 Table& DatabaseEngine::getTable(const std::string& name) const {
@@ -25,7 +141,28 @@ Table& DatabaseEngine::getTable(const std::string& name) const {
 
 std::unique_ptr<QueryOperation> DatabaseEngine::parse(const std::string& text) const {
 	QueryParser parser(Tokenizer::tokenize(text));
-	return parser.parse();
+	auto operation = parser.parse();
+	if (!parser.parameters().empty()) {
+		throw std::runtime_error("Parameters are only supported in prepared statements.");
+	}
+
+	return operation;
+}
+
+std::size_t DatabaseEngine::catalogVersion() const {
+	return mCatalogVersion;
+}
+
+std::shared_ptr<PreparedStatement> DatabaseEngine::prepare(const std::string& text) {
+	std::lock_guard<std::mutex> guard(mPreparedStatementsMutex);
+	auto preparedStatement = mPreparedStatements.find(text);
+	if (preparedStatement != mPreparedStatements.end()) {
+		return preparedStatement->second;
+	}
+
+	auto statement = std::make_shared<PreparedStatement>(*this, text);
+	mPreparedStatements[text] = statement;
+	return statement;
 }
 
 void DatabaseEngine::execute(const Query& query, QueryResult& result) {
@@ -1,12 +1,18 @@
 #pragma once
+#include <atomic>
 #include <unordered_map>
 #include <memory>
+#include <mutex>
+#include <string>
 
 #include "table.h"
+#include "write_ahead_log.h"
+#include "checkpointer.h"
 
 struct Query;
 struct QueryResult;
 struct QueryOperation;
+class PreparedStatement;
 
 /**
  * The database configuration
@@ -14,6 +20,28 @@ struct QueryOperation;
 struct DatabaseConfiguration {
 	bool optimizeExpressions = true;
 	bool optimizeExecution = false;
+	bool batchExecution = true;
+
+	// The number of threads used for scans. Zero uses all hardware threads.
+	std::size_t parallelism = 0;
+
+	// Sorts the rows found by an index scan by row id, which makes gathering their values sequential
+	bool sortIndexScanRows = true;
+
+	// Filters that compare an int32 column against a value compare the encoded values of its encoded segments instead of decoding them
+	bool scanEncodedColumns = true;
+
+	// The number of bytes that an ordered result may buffer before sorted runs are spilled to disk. Zero disables spilling.
+	std::size_t sortMemoryLimit = 0;
+
+	// The directory where the spilled runs are written
+	std::string sortDirectory = "/tmp";
+
+	// When the write-ahead log of an opened database is synced to disk
+	WalSyncMode walSyncMode = WalSyncMode::Group;
+
+	// The size in bytes of the write-ahead log that starts a checkpoint in the background. Zero disables them.
+	std::size_t checkpointWalSize = 0;
 };
 
 /**
@@ -23,17 +51,35 @@ class DatabaseEngine {
 private:
 	DatabaseConfiguration mConfig;
 	std::unordered_map<std::string, std::unique_ptr<Table>> mTables;
+	std::atomic<std::size_t> mCatalogVersion { 0 };
+	std::unordered_map<std::string, std::shared_ptr<PreparedStatement>> mPreparedStatements;
+	std::mutex mPreparedStatementsMutex;
+
+	std::string mDirectory;
+	std::unique_ptr<WriteAheadLog> mWriteAheadLog;
+	std::mutex mWriteMutex;
+
+	std::mutex mCheckpointMutex;
+	mutable std::mutex mCheckpointMetricsMutex;
+	std::vector<CheckpointMetrics> mCheckpointMetrics;
+	std::unique_ptr<Checkpointer> mCheckpointer;
 public:
 	/**
 	 * Creates a new database engine
 	 */
 	explicit DatabaseEngine(DatabaseConfiguration config = {});
+	~DatabaseEngine();
 
 	/**
 	 * Returns the configuration
 	 */
 	const DatabaseConfiguration& config() const;
 
+	/**
+	 * Returns the configuration
+	 */
+	DatabaseConfiguration& config();
+
 	/**
 	 * Adds a new table
 	 * @param name The name of the table
@@ -41,6 +87,48 @@ public:
 	 */
 	void addTable(std::string name, std::unique_ptr<Table> table);
 
+	/**
+	 * Writes the tables to the given directory, as a catalog file and one file per column.
+	 * Saving to the opened directory removes the records of the write-ahead log, which are then stored in the table files.
+	 * @param directory The directory
+	 */
+	void save(const std::string& directory);
+
+	/**
+	 * Adds the tables stored in the given directory. The columns are mapped into memory, which makes them used without being read.
+	 * The changes in the write-ahead log of the directory are applied, and later changes are logged to it.
+	 * @param directory The directory
+	 */
+	void open(const std::string& directory);
+
+	/**
+	 * Writes the tables to the opened directory and removes the records they contain from the write-ahead log.
+	 * The columns are copied first, which lets changes continue while the files are written.
+	 * @return The metrics of the checkpoint
+	 */
+	CheckpointMetrics checkpoint();
+
+	/**
+	 * Returns the metrics of the checkpoints made so far
+	 */
+	std::vector<CheckpointMetrics> checkpointMetrics() const;
+
+	/**
+	 * Returns the write-ahead log, which is null unless a directory has been opened
+	 */
+	WriteAheadLog* writeAheadLog() const;
+
+	/**
+	 * Commits the records of a change up to the given position, and requests a checkpoint if the log has grown too large
+	 * @param walPosition The position in the write-ahead log
+	 */
+	void commit(std::uint64_t walPosition);
+
+	/**
+	 * Returns the mutex that orders the changes to the tables with the records of the write-ahead log
+	 */
+	std::mutex& writeMutex();
+
 	/**
 	 * Returns the given table
 	 * @param name The name of the table
@@ -53,6 +141,19 @@ public:
 	 */
 	std::unique_ptr<QueryOperation> parse(const std::string& text) const;
 
+	/**
+	 * Returns the version of the tables and their indices, which changes when they change
+	 */
+	std::size_t catalogVersion() const;
+
+	/**
+	 * Parses the given text as a prepared statement, where each '?' is a parameter.
+	 * Statements are cached by their text, which makes preparing the same text again return the same statement.
+	 * Sessions that share a statement execute it at the same time.
+	 * @param text The text
+	 */
+	std::shared_ptr<PreparedStatement> prepare(const std::string& text);
+
 	/**
 	 * Executes the given query
 	 * @param query The query
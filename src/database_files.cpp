@@ -0,0 +1,411 @@
+#include "database_files.h"
+#include "table.h"
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+#include <unistd.h>
+
+namespace {
+	const char COLUMN_FILE_MAGIC[8] = { 'C', 'O', 'L', 'U', 'M', 'N', 'S', '\0' };
+	constexpr std::uint32_t COLUMN_FILE_VERSION = 1;
+
+	// The values start at this offset, which keeps them aligned
+	constexpr std::size_t COLUMN_FILE_DATA_OFFSET = 64;
+
+	struct ColumnFileHeader {
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t type;
+		std::uint64_t numValues;
+	};
+
+	static_assert(sizeof(ColumnFileHeader) <= COLUMN_FILE_DATA_OFFSET, "The header must fit before the values.");
+
+	const std::string CATALOG_FILE_NAME = "catalog";
+
+	std::string typeName(ColumnType type) {
+		switch (type) {
+			case ColumnType::Bool:
+				return "bool";
+			case ColumnType::Int32:
+				return "int32";
+			case ColumnType::Float32:
+				return "float32";
+		}
+
+		throw std::runtime_error("Invalid type.");
+	}
+
+	ColumnType parseTypeName(const std::string& name) {
+		for (auto type : { ColumnType::Bool, ColumnType::Int32, ColumnType::Float32 }) {
+			if (typeName(type) == name) {
+				return type;
+			}
+		}
+
+		throw std::runtime_error("Invalid type '" + name + "' in the catalog.");
+	}
+
+	const std::string COLUMN_FILE_EXTENSION = ".column";
+
+	/**
+	 * Returns the name of a column file. Each write of the tables uses a new epoch, which keeps the files that the
+	 * current catalog refers to unchanged until the new catalog replaces it. Epoch zero is the name without an epoch.
+	 */
+	std::string columnFileName(const std::string& table, const std::string& column, std::uint64_t epoch) {
+		auto name = table + "." + column;
+		if (epoch > 0) {
+			name += "." + std::to_string(epoch);
+		}
+
+		return name + COLUMN_FILE_EXTENSION;
+	}
+
+	/**
+	 * Writes a file and syncs it to disk
+	 * @return False if the file could not be written
+	 */
+	template<typename F>
+	bool writeFile(const std::string& path, F writeContent) {
+		auto file = std::fopen(path.c_str(), "wb");
+		if (file == nullptr) {
+			return false;
+		}
+
+		auto success = writeContent(file);
+		success = success && std::fflush(file) == 0 && fsync(fileno(file)) == 0;
+		return std::fclose(file) == 0 && success;
+	}
+
+	/**
+	 * Writes a file by writing a temporary file that replaces it when complete
+	 */
+	template<typename F>
+	void replaceFile(const std::string& path, F writeContent) {
+		auto temporaryPath = path + ".tmp";
+		if (!writeFile(temporaryPath, writeContent) || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+			std::remove(temporaryPath.c_str());
+			throw std::runtime_error("Could not write '" + path + "'.");
+		}
+	}
+
+	/**
+	 * Syncs the entries of the given directory to disk, which makes the files created and renamed in it durable
+	 */
+	void syncDirectory(const std::string& directory) {
+		auto fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+		if (fd < 0) {
+			throw std::runtime_error("Could not open the directory '" + directory + "'.");
+		}
+
+		auto success = fsync(fd) == 0;
+		close(fd);
+		if (!success) {
+			throw std::runtime_error("Could not sync the directory '" + directory + "'.");
+		}
+	}
+
+	/**
+	 * Returns the epoch of the catalog in the given directory, which is zero if there is none
+	 */
+	std::uint64_t catalogEpoch(const std::string& directory) {
+		std::ifstream catalog(directory + "/" + CATALOG_FILE_NAME);
+		std::string line;
+		while (std::getline(catalog, line)) {
+			std::istringstream lineStream(line);
+			std::string kind;
+			std::uint64_t epoch = 0;
+			if (lineStream >> kind && kind == "epoch" && lineStream >> epoch) {
+				return epoch;
+			}
+		}
+
+		return 0;
+	}
+
+	/**
+	 * Removes the column files in the given directory that are not in the given set of file names
+	 */
+	void removeColumnFiles(const std::string& directory, const std::unordered_set<std::string>& keepFileNames) {
+		auto entries = opendir(directory.c_str());
+		if (entries == nullptr) {
+			return;
+		}
+
+		std::vector<std::string> removeFileNames;
+		while (auto entry = readdir(entries)) {
+			std::string name = entry->d_name;
+			auto extensionSize = COLUMN_FILE_EXTENSION.size();
+			auto isColumnFile = name.size() > extensionSize
+				&& name.compare(name.size() - extensionSize, extensionSize, COLUMN_FILE_EXTENSION) == 0;
+			if (isColumnFile && keepFileNames.count(name) == 0) {
+				removeFileNames.push_back(name);
+			}
+		}
+
+		closedir(entries);
+
+		// Mappings of removed files stay valid, which lets tables that were opened from them keep using them
+		for (auto& name : removeFileNames) {
+			std::remove((directory + "/" + name).c_str());
+		}
+	}
+
+	std::size_t writeColumn(const ColumnStorage& column, const std::string& path) {
+		auto success = writeFile(path, [&](std::FILE* file) {
+			std::uint8_t header[COLUMN_FILE_DATA_OFFSET] = {};
+			ColumnFileHeader columnHeader;
+			std::memcpy(columnHeader.magic, COLUMN_FILE_MAGIC, sizeof(COLUMN_FILE_MAGIC));
+			columnHeader.version = COLUMN_FILE_VERSION;
+			columnHeader.type = (std::uint32_t)column.type();
+			columnHeader.numValues = column.size();
+			std::memcpy(header, &columnHeader, sizeof(ColumnFileHeader));
+			if (std::fwrite(header, sizeof(header), 1, file) != 1) {
+				return false;
+			}
+
+			// Bool columns are stored as one byte per value
+			if (column.type() == ColumnType::Bool) {
+				auto& values = column.getUnderlyingStorage<bool>();
+				std::vector<std::uint8_t> bytes(values.begin(), values.end());
+				return std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+			}
+
+			auto handleForType = [&](auto dummy) {
+				using Type = decltype(dummy);
+				auto& values = column.getUnderlyingStorage<Type>();
+				bool written = true;
+				values.forEachSegment(0, values.size(), [&](const Type* segmentValues, std::size_t startIndex, std::size_t count) {
+					written = written && std::fwrite(segmentValues, sizeof(Type), count, file) == count;
+				});
+
+				return written;
+			};
+
+			return handleTypeResult<bool>(
+				column.type(),
+				[&]() { return false; },
+				[&]() { return handleForType((std::int32_t)0); },
+				[&]() { return handleForType((float)0); });
+		});
+
+		if (!success) {
+			std::remove(path.c_str());
+			throw std::runtime_error("Could not write '" + path + "'.");
+		}
+
+		auto valueSize = handleTypeResult<std::size_t>(
+			column.type(),
+			[&]() { return sizeof(std::uint8_t); },
+			[&]() { return sizeof(std::int32_t); },
+			[&]() { return sizeof(float); });
+		return COLUMN_FILE_DATA_OFFSET + column.size() * valueSize;
+	}
+
+	/**
+	 * Writes the column files of tables and the catalog that describes them.
+	 * The column files get names of a new epoch, and the catalog that refers to them replaces the current one last.
+	 * A crash before that leaves the current catalog and its files as they were.
+	 */
+	class CatalogWriter {
+	private:
+		std::string mDirectory;
+		std::uint64_t mEpoch;
+		std::ostringstream mCatalog;
+		std::unordered_set<std::string> mColumnFileNames;
+		std::size_t mNumBytes = 0;
+	public:
+		CatalogWriter(const std::string& directory, std::uint64_t walPosition)
+			: mDirectory(directory), mEpoch(catalogEpoch(directory) + 1) {
+			mCatalog << "wal " << walPosition << "\n";
+			mCatalog << "epoch " << mEpoch << "\n";
+		}
+
+		void writeTable(const std::string& name,
+						const Schema& schema,
+						std::function<const ColumnStorage& (const ColumnDefinition&)> getColumn) {
+			auto numRows = schema.columns().empty() ? 0 : getColumn(schema.columns()[0]).size();
+			mCatalog << "table " << name << " " << schema.name() << " " << numRows << "\n";
+
+			for (auto& column : schema.columns()) {
+				auto fileName = columnFileName(name, column.name(), mEpoch);
+				mColumnFileNames.insert(fileName);
+				mNumBytes += writeColumn(getColumn(column), mDirectory + "/" + fileName);
+				mCatalog << "column " << column.name() << " " << typeName(column.type()) << "\n";
+			}
+
+			for (auto& index : schema.indices()) {
+				mCatalog << "index " << index.column() << " " << (index.type() == IndexType::Hash ? "hash" : "tree") << "\n";
+			}
+
+			mCatalog << "end\n";
+		}
+
+		/**
+		 * Writes the catalog and returns the number of bytes written
+		 */
+		std::size_t finish() {
+			// The catalog is written last, which makes it refer to complete column files
+			auto catalogText = mCatalog.str();
+			replaceFile(mDirectory + "/" + CATALOG_FILE_NAME, [&](std::FILE* file) {
+				return std::fwrite(catalogText.data(), 1, catalogText.size(), file) == catalogText.size();
+			});
+
+			syncDirectory(mDirectory);
+
+			// The files of earlier epochs are only removed once the new catalog is durable
+			removeColumnFiles(mDirectory, mColumnFileNames);
+			return mNumBytes + catalogText.size();
+		}
+	};
+
+	ColumnStorage openColumn(const ColumnDefinition& column, std::size_t numRows, const std::string& path) {
+		auto mappedFile = std::make_shared<MappedFile>(path);
+
+		ColumnFileHeader header;
+		if (mappedFile->size() < COLUMN_FILE_DATA_OFFSET) {
+			throw std::runtime_error("The column file '" + path + "' is invalid.");
+		}
+
+		std::memcpy(&header, mappedFile->data(), sizeof(ColumnFileHeader));
+		if (std::memcmp(header.magic, COLUMN_FILE_MAGIC, sizeof(COLUMN_FILE_MAGIC)) != 0
+			|| header.version != COLUMN_FILE_VERSION
+			|| header.type != (std::uint32_t)column.type()
+			|| header.numValues != numRows) {
+			throw std::runtime_error("The column file '" + path + "' is invalid.");
+		}
+
+		auto valueSize = handleGenericTypeResult(std::size_t, column.type(), [&](auto dummy) {
+			return sizeof(decltype(dummy));
+		});
+
+		if (mappedFile->size() < COLUMN_FILE_DATA_OFFSET + numRows * valueSize) {
+			throw std::runtime_error("The column file '" + path + "' is truncated.");
+		}
+
+		return ColumnStorage::fromMappedFile(column.type(), std::move(mappedFile), COLUMN_FILE_DATA_OFFSET, numRows);
+	}
+}
+
+DatabaseFiles::Snapshot DatabaseFiles::snapshot(const Tables& tables) {
+	Snapshot snapshot;
+	for (auto& entry : tables) {
+		auto& table = *entry.second;
+		TableSnapshot tableSnapshot { table.schema(), {} };
+		for (auto& column : table.schema().columns()) {
+			tableSnapshot.columns.push_back(table.getColumn(column.name()).copy());
+		}
+
+		snapshot.emplace(entry.first, std::move(tableSnapshot));
+	}
+
+	return snapshot;
+}
+
+std::size_t DatabaseFiles::write(const Tables& tables, const std::string& directory, std::uint64_t walPosition) {
+	CatalogWriter catalog(directory, walPosition);
+	for (auto& entry : tables) {
+		auto& table = *entry.second;
+		catalog.writeTable(entry.first, table.schema(), [&](const ColumnDefinition& column) -> const ColumnStorage& {
+			return table.getColumn(column.name());
+		});
+	}
+
+	return catalog.finish();
+}
+
+std::size_t DatabaseFiles::write(const Snapshot& snapshot, const std::string& directory, std::uint64_t walPosition) {
+	CatalogWriter catalog(directory, walPosition);
+	for (auto& entry : snapshot) {
+		auto& tableSnapshot = entry.second;
+		catalog.writeTable(entry.first, tableSnapshot.schema, [&](const ColumnDefinition& column) -> const ColumnStorage& {
+			return tableSnapshot.columns[column.index()];
+		});
+	}
+
+	return catalog.finish();
+}
+
+DatabaseFiles::Tables DatabaseFiles::open(const std::string& directory, std::uint64_t& walPosition) {
+	Tables tables;
+	walPosition = 0;
+
+	if (access(directory.c_str(), F_OK) != 0) {
+		throw std::runtime_error("The directory '" + directory + "' does not exist.");
+	}
+
+	// A directory without a catalog holds no tables yet, only possibly a write-ahead log
+	std::ifstream catalog(directory + "/" + CATALOG_FILE_NAME);
+	if (!catalog) {
+		return tables;
+	}
+
+	std::string tableName;
+	std::string schemaName;
+	std::size_t numRows = 0;
+	std::vector<ColumnDefinition> columns;
+	std::vector<IndexDefinition> indices;
+	std::uint64_t epoch = 0;
+	bool inTable = false;
+
+	std::string line;
+	while (std::getline(catalog, line)) {
+		std::istringstream lineStream(line);
+		std::string kind;
+		if (!(lineStream >> kind)) {
+			continue;
+		}
+
+		if (kind == "wal" && !inTable) {
+			lineStream >> walPosition;
+		} else if (kind == "epoch" && !inTable) {
+			lineStream >> epoch;
+		} else if (kind == "table" && !inTable) {
+			lineStream >> tableName >> schemaName >> numRows;
+			columns.clear();
+			indices.clear();
+			inTable = true;
+		} else if (kind == "column" && inTable) {
+			std::string name;
+			std::string type;
+			lineStream >> name >> type;
+			columns.emplace_back(columns.size(), name, parseTypeName(type));
+		} else if (kind == "index" && inTable) {
+			std::string column;
+			std::string type;
+			lineStream >> column >> type;
+			indices.emplace_back(column, type == "hash" ? IndexType::Hash : IndexType::Tree);
+		} else if (kind == "end" && inTable) {
+			auto table = std::make_unique<Table>(Schema(schemaName, columns, indices));
+
+			std::vector<ColumnStorage> columnsStorage;
+			for (auto& column : table->schema().columns()) {
+				auto path = directory + "/" + columnFileName(tableName, column.name(), epoch);
+				columnsStorage.push_back(openColumn(column, numRows, path));
+			}
+
+			table->appendColumns(std::move(columnsStorage));
+			tables[tableName] = std::move(table);
+			inTable = false;
+			continue;
+		} else {
+			throw std::runtime_error("Invalid line '" + line + "' in the catalog.");
+		}
+
+		if (lineStream.fail()) {
+			throw std::runtime_error("Invalid line '" + line + "' in the catalog.");
+		}
+	}
+
+	if (inTable) {
+		throw std::runtime_error("The catalog ends inside a table.");
+	}
+
+	return tables;
+}
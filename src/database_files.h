@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "table.h"
+
+/**
+ * Stores tables on disk as a catalog file, which describes the schemas and indices, and one file per column.
+ * A column file holds a header followed by the raw values, which allows it to be mapped into memory and used in place.
+ */
+namespace DatabaseFiles {
+	using Tables = std::unordered_map<std::string, std::unique_ptr<Table>>;
+
+	/**
+	 * A copy of the columns of a table, in the order of the schema
+	 */
+	struct TableSnapshot {
+		Schema schema;
+		std::vector<ColumnStorage> columns;
+	};
+
+	using Snapshot = std::unordered_map<std::string, TableSnapshot>;
+
+	/**
+	 * Copies the columns of the given tables, which lets them be written while the tables change
+	 * @param tables The tables
+	 */
+	Snapshot snapshot(const Tables& tables);
+
+	/**
+	 * Writes the given tables to the given directory. The column files are written under new names and the catalog is
+	 * replaced last, which makes a crash leave the previous tables. Existing mappings of the previous files stay valid.
+	 * @param tables The tables
+	 * @param directory The directory
+	 * @param walPosition The position in the write-ahead log that the tables contain the records up to
+	 * @return The number of bytes written
+	 */
+	std::size_t write(const Tables& tables, const std::string& directory, std::uint64_t walPosition = 0);
+
+	/**
+	 * Writes the given snapshot to the given directory, like the tables it was taken of
+	 * @param snapshot The snapshot
+	 * @param directory The directory
+	 * @param walPosition The position in the write-ahead log that the snapshot contains the records up to
+	 * @return The number of bytes written
+	 */
+	std::size_t write(const Snapshot& snapshot, const std::string& directory, std::uint64_t walPosition);
+
+	/**
+	 * Opens the tables in the given directory. The columns are mapped without being read, while the indices are built from them.
+	 * A directory without a catalog has no tables.
+	 * @param directory The directory
+	 * @param walPosition Set to the position in the write-ahead log that the tables contain the records up to
+	 */
+	Tables open(const std::string& directory, std::uint64_t& walPosition);
+}
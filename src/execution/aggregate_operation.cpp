@@ -0,0 +1,525 @@
+#include "aggregate_operation.h"
+#include "expression_execution.h"
+#include "index_scanner.h"
+#include "virtual_table.h"
+#include "../query.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+	constexpr std::size_t EMPTY_SLOT = std::numeric_limits<std::size_t>::max();
+
+	/**
+	 * The state of an aggregate function for a group
+	 */
+	struct AggregateAccumulator {
+		std::int64_t count = 0;
+		std::int64_t intValue = 0;
+		double floatValue = 0.0;
+	};
+
+	inline std::int64_t& accumulatorValue(AggregateAccumulator& accumulator, bool) {
+		return accumulator.intValue;
+	}
+
+	inline std::int64_t& accumulatorValue(AggregateAccumulator& accumulator, std::int32_t) {
+		return accumulator.intValue;
+	}
+
+	inline double& accumulatorValue(AggregateAccumulator& accumulator, float) {
+		return accumulator.floatValue;
+	}
+
+	/**
+	 * Encodes the given value as a group key
+	 */
+	inline std::uint64_t encodeKey(bool value) {
+		return value ? 1 : 0;
+	}
+
+	inline std::uint64_t encodeKey(std::int32_t value) {
+		return (std::uint32_t)value;
+	}
+
+	inline std::uint64_t encodeKey(float value) {
+		// Negative and positive zero are the same group
+		if (value == 0.0f) {
+			value = 0.0f;
+		}
+
+		std::uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	/**
+	 * Decodes the given group key
+	 * @tparam T The type of the value
+	 */
+	template<typename T>
+	inline T decodeKey(std::uint64_t key);
+
+	template<>
+	inline bool decodeKey<bool>(std::uint64_t key) {
+		return key != 0;
+	}
+
+	template<>
+	inline std::int32_t decodeKey<std::int32_t>(std::uint64_t key) {
+		return (std::int32_t)(std::uint32_t)key;
+	}
+
+	template<>
+	inline float decodeKey<float>(std::uint64_t key) {
+		auto bits = (std::uint32_t)key;
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	inline std::uint64_t hashKey(const std::uint64_t* key, std::size_t numKeyColumns) {
+		std::uint64_t hash = 0;
+		for (std::size_t i = 0; i < numKeyColumns; i++) {
+			hash = (hash ^ key[i]) * 0x9E3779B97F4A7C15ull;
+			hash ^= hash >> 32;
+		}
+
+		return hash;
+	}
+
+	/**
+	 * A flat open-addressing hash table from group keys to group indices.
+	 * The keys are stored contiguously, in the order the groups were first seen.
+	 */
+	class GroupHashTable {
+	private:
+		std::size_t mNumKeyColumns;
+		std::vector<std::uint64_t> mKeys;
+		std::vector<std::uint64_t> mHashes;
+		std::vector<std::size_t> mSlots;
+		std::size_t mNumGroups = 0;
+
+		void grow() {
+			mSlots.assign(mSlots.size() * 2, EMPTY_SLOT);
+			auto mask = mSlots.size() - 1;
+
+			for (std::size_t groupIndex = 0; groupIndex < mNumGroups; groupIndex++) {
+				auto slot = mHashes[groupIndex] & mask;
+				while (mSlots[slot] != EMPTY_SLOT) {
+					slot = (slot + 1) & mask;
+				}
+
+				mSlots[slot] = groupIndex;
+			}
+		}
+	public:
+		/**
+		 * Creates a new table
+		 * @param numKeyColumns The number of columns in the key
+		 */
+		explicit GroupHashTable(std::size_t numKeyColumns)
+			: mNumKeyColumns(numKeyColumns), mSlots(64, EMPTY_SLOT) {
+
+		}
+
+		/**
+		 * Returns the number of groups
+		 */
+		std::size_t numGroups() const {
+			return mNumGroups;
+		}
+
+		/**
+		 * Returns the given key column of the given group
+		 * @param groupIndex The group
+		 * @param keyColumnIndex The key column
+		 */
+		std::uint64_t key(std::size_t groupIndex, std::size_t keyColumnIndex) const {
+			return mKeys[groupIndex * mNumKeyColumns + keyColumnIndex];
+		}
+
+		/**
+		 * Returns the group with the given key. The group is created if it does not exist.
+		 * @param key The key
+		 * @param hash The hash of the key
+		 */
+		inline std::size_t findOrInsert(const std::uint64_t* key, std::uint64_t hash) {
+			if (2 * (mNumGroups + 1) > mSlots.size()) {
+				grow();
+			}
+
+			auto mask = mSlots.size() - 1;
+			for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+				auto groupIndex = mSlots[slot];
+				if (groupIndex == EMPTY_SLOT) {
+					mSlots[slot] = mNumGroups;
+					mHashes.push_back(hash);
+					mKeys.insert(mKeys.end(), key, key + mNumKeyColumns);
+					return mNumGroups++;
+				}
+
+				if (mHashes[groupIndex] == hash
+					&& std::equal(key, key + mNumKeyColumns, mKeys.data() + groupIndex * mNumKeyColumns)) {
+					return groupIndex;
+				}
+			}
+		}
+	};
+
+	/**
+	 * Updates the accumulators of an aggregate function with the given values
+	 * @param function The aggregate function
+	 * @param values The values
+	 * @param groupIndices The group of each value
+	 * @param count The number of values
+	 * @param accumulators The accumulators of the groups
+	 */
+	template<typename T>
+	void updateAccumulators(AggregateFunction function,
+							const UnderlyingColumnStorage<T>& values,
+							const std::size_t* groupIndices,
+							std::size_t count,
+							AggregateAccumulator* accumulators) {
+		switch (function) {
+			case AggregateFunction::Count:
+				for (std::size_t i = 0; i < count; i++) {
+					accumulators[groupIndices[i]].count++;
+				}
+				break;
+			case AggregateFunction::Sum:
+			case AggregateFunction::Average:
+				for (std::size_t i = 0; i < count; i++) {
+					auto& accumulator = accumulators[groupIndices[i]];
+					accumulatorValue(accumulator, T()) += values[i];
+					accumulator.count++;
+				}
+				break;
+			case AggregateFunction::Min:
+				for (std::size_t i = 0; i < count; i++) {
+					auto& accumulator = accumulators[groupIndices[i]];
+					auto& value = accumulatorValue(accumulator, T());
+					if (accumulator.count == 0 || values[i] < value) {
+						value = values[i];
+					}
+
+					accumulator.count++;
+				}
+				break;
+			case AggregateFunction::Max:
+				for (std::size_t i = 0; i < count; i++) {
+					auto& accumulator = accumulators[groupIndices[i]];
+					auto& value = accumulatorValue(accumulator, T());
+					if (accumulator.count == 0 || values[i] > value) {
+						value = values[i];
+					}
+
+					accumulator.count++;
+				}
+				break;
+		}
+	}
+
+	/**
+	 * Returns the result type of the given aggregate function
+	 * @param function The function
+	 * @param argumentType The type of the argument
+	 */
+	ColumnType aggregateResultType(AggregateFunction function, ColumnType argumentType) {
+		switch (function) {
+			case AggregateFunction::Count:
+				return ColumnType::Int32;
+			case AggregateFunction::Sum:
+			case AggregateFunction::Average:
+				if (argumentType == ColumnType::Bool) {
+					throw std::runtime_error("Only Int32 and Float32 supported.");
+				}
+
+				return function == AggregateFunction::Sum ? argumentType : ColumnType::Float32;
+			case AggregateFunction::Min:
+			case AggregateFunction::Max:
+				return argumentType;
+		}
+
+		return argumentType;
+	}
+}
+
+AggregateOperationExecutor::AggregateOperationExecutor(DatabaseEngine& databaseEngine,
+													   VirtualTableContainer& tableContainer,
+													   QuerySelectOperation* operation,
+													   ExpressionExecutionEngine& filterExecutionEngine,
+													   QueryResult& result)
+	: mDatabaseEngine(databaseEngine),
+	  mTableContainer(tableContainer),
+	  mTable(tableContainer.getTable(operation->table)),
+	  mOperation(operation),
+	  mFilterExecutionEngine(filterExecutionEngine),
+	  mResult(result) {
+	if (!operation->join.empty) {
+		throw std::runtime_error("Joins are not supported when aggregating.");
+	}
+
+	compileGroupColumns();
+	compileProjections();
+}
+
+std::int64_t AggregateOperationExecutor::findGroupColumn(const std::string& name) const {
+	auto fullName = QueryExpressionHelpers::fullColumnName(mOperation->table, name);
+	for (std::size_t groupIndex = 0; groupIndex < mOperation->group.columns.size(); groupIndex++) {
+		if (QueryExpressionHelpers::fullColumnName(mOperation->table, mOperation->group.columns[groupIndex]) == fullName) {
+			return (std::int64_t)groupIndex;
+		}
+	}
+
+	return -1;
+}
+
+void AggregateOperationExecutor::compileGroupColumns() {
+	for (auto& column : mOperation->group.columns) {
+		auto accessExpression = std::make_unique<QueryColumnReferenceExpression>(column);
+		mGroupExecutionEngines.push_back(std::make_unique<ExpressionExecutionEngine>(ExecutorHelpers::compile(
+			mTableContainer,
+			mOperation->table,
+			accessExpression.get(),
+			mDatabaseEngine.config())));
+	}
+}
+
+void AggregateOperationExecutor::compileProjections() {
+	for (auto& projection : mOperation->projections) {
+		if (auto aggregateExpression = dynamic_cast<QueryAggregateExpression*>(projection.get())) {
+			AggregateColumn aggregate;
+			aggregate.function = aggregateExpression->function;
+			aggregate.argumentType = ColumnType::Int32;
+
+			if (aggregateExpression->argument) {
+				aggregate.argumentExecutionEngine = std::make_unique<ExpressionExecutionEngine>(ExecutorHelpers::compile(
+					mTableContainer,
+					mOperation->table,
+					aggregateExpression->argument.get(),
+					mDatabaseEngine.config()));
+				aggregate.argumentType = aggregate.argumentExecutionEngine->expressionType();
+			} else if (aggregate.function != AggregateFunction::Count) {
+				throw std::runtime_error("Only count can be used without an argument.");
+			}
+
+			aggregate.resultType = aggregateResultType(aggregate.function, aggregate.argumentType);
+			mResult.columns.emplace_back(aggregate.resultType);
+			mProjectionSources.push_back(ProjectionSource { true, mAggregates.size() });
+			mAggregates.push_back(std::move(aggregate));
+		} else if (auto columnExpression = dynamic_cast<QueryColumnReferenceExpression*>(projection.get())) {
+			auto groupIndex = findGroupColumn(columnExpression->name);
+			if (groupIndex == -1) {
+				throw std::runtime_error("The column '" + columnExpression->name + "' must be grouped by or aggregated.");
+			}
+
+			mResult.columns.emplace_back(mGroupExecutionEngines[groupIndex]->expressionType());
+			mProjectionSources.push_back(ProjectionSource { false, (std::size_t)groupIndex });
+		} else {
+			throw std::runtime_error("Only aggregates and grouped columns can be projected when aggregating.");
+		}
+	}
+}
+
+void AggregateOperationExecutor::orderResult() {
+	std::vector<ColumnType> orderingDataTypes;
+	std::vector<std::vector<RawQueryValue>> orderingData;
+
+	for (auto& column : mOperation->order.columns) {
+		auto groupIndex = findGroupColumn(column.name);
+		if (groupIndex == -1) {
+			throw std::runtime_error("Only grouped columns can be ordered by when aggregating.");
+		}
+
+		auto& groupValues = mGroupValues[groupIndex];
+		orderingDataTypes.push_back(groupValues.type());
+		orderingData.emplace_back();
+		for (std::size_t rowIndex = 0; rowIndex < groupValues.size(); rowIndex++) {
+			orderingData.back().push_back(groupValues.getValue(rowIndex).data);
+		}
+	}
+
+	ExecutorHelpers::orderResult(
+		mDatabaseEngine.config(),
+		orderingDataTypes,
+		mOperation->order.columns,
+		orderingData,
+		mResult);
+}
+
+void AggregateOperationExecutor::execute() {
+	auto numKeyColumns = mGroupExecutionEngines.size();
+
+	mResult.plan.push_back("Scan: " + TreeIndexScanner().describeSequentialScan(mTable));
+	mResult.plan.push_back("Aggregate: hash aggregation on " + std::to_string(numKeyColumns) + " columns");
+	if (!mOperation->order.empty()) {
+		mResult.plan.push_back("Sort: all groups");
+	}
+
+	if (mOperation->explain) {
+		return;
+	}
+	GroupHashTable groupTable(numKeyColumns);
+	std::vector<std::vector<AggregateAccumulator>> accumulators(mAggregates.size());
+
+	// Without grouping, there is always exactly one group
+	if (numKeyColumns == 0) {
+		groupTable.findOrInsert(nullptr, hashKey(nullptr, 0));
+		for (auto& aggregateAccumulators : accumulators) {
+			aggregateAccumulators.resize(1);
+		}
+	}
+
+	std::vector<ColumnStorage> keyValues;
+	for (auto& groupExecutionEngine : mGroupExecutionEngines) {
+		keyValues.emplace_back(groupExecutionEngine->expressionType());
+	}
+
+	std::vector<ColumnStorage> argumentValues;
+	for (auto& aggregate : mAggregates) {
+		argumentValues.emplace_back(aggregate.argumentType);
+	}
+
+	std::vector<std::uint64_t> batchKeys;
+	std::vector<std::size_t> groupIndices;
+
+	ExecutorHelpers::forEachBatchFiltered(
+		mTable,
+		mFilterExecutionEngine,
+		[&](const std::vector<std::size_t>& rowIndices) {
+			auto numRows = rowIndices.size();
+
+			// Find the group of each row
+			batchKeys.resize(numRows * numKeyColumns);
+			for (std::size_t keyColumnIndex = 0; keyColumnIndex < numKeyColumns; keyColumnIndex++) {
+				auto& values = keyValues[keyColumnIndex];
+
+				auto handleForType = [&](auto dummy) {
+					using Type = decltype(dummy);
+					auto& underlyingValues = values.getUnderlyingStorage<Type>();
+					underlyingValues.clear();
+					ExecutorHelpers::addExpressionToResult(*mGroupExecutionEngines[keyColumnIndex], values, rowIndices);
+
+					for (std::size_t i = 0; i < numRows; i++) {
+						batchKeys[i * numKeyColumns + keyColumnIndex] = encodeKey(underlyingValues[i]);
+					}
+				};
+
+				handleGenericType(values.type(), handleForType);
+			}
+
+			groupIndices.resize(numRows);
+			for (std::size_t i = 0; i < numRows; i++) {
+				auto key = batchKeys.data() + i * numKeyColumns;
+				groupIndices[i] = groupTable.findOrInsert(key, hashKey(key, numKeyColumns));
+			}
+
+			// Update the aggregates, one at a time
+			for (std::size_t aggregateIndex = 0; aggregateIndex < mAggregates.size(); aggregateIndex++) {
+				auto& aggregate = mAggregates[aggregateIndex];
+				auto& aggregateAccumulators = accumulators[aggregateIndex];
+				aggregateAccumulators.resize(groupTable.numGroups());
+
+				if (!aggregate.argumentExecutionEngine) {
+					for (auto groupIndex : groupIndices) {
+						aggregateAccumulators[groupIndex].count++;
+					}
+
+					continue;
+				}
+
+				auto& values = argumentValues[aggregateIndex];
+
+				auto handleForType = [&](auto dummy) {
+					using Type = decltype(dummy);
+					auto& underlyingValues = values.getUnderlyingStorage<Type>();
+					underlyingValues.clear();
+					ExecutorHelpers::addExpressionToResult(*aggregate.argumentExecutionEngine, values, rowIndices);
+
+					updateAccumulators(
+						aggregate.function,
+						underlyingValues,
+						groupIndices.data(),
+						numRows,
+						aggregateAccumulators.data());
+				};
+
+				handleGenericType(values.type(), handleForType);
+			}
+		});
+
+	// Create the result
+	auto numGroups = groupTable.numGroups();
+	for (std::size_t keyColumnIndex = 0; keyColumnIndex < numKeyColumns; keyColumnIndex++) {
+		mGroupValues.emplace_back(mGroupExecutionEngines[keyColumnIndex]->expressionType());
+		auto& groupValues = mGroupValues.back();
+
+		auto handleForType = [&](auto dummy) {
+			using Type = decltype(dummy);
+			auto& underlyingValues = groupValues.getUnderlyingStorage<Type>();
+			for (std::size_t groupIndex = 0; groupIndex < numGroups; groupIndex++) {
+				underlyingValues.push_back(decodeKey<Type>(groupTable.key(groupIndex, keyColumnIndex)));
+			}
+		};
+
+		handleGenericType(groupValues.type(), handleForType);
+	}
+
+	for (std::size_t projectionIndex = 0; projectionIndex < mProjectionSources.size(); projectionIndex++) {
+		auto& source = mProjectionSources[projectionIndex];
+		auto& resultStorage = mResult.columns[projectionIndex];
+
+		if (!source.isAggregate) {
+			auto& groupValues = mGroupValues[source.index];
+
+			auto handleForType = [&](auto dummy) {
+				using Type = decltype(dummy);
+				resultStorage.getUnderlyingStorage<Type>() = groupValues.getUnderlyingStorage<Type>();
+			};
+
+			handleGenericType(groupValues.type(), handleForType);
+			continue;
+		}
+
+		auto& aggregate = mAggregates[source.index];
+		auto& aggregateAccumulators = accumulators[source.index];
+		aggregateAccumulators.resize(numGroups);
+
+		auto handleForType = [&](auto dummy) {
+			using Type = decltype(dummy);
+			auto& resultValues = resultStorage.getUnderlyingStorage<Type>();
+
+			for (auto& accumulator : aggregateAccumulators) {
+				switch (aggregate.function) {
+					case AggregateFunction::Count:
+						resultValues.push_back((Type)accumulator.count);
+						break;
+					case AggregateFunction::Average: {
+						auto sum = aggregate.argumentType == ColumnType::Float32
+								   ? accumulator.floatValue
+								   : (double)accumulator.intValue;
+						resultValues.push_back(accumulator.count > 0 ? (Type)(sum / accumulator.count) : Type());
+						break;
+					}
+					default:
+						if (aggregate.argumentType == ColumnType::Float32) {
+							resultValues.push_back((Type)accumulator.floatValue);
+						} else {
+							resultValues.push_back((Type)accumulator.intValue);
+						}
+						break;
+				}
+			}
+		};
+
+		handleGenericType(aggregate.resultType, handleForType);
+	}
+
+	if (!mOperation->order.empty()) {
+		orderResult();
+	}
+
+	ExecutorHelpers::limitResult(mOperation->limit, mResult);
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include "helpers.h"
+
+struct ExpressionExecutionEngine;
+struct QuerySelectOperation;
+struct QueryResult;
+
+/**
+ * Represents an aggregate function in the projections of an aggregation
+ */
+struct AggregateColumn {
+	AggregateFunction function;
+	std::unique_ptr<ExpressionExecutionEngine> argumentExecutionEngine;
+	ColumnType argumentType;
+	ColumnType resultType;
+};
+
+/**
+ * Represents an executor for select operations that aggregate rows.
+ * The filtered rows are aggregated batch by batch into a hash table of groups, without materializing them.
+ */
+class AggregateOperationExecutor {
+private:
+	/**
+	 * Where the values of a projection comes from
+	 */
+	struct ProjectionSource {
+		bool isAggregate;
+		std::size_t index;
+	};
+
+	DatabaseEngine& mDatabaseEngine;
+	VirtualTableContainer& mTableContainer;
+	VirtualTable& mTable;
+	QuerySelectOperation* mOperation;
+	ExpressionExecutionEngine& mFilterExecutionEngine;
+	QueryResult& mResult;
+
+	std::vector<std::unique_ptr<ExpressionExecutionEngine>> mGroupExecutionEngines;
+	std::vector<AggregateColumn> mAggregates;
+	std::vector<ProjectionSource> mProjectionSources;
+
+	std::vector<ColumnStorage> mGroupValues;
+
+	std::int64_t findGroupColumn(const std::string& name) const;
+
+	void compileGroupColumns();
+	void compileProjections();
+	void orderResult();
+public:
+	/**
+	 * Creates a new aggregate operation executor
+	 * @param databaseEngine The database engine
+	 * @param tableContainer The table container
+	 * @param operation The operation
+	 * @param filterExecutionEngine The filter execution engine
+	 * @param result The result
+	 */
+	AggregateOperationExecutor(DatabaseEngine& databaseEngine,
+							   VirtualTableContainer& tableContainer,
+							   QuerySelectOperation* operation,
+							   ExpressionExecutionEngine& filterExecutionEngine,
+							   QueryResult& result);
+
+	/**
+	 * Executes the operation
+	 */
+	void execute();
+};
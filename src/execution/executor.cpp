@@ -4,31 +4,96 @@
 #include "../query_expressions/helpers.h"
 #include "../query_expressions/compiler.h"
 #include "select_operation.h"
+#include "aggregate_operation.h"
 #include "update_operation.h"
 
 #include <iostream>
 
-OperationExecutorVisitor::OperationExecutorVisitor(DatabaseEngine& databaseEngine, QueryResult& result)
-	: databaseEngine(databaseEngine), result(result) {
+namespace {
+	// Compiles the given filter, which is kept by the operation as a prepared statement executes it again
+	ExpressionExecutionEngine compileFilter(VirtualTableContainer& tableContainer,
+											const std::string& table,
+											std::unique_ptr<QueryExpression>& filter,
+											const DatabaseConfiguration& config) {
+		if (!filter) {
+			QueryValueExpression alwaysTrue(QueryValue(true));
+			return ExecutorHelpers::compile(tableContainer, table, &alwaysTrue, config);
+		}
+
+		QueryRootExpression filterExpression(std::move(filter));
+		try {
+			auto filterExecutionEngine = ExecutorHelpers::compile(tableContainer, table, &filterExpression, config);
+			filter = std::move(filterExpression.root);
+			return filterExecutionEngine;
+		} catch (...) {
+			filter = std::move(filterExpression.root);
+			throw;
+		}
+	}
+}
+
+OperationExecutorVisitor::OperationExecutorVisitor(DatabaseEngine& databaseEngine,
+												   QueryResult& result,
+												   CompiledSelectPlan* compiledSelectPlan,
+												   const std::vector<QueryValue>* parameters)
+	: databaseEngine(databaseEngine),
+	  result(result),
+	  compiledSelectPlan(compiledSelectPlan),
+	  parameters(parameters) {
 
 }
 
 void OperationExecutorVisitor::visit(QuerySelectOperation* operation) {
-	std::unique_ptr<QueryExpression> filterExpression;
-	if (operation->filter) {
-		filterExpression = std::make_unique<QueryRootExpression>(std::move(operation->filter));
-	} else {
-		filterExpression = std::make_unique<QueryValueExpression>(QueryValue(true));
-	}
-
 	VirtualTableContainer virtualTableContainer(databaseEngine);
 
-	auto filterExecutionEngine = ExecutorHelpers::compile(
+	// A compiled plan only needs its parameters bound and its columns filled
+	if (compiledSelectPlan != nullptr && compiledSelectPlan->filterExecutionEngine) {
+		// The scan plan is chosen again if the compiling execution did not choose one, without changing the compiled plan
+		auto& scanPlan = compiledSelectPlan->scanPlan;
+
+		auto filterExecutionEngine = compiledSelectPlan->filterExecutionEngine->clone();
+		filterExecutionEngine.bindParameters(*parameters);
+		filterExecutionEngine.fillSlots(virtualTableContainer);
+
+		std::vector<std::unique_ptr<ExpressionExecutionEngine>> projectionExecutionEngines;
+		for (auto& projection : compiledSelectPlan->projectionExecutionEngines) {
+			projectionExecutionEngines.emplace_back(std::make_unique<ExpressionExecutionEngine>(projection->clone()));
+			projectionExecutionEngines.back()->bindParameters(*parameters);
+			projectionExecutionEngines.back()->fillSlots(virtualTableContainer);
+			result.columns.emplace_back(projectionExecutionEngines.back()->expressionType());
+		}
+
+		SelectOperationExecutor executor(
+			databaseEngine,
+			virtualTableContainer,
+			operation,
+			projectionExecutionEngines,
+			filterExecutionEngine,
+			result,
+			scanPlan.valid ? &scanPlan : nullptr);
+
+		executor.execute();
+		return;
+	}
+
+	auto filterExecutionEngine = compileFilter(
 		virtualTableContainer,
 		operation->table,
-		filterExpression.get(),
+		operation->filter,
 		databaseEngine.config());
 
+	if (operation->isAggregation()) {
+		AggregateOperationExecutor executor(
+			databaseEngine,
+			virtualTableContainer,
+			operation,
+			filterExecutionEngine,
+			result);
+
+		executor.execute();
+		return;
+	}
+
 	std::vector<std::unique_ptr<ExpressionExecutionEngine>> projectionExecutionEngines;
 	for (auto& projection : operation->projections) {
 		projectionExecutionEngines.emplace_back(std::make_unique<ExpressionExecutionEngine>(
@@ -41,29 +106,56 @@ void OperationExecutorVisitor::visit(QuerySelectOperation* operation) {
 		result.columns.emplace_back(projectionExecutionEngines.back()->expressionType());
 	}
 
+	CachedScanPlan* cachedScanPlan = nullptr;
+	if (compiledSelectPlan != nullptr) {
+		compiledSelectPlan->filterExecutionEngine = std::make_unique<ExpressionExecutionEngine>(filterExecutionEngine.clone());
+		for (auto& projection : projectionExecutionEngines) {
+			compiledSelectPlan->projectionExecutionEngines.emplace_back(
+				std::make_unique<ExpressionExecutionEngine>(projection->clone()));
+		}
+
+		cachedScanPlan = &compiledSelectPlan->scanPlan;
+	}
+
 	SelectOperationExecutor executor(
 		databaseEngine,
 		virtualTableContainer,
 		operation,
 		projectionExecutionEngines,
 		filterExecutionEngine,
-		result);
+		result,
+		cachedScanPlan);
 
 	executor.execute();
 }
 
 void OperationExecutorVisitor::visit(QueryInsertOperation* operation) {
 	auto& table = databaseEngine.getTable(operation->table);
-	std::size_t columnIndex = 0;
-	if (operation->columns.size() != table.schema().columns().size()) {
+	auto& columnDefinitions = table.schema().columns();
+	if (operation->columns.size() != columnDefinitions.size()) {
 		throw std::runtime_error("Wrong number of columns.");
 	}
 
+	for (auto& columnValues : operation->values) {
+		if (columnValues.size() != operation->columns.size()) {
+			throw std::runtime_error("Wrong number of values.");
+		}
+	}
+
+	// The rows are gathered into columns that are appended to the table at once
+	std::vector<ColumnStorage> columns;
+	for (auto& columnDefinition : columnDefinitions) {
+		columns.emplace_back(columnDefinition.type());
+	}
+
+	std::size_t columnIndex = 0;
 	for (auto& column : operation->columns) {
 		auto& columnDefinition = table.schema().getDefinition(column);
 
 		auto insertForType = [&](auto dummy) {
 			using ColumnType = decltype(dummy);
+			auto& values = columns[columnDefinition.index()].getUnderlyingStorage<ColumnType>();
+			values.reserve(operation->values.size());
 
 			for (auto& columnValues : operation->values) {
 				auto& value = columnValues[columnIndex];
@@ -71,29 +163,38 @@ void OperationExecutorVisitor::visit(QueryInsertOperation* operation) {
 					throw std::runtime_error("Wrong type.");
 				}
 
-				table.insertColumn(column, value.getValue<ColumnType>());
+				values.push_back(value.getValue<ColumnType>());
 			}
 		};
 
 		handleGenericType(columnDefinition.type(), insertForType);
 		columnIndex++;
 	}
+
+	// The values have been checked, which lets the insert be logged before it is applied
+	auto writeAheadLog = databaseEngine.writeAheadLog();
+	std::uint64_t logPosition = 0;
+	{
+		std::lock_guard<std::mutex> guard(databaseEngine.writeMutex());
+		if (writeAheadLog != nullptr) {
+			logPosition = writeAheadLog->logInsert(operation->table, columns);
+		}
+
+		table.appendColumns(std::move(columns));
+	}
+
+	if (writeAheadLog != nullptr) {
+		databaseEngine.commit(logPosition);
+	}
 }
 
 void OperationExecutorVisitor::visit(QueryUpdateOperation* operation) {
 	VirtualTableContainer virtualTableContainer(databaseEngine);
 
-	std::unique_ptr<QueryExpression> filterExpression;
-	if (operation->filter) {
-		filterExpression = std::make_unique<QueryRootExpression>(std::move(operation->filter));
-	} else {
-		filterExpression = std::make_unique<QueryValueExpression>(QueryValue(true));
-	}
-
-	auto filterExecutionEngine = ExecutorHelpers::compile(
+	auto filterExecutionEngine = compileFilter(
 		virtualTableContainer,
 		operation->table,
-		filterExpression.get(),
+		operation->filter,
 		databaseEngine.config());
 
 	std::vector<std::unique_ptr<ExpressionExecutionEngine>> setExecutionEngines;
@@ -106,11 +207,28 @@ void OperationExecutorVisitor::visit(QueryUpdateOperation* operation) {
 				databaseEngine.config())));
 	}
 
-	UpdateOperationExecutor executor(
-		virtualTableContainer.getTable(operation->table),
-		operation,
-		setExecutionEngines,
-		filterExecutionEngine);
+	// The new values are only known once the update is applied, which is when it is logged
+	auto writeAheadLog = databaseEngine.writeAheadLog();
+	std::vector<ColumnUpdate> columnUpdates;
+	std::uint64_t logPosition = 0;
+	{
+		std::lock_guard<std::mutex> guard(databaseEngine.writeMutex());
+		UpdateOperationExecutor executor(
+			databaseEngine,
+			virtualTableContainer.getTable(operation->table),
+			operation,
+			setExecutionEngines,
+			filterExecutionEngine,
+			writeAheadLog != nullptr ? &columnUpdates : nullptr);
+
+		executor.execute();
+
+		if (writeAheadLog != nullptr) {
+			logPosition = writeAheadLog->logUpdate(operation->table, columnUpdates);
+		}
+	}
 
-	executor.execute();
+	if (writeAheadLog != nullptr) {
+		databaseEngine.commit(logPosition);
+	}
 }
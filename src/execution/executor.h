@@ -1,9 +1,20 @@
 #pragma once
 #include "operation_visitor.h"
+#include "select_operation.h"
 #include "../query_expressions/compiler.h"
 
 class DatabaseEngine;
 
+/**
+ * The compiled parts of a select operation, which are reused by later executions of a prepared statement.
+ * These only read it, and fill the slots of their own copies of the execution engines.
+ */
+struct CompiledSelectPlan {
+	std::unique_ptr<ExpressionExecutionEngine> filterExecutionEngine;
+	std::vector<std::unique_ptr<ExpressionExecutionEngine>> projectionExecutionEngines;
+	CachedScanPlan scanPlan;
+};
+
 /**
  * Represents a operations executor visitor
  */
@@ -11,13 +22,20 @@ class OperationExecutorVisitor : public QueryOperationVisitor {
 private:
 	DatabaseEngine& databaseEngine;
 	QueryResult& result;
+	CompiledSelectPlan* compiledSelectPlan;
+	const std::vector<QueryValue>* parameters;
 public:
 	/**
 	 * Creates a new operation executor
 	 * @param databaseEngine The database engine
 	 * @param result The result
+	 * @param compiledSelectPlan The plan of a prepared statement, which is compiled by the first execution if empty
+	 * @param parameters The parameters of a prepared statement
 	 */
-	explicit OperationExecutorVisitor(DatabaseEngine& databaseEngine, QueryResult& result);
+	explicit OperationExecutorVisitor(DatabaseEngine& databaseEngine,
+									  QueryResult& result,
+									  CompiledSelectPlan* compiledSelectPlan = nullptr,
+									  const std::vector<QueryValue>* parameters = nullptr);
 
 	virtual void visit(QuerySelectOperation* operation) override;
 	virtual void visit(QueryInsertOperation* operation) override;
@@ -3,6 +3,32 @@
 #include "../table.h"
 #include "virtual_table.h"
 
+RowBatch::RowBatch(std::size_t startRowIndex, std::size_t size)
+	: startRowIndex(startRowIndex), size(size), rowIndices(nullptr) {
+
+}
+
+RowBatch::RowBatch(const std::size_t* rowIndices, std::size_t size)
+	: startRowIndex(0), size(size), rowIndices(rowIndices) {
+
+}
+
+ExpressionBatch::ExpressionBatch()
+	: mType(ColumnType::Int32),
+	  mSize(0),
+	  mData(new std::uint8_t[EXPRESSION_BATCH_SIZE * MAX_QUERY_VALUE_SIZE]) {
+
+}
+
+QueryValue ExpressionBatch::getValue(std::size_t index) const {
+	auto handleForType = [&](auto dummy) {
+		using Type = decltype(dummy);
+		return QueryValue(this->values<Type>()[index]);
+	};
+
+	return handleGenericTypeResult(QueryValue, mType, handleForType);
+}
+
 ExpressionExecutionEngine::ExpressionExecutionEngine()
 	: mExpressionTypes({ ColumnType::Int32 }) {
 
@@ -90,6 +116,66 @@ std::size_t ExpressionExecutionEngine::evaluationStackSize() const {
 	return mEvaluationStack.size();
 }
 
+ExpressionBatch& ExpressionExecutionEngine::pushBatchEvaluation(ColumnType type, std::size_t size) {
+	if (mBatchEvaluationStackSize == mBatchEvaluationStack.size()) {
+		mBatchEvaluationStack.push_back(std::make_unique<ExpressionBatch>());
+	}
+
+	auto& batch = *mBatchEvaluationStack[mBatchEvaluationStackSize++];
+	batch.reset(type, size);
+	return batch;
+}
+
+const ExpressionBatch& ExpressionExecutionEngine::popBatchEvaluation() {
+	return *mBatchEvaluationStack[--mBatchEvaluationStackSize];
+}
+
+void ExpressionExecutionEngine::collapseBatchEvaluation(std::size_t count) {
+	std::swap(
+		mBatchEvaluationStack[mBatchEvaluationStackSize - 1],
+		mBatchEvaluationStack[mBatchEvaluationStackSize - 1 - count]);
+	mBatchEvaluationStackSize -= count;
+}
+
+ExpressionExecutionEngine ExpressionExecutionEngine::clone() const {
+	ExpressionExecutionEngine executionEngine;
+	executionEngine.mSlottedColumnStorage = mSlottedColumnStorage;
+	executionEngine.mColumnNameToSlot = mColumnNameToSlot;
+	executionEngine.mNextColumnSlot = mNextColumnSlot;
+	executionEngine.mExpressionTypes = mExpressionTypes;
+	executionEngine.mBatchExecution = mBatchExecution;
+
+	for (auto& instruction : mInstructions) {
+		executionEngine.mInstructions.push_back(instruction->clone());
+	}
+
+	return executionEngine;
+}
+
+void ExpressionExecutionEngine::setBatchExecution(bool enabled) {
+	mBatchExecution = enabled;
+}
+
+bool ExpressionExecutionEngine::canExecuteBatch() const {
+	if (!mBatchExecution) {
+		return false;
+	}
+
+	for (auto& instruction : mInstructions) {
+		if (!instruction->canExecuteBatch()) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void ExpressionExecutionEngine::bindParameters(const std::vector<QueryValue>& parameters) {
+	for (auto& instruction : mInstructions) {
+		instruction->bindParameters(parameters);
+	}
+}
+
 void ExpressionExecutionEngine::execute(std::size_t rowIndex) {
 	mCurrentRowIndex = rowIndex;
 
@@ -98,8 +184,31 @@ void ExpressionExecutionEngine::execute(std::size_t rowIndex) {
 	}
 }
 
-QueryValueExpressionIR::QueryValueExpressionIR(QueryValue value)
-	: value(value) {
+void ExpressionExecutionEngine::executeBatch(const RowBatch& rows) {
+	for (auto& instruction : mInstructions) {
+		instruction->executeBatch(*this, rows);
+	}
+}
+
+bool ExpressionIR::canExecuteBatch() const {
+	return false;
+}
+
+void ExpressionIR::executeBatch(ExpressionExecutionEngine& executionEngine, const RowBatch& rows) {
+	throw std::runtime_error("Batch execution not supported.");
+}
+
+std::size_t ExpressionIR::numOperands() const {
+	return 0;
+}
+
+void ExpressionIR::bindParameters(const std::vector<QueryValue>& parameters) {
+
+}
+
+QueryValueExpressionIR::QueryValueExpressionIR(QueryValue value, std::int64_t parameterIndex)
+	: value(value),
+	  parameterIndex(parameterIndex) {
 
 }
 
@@ -107,6 +216,43 @@ void QueryValueExpressionIR::execute(ExpressionExecutionEngine& executionEngine)
 	executionEngine.pushEvaluation(value);
 }
 
+bool QueryValueExpressionIR::canExecuteBatch() const {
+	return true;
+}
+
+void QueryValueExpressionIR::executeBatch(ExpressionExecutionEngine& executionEngine, const RowBatch& rows) {
+	auto& result = executionEngine.pushBatchEvaluation(value.type, rows.size);
+
+	auto handleForType = [&](auto dummy) {
+		using Type = decltype(dummy);
+		auto resultValues = result.values<Type>();
+		auto rawValue = value.getValue<Type>();
+		for (std::size_t i = 0; i < rows.size; i++) {
+			resultValues[i] = rawValue;
+		}
+	};
+
+	handleGenericType(value.type, handleForType);
+}
+
+void QueryValueExpressionIR::bindParameters(const std::vector<QueryValue>& parameters) {
+	if (parameterIndex == -1) {
+		return;
+	}
+
+	// The types of the instructions that use the value were checked when compiled
+	auto& parameter = parameters.at(parameterIndex);
+	if (parameter.type != value.type) {
+		throw std::runtime_error("Wrong type.");
+	}
+
+	value = parameter;
+}
+
+std::unique_ptr<ExpressionIR> QueryValueExpressionIR::clone() const {
+	return std::make_unique<QueryValueExpressionIR>(*this);
+}
+
 ColumnReferenceExpressionIR::ColumnReferenceExpressionIR(std::size_t columnSlot)
 	: columnSlot(columnSlot) {
 
@@ -118,6 +264,26 @@ void ColumnReferenceExpressionIR::execute(ExpressionExecutionEngine& executionEn
 		executionEngine.currentRowIndex()));
 }
 
+bool ColumnReferenceExpressionIR::canExecuteBatch() const {
+	return true;
+}
+
+void ColumnReferenceExpressionIR::executeBatch(ExpressionExecutionEngine& executionEngine, const RowBatch& rows) {
+	auto& column = *executionEngine.columnFromSlot(columnSlot)->storage();
+	auto& result = executionEngine.pushBatchEvaluation(column.type(), rows.size);
+
+	auto handleForType = [&](auto dummy) {
+		using Type = decltype(dummy);
+		ExpressionBatchHelpers::gather(column.getUnderlyingStorage<Type>(), rows, result.values<Type>());
+	};
+
+	handleGenericType(column.type(), handleForType);
+}
+
+std::unique_ptr<ExpressionIR> ColumnReferenceExpressionIR::clone() const {
+	return std::make_unique<ColumnReferenceExpressionIR>(*this);
+}
+
 CompareExpressionIR::CompareExpressionIR(CompareOperator op)
 	: op(op) {
 
@@ -137,6 +303,40 @@ void CompareExpressionIR::execute(ExpressionExecutionEngine& executionEngine) {
 	handleGenericType(op1.type, handleForType);
 }
 
+bool CompareExpressionIR::canExecuteBatch() const {
+	return true;
+}
+
+void CompareExpressionIR::executeBatch(ExpressionExecutionEngine& executionEngine, const RowBatch& rows) {
+	auto& op2 = executionEngine.peekBatchEvaluation(0);
+	auto& op1 = executionEngine.peekBatchEvaluation(1);
+	auto& result = executionEngine.pushBatchEvaluation(ColumnType::Bool, rows.size);
+
+	auto handleForType = [&](auto dummy) {
+		using Type = decltype(dummy);
+		auto op1Values = op1.values<Type>();
+		auto op2Values = op2.values<Type>();
+
+		ExpressionBatchHelpers::compare(
+			op,
+			rows.size,
+			[&](std::size_t i) { return op1Values[i]; },
+			[&](std::size_t i) { return op2Values[i]; },
+			result.values<bool>());
+	};
+
+	handleGenericType(op1.type(), handleForType);
+	executionEngine.collapseBatchEvaluation(2);
+}
+
+std::size_t CompareExpressionIR::numOperands() const {
+	return 2;
+}
+
+std::unique_ptr<ExpressionIR> CompareExpressionIR::clone() const {
+	return std::make_unique<CompareExpressionIR>(*this);
+}
+
 void AndExpressionIR::execute(ExpressionExecutionEngine& executionEngine) {
 	auto op2 = executionEngine.popEvaluation();
 	auto op1 = executionEngine.popEvaluation();
@@ -146,6 +346,63 @@ void AndExpressionIR::execute(ExpressionExecutionEngine& executionEngine) {
 	executionEngine.pushEvaluation(QueryValue(op1Value && op2Value));
 }
 
+bool AndExpressionIR::canExecuteBatch() const {
+	return true;
+}
+
+void AndExpressionIR::executeBatch(ExpressionExecutionEngine& executionEngine, const RowBatch& rows) {
+	auto op2Values = executionEngine.peekBatchEvaluation(0).values<bool>();
+	auto op1Values = executionEngine.peekBatchEvaluation(1).values<bool>();
+	auto resultValues = executionEngine.pushBatchEvaluation(ColumnType::Bool, rows.size).values<bool>();
+
+	for (std::size_t i = 0; i < rows.size; i++) {
+		resultValues[i] = op1Values[i] && op2Values[i];
+	}
+
+	executionEngine.collapseBatchEvaluation(2);
+}
+
+std::size_t AndExpressionIR::numOperands() const {
+	return 2;
+}
+
+std::unique_ptr<ExpressionIR> AndExpressionIR::clone() const {
+	return std::make_unique<AndExpressionIR>(*this);
+}
+
+void OrExpressionIR::execute(ExpressionExecutionEngine& executionEngine) {
+	auto op2 = executionEngine.popEvaluation();
+	auto op1 = executionEngine.popEvaluation();
+
+	auto op1Value = op1.getValue<bool>();
+	auto op2Value = op2.getValue<bool>();
+	executionEngine.pushEvaluation(QueryValue(op1Value || op2Value));
+}
+
+bool OrExpressionIR::canExecuteBatch() const {
+	return true;
+}
+
+void OrExpressionIR::executeBatch(ExpressionExecutionEngine& executionEngine, const RowBatch& rows) {
+	auto op2Values = executionEngine.peekBatchEvaluation(0).values<bool>();
+	auto op1Values = executionEngine.peekBatchEvaluation(1).values<bool>();
+	auto resultValues = executionEngine.pushBatchEvaluation(ColumnType::Bool, rows.size).values<bool>();
+
+	for (std::size_t i = 0; i < rows.size; i++) {
+		resultValues[i] = op1Values[i] || op2Values[i];
+	}
+
+	executionEngine.collapseBatchEvaluation(2);
+}
+
+std::size_t OrExpressionIR::numOperands() const {
+	return 2;
+}
+
+std::unique_ptr<ExpressionIR> OrExpressionIR::clone() const {
+	return std::make_unique<OrExpressionIR>(*this);
+}
+
 MathOperationExpressionIR::MathOperationExpressionIR(MathOperator op)
 	: op(op) {
 
@@ -165,6 +422,61 @@ void MathOperationExpressionIR::execute(ExpressionExecutionEngine& executionEngi
 	handleGenericType(op1.type, handleForType);
 }
 
+bool MathOperationExpressionIR::canExecuteBatch() const {
+	return true;
+}
+
+void MathOperationExpressionIR::executeBatch(ExpressionExecutionEngine& executionEngine, const RowBatch& rows) {
+	auto& op2 = executionEngine.peekBatchEvaluation(0);
+	auto& op1 = executionEngine.peekBatchEvaluation(1);
+	auto& result = executionEngine.pushBatchEvaluation(op1.type(), rows.size);
+
+	auto handleForType = [&](auto dummy) {
+		using Type = decltype(dummy);
+		auto op1Values = op1.values<Type>();
+		auto op2Values = op2.values<Type>();
+		auto resultValues = result.values<Type>();
+
+		switch (op) {
+			case MathOperator::Add:
+				for (std::size_t i = 0; i < rows.size; i++) {
+					resultValues[i] = op1Values[i] + op2Values[i];
+				}
+				break;
+			case MathOperator::Sub:
+				for (std::size_t i = 0; i < rows.size; i++) {
+					resultValues[i] = op1Values[i] - op2Values[i];
+				}
+				break;
+			case MathOperator::Mul:
+				for (std::size_t i = 0; i < rows.size; i++) {
+					resultValues[i] = op1Values[i] * op2Values[i];
+				}
+				break;
+			case MathOperator::Div:
+				for (std::size_t i = 0; i < rows.size; i++) {
+					resultValues[i] = op1Values[i] / op2Values[i];
+				}
+				break;
+		}
+	};
+
+	handleTypeResult<void>(
+		op1.type(),
+		[&]() { throw std::runtime_error("Only Int32 and Float32 supported."); },
+		[&]() { handleForType((std::int32_t)0); },
+		[&]() { handleForType((float)0); });
+	executionEngine.collapseBatchEvaluation(2);
+}
+
+std::size_t MathOperationExpressionIR::numOperands() const {
+	return 2;
+}
+
+std::unique_ptr<ExpressionIR> MathOperationExpressionIR::clone() const {
+	return std::make_unique<MathOperationExpressionIR>(*this);
+}
+
 CompareExpressionLeftColumnRightColumnIR::CompareExpressionLeftColumnRightColumnIR(std::size_t lhs, std::size_t rhs, CompareOperator op)
 	: lhs(lhs), rhs(rhs), op(op) {
 
@@ -183,4 +495,32 @@ void CompareExpressionLeftColumnRightColumnIR::execute(ExpressionExecutionEngine
 	};
 
 	handleGenericType(lhsColumn->type(), handleForType);
-}
\ No newline at end of file
+}
+bool CompareExpressionLeftColumnRightColumnIR::canExecuteBatch() const {
+	return true;
+}
+
+void CompareExpressionLeftColumnRightColumnIR::executeBatch(ExpressionExecutionEngine& executionEngine, const RowBatch& rows) {
+	auto lhsColumn = executionEngine.columnFromSlot(lhs)->storage();
+	auto rhsColumn = executionEngine.columnFromSlot(rhs)->storage();
+	auto& result = executionEngine.pushBatchEvaluation(ColumnType::Bool, rows.size);
+
+	auto handleForType = [&](auto dummy) {
+		using Type = decltype(dummy);
+		auto& lhsColumnValues = lhsColumn->getUnderlyingStorage<Type>();
+		auto& rhsColumnValues = rhsColumn->getUnderlyingStorage<Type>();
+
+		ExpressionBatchHelpers::compare(
+			op,
+			rows.size,
+			[&](std::size_t i) { return lhsColumnValues[rows.rowIndex(i)]; },
+			[&](std::size_t i) { return rhsColumnValues[rows.rowIndex(i)]; },
+			result.values<bool>());
+	};
+
+	handleGenericType(lhsColumn->type(), handleForType);
+}
+
+std::unique_ptr<ExpressionIR> CompareExpressionLeftColumnRightColumnIR::clone() const {
+	return std::make_unique<CompareExpressionLeftColumnRightColumnIR>(*this);
+}
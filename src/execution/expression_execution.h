@@ -6,10 +6,117 @@
 #include "../common.h"
 #include "../query_expressions/helpers.h"
 #include "virtual_table.h"
+#include "filter_kernels.h"
 
 class ColumnStorage;
 struct ExpressionIR;
 
+/**
+ * The number of rows in an expression batch
+ */
+constexpr std::size_t EXPRESSION_BATCH_SIZE = 1024;
+
+/**
+ * Represents the rows in a batch
+ */
+struct RowBatch {
+	std::size_t startRowIndex;
+	std::size_t size;
+	const std::size_t* rowIndices;
+
+	/**
+	 * Creates a batch of consecutive rows
+	 * @param startRowIndex The first row in the batch
+	 * @param size The number of rows
+	 */
+	RowBatch(std::size_t startRowIndex, std::size_t size);
+
+	/**
+	 * Creates a batch of the given rows
+	 * @param rowIndices The rows in the batch
+	 * @param size The number of rows
+	 */
+	RowBatch(const std::size_t* rowIndices, std::size_t size);
+
+	/**
+	 * Returns the row index for the given entry in the batch
+	 * @param index The index in the batch
+	 */
+	inline std::size_t rowIndex(std::size_t index) const {
+		if (rowIndices != nullptr) {
+			return rowIndices[index];
+		}
+
+		return startRowIndex + index;
+	}
+};
+
+/**
+ * Represents the values of an expression for a batch of rows
+ */
+class ExpressionBatch {
+private:
+	ColumnType mType;
+	std::size_t mSize;
+	std::unique_ptr<std::uint8_t[]> mData;
+public:
+	/**
+	 * Creates a new expression batch
+	 */
+	explicit ExpressionBatch();
+
+	ExpressionBatch(const ExpressionBatch&) = delete;
+	ExpressionBatch& operator=(const ExpressionBatch&) = delete;
+
+	/**
+	 * Returns the type of the values
+	 */
+	inline ColumnType type() const {
+		return mType;
+	}
+
+	/**
+	 * Returns the number of values
+	 */
+	inline std::size_t size() const {
+		return mSize;
+	}
+
+	/**
+	 * Resets the batch to hold values of the given type
+	 * @param type The type of the values
+	 * @param size The number of values
+	 */
+	inline void reset(ColumnType type, std::size_t size) {
+		mType = type;
+		mSize = size;
+	}
+
+	/**
+	 * Returns the values
+	 * @tparam T The type of the values
+	 */
+	template<typename T>
+	inline T* values() {
+		return reinterpret_cast<T*>(mData.get());
+	}
+
+	/**
+	 * Returns the values
+	 * @tparam T The type of the values
+	 */
+	template<typename T>
+	inline const T* values() const {
+		return reinterpret_cast<const T*>(mData.get());
+	}
+
+	/**
+	 * Returns the value at the given index
+	 * @param index The index
+	 */
+	QueryValue getValue(std::size_t index) const;
+};
+
 /**
  * Contains metadata for a column slot
  */
@@ -35,6 +142,10 @@ private:
 
 	std::size_t mCurrentRowIndex = 0;
 	EvaluationStack mEvaluationStack;
+
+	bool mBatchExecution = true;
+	std::vector<std::unique_ptr<ExpressionBatch>> mBatchEvaluationStack;
+	std::size_t mBatchEvaluationStackSize = 0;
 public:
 	/**
 	 * Creates a new execution engine
@@ -131,6 +242,48 @@ public:
 
 	std::size_t evaluationStackSize() const;
 
+	/**
+	 * Pushes a new batch on the batch evaluation stack
+	 * @param type The type of the values in the batch
+	 * @param size The number of values in the batch
+	 */
+	ExpressionBatch& pushBatchEvaluation(ColumnType type, std::size_t size);
+
+	/**
+	 * Returns the batch at the given depth of the batch evaluation stack
+	 * @param depth The depth, where zero is the top
+	 */
+	inline ExpressionBatch& peekBatchEvaluation(std::size_t depth = 0) {
+		return *mBatchEvaluationStack[mBatchEvaluationStackSize - 1 - depth];
+	}
+
+	/**
+	 * Pops from the batch evaluation stack. The batch is valid until the next batch execution.
+	 */
+	const ExpressionBatch& popBatchEvaluation();
+
+	/**
+	 * Removes the given number of batches below the top of the batch evaluation stack
+	 * @param count The number of batches to remove
+	 */
+	void collapseBatchEvaluation(std::size_t count);
+
+	/**
+	 * Creates a copy of the engine with the same instructions and column slots but its own evaluation stacks
+	 */
+	ExpressionExecutionEngine clone() const;
+
+	/**
+	 * Sets if batch execution is enabled
+	 * @param enabled Indicates if enabled
+	 */
+	void setBatchExecution(bool enabled);
+
+	/**
+	 * Indicates if the instructions can be executed on batches
+	 */
+	bool canExecuteBatch() const;
+
 	/**
 	 * Adds the given instruction
 	 * @param instruction The instruction
@@ -161,11 +314,23 @@ public:
 	 */
 	void makeCompareAlwaysTrue(std::size_t index);
 
+	/**
+	 * Binds the parameters of a prepared statement to the instructions that use them
+	 * @param parameters The values of the parameters
+	 */
+	void bindParameters(const std::vector<QueryValue>& parameters);
+
 	/**
 	 * Executes the expression on the given row
 	 * @param rowIndex The index of the row
 	 */
 	void execute(std::size_t rowIndex);
+
+	/**
+	 * Executes the expression on the given batch of rows. The results are placed on the batch evaluation stack.
+	 * @param rows The rows
+	 */
+	void executeBatch(const RowBatch& rows);
 };
 
 /**
@@ -179,21 +344,130 @@ struct ExpressionIR {
 	 * @param executionEngine The execution engine
 	 */
 	virtual void execute(ExpressionExecutionEngine& executionEngine) = 0;
+
+	/**
+	 * Indicates if the instruction can be executed on batches
+	 */
+	virtual bool canExecuteBatch() const;
+
+	/**
+	 * Executes the instruction on a batch of rows
+	 * @param executionEngine The execution engine
+	 * @param rows The rows
+	 */
+	virtual void executeBatch(ExpressionExecutionEngine& executionEngine, const RowBatch& rows);
+
+	/**
+	 * Returns the number of values that the instruction pops from the evaluation stack.
+	 * The operands are the instructions that precede it.
+	 */
+	virtual std::size_t numOperands() const;
+
+	/**
+	 * Binds the parameters of a prepared statement, if the instruction uses one
+	 * @param parameters The values of the parameters
+	 */
+	virtual void bindParameters(const std::vector<QueryValue>& parameters);
+
+	/**
+	 * Creates a copy of the instruction
+	 */
+	virtual std::unique_ptr<ExpressionIR> clone() const = 0;
 };
 
+/**
+ * Helper functions for batch execution
+ */
+namespace ExpressionBatchHelpers {
+	/**
+	 * Gathers the values of the given rows in the given column
+	 * @tparam T The type of the column
+	 * @param columnValues The values of the column
+	 * @param rows The rows
+	 * @param values The gathered values
+	 */
+	template<typename T>
+	void gather(const UnderlyingColumnStorage<T>& columnValues, const RowBatch& rows, T* values) {
+		if (rows.rowIndices != nullptr) {
+			for (std::size_t i = 0; i < rows.size; i++) {
+				values[i] = columnValues[rows.rowIndices[i]];
+			}
+		} else {
+			columnValues.forEachSegment(
+				rows.startRowIndex,
+				rows.startRowIndex + rows.size,
+				[&](const T* segmentValues, std::size_t startRowIndex, std::size_t count) {
+					std::copy(segmentValues, segmentValues + count, values + (startRowIndex - rows.startRowIndex));
+				});
+		}
+	}
+
+	/**
+	 * Compares the given values
+	 * @tparam LhsFunc The type of the lhs accessor
+	 * @tparam RhsFunc The type of the rhs accessor
+	 * @param op The operator
+	 * @param size The number of values
+	 * @param lhs Returns the lhs value at the given index
+	 * @param rhs Returns the rhs value at the given index
+	 * @param result The results
+	 */
+	template<typename LhsFunc, typename RhsFunc>
+	void compare(CompareOperator op, std::size_t size, LhsFunc lhs, RhsFunc rhs, bool* result) {
+		switch (op) {
+			case CompareOperator::Equal:
+				for (std::size_t i = 0; i < size; i++) {
+					result[i] = lhs(i) == rhs(i);
+				}
+				break;
+			case CompareOperator::NotEqual:
+				for (std::size_t i = 0; i < size; i++) {
+					result[i] = lhs(i) != rhs(i);
+				}
+				break;
+			case CompareOperator::LessThan:
+				for (std::size_t i = 0; i < size; i++) {
+					result[i] = lhs(i) < rhs(i);
+				}
+				break;
+			case CompareOperator::LessThanOrEqual:
+				for (std::size_t i = 0; i < size; i++) {
+					result[i] = lhs(i) <= rhs(i);
+				}
+				break;
+			case CompareOperator::GreaterThan:
+				for (std::size_t i = 0; i < size; i++) {
+					result[i] = lhs(i) > rhs(i);
+				}
+				break;
+			case CompareOperator::GreaterThanOrEqual:
+				for (std::size_t i = 0; i < size; i++) {
+					result[i] = lhs(i) >= rhs(i);
+				}
+				break;
+		}
+	}
+}
+
 /**
  * Represents expression IR for a query value
  */
 struct QueryValueExpressionIR : public ExpressionIR {
 	QueryValue value;
+	std::int64_t parameterIndex = -1;
 
 	/**
 	 * Creates a new value expression IR
 	 * @param value The value
+	 * @param parameterIndex The index of the parameter that binds the value, or -1 for a constant
 	 */
-	explicit QueryValueExpressionIR(QueryValue value);
+	explicit QueryValueExpressionIR(QueryValue value, std::int64_t parameterIndex = -1);
 
 	virtual void execute(ExpressionExecutionEngine& executionEngine) override;
+	virtual bool canExecuteBatch() const override;
+	virtual void executeBatch(ExpressionExecutionEngine& executionEngine, const RowBatch& rows) override;
+	virtual void bindParameters(const std::vector<QueryValue>& parameters) override;
+	virtual std::unique_ptr<ExpressionIR> clone() const override;
 };
 
 /**
@@ -209,6 +483,9 @@ struct ColumnReferenceExpressionIR : public ExpressionIR {
 	explicit ColumnReferenceExpressionIR(std::size_t columnSlot);
 
 	virtual void execute(ExpressionExecutionEngine& executionEngine) override;
+	virtual bool canExecuteBatch() const override;
+	virtual void executeBatch(ExpressionExecutionEngine& executionEngine, const RowBatch& rows) override;
+	virtual std::unique_ptr<ExpressionIR> clone() const override;
 };
 
 /**
@@ -224,6 +501,10 @@ struct CompareExpressionIR : public ExpressionIR {
 	explicit CompareExpressionIR(CompareOperator op);
 
 	virtual void execute(ExpressionExecutionEngine& executionEngine) override;
+	virtual bool canExecuteBatch() const override;
+	virtual void executeBatch(ExpressionExecutionEngine& executionEngine, const RowBatch& rows) override;
+	virtual std::size_t numOperands() const override;
+	virtual std::unique_ptr<ExpressionIR> clone() const override;
 };
 
 /**
@@ -231,6 +512,21 @@ struct CompareExpressionIR : public ExpressionIR {
  */
 struct AndExpressionIR : public ExpressionIR {
 	virtual void execute(ExpressionExecutionEngine& executionEngine) override;
+	virtual bool canExecuteBatch() const override;
+	virtual void executeBatch(ExpressionExecutionEngine& executionEngine, const RowBatch& rows) override;
+	virtual std::size_t numOperands() const override;
+	virtual std::unique_ptr<ExpressionIR> clone() const override;
+};
+
+/**
+ * Represents expression IR for an or operator
+ */
+struct OrExpressionIR : public ExpressionIR {
+	virtual void execute(ExpressionExecutionEngine& executionEngine) override;
+	virtual bool canExecuteBatch() const override;
+	virtual void executeBatch(ExpressionExecutionEngine& executionEngine, const RowBatch& rows) override;
+	virtual std::size_t numOperands() const override;
+	virtual std::unique_ptr<ExpressionIR> clone() const override;
 };
 
 /**
@@ -246,6 +542,10 @@ struct MathOperationExpressionIR : public ExpressionIR {
 	explicit MathOperationExpressionIR(MathOperator op);
 
 	virtual void execute(ExpressionExecutionEngine& executionEngine) override;
+	virtual bool canExecuteBatch() const override;
+	virtual void executeBatch(ExpressionExecutionEngine& executionEngine, const RowBatch& rows) override;
+	virtual std::size_t numOperands() const override;
+	virtual std::unique_ptr<ExpressionIR> clone() const override;
 };
 
 /**
@@ -256,6 +556,7 @@ struct CompareExpressionLeftValueKnownTypeRightColumnIR : public ExpressionIR {
 	T lhs;
 	std::size_t rhs;
 	CompareOperator op;
+	std::int64_t parameterIndex = -1;
 
 	/**
 	 * Creates a new compare expression IR
@@ -272,6 +573,44 @@ struct CompareExpressionLeftValueKnownTypeRightColumnIR : public ExpressionIR {
 		T rhsValue = executionEngine.columnFromSlot(rhs)->storage()->template getUnderlyingStorage<T>()[executionEngine.currentRowIndex()];
 		executionEngine.pushEvaluation(QueryValue(QueryExpressionHelpers::compare(op, lhs, rhsValue)));
 	}
+
+	virtual bool canExecuteBatch() const override {
+		return true;
+	}
+
+	virtual void executeBatch(ExpressionExecutionEngine& executionEngine, const RowBatch& rows) override {
+		auto& rhsColumnValues = executionEngine.columnFromSlot(rhs)->storage()->template getUnderlyingStorage<T>();
+		auto& result = executionEngine.pushBatchEvaluation(ColumnType::Bool, rows.size);
+
+		if (rows.rowIndices == nullptr) {
+			FilterKernels::compareColumn(
+				QueryExpressionHelpers::otherSideCompareOp(op),
+				rhsColumnValues,
+				rows.startRowIndex,
+				rows.size,
+				lhs,
+				result.template values<bool>());
+			return;
+		}
+
+		auto lhsValue = lhs;
+		ExpressionBatchHelpers::compare(
+			op,
+			rows.size,
+			[&](std::size_t) { return lhsValue; },
+			[&](std::size_t i) { return rhsColumnValues[rows.rowIndex(i)]; },
+			result.template values<bool>());
+	}
+
+	virtual void bindParameters(const std::vector<QueryValue>& parameters) override {
+		if (parameterIndex != -1) {
+			lhs = parameters.at(parameterIndex).template getValue<T>();
+		}
+	}
+
+	virtual std::unique_ptr<ExpressionIR> clone() const override {
+		return std::make_unique<CompareExpressionLeftValueKnownTypeRightColumnIR<T>>(*this);
+	}
 };
 
 /**
@@ -282,6 +621,7 @@ struct CompareExpressionLeftColumnRightValueKnownTypeIR : public ExpressionIR {
 	std::size_t lhs;
 	T rhs;
 	CompareOperator op;
+	std::int64_t parameterIndex = -1;
 
 	/**
 	 * Creates a new compare expression IR
@@ -299,6 +639,44 @@ struct CompareExpressionLeftColumnRightValueKnownTypeIR : public ExpressionIR {
 		T lhsValue = lhsColumn->template getUnderlyingStorage<T>()[executionEngine.currentRowIndex()];
 		executionEngine.pushEvaluation(QueryValue(QueryExpressionHelpers::compare(op, lhsValue, rhs)));
 	}
+
+	virtual bool canExecuteBatch() const override {
+		return true;
+	}
+
+	virtual void executeBatch(ExpressionExecutionEngine& executionEngine, const RowBatch& rows) override {
+		auto& lhsColumnValues = executionEngine.columnFromSlot(lhs)->storage()->template getUnderlyingStorage<T>();
+		auto& result = executionEngine.pushBatchEvaluation(ColumnType::Bool, rows.size);
+
+		if (rows.rowIndices == nullptr) {
+			FilterKernels::compareColumn(
+				op,
+				lhsColumnValues,
+				rows.startRowIndex,
+				rows.size,
+				rhs,
+				result.template values<bool>());
+			return;
+		}
+
+		auto rhsValue = rhs;
+		ExpressionBatchHelpers::compare(
+			op,
+			rows.size,
+			[&](std::size_t i) { return lhsColumnValues[rows.rowIndex(i)]; },
+			[&](std::size_t) { return rhsValue; },
+			result.template values<bool>());
+	}
+
+	virtual void bindParameters(const std::vector<QueryValue>& parameters) override {
+		if (parameterIndex != -1) {
+			rhs = parameters.at(parameterIndex).template getValue<T>();
+		}
+	}
+
+	virtual std::unique_ptr<ExpressionIR> clone() const override {
+		return std::make_unique<CompareExpressionLeftColumnRightValueKnownTypeIR<T>>(*this);
+	}
 };
 
 /**
@@ -318,4 +696,7 @@ struct CompareExpressionLeftColumnRightColumnIR : public ExpressionIR {
 	CompareExpressionLeftColumnRightColumnIR(std::size_t lhs, std::size_t rhs, CompareOperator op);
 
 	virtual void execute(ExpressionExecutionEngine& executionEngine) override;
+	virtual bool canExecuteBatch() const override;
+	virtual void executeBatch(ExpressionExecutionEngine& executionEngine, const RowBatch& rows) override;
+	virtual std::unique_ptr<ExpressionIR> clone() const override;
 };
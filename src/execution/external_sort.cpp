@@ -0,0 +1,277 @@
+#include "external_sort.h"
+#include "helpers.h"
+#include "radix_sort.h"
+#include "../database_engine.h"
+#include <algorithm>
+#include <cstring>
+#include <queue>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+	// The number of records that are encoded before being written or decoded after being merged
+	constexpr std::size_t RECORDS_PER_CHUNK = 1024;
+
+	// The smallest number of records that each run reads at a time when merging
+	constexpr std::size_t MIN_READ_RECORDS = 64;
+
+	std::size_t valueSize(ColumnType type) {
+		return handleGenericTypeResult(std::size_t, type, [&](auto dummy) {
+			return sizeof(decltype(dummy));
+		});
+	}
+
+	std::uint32_t readKey(const std::uint8_t* record, std::size_t keyIndex) {
+		std::uint32_t key = 0;
+		std::memcpy(&key, record + keyIndex * sizeof(std::uint32_t), sizeof(std::uint32_t));
+		return key;
+	}
+
+	/**
+	 * Reads the records of a run a block at a time
+	 */
+	struct RunReader {
+		std::FILE* file;
+		std::size_t recordSize;
+		std::size_t numRowsLeft;
+
+		std::vector<std::uint8_t> buffer;
+		std::size_t numRecords = 0;
+		std::size_t position = 0;
+
+		RunReader(std::FILE* file, std::size_t recordSize, std::size_t numRows, std::size_t numReadRecords)
+			: file(file),
+			  recordSize(recordSize),
+			  numRowsLeft(numRows),
+			  buffer(numReadRecords * recordSize) {
+			if (std::fseek(file, 0, SEEK_SET) != 0) {
+				throw std::runtime_error("Could not read a sort run.");
+			}
+
+			fill();
+		}
+
+		bool empty() const {
+			return position == numRecords;
+		}
+
+		const std::uint8_t* current() const {
+			return buffer.data() + position * recordSize;
+		}
+
+		void next() {
+			position++;
+			if (position == numRecords) {
+				fill();
+			}
+		}
+
+		void fill() {
+			auto numToRead = std::min(numRowsLeft, buffer.size() / recordSize);
+			if (numToRead > 0 && std::fread(buffer.data(), recordSize, numToRead, file) != numToRead) {
+				throw std::runtime_error("Could not read a sort run.");
+			}
+
+			numRowsLeft -= numToRead;
+			numRecords = numToRead;
+			position = 0;
+		}
+	};
+}
+
+ExternalSort::ExternalSort(const DatabaseConfiguration& config,
+						   std::vector<ColumnType> orderingDataTypes,
+						   std::vector<OrderingColumn> ordering,
+						   std::vector<ColumnType> resultTypes)
+	: mConfig(config),
+	  mOrderingDataTypes(std::move(orderingDataTypes)),
+	  mOrdering(std::move(ordering)),
+	  mResultTypes(std::move(resultTypes)),
+	  mKeysSize(mOrderingDataTypes.size() * sizeof(std::uint32_t)),
+	  mRecordSize(mKeysSize) {
+	for (auto type : mResultTypes) {
+		mRecordSize += valueSize(type);
+	}
+}
+
+ExternalSort::~ExternalSort() {
+	for (auto& run : mRuns) {
+		std::fclose(run.file);
+	}
+}
+
+std::size_t ExternalSort::numRuns() const {
+	return mRuns.size();
+}
+
+std::size_t ExternalSort::rowMemoryUsage() const {
+	// The radix sort uses two index and two key arrays
+	auto sortSize = 2 * sizeof(std::size_t) + 2 * sizeof(std::uint32_t);
+	return mOrderingDataTypes.size() * sizeof(RawQueryValue) + (mRecordSize - mKeysSize) + sortSize;
+}
+
+void ExternalSort::writeRecords(std::FILE* file,
+								const OrderingData& orderingData,
+								const QueryResult& result,
+								const std::vector<std::size_t>& sortedIndices) const {
+	std::vector<std::uint8_t> chunk(RECORDS_PER_CHUNK * mRecordSize);
+	for (std::size_t startIndex = 0; startIndex < sortedIndices.size(); startIndex += RECORDS_PER_CHUNK) {
+		auto endIndex = std::min(startIndex + RECORDS_PER_CHUNK, sortedIndices.size());
+
+		for (std::size_t keyIndex = 0; keyIndex < mOrderingDataTypes.size(); keyIndex++) {
+			auto& columnOrdering = orderingData[keyIndex];
+			auto type = mOrderingDataTypes[keyIndex];
+			auto descending = mOrdering[keyIndex].descending;
+			auto offset = keyIndex * sizeof(std::uint32_t);
+			for (auto i = startIndex; i < endIndex; i++) {
+				auto key = RadixSort::encodeKey(type, columnOrdering[sortedIndices[i]], descending);
+				std::memcpy(chunk.data() + (i - startIndex) * mRecordSize + offset, &key, sizeof(std::uint32_t));
+			}
+		}
+
+		auto offset = mKeysSize;
+		for (auto& column : result.columns) {
+			handleGenericType(column.type(), [&](auto dummy) {
+				using Type = decltype(dummy);
+				auto& values = column.getUnderlyingStorage<Type>();
+				for (auto i = startIndex; i < endIndex; i++) {
+					Type value = values[sortedIndices[i]];
+					std::memcpy(chunk.data() + (i - startIndex) * mRecordSize + offset, &value, sizeof(Type));
+				}
+
+				offset += sizeof(Type);
+			});
+		}
+
+		auto numRecords = endIndex - startIndex;
+		if (std::fwrite(chunk.data(), mRecordSize, numRecords, file) != numRecords) {
+			throw std::runtime_error("Could not write a sort run.");
+		}
+	}
+
+	if (std::fflush(file) != 0) {
+		throw std::runtime_error("Could not write a sort run.");
+	}
+}
+
+void ExternalSort::addRun(OrderingData& orderingData, QueryResult& result) {
+	auto numRows = orderingData.empty() ? 0 : orderingData[0].size();
+	if (numRows == 0) {
+		return;
+	}
+
+	auto sortedIndices = ExecutorHelpers::sortedIndices(mConfig, mOrderingDataTypes, mOrdering, orderingData);
+
+	// The file is removed at once, which makes it disappear when closed even if the query fails
+	auto path = mConfig.sortDirectory + "/sort_run_XXXXXX";
+	auto fileDescriptor = mkstemp(&path[0]);
+	if (fileDescriptor == -1) {
+		throw std::runtime_error("Could not create a sort run in '" + mConfig.sortDirectory + "'.");
+	}
+
+	unlink(path.c_str());
+	auto file = fdopen(fileDescriptor, "w+b");
+	if (file == nullptr) {
+		close(fileDescriptor);
+		throw std::runtime_error("Could not create a sort run in '" + mConfig.sortDirectory + "'.");
+	}
+
+	mRuns.push_back({ file, numRows });
+	writeRecords(file, orderingData, result, sortedIndices);
+
+	for (auto& columnOrdering : orderingData) {
+		columnOrdering.clear();
+		columnOrdering.shrink_to_fit();
+	}
+
+	for (auto& column : result.columns) {
+		column = ColumnStorage(column.type());
+	}
+}
+
+void ExternalSort::merge(QueryResult& result) {
+	std::size_t numRows = 0;
+	for (auto& run : mRuns) {
+		numRows += run.numRows;
+	}
+
+	for (auto& column : result.columns) {
+		handleGenericType(column.type(), [&](auto dummy) {
+			column.getUnderlyingStorage<decltype(dummy)>().reserve(numRows);
+		});
+	}
+
+	// Half of the memory limit is split between the read buffers of the runs
+	auto numReadRecords = std::max(
+		MIN_READ_RECORDS,
+		mConfig.sortMemoryLimit / 2 / std::max(mRuns.size(), (std::size_t)1) / mRecordSize);
+
+	std::vector<RunReader> readers;
+	readers.reserve(mRuns.size());
+	for (auto& run : mRuns) {
+		readers.emplace_back(run.file, mRecordSize, run.numRows, numReadRecords);
+	}
+
+	// Equal rows are taken from the earliest run, which keeps the rows in the order they were added
+	auto numKeys = mOrderingDataTypes.size();
+	auto after = [&](std::size_t lhsRun, std::size_t rhsRun) {
+		auto lhsRecord = readers[lhsRun].current();
+		auto rhsRecord = readers[rhsRun].current();
+		for (std::size_t keyIndex = 0; keyIndex < numKeys; keyIndex++) {
+			auto lhsKey = readKey(lhsRecord, keyIndex);
+			auto rhsKey = readKey(rhsRecord, keyIndex);
+			if (lhsKey != rhsKey) {
+				return lhsKey > rhsKey;
+			}
+		}
+
+		return lhsRun > rhsRun;
+	};
+
+	std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(after)> heap(after);
+	for (std::size_t runIndex = 0; runIndex < readers.size(); runIndex++) {
+		if (!readers[runIndex].empty()) {
+			heap.push(runIndex);
+		}
+	}
+
+	std::vector<std::uint8_t> chunk(RECORDS_PER_CHUNK * mRecordSize);
+	std::size_t numInChunk = 0;
+	auto decodeChunk = [&]() {
+		auto offset = mKeysSize;
+		for (auto& column : result.columns) {
+			handleGenericType(column.type(), [&](auto dummy) {
+				using Type = decltype(dummy);
+				auto& values = column.getUnderlyingStorage<Type>();
+				for (std::size_t i = 0; i < numInChunk; i++) {
+					Type value;
+					std::memcpy(&value, chunk.data() + i * mRecordSize + offset, sizeof(Type));
+					values.push_back(value);
+				}
+
+				offset += sizeof(Type);
+			});
+		}
+
+		numInChunk = 0;
+	};
+
+	while (!heap.empty()) {
+		auto runIndex = heap.top();
+		heap.pop();
+
+		auto& reader = readers[runIndex];
+		std::memcpy(chunk.data() + numInChunk * mRecordSize, reader.current(), mRecordSize);
+		numInChunk++;
+		if (numInChunk == RECORDS_PER_CHUNK) {
+			decodeChunk();
+		}
+
+		reader.next();
+		if (!reader.empty()) {
+			heap.push(runIndex);
+		}
+	}
+
+	decodeChunk();
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdio>
+#include <vector>
+#include "../common.h"
+#include "../query.h"
+
+struct DatabaseConfiguration;
+
+/**
+ * Sorts results that are larger than the sort memory limit.
+ * The buffered rows are sorted and spilled as runs to temporary files, which are merged into the result at the end.
+ * Each row of a run is stored as a fixed size record of its encoded ordering keys followed by its result values.
+ */
+class ExternalSort {
+private:
+	using OrderingData = std::vector<std::vector<RawQueryValue>>;
+
+	const DatabaseConfiguration& mConfig;
+	std::vector<ColumnType> mOrderingDataTypes;
+	std::vector<OrderingColumn> mOrdering;
+	std::vector<ColumnType> mResultTypes;
+
+	std::size_t mKeysSize;
+	std::size_t mRecordSize;
+
+	struct Run {
+		std::FILE* file;
+		std::size_t numRows;
+	};
+
+	std::vector<Run> mRuns;
+
+	void writeRecords(std::FILE* file,
+					  const OrderingData& orderingData,
+					  const QueryResult& result,
+					  const std::vector<std::size_t>& sortedIndices) const;
+public:
+	/**
+	 * Creates a new external sort
+	 * @param config The database configuration
+	 * @param orderingDataTypes The types of the ordering
+	 * @param ordering The ordering
+	 * @param resultTypes The types of the columns in the result
+	 */
+	ExternalSort(const DatabaseConfiguration& config,
+				 std::vector<ColumnType> orderingDataTypes,
+				 std::vector<OrderingColumn> ordering,
+				 std::vector<ColumnType> resultTypes);
+
+	~ExternalSort();
+
+	ExternalSort(const ExternalSort&) = delete;
+	ExternalSort& operator=(const ExternalSort&) = delete;
+
+	/**
+	 * Returns the number of runs that have been spilled
+	 */
+	std::size_t numRuns() const;
+
+	/**
+	 * Returns the number of bytes used by each buffered row, including the arrays used when sorting it
+	 */
+	std::size_t rowMemoryUsage() const;
+
+	/**
+	 * Sorts the given rows and spills them as a new run. The ordering data and the result columns are cleared.
+	 * @param orderingData The ordering data of the rows
+	 * @param result The result containing the rows
+	 */
+	void addRun(OrderingData& orderingData, QueryResult& result);
+
+	/**
+	 * Merges the spilled runs into the given result, which must have no rows
+	 * @param result The result
+	 */
+	void merge(QueryResult& result);
+};
@@ -0,0 +1,457 @@
+#include "filter_kernels.h"
+#include "filter_kernels_impl.h"
+
+#include <algorithm>
+#include <limits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+	template<typename T>
+	struct ScalarKernel {
+		static constexpr std::size_t width = 1;
+
+		static inline T broadcast(T value) {
+			return value;
+		}
+
+		static inline T load(const T* values) {
+			return *values;
+		}
+
+		template<CompareOperator Op>
+		static inline unsigned int compare(T x, T y) {
+			return compareScalar<Op>(x, y) ? 1 : 0;
+		}
+
+		static inline std::size_t storeSelection(unsigned int mask, std::size_t rowIndex, std::size_t* selection) {
+			return storeSelectionScalar<width>(mask, rowIndex, selection);
+		}
+	};
+
+#ifdef __SSE2__
+	struct Sse2Int32 {
+		static constexpr std::size_t width = 4;
+
+		static inline __m128i broadcast(std::int32_t value) {
+			return _mm_set1_epi32(value);
+		}
+
+		static inline __m128i load(const std::int32_t* values) {
+			return _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+		}
+
+		template<CompareOperator Op>
+		static inline unsigned int compare(__m128i x, __m128i y) {
+			switch (Op) {
+				case CompareOperator::Equal:
+					return mask(_mm_cmpeq_epi32(x, y));
+				case CompareOperator::NotEqual:
+					return ~mask(_mm_cmpeq_epi32(x, y)) & 0xF;
+				case CompareOperator::LessThan:
+					return mask(_mm_cmplt_epi32(x, y));
+				case CompareOperator::LessThanOrEqual:
+					return ~mask(_mm_cmpgt_epi32(x, y)) & 0xF;
+				case CompareOperator::GreaterThan:
+					return mask(_mm_cmpgt_epi32(x, y));
+				case CompareOperator::GreaterThanOrEqual:
+					return ~mask(_mm_cmplt_epi32(x, y)) & 0xF;
+			}
+
+			return 0;
+		}
+
+		static inline unsigned int mask(__m128i result) {
+			return (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(result));
+		}
+
+		static inline std::size_t storeSelection(unsigned int mask, std::size_t rowIndex, std::size_t* selection) {
+			return storeSelectionScalar<width>(mask, rowIndex, selection);
+		}
+	};
+
+	struct Sse2Float32 {
+		static constexpr std::size_t width = 4;
+
+		static inline __m128 broadcast(float value) {
+			return _mm_set1_ps(value);
+		}
+
+		static inline __m128 load(const float* values) {
+			return _mm_loadu_ps(values);
+		}
+
+		template<CompareOperator Op>
+		static inline unsigned int compare(__m128 x, __m128 y) {
+			switch (Op) {
+				case CompareOperator::Equal:
+					return (unsigned int)_mm_movemask_ps(_mm_cmpeq_ps(x, y));
+				case CompareOperator::NotEqual:
+					return (unsigned int)_mm_movemask_ps(_mm_cmpneq_ps(x, y));
+				case CompareOperator::LessThan:
+					return (unsigned int)_mm_movemask_ps(_mm_cmplt_ps(x, y));
+				case CompareOperator::LessThanOrEqual:
+					return (unsigned int)_mm_movemask_ps(_mm_cmple_ps(x, y));
+				case CompareOperator::GreaterThan:
+					return (unsigned int)_mm_movemask_ps(_mm_cmpgt_ps(x, y));
+				case CompareOperator::GreaterThanOrEqual:
+					return (unsigned int)_mm_movemask_ps(_mm_cmpge_ps(x, y));
+			}
+
+			return 0;
+		}
+
+		static inline std::size_t storeSelection(unsigned int mask, std::size_t rowIndex, std::size_t* selection) {
+			return storeSelectionScalar<width>(mask, rowIndex, selection);
+		}
+	};
+#endif
+
+	FilterInstructionSet detectInstructionSet() {
+#ifdef FILTER_KERNELS_AVX2
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2")) {
+			return FilterInstructionSet::AVX2;
+		}
+#endif
+
+#ifdef __SSE2__
+		return FilterInstructionSet::SSE2;
+#else
+		return FilterInstructionSet::Scalar;
+#endif
+	}
+
+	template<typename T, typename Sse2Kernel>
+	std::size_t selectWith(FilterInstructionSet instructionSet,
+						   CompareOperator op,
+						   const T* values,
+						   std::size_t count,
+						   T value,
+						   std::size_t startRowIndex,
+						   std::size_t* selection) {
+		switch (instructionSet) {
+			case FilterInstructionSet::AVX2:
+#ifdef FILTER_KERNELS_AVX2
+				return FilterKernelsAvx2::select(op, values, count, value, startRowIndex, selection);
+#endif
+			case FilterInstructionSet::SSE2:
+#ifdef __SSE2__
+				return selectForOperator<Sse2Kernel>(op, values, count, value, startRowIndex, selection);
+#endif
+			case FilterInstructionSet::Scalar:
+				break;
+		}
+
+		return selectForOperator<ScalarKernel<T>>(op, values, count, value, startRowIndex, selection);
+	}
+
+	template<typename T, typename Sse2Kernel>
+	void compareWith(FilterInstructionSet instructionSet,
+					 CompareOperator op,
+					 const T* values,
+					 std::size_t count,
+					 T value,
+					 bool* result) {
+		switch (instructionSet) {
+			case FilterInstructionSet::AVX2:
+#ifdef FILTER_KERNELS_AVX2
+				FilterKernelsAvx2::compare(op, values, count, value, result);
+				return;
+#endif
+			case FilterInstructionSet::SSE2:
+#ifdef __SSE2__
+				compareForOperator<Sse2Kernel>(op, values, count, value, result);
+				return;
+#endif
+			case FilterInstructionSet::Scalar:
+				break;
+		}
+
+		compareForOperator<ScalarKernel<T>>(op, values, count, value, result);
+	}
+
+#ifndef __SSE2__
+	using Sse2Int32 = ScalarKernel<std::int32_t>;
+	using Sse2Float32 = ScalarKernel<float>;
+#endif
+
+	// The number of encoded values unpacked at a time
+	constexpr std::size_t UNPACK_BATCH_SIZE = 1024;
+
+	/**
+	 * The values that compare true against a value, as an inclusive range. The range is negated for not equal.
+	 */
+	struct MatchingRange {
+		std::int64_t min;
+		std::int64_t max;
+		bool negated;
+	};
+
+	MatchingRange matchingRange(CompareOperator op, std::int32_t value) {
+		const std::int64_t minValue = std::numeric_limits<std::int32_t>::min();
+		const std::int64_t maxValue = std::numeric_limits<std::int32_t>::max();
+		switch (op) {
+			case CompareOperator::Equal:
+				return { value, value, false };
+			case CompareOperator::NotEqual:
+				return { value, value, true };
+			case CompareOperator::LessThan:
+				return { minValue, (std::int64_t)value - 1, false };
+			case CompareOperator::LessThanOrEqual:
+				return { minValue, value, false };
+			case CompareOperator::GreaterThan:
+				return { (std::int64_t)value + 1, maxValue, false };
+			case CompareOperator::GreaterThanOrEqual:
+				return { value, maxValue, false };
+		}
+
+		return { 1, 0, false };
+	}
+
+	void selectAll(std::size_t startRowIndex, std::size_t endRowIndex, std::vector<std::size_t>& selection) {
+		for (auto rowIndex = startRowIndex; rowIndex < endRowIndex; rowIndex++) {
+			selection.push_back(rowIndex);
+		}
+	}
+
+	/**
+	 * Selects the rows in the given range of a segment whose packed value is in the given inclusive range, or not in it if negated.
+	 * The packed values keep the order of the values, which turns the range into a compare that the kernels do on the unpacked values.
+	 */
+	void selectPacked(const BitPackedArray& packed,
+					  std::uint32_t minPacked,
+					  std::uint32_t maxPacked,
+					  std::uint32_t maxPossiblePacked,
+					  bool negated,
+					  std::size_t segmentStartRowIndex,
+					  std::size_t startIndex,
+					  std::size_t endIndex,
+					  std::vector<std::size_t>& selection) {
+		auto op = CompareOperator::Equal;
+		auto value = minPacked;
+		if (minPacked == maxPacked) {
+			op = negated ? CompareOperator::NotEqual : CompareOperator::Equal;
+		} else if (minPacked == 0) {
+			op = negated ? CompareOperator::GreaterThan : CompareOperator::LessThanOrEqual;
+			value = maxPacked;
+		} else if (maxPacked == maxPossiblePacked) {
+			op = negated ? CompareOperator::LessThan : CompareOperator::GreaterThanOrEqual;
+		}
+
+		auto selectionSize = selection.size();
+		selection.resize(selectionSize + endIndex - startIndex);
+		auto selected = selection.data() + selectionSize;
+
+		std::uint32_t values[UNPACK_BATCH_SIZE];
+		std::size_t numSelected = 0;
+		auto isCompare = packed.bitWidth() < 32 && (minPacked == maxPacked || minPacked == 0 || maxPacked == maxPossiblePacked);
+		for (auto batchStartIndex = startIndex; batchStartIndex < endIndex; batchStartIndex += UNPACK_BATCH_SIZE) {
+			auto count = std::min(UNPACK_BATCH_SIZE, endIndex - batchStartIndex);
+			auto rowIndex = segmentStartRowIndex + batchStartIndex;
+			packed.unpack(batchStartIndex, count, values);
+
+			// Values of less than 32 bits are positive as int32
+			if (isCompare) {
+				numSelected += FilterKernels::select(
+					FilterKernels::bestInstructionSet(),
+					op,
+					reinterpret_cast<const std::int32_t*>(values),
+					count,
+					(std::int32_t)value,
+					rowIndex,
+					selected + numSelected);
+			} else {
+				for (std::size_t i = 0; i < count; i++) {
+					selected[numSelected] = rowIndex + i;
+					numSelected += (values[i] >= minPacked && values[i] <= maxPacked) != negated;
+				}
+			}
+		}
+
+		selection.resize(selectionSize + numSelected);
+	}
+
+	/**
+	 * Selects the rows in the given range of a segment, where the range of matching values overlaps the values of the segment
+	 */
+	void selectSegment(CompareOperator op,
+					   std::int32_t value,
+					   const MatchingRange& range,
+					   const EncodedSegment& segment,
+					   std::size_t segmentStartRowIndex,
+					   std::size_t startIndex,
+					   std::size_t endIndex,
+					   std::vector<std::size_t>& selection) {
+		// The matching values within the segment, which makes the bounds fit the encoded values
+		auto minMatching = (std::int32_t)std::max(range.min, (std::int64_t)segment.min);
+		auto maxMatching = (std::int32_t)std::min(range.max, (std::int64_t)segment.max);
+
+		switch (segment.encoding) {
+			case SegmentEncoding::Plain: {
+				auto selectionSize = selection.size();
+				selection.resize(selectionSize + endIndex - startIndex);
+				selection.resize(selectionSize + FilterKernels::select(
+					FilterKernels::bestInstructionSet(),
+					op,
+					segment.values.data() + startIndex,
+					endIndex - startIndex,
+					value,
+					segmentStartRowIndex + startIndex,
+					selection.data() + selectionSize));
+				break;
+			}
+			case SegmentEncoding::Dictionary: {
+				// The dictionary is sorted, which makes the matching values a range of indices that can be empty
+				auto minIndex = (std::uint32_t)(std::lower_bound(segment.values.begin(), segment.values.end(), minMatching) - segment.values.begin());
+				auto maxIndex = (std::uint32_t)(std::upper_bound(segment.values.begin(), segment.values.end(), maxMatching) - segment.values.begin());
+				if (minIndex == maxIndex) {
+					if (range.negated) {
+						selectAll(segmentStartRowIndex + startIndex, segmentStartRowIndex + endIndex, selection);
+					}
+
+					break;
+				}
+
+				selectPacked(
+					segment.packed,
+					minIndex,
+					maxIndex - 1,
+					(std::uint32_t)(segment.values.size() - 1),
+					range.negated,
+					segmentStartRowIndex,
+					startIndex,
+					endIndex,
+					selection);
+
+				break;
+			}
+			case SegmentEncoding::RunLength: {
+				// Each run is compared once
+				auto runIndex = std::upper_bound(segment.runEnds.begin(), segment.runEnds.end(), (std::uint32_t)startIndex) - segment.runEnds.begin();
+				auto runStartIndex = startIndex;
+				for (; runStartIndex < endIndex; runIndex++) {
+					auto runEndIndex = std::min((std::size_t)segment.runEnds[runIndex], endIndex);
+					auto runValue = segment.values[runIndex];
+					if ((runValue >= minMatching && runValue <= maxMatching) != range.negated) {
+						selectAll(segmentStartRowIndex + runStartIndex, segmentStartRowIndex + runEndIndex, selection);
+					}
+
+					runStartIndex = runEndIndex;
+				}
+
+				break;
+			}
+			case SegmentEncoding::FrameOfReference: {
+				// The matching values are compared as differences to the minimum
+				auto minDifference = (std::uint32_t)((std::int64_t)minMatching - segment.min);
+				auto maxDifference = (std::uint32_t)((std::int64_t)maxMatching - segment.min);
+				selectPacked(
+					segment.packed,
+					minDifference,
+					maxDifference,
+					(std::uint32_t)((std::int64_t)segment.max - segment.min),
+					range.negated,
+					segmentStartRowIndex,
+					startIndex,
+					endIndex,
+					selection);
+
+				break;
+			}
+		}
+	}
+}
+
+FilterInstructionSet FilterKernels::bestInstructionSet() {
+	static const FilterInstructionSet instructionSet = detectInstructionSet();
+	return instructionSet;
+}
+
+std::size_t FilterKernels::select(FilterInstructionSet instructionSet,
+								  CompareOperator op,
+								  const std::int32_t* values,
+								  std::size_t count,
+								  std::int32_t value,
+								  std::size_t startRowIndex,
+								  std::size_t* selection) {
+	return selectWith<std::int32_t, Sse2Int32>(instructionSet, op, values, count, value, startRowIndex, selection);
+}
+
+std::size_t FilterKernels::select(FilterInstructionSet instructionSet,
+								  CompareOperator op,
+								  const float* values,
+								  std::size_t count,
+								  float value,
+								  std::size_t startRowIndex,
+								  std::size_t* selection) {
+	return selectWith<float, Sse2Float32>(instructionSet, op, values, count, value, startRowIndex, selection);
+}
+
+void FilterKernels::compare(FilterInstructionSet instructionSet,
+							CompareOperator op,
+							const std::int32_t* values,
+							std::size_t count,
+							std::int32_t value,
+							bool* result) {
+	compareWith<std::int32_t, Sse2Int32>(instructionSet, op, values, count, value, result);
+}
+
+void FilterKernels::compare(FilterInstructionSet instructionSet,
+							CompareOperator op,
+							const float* values,
+							std::size_t count,
+							float value,
+							bool* result) {
+	compareWith<float, Sse2Float32>(instructionSet, op, values, count, value, result);
+}
+
+void FilterKernels::selectEncodedColumn(CompareOperator op,
+										const UnderlyingColumnStorage<std::int32_t>& columnValues,
+										std::size_t startRowIndex,
+										std::size_t count,
+										std::int32_t value,
+										std::vector<std::size_t>& selection) {
+	selection.clear();
+	auto range = matchingRange(op, value);
+	ColumnStorage::forEachSegment(startRowIndex, startRowIndex + count, [&](const ColumnSegment& columnSegment) {
+		auto segmentValues = columnValues.segmentValues(columnSegment.index);
+		if (segmentValues != nullptr) {
+			auto selectionSize = selection.size();
+			selection.resize(selectionSize + columnSegment.endRowIndex - columnSegment.startRowIndex);
+			selection.resize(selectionSize + select(
+				bestInstructionSet(),
+				op,
+				segmentValues + (columnSegment.startRowIndex - columnSegment.index * COLUMN_SEGMENT_SIZE),
+				columnSegment.endRowIndex - columnSegment.startRowIndex,
+				value,
+				columnSegment.startRowIndex,
+				selection.data() + selectionSize));
+			return;
+		}
+
+		auto& segment = *columnValues.encodedSegment(columnSegment.index);
+		auto segmentStartRowIndex = columnSegment.index * COLUMN_SEGMENT_SIZE;
+
+		// The minimum and maximum of a segment can decide the comparison for all of its rows
+		auto allInRange = range.min <= segment.min && segment.max <= range.max;
+		auto noneInRange = range.max < segment.min || range.min > segment.max;
+		if (allInRange || noneInRange) {
+			if (allInRange != range.negated) {
+				selectAll(columnSegment.startRowIndex, columnSegment.endRowIndex, selection);
+			}
+		} else {
+			selectSegment(
+				op,
+				value,
+				range,
+				segment,
+				segmentStartRowIndex,
+				columnSegment.startRowIndex - segmentStartRowIndex,
+				columnSegment.endRowIndex - segmentStartRowIndex,
+				selection);
+		}
+	});
+}
@@ -0,0 +1,238 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include "../common.h"
+#include "../storage.h"
+#include "../column_encoding.h"
+#include "../query_expressions/helpers.h"
+
+/**
+ * The instruction sets for the filter kernels
+ */
+enum class FilterInstructionSet {
+	Scalar,
+	SSE2,
+	AVX2
+};
+
+/**
+ * Contains kernels for comparing a column against a constant value
+ */
+namespace FilterKernels {
+	/**
+	 * Returns the best instruction set supported by the current CPU
+	 */
+	FilterInstructionSet bestInstructionSet();
+
+	/**
+	 * Selects the values that compares true against the given value
+	 * @param instructionSet The instruction set to use
+	 * @param op The compare operator
+	 * @param values The values
+	 * @param count The number of values
+	 * @param value The value to compare against
+	 * @param startRowIndex The row index of the first value
+	 * @param selection The row indices of the selected values. Must have room for count values
+	 * @return The number of selected values
+	 */
+	std::size_t select(FilterInstructionSet instructionSet,
+					   CompareOperator op,
+					   const std::int32_t* values,
+					   std::size_t count,
+					   std::int32_t value,
+					   std::size_t startRowIndex,
+					   std::size_t* selection);
+
+	/**
+	 * Selects the values that compares true against the given value
+	 * @param instructionSet The instruction set to use
+	 * @param op The compare operator
+	 * @param values The values
+	 * @param count The number of values
+	 * @param value The value to compare against
+	 * @param startRowIndex The row index of the first value
+	 * @param selection The row indices of the selected values. Must have room for count values
+	 * @return The number of selected values
+	 */
+	std::size_t select(FilterInstructionSet instructionSet,
+					   CompareOperator op,
+					   const float* values,
+					   std::size_t count,
+					   float value,
+					   std::size_t startRowIndex,
+					   std::size_t* selection);
+
+	/**
+	 * Compares the values against the given value
+	 * @param instructionSet The instruction set to use
+	 * @param op The compare operator
+	 * @param values The values
+	 * @param count The number of values
+	 * @param value The value to compare against
+	 * @param result The result of each comparison
+	 */
+	void compare(FilterInstructionSet instructionSet,
+				 CompareOperator op,
+				 const std::int32_t* values,
+				 std::size_t count,
+				 std::int32_t value,
+				 bool* result);
+
+	/**
+	 * Compares the values against the given value
+	 * @param instructionSet The instruction set to use
+	 * @param op The compare operator
+	 * @param values The values
+	 * @param count The number of values
+	 * @param value The value to compare against
+	 * @param result The result of each comparison
+	 */
+	void compare(FilterInstructionSet instructionSet,
+				 CompareOperator op,
+				 const float* values,
+				 std::size_t count,
+				 float value,
+				 bool* result);
+
+	/**
+	 * Selects the rows in the given range of a column that compares true against the given value
+	 * @tparam T The type of the column
+	 * @param op The compare operator
+	 * @param columnValues The values of the column
+	 * @param startRowIndex The first row
+	 * @param count The number of rows
+	 * @param value The value to compare against
+	 * @param selection The selected rows
+	 */
+	template<typename T>
+	void selectColumn(CompareOperator op,
+					  const UnderlyingColumnStorage<T>& columnValues,
+					  std::size_t startRowIndex,
+					  std::size_t count,
+					  const T& value,
+					  std::vector<std::size_t>& selection) {
+		selection.clear();
+		for (std::size_t rowIndex = startRowIndex; rowIndex < startRowIndex + count; rowIndex++) {
+			if (QueryExpressionHelpers::compare<T>(op, columnValues[rowIndex], value)) {
+				selection.push_back(rowIndex);
+			}
+		}
+	}
+
+	inline void selectColumn(CompareOperator op,
+							 const UnderlyingColumnStorage<std::int32_t>& columnValues,
+							 std::size_t startRowIndex,
+							 std::size_t count,
+							 std::int32_t value,
+							 std::vector<std::size_t>& selection) {
+		selection.resize(count);
+		std::size_t numSelected = 0;
+		columnValues.forEachSegment(
+			startRowIndex,
+			startRowIndex + count,
+			[&](const std::int32_t* values, std::size_t segmentStartRowIndex, std::size_t segmentCount) {
+				numSelected += select(
+					bestInstructionSet(),
+					op,
+					values,
+					segmentCount,
+					value,
+					segmentStartRowIndex,
+					selection.data() + numSelected);
+			});
+		selection.resize(numSelected);
+	}
+
+	inline void selectColumn(CompareOperator op,
+							 const UnderlyingColumnStorage<float>& columnValues,
+							 std::size_t startRowIndex,
+							 std::size_t count,
+							 float value,
+							 std::vector<std::size_t>& selection) {
+		selection.resize(count);
+		std::size_t numSelected = 0;
+		columnValues.forEachSegment(
+			startRowIndex,
+			startRowIndex + count,
+			[&](const float* values, std::size_t segmentStartRowIndex, std::size_t segmentCount) {
+				numSelected += select(
+					bestInstructionSet(),
+					op,
+					values,
+					segmentCount,
+					value,
+					segmentStartRowIndex,
+					selection.data() + numSelected);
+			});
+		selection.resize(numSelected);
+	}
+
+	/**
+	 * Selects the rows in the given range of a column that compares true against the given value.
+	 * The comparison is done on the encoded values of encoded segments, and segments whose minimum and maximum decide it
+	 * are not read.
+	 * @param op The compare operator
+	 * @param columnValues The values of the column
+	 * @param startRowIndex The first row
+	 * @param count The number of rows
+	 * @param value The value to compare against
+	 * @param selection The selected rows
+	 */
+	void selectEncodedColumn(CompareOperator op,
+							 const UnderlyingColumnStorage<std::int32_t>& columnValues,
+							 std::size_t startRowIndex,
+							 std::size_t count,
+							 std::int32_t value,
+							 std::vector<std::size_t>& selection);
+
+	/**
+	 * Compares the given range of a column against the given value
+	 * @tparam T The type of the column
+	 * @param op The compare operator
+	 * @param columnValues The values of the column
+	 * @param startRowIndex The first row
+	 * @param count The number of rows
+	 * @param value The value to compare against
+	 * @param result The result of each comparison
+	 */
+	template<typename T>
+	void compareColumn(CompareOperator op,
+					   const UnderlyingColumnStorage<T>& columnValues,
+					   std::size_t startRowIndex,
+					   std::size_t count,
+					   const T& value,
+					   bool* result) {
+		for (std::size_t i = 0; i < count; i++) {
+			result[i] = QueryExpressionHelpers::compare<T>(op, columnValues[startRowIndex + i], value);
+		}
+	}
+
+	inline void compareColumn(CompareOperator op,
+							  const UnderlyingColumnStorage<std::int32_t>& columnValues,
+							  std::size_t startRowIndex,
+							  std::size_t count,
+							  std::int32_t value,
+							  bool* result) {
+		columnValues.forEachSegment(
+			startRowIndex,
+			startRowIndex + count,
+			[&](const std::int32_t* values, std::size_t segmentStartRowIndex, std::size_t segmentCount) {
+				compare(bestInstructionSet(), op, values, segmentCount, value, result + (segmentStartRowIndex - startRowIndex));
+			});
+	}
+
+	inline void compareColumn(CompareOperator op,
+							  const UnderlyingColumnStorage<float>& columnValues,
+							  std::size_t startRowIndex,
+							  std::size_t count,
+							  float value,
+							  bool* result) {
+		columnValues.forEachSegment(
+			startRowIndex,
+			startRowIndex + count,
+			[&](const float* values, std::size_t segmentStartRowIndex, std::size_t segmentCount) {
+				compare(bestInstructionSet(), op, values, segmentCount, value, result + (segmentStartRowIndex - startRowIndex));
+			});
+	}
+}
@@ -0,0 +1,146 @@
+#include "filter_kernels_impl.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+namespace {
+	/**
+	 * Returns the permutations that moves the set lanes of a 4 lane mask of 64-bit values to the front
+	 */
+	inline const std::array<std::array<std::int32_t, 8>, 16>& compressPermutations() {
+		static const std::array<std::array<std::int32_t, 8>, 16> table = []() {
+			std::array<std::array<std::int32_t, 8>, 16> permutations {};
+			for (std::size_t mask = 0; mask < permutations.size(); mask++) {
+				std::size_t outputLane = 0;
+				for (std::int32_t lane = 0; lane < 4; lane++) {
+					if ((mask >> lane) & 1) {
+						permutations[mask][2 * outputLane] = 2 * lane;
+						permutations[mask][2 * outputLane + 1] = 2 * lane + 1;
+						outputLane++;
+					}
+				}
+			}
+
+			return permutations;
+		}();
+
+		return table;
+	}
+
+	/**
+	 * Stores the row indices of the set lanes in the given 8 lane mask
+	 */
+	inline std::size_t storeSelectionAvx2(unsigned int mask, std::size_t rowIndex, std::size_t* selection) {
+		auto& permutations = compressPermutations();
+		auto rowIndices = _mm256_add_epi64(
+			_mm256_set1_epi64x((long long)rowIndex),
+			_mm256_set_epi64x(3, 2, 1, 0));
+
+		auto lowMask = mask & 0xF;
+		auto lowPermutation = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(permutations[lowMask].data()));
+		_mm256_storeu_si256(
+			reinterpret_cast<__m256i*>(selection),
+			_mm256_permutevar8x32_epi32(rowIndices, lowPermutation));
+		std::size_t numSelected = (std::size_t)__builtin_popcount(lowMask);
+
+		auto highMask = (mask >> 4) & 0xF;
+		auto highPermutation = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(permutations[highMask].data()));
+		_mm256_storeu_si256(
+			reinterpret_cast<__m256i*>(selection + numSelected),
+			_mm256_permutevar8x32_epi32(_mm256_add_epi64(rowIndices, _mm256_set1_epi64x(4)), highPermutation));
+		return numSelected + (std::size_t)__builtin_popcount(highMask);
+	}
+
+	struct Avx2Int32 {
+		static constexpr std::size_t width = 8;
+
+		static inline __m256i broadcast(std::int32_t value) {
+			return _mm256_set1_epi32(value);
+		}
+
+		static inline __m256i load(const std::int32_t* values) {
+			return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+		}
+
+		template<CompareOperator Op>
+		static inline unsigned int compare(__m256i x, __m256i y) {
+			switch (Op) {
+				case CompareOperator::Equal:
+					return mask(_mm256_cmpeq_epi32(x, y));
+				case CompareOperator::NotEqual:
+					return ~mask(_mm256_cmpeq_epi32(x, y)) & 0xFF;
+				case CompareOperator::LessThan:
+					return mask(_mm256_cmpgt_epi32(y, x));
+				case CompareOperator::LessThanOrEqual:
+					return ~mask(_mm256_cmpgt_epi32(x, y)) & 0xFF;
+				case CompareOperator::GreaterThan:
+					return mask(_mm256_cmpgt_epi32(x, y));
+				case CompareOperator::GreaterThanOrEqual:
+					return ~mask(_mm256_cmpgt_epi32(y, x)) & 0xFF;
+			}
+
+			return 0;
+		}
+
+		static inline unsigned int mask(__m256i result) {
+			return (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(result));
+		}
+
+		static inline std::size_t storeSelection(unsigned int mask, std::size_t rowIndex, std::size_t* selection) {
+			return storeSelectionAvx2(mask, rowIndex, selection);
+		}
+	};
+
+	struct Avx2Float32 {
+		static constexpr std::size_t width = 8;
+
+		static inline __m256 broadcast(float value) {
+			return _mm256_set1_ps(value);
+		}
+
+		static inline __m256 load(const float* values) {
+			return _mm256_loadu_ps(values);
+		}
+
+		template<CompareOperator Op>
+		static inline unsigned int compare(__m256 x, __m256 y) {
+			switch (Op) {
+				case CompareOperator::Equal:
+					return (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(x, y, _CMP_EQ_OQ));
+				case CompareOperator::NotEqual:
+					return (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(x, y, _CMP_NEQ_UQ));
+				case CompareOperator::LessThan:
+					return (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(x, y, _CMP_LT_OQ));
+				case CompareOperator::LessThanOrEqual:
+					return (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(x, y, _CMP_LE_OQ));
+				case CompareOperator::GreaterThan:
+					return (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(x, y, _CMP_GT_OQ));
+				case CompareOperator::GreaterThanOrEqual:
+					return (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(x, y, _CMP_GE_OQ));
+			}
+
+			return 0;
+		}
+
+		static inline std::size_t storeSelection(unsigned int mask, std::size_t rowIndex, std::size_t* selection) {
+			return storeSelectionAvx2(mask, rowIndex, selection);
+		}
+	};
+}
+
+std::size_t FilterKernelsAvx2::select(CompareOperator op, const std::int32_t* values, std::size_t count, std::int32_t value, std::size_t startRowIndex, std::size_t* selection) {
+	return selectForOperator<Avx2Int32>(op, values, count, value, startRowIndex, selection);
+}
+
+std::size_t FilterKernelsAvx2::select(CompareOperator op, const float* values, std::size_t count, float value, std::size_t startRowIndex, std::size_t* selection) {
+	return selectForOperator<Avx2Float32>(op, values, count, value, startRowIndex, selection);
+}
+
+void FilterKernelsAvx2::compare(CompareOperator op, const std::int32_t* values, std::size_t count, std::int32_t value, bool* result) {
+	compareForOperator<Avx2Int32>(op, values, count, value, result);
+}
+
+void FilterKernelsAvx2::compare(CompareOperator op, const float* values, std::size_t count, float value, bool* result) {
+	compareForOperator<Avx2Float32>(op, values, count, value, result);
+}
+#endif
@@ -0,0 +1,161 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <array>
+
+#include "filter_kernels.h"
+
+/**
+ * The instruction set independent part of the filter kernels.
+ * Everything is in an anonymous namespace since each instruction set is compiled in its own translation unit.
+ */
+namespace {
+	/**
+	 * Compares the given values with a compile time operator
+	 */
+	template<CompareOperator Op, typename T>
+	inline bool compareScalar(T x, T y) {
+		switch (Op) {
+			case CompareOperator::Equal:
+				return x == y;
+			case CompareOperator::NotEqual:
+				return x != y;
+			case CompareOperator::LessThan:
+				return x < y;
+			case CompareOperator::LessThanOrEqual:
+				return x <= y;
+			case CompareOperator::GreaterThan:
+				return x > y;
+			case CompareOperator::GreaterThanOrEqual:
+				return x >= y;
+		}
+
+		return false;
+	}
+
+	/**
+	 * Returns a table that maps a mask of 8 lanes to 8 bools
+	 */
+	inline const std::array<std::uint64_t, 256>& maskToBools() {
+		static const std::array<std::uint64_t, 256> table = []() {
+			std::array<std::uint64_t, 256> masks {};
+			for (std::size_t mask = 0; mask < masks.size(); mask++) {
+				std::uint8_t bools[8];
+				for (std::size_t lane = 0; lane < 8; lane++) {
+					bools[lane] = (std::uint8_t)((mask >> lane) & 1);
+				}
+
+				std::memcpy(&masks[mask], bools, sizeof(bools));
+			}
+
+			return masks;
+		}();
+
+		return table;
+	}
+
+	/**
+	 * Stores the row indices of the set lanes in the given mask without branching.
+	 * The selection must have room for all the lanes.
+	 */
+	template<std::size_t Width>
+	inline std::size_t storeSelectionScalar(unsigned int mask, std::size_t rowIndex, std::size_t* selection) {
+		std::size_t numSelected = 0;
+		for (std::size_t lane = 0; lane < Width; lane++) {
+			selection[numSelected] = rowIndex + lane;
+			numSelected += (mask >> lane) & 1;
+		}
+
+		return numSelected;
+	}
+
+	template<typename Isa, CompareOperator Op, typename T>
+	std::size_t selectLoop(const T* values, std::size_t count, T value, std::size_t startRowIndex, std::size_t* selection) {
+		std::size_t numSelected = 0;
+		std::size_t index = 0;
+
+		auto valueVector = Isa::broadcast(value);
+		for (; index + Isa::width <= count; index += Isa::width) {
+			auto mask = Isa::template compare<Op>(Isa::load(values + index), valueVector);
+			numSelected += Isa::storeSelection(mask, startRowIndex + index, selection + numSelected);
+		}
+
+		for (; index < count; index++) {
+			if (compareScalar<Op>(values[index], value)) {
+				selection[numSelected++] = startRowIndex + index;
+			}
+		}
+
+		return numSelected;
+	}
+
+	template<typename Isa, CompareOperator Op, typename T>
+	void compareLoop(const T* values, std::size_t count, T value, bool* result) {
+		std::size_t index = 0;
+		auto& masks = maskToBools();
+
+		auto valueVector = Isa::broadcast(value);
+		for (; index + Isa::width <= count; index += Isa::width) {
+			auto mask = Isa::template compare<Op>(Isa::load(values + index), valueVector);
+			std::memcpy(result + index, &masks[mask], Isa::width);
+		}
+
+		for (; index < count; index++) {
+			result[index] = compareScalar<Op>(values[index], value);
+		}
+	}
+
+	template<typename Isa, typename T>
+	std::size_t selectForOperator(CompareOperator op, const T* values, std::size_t count, T value, std::size_t startRowIndex, std::size_t* selection) {
+		switch (op) {
+			case CompareOperator::Equal:
+				return selectLoop<Isa, CompareOperator::Equal>(values, count, value, startRowIndex, selection);
+			case CompareOperator::NotEqual:
+				return selectLoop<Isa, CompareOperator::NotEqual>(values, count, value, startRowIndex, selection);
+			case CompareOperator::LessThan:
+				return selectLoop<Isa, CompareOperator::LessThan>(values, count, value, startRowIndex, selection);
+			case CompareOperator::LessThanOrEqual:
+				return selectLoop<Isa, CompareOperator::LessThanOrEqual>(values, count, value, startRowIndex, selection);
+			case CompareOperator::GreaterThan:
+				return selectLoop<Isa, CompareOperator::GreaterThan>(values, count, value, startRowIndex, selection);
+			case CompareOperator::GreaterThanOrEqual:
+				return selectLoop<Isa, CompareOperator::GreaterThanOrEqual>(values, count, value, startRowIndex, selection);
+		}
+
+		return 0;
+	}
+
+	template<typename Isa, typename T>
+	void compareForOperator(CompareOperator op, const T* values, std::size_t count, T value, bool* result) {
+		switch (op) {
+			case CompareOperator::Equal:
+				compareLoop<Isa, CompareOperator::Equal>(values, count, value, result);
+				break;
+			case CompareOperator::NotEqual:
+				compareLoop<Isa, CompareOperator::NotEqual>(values, count, value, result);
+				break;
+			case CompareOperator::LessThan:
+				compareLoop<Isa, CompareOperator::LessThan>(values, count, value, result);
+				break;
+			case CompareOperator::LessThanOrEqual:
+				compareLoop<Isa, CompareOperator::LessThanOrEqual>(values, count, value, result);
+				break;
+			case CompareOperator::GreaterThan:
+				compareLoop<Isa, CompareOperator::GreaterThan>(values, count, value, result);
+				break;
+			case CompareOperator::GreaterThanOrEqual:
+				compareLoop<Isa, CompareOperator::GreaterThanOrEqual>(values, count, value, result);
+				break;
+		}
+	}
+}
+
+/**
+ * The kernels for a specific instruction set
+ */
+namespace FilterKernelsAvx2 {
+	std::size_t select(CompareOperator op, const std::int32_t* values, std::size_t count, std::int32_t value, std::size_t startRowIndex, std::size_t* selection);
+	std::size_t select(CompareOperator op, const float* values, std::size_t count, float value, std::size_t startRowIndex, std::size_t* selection);
+	void compare(CompareOperator op, const std::int32_t* values, std::size_t count, std::int32_t value, bool* result);
+	void compare(CompareOperator op, const float* values, std::size_t count, float value, bool* result);
+}
@@ -0,0 +1,98 @@
+#include "hash_join.h"
+#include "../storage.h"
+
+#include <functional>
+#include <limits>
+
+namespace {
+	constexpr std::size_t EMPTY_BUCKET = std::numeric_limits<std::size_t>::max();
+
+	/**
+	 * A chained hash table from the values of a column to the row indices
+	 */
+	template<typename T>
+	class JoinHashTable {
+	private:
+		const UnderlyingColumnStorage<T>& mValues;
+		std::size_t mShift;
+		std::vector<std::size_t> mBuckets;
+		std::vector<std::size_t> mNext;
+
+		inline std::size_t bucket(const T& value) const {
+			// Fibonacci hashing, as std::hash is the identity for integers
+			auto hash = (std::uint64_t)std::hash<T>()(value) * 0x9E3779B97F4A7C15ull;
+			return (std::size_t)(hash >> mShift);
+		}
+	public:
+		/**
+		 * Builds a hash table for the given values
+		 * @param values The values
+		 */
+		explicit JoinHashTable(const UnderlyingColumnStorage<T>& values)
+			: mValues(values) {
+			std::size_t numBits = 1;
+			while (((std::size_t)1 << numBits) < 2 * values.size()) {
+				numBits++;
+			}
+
+			mShift = 64 - numBits;
+			mBuckets.assign((std::size_t)1 << numBits, EMPTY_BUCKET);
+			mNext.resize(values.size());
+
+			// Insert in reverse order such that each chain is ordered by row index
+			for (std::size_t rowIndex = values.size(); rowIndex-- > 0;) {
+				auto& head = mBuckets[bucket(values[rowIndex])];
+				mNext[rowIndex] = head;
+				head = rowIndex;
+			}
+		}
+
+		/**
+		 * Applies the given function on each row that has the given value
+		 * @param value The value
+		 * @param applyRow The function to apply
+		 */
+		template<typename F>
+		inline void forEachMatch(const T& value, F applyRow) const {
+			for (auto rowIndex = mBuckets[bucket(value)]; rowIndex != EMPTY_BUCKET; rowIndex = mNext[rowIndex]) {
+				if (mValues[rowIndex] == value) {
+					applyRow(rowIndex);
+				}
+			}
+		}
+	};
+}
+
+void HashJoin::execute(const ColumnStorage& leftColumn,
+					   const ColumnStorage& rightColumn,
+					   JoinedRowIndices& result) {
+	if (leftColumn.type() != rightColumn.type()) {
+		return;
+	}
+
+	auto handleForType = [&](auto dummy) {
+		using Type = decltype(dummy);
+		auto& leftValues = leftColumn.getUnderlyingStorage<Type>();
+		auto& rightValues = rightColumn.getUnderlyingStorage<Type>();
+
+		if (leftValues.size() <= rightValues.size()) {
+			JoinHashTable<Type> hashTable(leftValues);
+			for (std::size_t rightRowIndex = 0; rightRowIndex < rightValues.size(); rightRowIndex++) {
+				hashTable.forEachMatch(rightValues[rightRowIndex], [&](std::size_t leftRowIndex) {
+					result.leftRowIndices.push_back(leftRowIndex);
+					result.rightRowIndices.push_back(rightRowIndex);
+				});
+			}
+		} else {
+			JoinHashTable<Type> hashTable(rightValues);
+			for (std::size_t leftRowIndex = 0; leftRowIndex < leftValues.size(); leftRowIndex++) {
+				hashTable.forEachMatch(leftValues[leftRowIndex], [&](std::size_t rightRowIndex) {
+					result.leftRowIndices.push_back(leftRowIndex);
+					result.rightRowIndices.push_back(rightRowIndex);
+				});
+			}
+		}
+	};
+
+	handleGenericType(leftColumn.type(), handleForType);
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <vector>
+
+#include "../common.h"
+
+class ColumnStorage;
+
+/**
+ * The matching rows of a join. The row at the same position in both lists form a pair.
+ */
+struct JoinedRowIndices {
+	std::vector<std::size_t> leftRowIndices;
+	std::vector<std::size_t> rightRowIndices;
+};
+
+/**
+ * Represents a hash join between two columns
+ */
+class HashJoin {
+public:
+	/**
+	 * Finds the rows where the given columns are equal.
+	 * The hash table is built on the smaller column and probed with the other column.
+	 * @param leftColumn The left column
+	 * @param rightColumn The right column
+	 * @param result The matching rows
+	 */
+	void execute(const ColumnStorage& leftColumn,
+				 const ColumnStorage& rightColumn,
+				 JoinedRowIndices& result);
+};
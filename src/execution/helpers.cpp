@@ -5,6 +5,8 @@
 #include "../table.h"
 #include "../query.h"
 #include "../helpers.h"
+#include "parallel_scan.h"
+#include "radix_sort.h"
 
 #include <algorithm>
 #include <iostream>
@@ -23,16 +25,111 @@ ExpressionExecutionEngine ExecutorHelpers::compile(VirtualTableContainer& tableC
 		numReturnValues);
 
 	expressionCompilerVisitor.compile(rootExpression);
+	executionEngine.setBatchExecution(config.batchExecution);
 	return executionEngine;
 }
 
 void ExecutorHelpers::forEachRowFiltered(VirtualTable& table,
 										 ExpressionExecutionEngine& filterExecutionEngine,
 										 std::function<void (std::size_t)> applyRow) {
-	for (std::size_t rowIndex = 0; rowIndex < table.numRows(); rowIndex++) {
-		filterExecutionEngine.execute(rowIndex);
-		if (filterExecutionEngine.popEvaluation().getValue<bool>()) {
-			applyRow(rowIndex);
+	if (!filterExecutionEngine.canExecuteBatch()) {
+		for (std::size_t rowIndex = 0; rowIndex < table.numRows(); rowIndex++) {
+			filterExecutionEngine.execute(rowIndex);
+			if (filterExecutionEngine.popEvaluation().getValue<bool>()) {
+				applyRow(rowIndex);
+			}
+		}
+
+		return;
+	}
+
+	forEachBatchFiltered(
+		table,
+		filterExecutionEngine,
+		[&](const std::vector<std::size_t>& rowIndices) {
+			for (auto rowIndex : rowIndices) {
+				applyRow(rowIndex);
+			}
+		});
+}
+
+void ExecutorHelpers::forEachBatchFiltered(VirtualTable& table,
+										   ExpressionExecutionEngine& filterExecutionEngine,
+										   std::function<void (const std::vector<std::size_t>&)> applyRows) {
+	forEachBatchFiltered(table, filterExecutionEngine, 0, table.numRows(), std::move(applyRows));
+}
+
+void ExecutorHelpers::forEachBatchFiltered(VirtualTable& table,
+										   ExpressionExecutionEngine& filterExecutionEngine,
+										   std::size_t startRowIndex,
+										   std::size_t endRowIndex,
+										   std::function<void (const std::vector<std::size_t>&)> applyRows) {
+	std::vector<std::size_t> rowIndices;
+	rowIndices.reserve(EXPRESSION_BATCH_SIZE);
+
+	if (!filterExecutionEngine.canExecuteBatch()) {
+		for (std::size_t rowIndex = startRowIndex; rowIndex < endRowIndex; rowIndex++) {
+			filterExecutionEngine.execute(rowIndex);
+			if (filterExecutionEngine.popEvaluation().getValue<bool>()) {
+				rowIndices.push_back(rowIndex);
+			}
+
+			if (rowIndices.size() == EXPRESSION_BATCH_SIZE) {
+				applyRows(rowIndices);
+				rowIndices.clear();
+			}
+		}
+
+		if (!rowIndices.empty()) {
+			applyRows(rowIndices);
+		}
+
+		return;
+	}
+
+	for (std::size_t batchStartRowIndex = startRowIndex; batchStartRowIndex < endRowIndex; batchStartRowIndex += EXPRESSION_BATCH_SIZE) {
+		RowBatch rows(batchStartRowIndex, std::min(EXPRESSION_BATCH_SIZE, endRowIndex - batchStartRowIndex));
+		filterExecutionEngine.executeBatch(rows);
+
+		auto filterValues = filterExecutionEngine.popBatchEvaluation().values<bool>();
+		rowIndices.clear();
+		for (std::size_t i = 0; i < rows.size; i++) {
+			if (filterValues[i]) {
+				rowIndices.push_back(batchStartRowIndex + i);
+			}
+		}
+
+		if (!rowIndices.empty()) {
+			applyRows(rowIndices);
+		}
+	}
+}
+
+void ExecutorHelpers::filterRows(ExpressionExecutionEngine& filterExecutionEngine,
+								 const std::vector<std::size_t>& rowIndices,
+								 std::vector<std::size_t>& filteredRowIndices) {
+	filteredRowIndices.clear();
+
+	if (!filterExecutionEngine.canExecuteBatch()) {
+		for (auto rowIndex : rowIndices) {
+			filterExecutionEngine.execute(rowIndex);
+			if (filterExecutionEngine.popEvaluation().getValue<bool>()) {
+				filteredRowIndices.push_back(rowIndex);
+			}
+		}
+
+		return;
+	}
+
+	for (std::size_t offset = 0; offset < rowIndices.size(); offset += EXPRESSION_BATCH_SIZE) {
+		RowBatch rows(rowIndices.data() + offset, std::min(EXPRESSION_BATCH_SIZE, rowIndices.size() - offset));
+		filterExecutionEngine.executeBatch(rows);
+
+		auto filterValues = filterExecutionEngine.popBatchEvaluation().values<bool>();
+		for (std::size_t i = 0; i < rows.size; i++) {
+			if (filterValues[i]) {
+				filteredRowIndices.push_back(rows.rowIndex(i));
+			}
 		}
 	}
 }
@@ -48,6 +145,22 @@ void ExecutorHelpers::addColumnToResult(const ColumnStorage& storage,
 	handleGenericType(storage.type(), handleForType);
 }
 
+void ExecutorHelpers::addColumnToResult(const ColumnStorage& storage,
+										ColumnStorage& resultStorage,
+										const std::vector<std::size_t>& rowIndices) {
+	auto handleForType = [&](auto dummy) {
+		using Type = decltype(dummy);
+		auto& values = storage.getUnderlyingStorage<Type>();
+		auto& resultValues = resultStorage.getUnderlyingStorage<Type>();
+		resultValues.reserve(resultValues.size() + rowIndices.size());
+		for (auto rowIndex : rowIndices) {
+			resultValues.push_back(values[rowIndex]);
+		}
+	};
+
+	handleGenericType(storage.type(), handleForType);
+}
+
 void ExecutorHelpers::addRowToResult(std::vector<VirtualColumn*> columnsStorage, QueryResult& result, std::size_t rowIndex) {
 	for (std::size_t columnIndex = 0; columnIndex < columnsStorage.size(); columnIndex++) {
 		ExecutorHelpers::addColumnToResult(
@@ -57,6 +170,17 @@ void ExecutorHelpers::addRowToResult(std::vector<VirtualColumn*> columnsStorage,
 	}
 }
 
+void ExecutorHelpers::addRowsToResult(const std::vector<VirtualColumn*>& columnsStorage,
+									  QueryResult& result,
+									  const std::vector<std::size_t>& rowIndices) {
+	for (std::size_t columnIndex = 0; columnIndex < columnsStorage.size(); columnIndex++) {
+		ExecutorHelpers::addColumnToResult(
+			*columnsStorage[columnIndex]->storage(),
+			result.columns[columnIndex],
+			rowIndices);
+	}
+}
+
 void ExecutorHelpers::addRowToResult(std::vector<std::unique_ptr<ExpressionExecutionEngine>>& projections,
 									 ReducedProjections& reducedProjections,
 									 QueryResult& result,
@@ -86,13 +210,94 @@ void ExecutorHelpers::addRowToResult(std::vector<std::unique_ptr<ExpressionExecu
 	}
 }
 
-void ExecutorHelpers::orderResult(const std::vector<ColumnType>& orderingDataTypes,
-								  const std::vector<OrderingColumn>& ordering,
-							   	  const std::vector<std::vector<RawQueryValue>>& orderingData,
-							   	  QueryResult& result) {
-	// Find the indices of the ordering
+void ExecutorHelpers::addRowsToResult(std::vector<std::unique_ptr<ExpressionExecutionEngine>>& projections,
+									  ReducedProjections& reducedProjections,
+									  QueryResult& result,
+									  const std::vector<std::size_t>& rowIndices) {
+	std::size_t projectionIndex = 0;
+	for (auto& projection : projections) {
+		auto& resultStorage = result.columns[projectionIndex];
+
+		if (reducedProjections.storage[projectionIndex] != nullptr) {
+			ExecutorHelpers::addColumnToResult(
+				*reducedProjections.storage[projectionIndex]->storage(),
+				resultStorage,
+				rowIndices);
+		} else {
+			ExecutorHelpers::addExpressionToResult(*projection, resultStorage, rowIndices);
+		}
+
+		projectionIndex++;
+	}
+}
+
+void ExecutorHelpers::addExpressionToResult(ExpressionExecutionEngine& executionEngine,
+											ColumnStorage& resultStorage,
+											const std::vector<std::size_t>& rowIndices) {
+	if (executionEngine.canExecuteBatch()) {
+		for (std::size_t offset = 0; offset < rowIndices.size(); offset += EXPRESSION_BATCH_SIZE) {
+			RowBatch rows(rowIndices.data() + offset, std::min(EXPRESSION_BATCH_SIZE, rowIndices.size() - offset));
+			executionEngine.executeBatch(rows);
+			auto& resultBatch = executionEngine.popBatchEvaluation();
+
+			auto handleForType = [&](auto dummy) {
+				using Type = decltype(dummy);
+				auto values = resultBatch.values<Type>();
+				auto& resultValues = resultStorage.getUnderlyingStorage<Type>();
+				resultValues.append(values, resultBatch.size());
+			};
+
+			handleGenericType(resultBatch.type(), handleForType);
+		}
+	} else {
+		for (auto rowIndex : rowIndices) {
+			executionEngine.execute(rowIndex);
+			auto resultValue = executionEngine.popEvaluation();
+
+			auto handleForType = [&](auto dummy) {
+				using Type = decltype(dummy);
+				resultStorage.getUnderlyingStorage<Type>().push_back(resultValue.getValue<Type>());
+			};
+
+			handleGenericType(resultValue.type, handleForType);
+		}
+	}
+}
+
+void ExecutorHelpers::appendResult(QueryResult& result, QueryResult& other) {
+	for (std::size_t columnIndex = 0; columnIndex < result.columns.size(); columnIndex++) {
+		auto& resultStorage = result.columns[columnIndex];
+		auto& otherStorage = other.columns[columnIndex];
+
+		auto handleForType = [&](auto dummy) {
+			using Type = decltype(dummy);
+			auto& resultValues = resultStorage.getUnderlyingStorage<Type>();
+			auto& otherValues = otherStorage.getUnderlyingStorage<Type>();
+			if (resultValues.empty()) {
+				resultValues = std::move(otherValues);
+			} else {
+				resultValues.append(otherValues);
+			}
+
+			otherValues.clear();
+		};
+
+		handleGenericType(resultStorage.type(), handleForType);
+	}
+}
+
+std::vector<std::size_t> ExecutorHelpers::sortedIndices(const DatabaseConfiguration& config,
+														const std::vector<ColumnType>& orderingDataTypes,
+														const std::vector<OrderingColumn>& ordering,
+														const std::vector<std::vector<RawQueryValue>>& orderingData) {
+	auto numRows = orderingData[0].size();
+	auto numWorkers = ParallelScan::numWorkers(config, numRows);
+
 	std::vector<std::size_t> sortedIndices;
-	{
+	if (numRows >= RadixSort::MIN_NUM_ROWS) {
+		Timing timing("radix sort: ");
+		sortedIndices = RadixSort::sortedIndices(orderingDataTypes, ordering, orderingData, numWorkers);
+	} else {
 		Timing timing("sort: ");
 		for (std::size_t i = 0; i < orderingData[0].size(); i++) {
 			sortedIndices.push_back(i);
@@ -154,6 +359,17 @@ void ExecutorHelpers::orderResult(const std::vector<ColumnType>& orderingDataTyp
 			*sortFunc);
 	}
 
+	return sortedIndices;
+}
+
+void ExecutorHelpers::orderResult(const DatabaseConfiguration& config,
+								  const std::vector<ColumnType>& orderingDataTypes,
+								  const std::vector<OrderingColumn>& ordering,
+							   	  const std::vector<std::vector<RawQueryValue>>& orderingData,
+							   	  QueryResult& result) {
+	auto sortedIndices = ExecutorHelpers::sortedIndices(config, orderingDataTypes, ordering, orderingData);
+	auto numWorkers = ParallelScan::numWorkers(config, sortedIndices.size());
+
 	// Now update the result
 	{
 		Timing timing("updateResult: ");
@@ -164,11 +380,17 @@ void ExecutorHelpers::orderResult(const std::vector<ColumnType>& orderingDataTyp
 				ColumnStorage sortedValues(column.type());
 				auto& underlyingStorageOriginal = column.getUnderlyingStorage<Type>();
 				auto& underlyingStorageSorted = sortedValues.getUnderlyingStorage<Type>();
-				underlyingStorageSorted.reserve(underlyingStorageOriginal.size());
-
-				for (std::size_t index : sortedIndices) {
-					underlyingStorageSorted.push_back(underlyingStorageOriginal[index]);
-				}
+				underlyingStorageSorted.resize(underlyingStorageOriginal.size());
+
+				// Each worker gathers its own range of the sorted values
+				ParallelScan::forEachMorsel(
+					sortedIndices.size(),
+					numWorkers,
+					[&](std::size_t workerIndex, const ScanMorsel& morsel) {
+						for (std::size_t i = morsel.startRowIndex; i < morsel.endRowIndex; i++) {
+							underlyingStorageSorted.set(i, underlyingStorageOriginal[sortedIndices[i]]);
+						}
+					});
 
 				column = std::move(sortedValues);
 			});
@@ -176,17 +398,32 @@ void ExecutorHelpers::orderResult(const std::vector<ColumnType>& orderingDataTyp
 	}
 }
 
-void ExecutorHelpers::copyRow(VirtualTable& table, std::vector<ColumnStorage>& resultsStorage, std::size_t rowIndex) {
-	std::size_t columnIndex = 0;
-	for (auto& column : table.underlying().schema().columns()) {
-		addColumnToResult(
-			*table.getColumn(column.name()).storage(),
-			resultsStorage[columnIndex],
-			rowIndex);
-		columnIndex++;
+void ExecutorHelpers::limitResult(const LimitClause& limit, QueryResult& result) {
+	if (limit.empty()) {
+		return;
+	}
+
+	for (auto& column : result.columns) {
+		handleGenericType(column.type(), [&](auto dummy) -> void {
+			using Type = decltype(dummy);
+			auto& underlyingStorage = column.getUnderlyingStorage<Type>();
+
+			auto startRowIndex = std::min(limit.offset, underlyingStorage.size());
+			auto endRowIndex = startRowIndex + std::min(limit.count, underlyingStorage.size() - startRowIndex);
+			underlyingStorage.erase(underlyingStorage.begin() + endRowIndex, underlyingStorage.end());
+			underlyingStorage.erase(underlyingStorage.begin(), underlyingStorage.begin() + startRowIndex);
+		});
 	}
 }
 
+std::size_t ExecutorHelpers::numResultRows(const QueryResult& result) {
+	if (result.columns.empty()) {
+		return 0;
+	}
+
+	return result.columns.front().size();
+}
+
 ReducedProjections::ReducedProjections(const std::string& mainTable)
 	: mainTable(mainTable) {
 
@@ -41,6 +41,40 @@ namespace ExecutorHelpers {
 							ExpressionExecutionEngine& filterExecutionEngine,
 							std::function<void (std::size_t)> applyRow);
 
+	/**
+	 * Applies the given function to each batch of rows with filtering. Batch execution is used if possible.
+	 * @param table The table
+	 * @param filterExecutionEngine The filtering execution
+	 * @param applyRows Function to apply on the rows that passed the filter in each batch
+	 */
+	void forEachBatchFiltered(VirtualTable& table,
+							  ExpressionExecutionEngine& filterExecutionEngine,
+							  std::function<void (const std::vector<std::size_t>&)> applyRows);
+
+	/**
+	 * Applies the given function to each batch of rows in the given range with filtering
+	 * @param table The table
+	 * @param filterExecutionEngine The filtering execution
+	 * @param startRowIndex The first row in the range
+	 * @param endRowIndex The end of the range (exclusive)
+	 * @param applyRows Function to apply on the rows that passed the filter in each batch
+	 */
+	void forEachBatchFiltered(VirtualTable& table,
+							  ExpressionExecutionEngine& filterExecutionEngine,
+							  std::size_t startRowIndex,
+							  std::size_t endRowIndex,
+							  std::function<void (const std::vector<std::size_t>&)> applyRows);
+
+	/**
+	 * Filters the given rows. Batch execution is used if possible.
+	 * @param filterExecutionEngine The filtering execution
+	 * @param rowIndices The rows to filter
+	 * @param filteredRowIndices The rows that passed the filter
+	 */
+	void filterRows(ExpressionExecutionEngine& filterExecutionEngine,
+					const std::vector<std::size_t>& rowIndices,
+					std::vector<std::size_t>& filteredRowIndices);
+
 	/**
 	 * Adds the given column to the results
 	 * @param storage The storage of the column
@@ -51,6 +85,27 @@ namespace ExecutorHelpers {
 						   ColumnStorage& resultStorage,
 						   std::size_t rowIndex);
 
+	/**
+	 * Adds the given rows of the column to the results
+	 * @param storage The storage of the column
+	 * @param resultStorage The result storage
+	 * @param rowIndices The rows to add
+	 */
+	void addColumnToResult(const ColumnStorage& storage,
+						   ColumnStorage& resultStorage,
+						   const std::vector<std::size_t>& rowIndices);
+
+	/**
+	 * Evaluates the given expression on the given rows and adds the values to the given storage.
+	 * Batch execution is used if possible.
+	 * @param executionEngine The expression
+	 * @param resultStorage The storage to add to
+	 * @param rowIndices The rows to evaluate on
+	 */
+	void addExpressionToResult(ExpressionExecutionEngine& executionEngine,
+							   ColumnStorage& resultStorage,
+							   const std::vector<std::size_t>& rowIndices);
+
 	/**
 	 * Adds given row to the result
 	 * @param columnsStorage The storage of the columns
@@ -59,6 +114,16 @@ namespace ExecutorHelpers {
 	 */
 	void addRowToResult(std::vector<VirtualColumn*> columnsStorage, QueryResult& result, std::size_t rowIndex);
 
+	/**
+	 * Adds the given rows to the result
+	 * @param columnsStorage The storage of the columns
+	 * @param result The result
+	 * @param rowIndices The indices of the rows
+	 */
+	void addRowsToResult(const std::vector<VirtualColumn*>& columnsStorage,
+						 QueryResult& result,
+						 const std::vector<std::size_t>& rowIndices);
+
 	/**
 	 * Adds the given row to the result
 	 * @param projections The projections
@@ -72,26 +137,62 @@ namespace ExecutorHelpers {
 						std::size_t rowIndex);
 
 	/**
-	 * Orders the given result
+	 * Adds the given rows to the result. Batch execution is used if possible.
+	 * @param projections The projections
+	 * @param reducedProjections The reduced projections. Nullptr if not reduced
+	 * @param result The result
+	 * @param rowIndices The indices of the rows
+	 */
+	void addRowsToResult(std::vector<std::unique_ptr<ExpressionExecutionEngine>>& projections,
+						 ReducedProjections& reducedProjections,
+						 QueryResult& result,
+						 const std::vector<std::size_t>& rowIndices);
+
+	/**
+	 * Moves the rows of the given result to the end of another result
+	 * @param result The result to append to
+	 * @param other The result to append
+	 */
+	void appendResult(QueryResult& result, QueryResult& other);
+
+	/**
+	 * Returns the indices of the rows in the given ordering. Large orderings are sorted in parallel.
+	 * @param config The database configuration
+	 * @param orderingDataTypes The types of the ordering
+	 * @param ordering The ordering
+	 * @param orderingData The ordering data
+	 */
+	std::vector<std::size_t> sortedIndices(const DatabaseConfiguration& config,
+										   const std::vector<ColumnType>& orderingDataTypes,
+										   const std::vector<OrderingColumn>& ordering,
+										   const std::vector<std::vector<RawQueryValue>>& orderingData);
+
+	/**
+	 * Orders the given result. Large results are sorted and gathered in parallel.
+	 * @param config The database configuration
 	 * @param orderingDataTypes The types of the ordering
 	 * @param ordering The ordering
 	 * @param orderingData The ordering data
 	 * @param result The result to order
 	 */
-	void orderResult(const std::vector<ColumnType>& orderingDataTypes,
+	void orderResult(const DatabaseConfiguration& config,
+					 const std::vector<ColumnType>& orderingDataTypes,
 					 const std::vector<OrderingColumn>& ordering,
 					 const std::vector<std::vector<RawQueryValue>>& orderingData,
 					 QueryResult& result);
 
 	/**
-	 * Copies the given row from the given table
-	 * @param table The table to copy from
-	 * @param resultsStorage Where to copy to
-	 * @param rowIndex The index of the row to copy
+	 * Removes the rows of the given result that are outside the given limit
+	 * @param limit The limit
+	 * @param result The result
+	 */
+	void limitResult(const LimitClause& limit, QueryResult& result);
+
+	/**
+	 * Returns the number of rows in the given result
+	 * @param result The result
 	 */
-	void copyRow(VirtualTable& table,
-				 std::vector<ColumnStorage>& resultsStorage,
-				 std::size_t rowIndex);
+	std::size_t numResultRows(const QueryResult& result);
 }
 
 /**
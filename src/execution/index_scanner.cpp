@@ -1,21 +1,77 @@
+#include <algorithm>
+#include <cmath>
 #include <functional>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <sstream>
+#include <unordered_set>
 #include "index_scanner.h"
 #include "../indices.h"
 #include "expression_execution.h"
 #include "helpers.h"
+#include "row_id_set.h"
 
 PossibleIndexScan::PossibleIndexScan(std::size_t instructionIndex,
 									 TreeIndex& index,
 									 CompareOperator op,
 									 QueryValue indexSearchValue)
 	: instructionIndex(instructionIndex),
-	  index(index),
+	  treeIndex(&index),
 	  op(op),
 	  indexSearchValue(indexSearchValue) {
 
 }
 
+PossibleIndexScan::PossibleIndexScan(std::size_t instructionIndex,
+									 HashIndex& index,
+									 QueryValue indexSearchValue)
+	: instructionIndex(instructionIndex),
+	  hashIndex(&index),
+	  op(CompareOperator::Equal),
+	  indexSearchValue(indexSearchValue) {
+
+}
+
+const ColumnDefinition& PossibleIndexScan::column() const {
+	if (hashIndex != nullptr) {
+		return hashIndex->column();
+	}
+
+	return treeIndex->column();
+}
+
+void PossibleIndexScan::addUpperBound(const PossibleIndexScan& upperBound) {
+	hasUpperBound = true;
+	upperBoundInstructionIndex = upperBound.instructionIndex;
+	upperBoundOp = upperBound.op;
+	upperBoundValue = upperBound.indexSearchValue;
+}
+
+void PossibleIndexScan::makeComparesAlwaysTrue(ExpressionExecutionEngine& executionEngine) const {
+	executionEngine.makeCompareAlwaysTrue(instructionIndex);
+	if (hasUpperBound) {
+		executionEngine.makeCompareAlwaysTrue(upperBoundInstructionIndex);
+	}
+}
+
+std::size_t PossibleIndexSetScan::numScans() const {
+	std::size_t numScans = 0;
+	for (auto& term : terms) {
+		numScans += term.size();
+	}
+
+	return numScans;
+}
+
+void PossibleIndexSetScan::makeComparesAlwaysTrue(ExpressionExecutionEngine& executionEngine) const {
+	for (auto& term : terms) {
+		for (auto& indexScan : term) {
+			indexScan.makeComparesAlwaysTrue(executionEngine);
+		}
+	}
+}
+
 namespace {
 	template<typename T>
 	using TreeIndexIterator = typename TreeIndex::UnderlyingStorage<T>::const_iterator;
@@ -69,19 +125,127 @@ namespace {
 		return std::make_pair(startIterator, endIterator);
 	}
 
+	template<typename T>
+	TreeIndexRange<T> findTreeIndexIterators(const TreeIndex::UnderlyingStorage<T>& underlyingIndex,
+											 const PossibleIndexScan& indexScan) {
+		auto lowerValue = indexScan.indexSearchValue.getValue<T>();
+		auto lowerRange = findTreeIndexIterators(underlyingIndex, indexScan.op, lowerValue);
+		if (!indexScan.hasUpperBound) {
+			return lowerRange;
+		}
+
+		// An empty range must not be iterated, as the end would come before the start
+		auto upperValue = indexScan.upperBoundValue.getValue<T>();
+		auto isEmpty = lowerValue > upperValue
+			|| (lowerValue == upperValue
+				&& (indexScan.op == CompareOperator::GreaterThan || indexScan.upperBoundOp == CompareOperator::LessThan));
+
+		if (isEmpty) {
+			return std::make_pair(underlyingIndex.end(), underlyingIndex.end());
+		}
+
+		auto upperRange = findTreeIndexIterators(underlyingIndex, indexScan.upperBoundOp, upperValue);
+		return std::make_pair(lowerRange.first, upperRange.second);
+	}
+
+	// The cost of copying one column of a row found by an index, relative to filtering a row in a sequential scan.
+	// Rows are copied through random accesses, which are much slower than the batched sequential filtering.
+	constexpr double INDEX_COPY_COLUMN_COST = 4.0;
+
+	// The cost of looking up a value in an index
+	constexpr double INDEX_LOOKUP_COST = 50.0;
+
+	// The cost of a row when walking an index in order, where the row is filtered and projected through random accesses
+	constexpr double INDEX_ORDER_ROW_COST = 5.0;
+
+	// The cost of comparing two rows when sorting
+	constexpr double SORT_COMPARE_COST = 1.0;
+
+	// The cost of collecting a row id found by an index and combining it with the row ids of other indices
+	constexpr double ROW_ID_COST = 2.0;
+
+	std::string formatEstimate(const ScanCostEstimate& estimate) {
+		std::ostringstream stream;
+		stream << std::fixed << std::setprecision(0) << "rows=" << estimate.numRows << " cost=" << estimate.cost;
+		return stream.str();
+	}
+
+	std::string describeIndex(const PossibleIndexScan& indexScan) {
+		return std::string(indexScan.hashIndex != nullptr ? "hash" : "tree")
+			   + (indexScan.hasUpperBound ? " index range on " : " index on ")
+			   + indexScan.column().name();
+	}
+
 	bool canTreeIndexScan(const TreeIndex& index, const std::string& column, CompareOperator op) {
 		return index.columnName() == column && op != CompareOperator::NotEqual;
 	}
-}
 
-std::vector<PossibleIndexScan> TreeIndexScanner::findPossibleIndexScans(const VirtualTable& table,
-																		const ExpressionExecutionEngine& executionEngine) {
-	std::vector<PossibleIndexScan> possibleScans;
+	bool canHashIndexScan(const HashIndex& index, const std::string& column, CompareOperator op) {
+		return index.columnName() == column && op == CompareOperator::Equal;
+	}
 
-	for (std::size_t instructionIndex = 0; instructionIndex < executionEngine.instructions().size(); instructionIndex++) {
+	bool isLowerBound(CompareOperator op) {
+		return op == CompareOperator::GreaterThan || op == CompareOperator::GreaterThanOrEqual;
+	}
+
+	bool isUpperBound(CompareOperator op) {
+		return op == CompareOperator::LessThan || op == CompareOperator::LessThanOrEqual;
+	}
+
+	// Combines a lower and an upper bound on the same index into one range scan
+	std::vector<PossibleIndexScan> combineRangeScans(const std::vector<PossibleIndexScan>& possibleScans) {
+		std::vector<PossibleIndexScan> rangeScans;
+		std::vector<PossibleIndexScan> otherScans;
+		std::vector<bool> isCombined(possibleScans.size(), false);
+
+		for (std::size_t lowerIndex = 0; lowerIndex < possibleScans.size(); lowerIndex++) {
+			auto& lowerBound = possibleScans[lowerIndex];
+			if (!isLowerBound(lowerBound.op)) {
+				continue;
+			}
+
+			for (std::size_t upperIndex = 0; upperIndex < possibleScans.size(); upperIndex++) {
+				auto& upperBound = possibleScans[upperIndex];
+				if (!isCombined[upperIndex]
+					&& isUpperBound(upperBound.op)
+					&& upperBound.treeIndex == lowerBound.treeIndex
+					&& upperBound.indexSearchValue.type == lowerBound.indexSearchValue.type) {
+					rangeScans.push_back(lowerBound);
+					rangeScans.back().addUpperBound(upperBound);
+					isCombined[lowerIndex] = true;
+					isCombined[upperIndex] = true;
+					break;
+				}
+			}
+		}
+
+		for (std::size_t i = 0; i < possibleScans.size(); i++) {
+			if (!isCombined[i]) {
+				otherScans.push_back(possibleScans[i]);
+			}
+		}
+
+		rangeScans.insert(rangeScans.end(), otherScans.begin(), otherScans.end());
+		return rangeScans;
+	}
+}
+
+namespace {
+	// Finds the index scans that can replace the given instruction
+	void findInstructionIndexScans(const VirtualTable& table,
+								   const ExpressionExecutionEngine& executionEngine,
+								   std::size_t instructionIndex,
+								   std::vector<PossibleIndexScan>& possibleHashScans,
+								   std::vector<PossibleIndexScan>& possibleScans) {
 		auto instruction = executionEngine.instructions()[instructionIndex].get();
 
 		auto tryAddIndexScan = [&](std::size_t columnSlot, CompareOperator op, QueryValue indexSearchValue) {
+			for (auto& index : table.underlying().hashIndices()) {
+				if (canHashIndexScan(*index, executionEngine.fromSlot(columnSlot), op)) {
+					possibleHashScans.emplace_back(instructionIndex, *index, indexSearchValue);
+				}
+			}
+
 			for (auto& index : table.underlying().indices()) {
 				if (canTreeIndexScan(*index, executionEngine.fromSlot(columnSlot), op)) {
 					possibleScans.emplace_back(instructionIndex, *index, op, indexSearchValue);
@@ -114,81 +278,382 @@ std::vector<PossibleIndexScan> TreeIndexScanner::findPossibleIndexScans(const Vi
 		anyGenericType(handleForType);
 	}
 
-	return possibleScans;
-}
+	// Finds the instruction that uses the result of each instruction, which is -1 for the final results
+	std::vector<std::int64_t> findParentInstructions(const ExpressionExecutionEngine& executionEngine) {
+		auto& instructions = executionEngine.instructions();
+		std::vector<std::int64_t> parentInstructions(instructions.size(), -1);
+		std::vector<std::size_t> operandStack;
 
-void TreeIndexScanner::execute(VirtualTable& table,
-							   const PossibleIndexScan& indexScan,
-							   OnColumnDefined onColumnDef,
-							   ApplyRow applyRow) {
-	auto handleForType = [&](auto dummy) -> void {
-		using Type = decltype(dummy);
+		for (std::size_t instructionIndex = 0; instructionIndex < instructions.size(); instructionIndex++) {
+			auto numOperands = instructions[instructionIndex]->numOperands();
+			for (std::size_t i = 0; i < numOperands && !operandStack.empty(); i++) {
+				parentInstructions[operandStack.back()] = (std::int64_t)instructionIndex;
+				operandStack.pop_back();
+			}
 
-		std::vector<ColumnStorage*> columnsStorage;
-		std::size_t columnIndex = 0;
-		for (auto& column : table.underlying().schema().columns()) {
-			onColumnDef(columnIndex, column);
-			columnsStorage.push_back(table.getColumn(column.name()).storage());
-			columnIndex++;
+			operandStack.push_back(instructionIndex);
 		}
 
-		auto& underlyingIndex = indexScan.index.getUnderlyingStorage<Type>();
-		auto iteratorRange = findTreeIndexIterators(
-			underlyingIndex,
-			indexScan.op,
-			indexScan.indexSearchValue.getValue<Type>());
+		return parentInstructions;
+	}
 
-		for (auto it = iteratorRange.first; it != iteratorRange.second; ++it) {
-			auto rowIndex = it->second;
+	// Indicates if the result of the given instruction must be true for the filter to be true
+	bool isConjunct(const ExpressionExecutionEngine& executionEngine,
+					const std::vector<std::int64_t>& parentInstructions,
+					std::size_t instructionIndex) {
+		auto parentIndex = parentInstructions[instructionIndex];
+		while (parentIndex != -1) {
+			if (dynamic_cast<AndExpressionIR*>(executionEngine.instructions()[parentIndex].get()) == nullptr) {
+				return false;
+			}
 
-			bool isFirstColumn = true;
-			for (std::size_t columnIndex = 0; columnIndex < columnsStorage.size(); columnIndex++) {
-				applyRow(rowIndex, columnIndex, columnsStorage[columnIndex], isFirstColumn);
-				isFirstColumn = false;
+			parentIndex = parentInstructions[parentIndex];
+		}
+
+		return true;
+	}
+
+	// Finds the scans for the compares of the given or instruction. Returns false if a compare can't use an index.
+	bool findOrIndexScans(const VirtualTable& table,
+						  const ExpressionExecutionEngine& executionEngine,
+						  const std::vector<std::int64_t>& parentInstructions,
+						  std::size_t orInstructionIndex,
+						  std::vector<PossibleIndexScan>& scans) {
+		for (std::size_t instructionIndex = 0; instructionIndex < orInstructionIndex; instructionIndex++) {
+			if (parentInstructions[instructionIndex] != (std::int64_t)orInstructionIndex) {
+				continue;
+			}
+
+			if (dynamic_cast<OrExpressionIR*>(executionEngine.instructions()[instructionIndex].get()) != nullptr) {
+				if (!findOrIndexScans(table, executionEngine, parentInstructions, instructionIndex, scans)) {
+					return false;
+				}
+
+				continue;
+			}
+
+			std::vector<PossibleIndexScan> possibleHashScans;
+			std::vector<PossibleIndexScan> possibleScans;
+			findInstructionIndexScans(table, executionEngine, instructionIndex, possibleHashScans, possibleScans);
+
+			if (!possibleHashScans.empty()) {
+				scans.push_back(possibleHashScans.front());
+			} else if (!possibleScans.empty()) {
+				scans.push_back(possibleScans.front());
+			} else {
+				return false;
 			}
 		}
-	};
 
-	handleGenericType(indexScan.indexSearchValue.type, handleForType);
+		return true;
+	}
+}
+
+std::vector<PossibleIndexScan> TreeIndexScanner::findPossibleIndexScans(const VirtualTable& table,
+																		const ExpressionExecutionEngine& executionEngine) {
+	std::vector<PossibleIndexScan> possibleHashScans;
+	std::vector<PossibleIndexScan> possibleScans;
+
+	// A compare below an or doesn't decide if the row matches, which means that it can't be replaced by an index
+	auto parentInstructions = findParentInstructions(executionEngine);
+	for (std::size_t instructionIndex = 0; instructionIndex < executionEngine.instructions().size(); instructionIndex++) {
+		if (isConjunct(executionEngine, parentInstructions, instructionIndex)) {
+			findInstructionIndexScans(table, executionEngine, instructionIndex, possibleHashScans, possibleScans);
+		}
+	}
+
+	possibleScans = combineRangeScans(possibleScans);
+	possibleHashScans.insert(possibleHashScans.end(), possibleScans.begin(), possibleScans.end());
+	return possibleHashScans;
 }
 
-void TreeIndexScanner::execute(VirtualTable& table,
-							   const PossibleIndexScan& indexScan,
-							   std::vector<ColumnStorage>& resultsStorage) {
-	execute(
-		table,
-		indexScan,
-		[&](std::size_t columnIndex, const ColumnDefinition& columnDefinition) {
-			resultsStorage.emplace_back(columnDefinition);
-		},
-		[&](std::size_t rowIndex, std::size_t columnIndex, const ColumnStorage* columnStorage, bool isFirstColumn) {
-			ExecutorHelpers::addColumnToResult(*columnStorage, resultsStorage[columnIndex], rowIndex);
+PossibleIndexSetScan TreeIndexScanner::findIndexSetScan(const VirtualTable& table,
+														const ExpressionExecutionEngine& executionEngine) {
+	// Each compare is only used once, where hash and range scans come first
+	std::vector<std::vector<PossibleIndexScan>> possibleTerms;
+	std::unordered_set<std::size_t> usedInstructions;
+	for (auto& indexScan : findPossibleIndexScans(table, executionEngine)) {
+		if (usedInstructions.count(indexScan.instructionIndex) > 0
+			|| (indexScan.hasUpperBound && usedInstructions.count(indexScan.upperBoundInstructionIndex) > 0)) {
+			continue;
+		}
+
+		usedInstructions.insert(indexScan.instructionIndex);
+		if (indexScan.hasUpperBound) {
+			usedInstructions.insert(indexScan.upperBoundInstructionIndex);
+		}
+
+		possibleTerms.push_back({ indexScan });
+	}
+
+	auto parentInstructions = findParentInstructions(executionEngine);
+	for (std::size_t instructionIndex = 0; instructionIndex < executionEngine.instructions().size(); instructionIndex++) {
+		auto isOr = dynamic_cast<OrExpressionIR*>(executionEngine.instructions()[instructionIndex].get()) != nullptr;
+		if (!isOr || !isConjunct(executionEngine, parentInstructions, instructionIndex)) {
+			continue;
+		}
+
+		std::vector<PossibleIndexScan> term;
+		if (findOrIndexScans(table, executionEngine, parentInstructions, instructionIndex, term)) {
+			possibleTerms.push_back(std::move(term));
+		}
+	}
+
+	// Add the most selective terms as long as the reduced number of copied rows pays for the extra index scans
+	std::sort(
+		possibleTerms.begin(),
+		possibleTerms.end(),
+		[&](const std::vector<PossibleIndexScan>& lhs, const std::vector<PossibleIndexScan>& rhs) {
+			return estimateSelectivity(table, lhs) < estimateSelectivity(table, rhs);
 		});
+
+	PossibleIndexSetScan indexSetScan;
+	auto bestCost = std::numeric_limits<double>::max();
+	for (auto& term : possibleTerms) {
+		indexSetScan.terms.push_back(term);
+
+		auto cost = estimateIndexSetScanCost(table, indexSetScan).cost;
+		if (cost >= bestCost) {
+			indexSetScan.terms.pop_back();
+			break;
+		}
+
+		bestCost = cost;
+	}
+
+	return indexSetScan;
+}
+
+ScanCostEstimate TreeIndexScanner::estimateSequentialScanCost(const VirtualTable& table) const {
+	ScanCostEstimate estimate;
+	estimate.numRows = (double)table.numRows();
+	estimate.cost = estimate.numRows;
+	return estimate;
+}
+
+double TreeIndexScanner::estimateSelectivity(const VirtualTable& table, const PossibleIndexScan& indexScan) const {
+	auto estimateCompareSelectivity = [&](CompareOperator op, const QueryValue& value) {
+		return table.underlying().estimateSelectivity(
+			indexScan.column().name(),
+			op,
+			handleGenericTypeResult(double, value.type, [&](auto dummy) {
+				using Type = decltype(dummy);
+				return (double)value.getValue<Type>();
+			}));
+	};
+
+	auto selectivity = estimateCompareSelectivity(indexScan.op, indexScan.indexSearchValue);
+	if (indexScan.hasUpperBound) {
+		// The rows of the range are the rows below the upper bound that are not below the lower bound
+		selectivity = std::max(
+			selectivity + estimateCompareSelectivity(indexScan.upperBoundOp, indexScan.upperBoundValue) - 1.0,
+			0.0);
+	}
+
+	return selectivity;
+}
+
+double TreeIndexScanner::estimateSelectivity(const VirtualTable& table, const std::vector<PossibleIndexScan>& term) const {
+	double notSelectedFraction = 1.0;
+	for (auto& indexScan : term) {
+		notSelectedFraction *= 1.0 - estimateSelectivity(table, indexScan);
+	}
+
+	return 1.0 - notSelectedFraction;
+}
+
+ScanCostEstimate TreeIndexScanner::estimateIndexScanCost(const VirtualTable& table, const PossibleIndexScan& indexScan) const {
+	auto numColumns = (double)table.underlying().schema().columns().size();
+
+	ScanCostEstimate estimate;
+	estimate.numRows = estimateSelectivity(table, indexScan) * (double)table.numRows();
+	estimate.cost = INDEX_LOOKUP_COST + estimate.numRows * (numColumns * INDEX_COPY_COLUMN_COST + 1.0);
+	return estimate;
+}
+
+ScanCostEstimate TreeIndexScanner::estimateIndexSetScanCost(const VirtualTable& table,
+															const PossibleIndexSetScan& indexSetScan) const {
+	auto numRows = (double)table.numRows();
+	auto numColumns = (double)table.underlying().schema().columns().size();
+
+	ScanCostEstimate estimate;
+	double selectivity = 1.0;
+	for (auto& term : indexSetScan.terms) {
+		for (auto& indexScan : term) {
+			estimate.cost += INDEX_LOOKUP_COST + estimateSelectivity(table, indexScan) * numRows * ROW_ID_COST;
+		}
+
+		selectivity *= estimateSelectivity(table, term);
+	}
+
+	// Only the rows found by all terms are copied
+	estimate.numRows = selectivity * numRows;
+	estimate.cost += estimate.numRows * (numColumns * INDEX_COPY_COLUMN_COST + 1.0);
+	return estimate;
+}
+
+ScanCostEstimate TreeIndexScanner::estimateIndexOrderScanCost(const VirtualTable& table,
+															  const TreeIndex& index,
+															  const PossibleIndexScan* rangeIndexScan,
+															  std::size_t numRowsNeeded) const {
+	ScanCostEstimate estimate;
+	if (rangeIndexScan != nullptr) {
+		estimate = estimateIndexScanCost(table, *rangeIndexScan);
+	} else {
+		estimate.numRows = (double)table.numRows();
+	}
+
+	// The walk stops when enough rows have been found
+	estimate.numRows = std::min(estimate.numRows, (double)numRowsNeeded);
+	estimate.cost = INDEX_LOOKUP_COST + estimate.numRows * INDEX_ORDER_ROW_COST;
+	return estimate;
+}
+
+double TreeIndexScanner::estimateSortCost(double numRows, std::size_t numRowsNeeded) const {
+	auto numRowsKept = std::max(std::min(numRows, (double)numRowsNeeded), 2.0);
+	return numRows * std::log2(numRowsKept) * SORT_COMPARE_COST;
+}
+
+std::int64_t TreeIndexScanner::chooseIndexScan(const VirtualTable& table,
+											   const std::vector<PossibleIndexScan>& possibleIndexScans) const {
+	std::int64_t bestIndexScan = -1;
+	auto bestCost = estimateSequentialScanCost(table).cost;
+
+	for (std::size_t i = 0; i < possibleIndexScans.size(); i++) {
+		auto cost = estimateIndexScanCost(table, possibleIndexScans[i]).cost;
+		if (cost < bestCost) {
+			bestIndexScan = (std::int64_t)i;
+			bestCost = cost;
+		}
+	}
+
+	return bestIndexScan;
+}
+
+std::string TreeIndexScanner::describeSequentialScan(const VirtualTable& table) const {
+	return "sequential scan (" + formatEstimate(estimateSequentialScanCost(table)) + ")";
+}
+
+std::string TreeIndexScanner::describe(const VirtualTable& table, const PossibleIndexScan& indexScan) const {
+	return describeIndex(indexScan) + " (" + formatEstimate(estimateIndexScanCost(table, indexScan)) + ")";
 }
 
-void TreeIndexScanner::execute(VirtualTable& table,
-							   const PossibleIndexScan& indexScan,
-							   std::vector<ColumnStorage>& resultsStorage,
-							   std::vector<std::size_t>& resultRowIndices) {
-	execute(
-		table,
-		indexScan,
-		[&](std::size_t columnIndex, const ColumnDefinition& columnDefinition) {
-			resultsStorage.emplace_back(columnDefinition);
-		},
-		[&](std::size_t rowIndex, std::size_t columnIndex, const ColumnStorage* columnStorage, bool isFirstColumn) {
-			// Save which row it correspond to
-			if (isFirstColumn) {
-				resultRowIndices.push_back(rowIndex);
+std::string TreeIndexScanner::describe(const VirtualTable& table, const PossibleIndexSetScan& indexSetScan) const {
+	std::ostringstream stream;
+	stream << "index set of ";
+	for (std::size_t termIndex = 0; termIndex < indexSetScan.terms.size(); termIndex++) {
+		auto& term = indexSetScan.terms[termIndex];
+		if (termIndex > 0) {
+			stream << " and ";
+		}
+
+		stream << "[";
+		for (std::size_t i = 0; i < term.size(); i++) {
+			stream << (i > 0 ? " or " : "") << describeIndex(term[i]);
+		}
+		stream << "]";
+	}
+
+	stream << " (" << formatEstimate(estimateIndexSetScanCost(table, indexSetScan)) << ")";
+	return stream.str();
+}
+
+std::string TreeIndexScanner::describeIndexOrderScan(const VirtualTable& table,
+													 const TreeIndex& index,
+													 const PossibleIndexScan* rangeIndexScan,
+													 std::size_t numRowsNeeded) const {
+	std::ostringstream stream;
+	stream << "tree index order on " << index.column().name()
+		   << (rangeIndexScan != nullptr ? " with range" : "")
+		   << " (" << formatEstimate(estimateIndexOrderScanCost(table, index, rangeIndexScan, numRowsNeeded)) << ")";
+	return stream.str();
+}
+
+namespace {
+	// Applies the given function on the row index of each row found by the given scan
+	void forEachRowIndex(const PossibleIndexScan& indexScan, std::function<void (std::size_t)> applyRowIndex) {
+		auto handleForType = [&](auto dummy) -> void {
+			using Type = decltype(dummy);
+
+			if (indexScan.hashIndex != nullptr) {
+				auto& underlyingIndex = indexScan.hashIndex->getUnderlyingStorage<Type>();
+				underlyingIndex.forEachValue(indexScan.indexSearchValue.getValue<Type>(), applyRowIndex);
+				return;
 			}
 
-			auto& resultStorage = resultsStorage[columnIndex];
+			auto& underlyingIndex = indexScan.treeIndex->getUnderlyingStorage<Type>();
+			auto iteratorRange = findTreeIndexIterators(underlyingIndex, indexScan);
 
-			auto handleForType = [&](auto dummy) {
-				using Type = decltype(dummy);
-				resultStorage.getUnderlyingStorage<Type>().push_back(columnStorage->getUnderlyingStorage<Type>()[rowIndex]);
-			};
+			for (auto it = iteratorRange.first; it != iteratorRange.second; ++it) {
+				applyRowIndex(it->second);
+			}
+		};
 
-			handleGenericType(columnStorage->type(), handleForType);
-		});
+		handleGenericType(indexScan.indexSearchValue.type, handleForType);
+	}
+}
+
+void TreeIndexScanner::findRowIndices(const PossibleIndexScan& indexScan, std::vector<std::size_t>& rowIndices) const {
+	forEachRowIndex(indexScan, [&](std::size_t rowIndex) {
+		rowIndices.push_back(rowIndex);
+	});
+}
+
+void TreeIndexScanner::findRowIndices(const VirtualTable& table,
+									  const PossibleIndexSetScan& indexSetScan,
+									  std::vector<std::size_t>& rowIndices) const {
+	auto numRows = table.underlying().numRows();
+
+	std::unique_ptr<RowIdSet> rowIds;
+	for (auto& term : indexSetScan.terms) {
+		RowIdSet termRowIds(numRows, {});
+		for (auto& indexScan : term) {
+			std::vector<std::size_t> scanRowIds;
+			findRowIndices(indexScan, scanRowIds);
+			termRowIds.unite(RowIdSet(numRows, std::move(scanRowIds)));
+		}
+
+		if (rowIds == nullptr) {
+			rowIds = std::make_unique<RowIdSet>(std::move(termRowIds));
+		} else {
+			rowIds->intersect(termRowIds);
+		}
+	}
+
+	if (rowIds != nullptr) {
+		auto setRowIndices = rowIds->rowIds();
+		rowIndices.insert(rowIndices.end(), setRowIndices.begin(), setRowIndices.end());
+	}
+}
+
+void TreeIndexScanner::forEachRowInOrder(const TreeIndex& index,
+										 const PossibleIndexScan* indexScan,
+										 bool descending,
+										 ApplyOrderedRow applyRow) {
+	auto handleForType = [&](auto dummy) -> void {
+		using Type = decltype(dummy);
+
+		auto& underlyingIndex = index.getUnderlyingStorage<Type>();
+		auto iteratorRange = std::make_pair(underlyingIndex.begin(), underlyingIndex.end());
+		if (indexScan != nullptr) {
+			iteratorRange = findTreeIndexIterators(underlyingIndex, *indexScan);
+		}
+
+		auto applyRows = [&](auto begin, auto end) {
+			for (auto it = begin; it != end; ++it) {
+				if (!applyRow(it->second)) {
+					break;
+				}
+			}
+		};
+
+		if (descending) {
+			using ReverseIterator = typename TreeIndex::UnderlyingStorage<Type>::const_reverse_iterator;
+			applyRows(ReverseIterator(iteratorRange.second), ReverseIterator(iteratorRange.first));
+		} else {
+			applyRows(iteratorRange.first, iteratorRange.second);
+		}
+	};
+
+	handleGenericType(index.column().type(), handleForType);
 }
@@ -4,23 +4,31 @@
 #include "../storage.h"
 
 class TreeIndex;
+class HashIndex;
 class Table;
 class VirtualTable;
 class ExpressionExecutionEngine;
 
 /**
- * Represents a possible index scan
+ * Represents a possible index scan. Either uses a tree index or a hash index.
  */
 struct PossibleIndexScan {
 	std::size_t instructionIndex;
 
-	TreeIndex& index;
+	TreeIndex* treeIndex = nullptr;
+	HashIndex* hashIndex = nullptr;
 
 	CompareOperator op;
 	QueryValue indexSearchValue;
 
+	// A range scan also has an upper bound, where op and indexSearchValue are the lower bound
+	bool hasUpperBound = false;
+	std::size_t upperBoundInstructionIndex = 0;
+	CompareOperator upperBoundOp = CompareOperator::LessThan;
+	QueryValue upperBoundValue;
+
 	/**
-	 * Creates a new index scan
+	 * Creates a new tree index scan
 	 * @param instructionIndex The instruction that the scan will replace
 	 * @param index The index
 	 * @param op The search operator
@@ -30,54 +38,195 @@ struct PossibleIndexScan {
 					  TreeIndex& index,
 					  CompareOperator op,
 					  QueryValue indexSearchValue);
+
+	/**
+	 * Creates a new hash index scan. The search operator is always equal.
+	 * @param instructionIndex The instruction that the scan will replace
+	 * @param index The index
+	 * @param indexSearchValue The index search value
+	 */
+	PossibleIndexScan(std::size_t instructionIndex,
+					  HashIndex& index,
+					  QueryValue indexSearchValue);
+
+	/**
+	 * Returns the column that is scanned on
+	 */
+	const ColumnDefinition& column() const;
+
+	/**
+	 * Combines the given upper bound with this scan, which makes it a range scan
+	 * @param upperBound A scan on the same index with an upper bound
+	 */
+	void addUpperBound(const PossibleIndexScan& upperBound);
+
+	/**
+	 * Replaces the compares handled by the scan with true
+	 * @param executionEngine The execution engine of the filter
+	 */
+	void makeComparesAlwaysTrue(ExpressionExecutionEngine& executionEngine) const;
+};
+
+/**
+ * Represents a scan that combines the rows found by several index scans.
+ * The rows found by the scans of a term are unioned, and the rows of the terms are intersected.
+ */
+struct PossibleIndexSetScan {
+	std::vector<std::vector<PossibleIndexScan>> terms;
+
+	/**
+	 * Returns the total number of index scans
+	 */
+	std::size_t numScans() const;
+
+	/**
+	 * Replaces the compares handled by the scans with true
+	 * @param executionEngine The execution engine of the filter
+	 */
+	void makeComparesAlwaysTrue(ExpressionExecutionEngine& executionEngine) const;
+};
+
+/**
+ * The estimated cost of a scan, in the cost of filtering one row in a sequential scan
+ */
+struct ScanCostEstimate {
+	double numRows = 0.0;
+	double cost = 0.0;
 };
 
 /**
- * Represents a tree index scanner
+ * Represents an index scanner for tree and hash indices
  */
 class TreeIndexScanner {
+private:
+	double estimateSelectivity(const VirtualTable& table, const PossibleIndexScan& indexScan) const;
+	double estimateSelectivity(const VirtualTable& table, const std::vector<PossibleIndexScan>& term) const;
 public:
 	/**
-	 * Finds the possible index scans
+	 * Finds the possible index scans. Hash index scans are placed first, as they are the cheapest.
 	 * @param table The table to scan for
 	 * @param executionEngine The execution engine to find for
 	 */
 	std::vector<PossibleIndexScan> findPossibleIndexScans(const VirtualTable& table,
 														  const ExpressionExecutionEngine& executionEngine);
 
-	using OnColumnDefined = std::function<void (std::size_t, const ColumnDefinition&)>;
-	using ApplyRow = std::function<void (std::size_t, std::size_t, ColumnStorage*, bool)>;
+	/**
+	 * Finds the index scans to combine for the filter, where the compares of an or are unioned and the
+	 * compares of an and are intersected. Only the terms that are estimated to make the scan cheaper are kept,
+	 * which means that the result can have less than two scans.
+	 * @param table The table to scan for
+	 * @param executionEngine The execution engine to find for
+	 */
+	PossibleIndexSetScan findIndexSetScan(const VirtualTable& table, const ExpressionExecutionEngine& executionEngine);
 
 	/**
-	 * Executes the given index scan
+	 * Estimates the cost of filtering all the rows of the given table in a sequential scan
 	 * @param table The table
-	 * @param indexScan The scan to execute
-	 * @param applyRow Called on each row with (rowIndex, columnIndex, columnStorage)
 	 */
-	void execute(VirtualTable& table,
-				 const PossibleIndexScan& indexScan,
-				 OnColumnDefined onColumnDef,
-				 ApplyRow applyRow);
+	ScanCostEstimate estimateSequentialScanCost(const VirtualTable& table) const;
 
 	/**
-	 * Executes the given index scan and copies the results
+	 * Estimates the cost of the given index scan using the statistics of the indexed column.
+	 * This includes copying the matching rows and filtering them.
 	 * @param table The table
-	 * @param indexScan The scan to execute
-	 * @param resultsStorage Where to store the result
+	 * @param indexScan The index scan
 	 */
-	void execute(VirtualTable& table,
-				 const PossibleIndexScan& indexScan,
-				 std::vector<ColumnStorage>& resultsStorage);
+	ScanCostEstimate estimateIndexScanCost(const VirtualTable& table, const PossibleIndexScan& indexScan) const;
 
 	/**
-	 * Executes the given index scan and copies the results
+	 * Estimates the cost of the given index set scan, where the selectivity of the compares are assumed to be independent
 	 * @param table The table
+	 * @param indexSetScan The index set scan
+	 */
+	ScanCostEstimate estimateIndexSetScanCost(const VirtualTable& table, const PossibleIndexSetScan& indexSetScan) const;
+
+	/**
+	 * Estimates the cost of walking the given index in order, which avoids sorting the result
+	 * @param table The table
+	 * @param index The index
+	 * @param rangeIndexScan Limits the range of the walk if not null
+	 * @param numRowsNeeded The number of rows needed, where the walk stops
+	 */
+	ScanCostEstimate estimateIndexOrderScanCost(const VirtualTable& table,
+												const TreeIndex& index,
+												const PossibleIndexScan* rangeIndexScan,
+												std::size_t numRowsNeeded) const;
+
+	/**
+	 * Estimates the cost of sorting the given number of rows
+	 * @param numRows The number of rows
+	 * @param numRowsNeeded The number of rows needed, which makes it a top-n sort if less than the number of rows
+	 */
+	double estimateSortCost(double numRows, std::size_t numRowsNeeded) const;
+
+	/**
+	 * Chooses the cheapest of the given index scans.
+	 * Returns -1 if a sequential scan is cheaper than all the index scans.
+	 * @param table The table
+	 * @param possibleIndexScans The possible index scans
+	 */
+	std::int64_t chooseIndexScan(const VirtualTable& table, const std::vector<PossibleIndexScan>& possibleIndexScans) const;
+
+	/**
+	 * Describes a sequential scan of the given table and its cost
+	 * @param table The table
+	 */
+	std::string describeSequentialScan(const VirtualTable& table) const;
+
+	/**
+	 * Describes the given index scan and its cost
+	 * @param table The table
+	 * @param indexScan The index scan
+	 */
+	std::string describe(const VirtualTable& table, const PossibleIndexScan& indexScan) const;
+
+	/**
+	 * Describes the given index set scan and its cost
+	 * @param table The table
+	 * @param indexSetScan The index set scan
+	 */
+	std::string describe(const VirtualTable& table, const PossibleIndexSetScan& indexSetScan) const;
+
+	/**
+	 * Describes walking the given index in order and its cost
+	 * @param table The table
+	 * @param index The index
+	 * @param rangeIndexScan Limits the range of the walk if not null
+	 * @param numRowsNeeded The number of rows needed
+	 */
+	std::string describeIndexOrderScan(const VirtualTable& table,
+									   const TreeIndex& index,
+									   const PossibleIndexScan* rangeIndexScan,
+									   std::size_t numRowsNeeded) const;
+
+	/**
+	 * Finds the rows of the given index scan, in index order
 	 * @param indexScan The scan to execute
-	 * @param resultsStorage Where to store the result
-	 * @param resultRowIndices Saves which real row each result row corresponds to
+	 * @param rowIndices The row indices are added to this
+	 */
+	void findRowIndices(const PossibleIndexScan& indexScan, std::vector<std::size_t>& rowIndices) const;
+
+	/**
+	 * Finds the rows of the given index set scan, in increasing row order
+	 * @param table The table
+	 * @param indexSetScan The scan to execute
+	 * @param rowIndices The row indices are added to this
+	 */
+	void findRowIndices(const VirtualTable& table,
+						const PossibleIndexSetScan& indexSetScan,
+						std::vector<std::size_t>& rowIndices) const;
+
+	using ApplyOrderedRow = std::function<bool (std::size_t)>;
+
+	/**
+	 * Applies the given function on the rows of the given tree index in index order
+	 * @param index The index
+	 * @param indexScan The range to visit. Nullptr visits all the rows of the index
+	 * @param descending Indicates if the rows are visited in descending order
+	 * @param applyRow Called on each row index. Returns false to stop.
 	 */
-	void execute(VirtualTable& table,
-				 const PossibleIndexScan& indexScan,
-				 std::vector<ColumnStorage>& resultsStorage,
-				 std::vector<std::size_t>& resultRowIndices);
+	void forEachRowInOrder(const TreeIndex& index,
+						   const PossibleIndexScan* indexScan,
+						   bool descending,
+						   ApplyOrderedRow applyRow);
 };
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "parallel_scan.h"
+#include "worker_pool.h"
+#include "../database_engine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+std::size_t ParallelScan::numMorsels(std::size_t numRows) {
+	return (numRows + SCAN_MORSEL_SIZE - 1) / SCAN_MORSEL_SIZE;
+}
+
+std::size_t ParallelScan::numWorkers(const DatabaseConfiguration& config, std::size_t numRows) {
+	std::size_t parallelism = config.parallelism;
+	if (parallelism == 0) {
+		parallelism = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	return std::max(std::min(parallelism, numMorsels(numRows)), (std::size_t)1);
+}
+
+void ParallelScan::forEachMorsel(std::size_t numRows,
+								 std::size_t numWorkers,
+								 std::function<void (std::size_t, const ScanMorsel&)> applyMorsel) {
+	auto numMorsels = ParallelScan::numMorsels(numRows);
+	std::atomic<std::size_t> nextMorsel(0);
+
+	std::mutex errorMutex;
+	std::exception_ptr error;
+
+	auto runWorker = [&](std::size_t workerIndex) {
+		try {
+			while (true) {
+				auto morselIndex = nextMorsel.fetch_add(1);
+				if (morselIndex >= numMorsels) {
+					break;
+				}
+
+				ScanMorsel morsel;
+				morsel.index = morselIndex;
+				morsel.startRowIndex = morselIndex * SCAN_MORSEL_SIZE;
+				morsel.endRowIndex = std::min(morsel.startRowIndex + SCAN_MORSEL_SIZE, numRows);
+				applyMorsel(workerIndex, morsel);
+			}
+		} catch (...) {
+			nextMorsel = numMorsels;
+
+			std::lock_guard<std::mutex> guard(errorMutex);
+			if (!error) {
+				error = std::current_exception();
+			}
+		}
+	};
+
+	WorkerPool::shared().run(numWorkers, runWorker);
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
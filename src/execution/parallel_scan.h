@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+
+#include "../storage.h"
+
+struct DatabaseConfiguration;
+
+/**
+ * The number of rows in a scan morsel
+ */
+constexpr std::size_t SCAN_MORSEL_SIZE = 16 * 1024;
+
+// A morsel never spans two segments, as long as its rows start at a multiple of the morsel size
+static_assert(COLUMN_SEGMENT_SIZE % SCAN_MORSEL_SIZE == 0, "A segment must hold a whole number of morsels.");
+
+/**
+ * Represents a range of rows that is scanned by one worker
+ */
+struct ScanMorsel {
+	std::size_t index;
+	std::size_t startRowIndex;
+	std::size_t endRowIndex;
+};
+
+/**
+ * Splits scans into morsels that are executed by multiple workers
+ */
+namespace ParallelScan {
+	/**
+	 * Returns the number of morsels for the given number of rows
+	 * @param numRows The number of rows
+	 */
+	std::size_t numMorsels(std::size_t numRows);
+
+	/**
+	 * Returns the number of workers to use for scanning the given number of rows
+	 * @param config The database configuration
+	 * @param numRows The number of rows
+	 */
+	std::size_t numWorkers(const DatabaseConfiguration& config, std::size_t numRows);
+
+	/**
+	 * Applies the given function on each morsel of the given rows, using the shared worker pool.
+	 * The calling thread is worker zero.
+	 * If a worker throws, the remaining morsels are skipped and the exception is rethrown.
+	 * @param numRows The number of rows
+	 * @param numWorkers The number of workers
+	 * @param applyMorsel Function that takes the worker index and the morsel
+	 */
+	void forEachMorsel(std::size_t numRows,
+					   std::size_t numWorkers,
+					   std::function<void (std::size_t, const ScanMorsel&)> applyMorsel);
+}
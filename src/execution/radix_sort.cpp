@@ -0,0 +1,138 @@
+#include "radix_sort.h"
+#include "parallel_scan.h"
+#include <array>
+#include <cstring>
+
+namespace {
+	constexpr std::size_t RADIX_BITS = 8;
+	constexpr std::size_t NUM_BUCKETS = (std::size_t)1 << RADIX_BITS;
+
+	std::uint32_t encodeKey(bool value) {
+		return value ? 1 : 0;
+	}
+
+	std::uint32_t encodeKey(std::int32_t value) {
+		// Flipping the sign bit moves the negative values before the positive
+		return (std::uint32_t)value ^ 0x80000000u;
+	}
+
+	std::uint32_t encodeKey(float value) {
+		// -0.0 and 0.0 compare equal
+		if (value == 0.0f) {
+			value = 0.0f;
+		}
+
+		std::uint32_t bits = 0;
+		std::memcpy(&bits, &value, sizeof(float));
+
+		// Negative values are flipped completely as a larger magnitude is a smaller value
+		return (bits & 0x80000000u) != 0 ? ~bits : bits | 0x80000000u;
+	}
+
+	std::size_t numKeyBytes(ColumnType type) {
+		return type == ColumnType::Bool ? 1 : 4;
+	}
+}
+
+std::uint32_t RadixSort::encodeKey(ColumnType type, const RawQueryValue& value, bool descending) {
+	std::uint32_t key = 0;
+	handleGenericType(type, [&](auto dummy) {
+		using Type = decltype(dummy);
+		key = ::encodeKey(value.getValue<Type>());
+	});
+
+	return descending ? ~key : key;
+}
+
+std::vector<std::size_t> RadixSort::sortedIndices(const std::vector<ColumnType>& orderingDataTypes,
+												  const std::vector<OrderingColumn>& ordering,
+												  const std::vector<std::vector<RawQueryValue>>& orderingData,
+												  std::size_t numWorkers) {
+	auto numRows = orderingData.empty() ? 0 : orderingData[0].size();
+
+	std::vector<std::size_t> indices(numRows);
+	for (std::size_t i = 0; i < numRows; i++) {
+		indices[i] = i;
+	}
+
+	if (numRows == 0) {
+		return indices;
+	}
+
+	std::vector<std::size_t> nextIndices(numRows);
+	std::vector<std::uint32_t> keys(numRows);
+	std::vector<std::uint32_t> nextKeys(numRows);
+
+	// Each morsel has its own histogram, which gives it its own range in each bucket
+	auto numMorsels = ParallelScan::numMorsels(numRows);
+	std::vector<std::array<std::size_t, NUM_BUCKETS>> morselOffsets(numMorsels);
+
+	// Each pass is stable, which means that sorting from the last ordering column to the first gives the full ordering
+	for (std::size_t columnIndex = orderingDataTypes.size(); columnIndex-- > 0;) {
+		auto& columnData = orderingData[columnIndex];
+		auto keyMask = ordering[columnIndex].descending ? 0xFFFFFFFFu : 0u;
+		auto numBytes = numKeyBytes(orderingDataTypes[columnIndex]);
+		if (numBytes == 1) {
+			keyMask &= 0xFFu;
+		}
+
+		ParallelScan::forEachMorsel(numRows, numWorkers, [&](std::size_t workerIndex, const ScanMorsel& morsel) {
+			handleGenericType(orderingDataTypes[columnIndex], [&](auto dummy) {
+				using Type = decltype(dummy);
+				for (std::size_t i = morsel.startRowIndex; i < morsel.endRowIndex; i++) {
+					keys[i] = ::encodeKey(columnData[indices[i]].getValue<Type>()) ^ keyMask;
+				}
+			});
+		});
+
+		for (std::size_t byteIndex = 0; byteIndex < numBytes; byteIndex++) {
+			auto shift = byteIndex * RADIX_BITS;
+			auto bucketOf = [&](std::uint32_t key) {
+				return (key >> shift) & (NUM_BUCKETS - 1);
+			};
+
+			ParallelScan::forEachMorsel(numRows, numWorkers, [&](std::size_t workerIndex, const ScanMorsel& morsel) {
+				auto& histogram = morselOffsets[morsel.index];
+				histogram.fill(0);
+				for (std::size_t i = morsel.startRowIndex; i < morsel.endRowIndex; i++) {
+					histogram[bucketOf(keys[i])]++;
+				}
+			});
+
+			// All the keys have the same byte, which leaves the order as is
+			auto firstBucket = bucketOf(keys[0]);
+			std::size_t numInFirstBucket = 0;
+			for (auto& histogram : morselOffsets) {
+				numInFirstBucket += histogram[firstBucket];
+			}
+
+			if (numInFirstBucket == numRows) {
+				continue;
+			}
+
+			// The rows of a bucket are placed in morsel order
+			std::size_t offset = 0;
+			for (std::size_t bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+				for (auto& histogram : morselOffsets) {
+					auto count = histogram[bucket];
+					histogram[bucket] = offset;
+					offset += count;
+				}
+			}
+
+			ParallelScan::forEachMorsel(numRows, numWorkers, [&](std::size_t workerIndex, const ScanMorsel& morsel) {
+				auto& offsets = morselOffsets[morsel.index];
+				for (std::size_t i = morsel.startRowIndex; i < morsel.endRowIndex; i++) {
+					auto destination = offsets[bucketOf(keys[i])]++;
+					nextKeys[destination] = keys[i];
+					nextIndices[destination] = indices[i];
+				}
+			});
+
+			keys.swap(nextKeys);
+			indices.swap(nextIndices);
+		}
+	}
+
+	return indices;
+}
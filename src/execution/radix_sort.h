@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+#include "../common.h"
+#include "../query.h"
+
+/**
+ * Contains a least significant digit radix sort for orderings.
+ * Each key is encoded as an unsigned integer with the same order, which is sorted one byte at a time.
+ * The passes are split by scan morsels, where each morsel scatters its rows to its own range of each bucket.
+ */
+namespace RadixSort {
+	// Below this number of rows, a comparison sort is faster than the passes of the radix sort
+	constexpr std::size_t MIN_NUM_ROWS = 512;
+
+	/**
+	 * Encodes the given ordering value as an unsigned integer that has the same order as the value
+	 * @param type The type of the value
+	 * @param value The value
+	 * @param descending Indicates if the order of the keys is reversed
+	 */
+	std::uint32_t encodeKey(ColumnType type, const RawQueryValue& value, bool descending);
+
+	/**
+	 * Returns the indices of the rows in the given ordering. Rows that compare equal keep their original order.
+	 * @param orderingDataTypes The types of the ordering
+	 * @param ordering The ordering
+	 * @param orderingData The ordering data, one vector of values per ordering column
+	 * @param numWorkers The number of workers that each pass is split between
+	 */
+	std::vector<std::size_t> sortedIndices(const std::vector<ColumnType>& orderingDataTypes,
+										   const std::vector<OrderingColumn>& ordering,
+										   const std::vector<std::vector<RawQueryValue>>& orderingData,
+										   std::size_t numWorkers = 1);
+}
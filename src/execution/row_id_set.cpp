@@ -0,0 +1,185 @@
+#include "row_id_set.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+	constexpr std::size_t BITS_PER_WORD = 64;
+	constexpr std::size_t SORT_WORDS_PER_ROW_ID = 8;
+
+	std::size_t numWords(std::size_t numRows) {
+		return (numRows + BITS_PER_WORD - 1) / BITS_PER_WORD;
+	}
+
+	std::size_t countBits(const std::vector<std::uint64_t>& bitmap) {
+		std::size_t count = 0;
+		for (auto word : bitmap) {
+			count += (std::size_t)__builtin_popcountll(word);
+		}
+
+		return count;
+	}
+}
+
+RowIdSet::RowIdSet(std::size_t numRows, std::vector<std::size_t> rowIds)
+	: mNumRows(numRows),
+	  mSize(rowIds.size()),
+	  mRowIds(std::move(rowIds)) {
+	sort(mNumRows, mRowIds);
+	compact();
+}
+
+bool RowIdSet::contains(std::size_t rowId) const {
+	if (mIsBitmap) {
+		return (mBitmap[rowId / BITS_PER_WORD] >> (rowId % BITS_PER_WORD)) & 1;
+	}
+
+	return std::binary_search(mRowIds.begin(), mRowIds.end(), rowId);
+}
+
+void RowIdSet::toBitmap() {
+	mBitmap.assign(numWords(mNumRows), 0);
+	for (auto rowId : mRowIds) {
+		mBitmap[rowId / BITS_PER_WORD] |= (std::uint64_t)1 << (rowId % BITS_PER_WORD);
+	}
+
+	mRowIds.clear();
+	mRowIds.shrink_to_fit();
+	mIsBitmap = true;
+}
+
+void RowIdSet::toRowIds() {
+	mRowIds = rowIds();
+	mBitmap.clear();
+	mBitmap.shrink_to_fit();
+	mIsBitmap = false;
+}
+
+void RowIdSet::compact() {
+	// A row id takes as much space as a bitmap of 64 rows
+	auto useBitmap = mSize * BITS_PER_WORD > mNumRows;
+	if (useBitmap && !mIsBitmap) {
+		toBitmap();
+	} else if (!useBitmap && mIsBitmap) {
+		toRowIds();
+	}
+}
+
+std::size_t RowIdSet::size() const {
+	return mSize;
+}
+
+bool RowIdSet::isBitmap() const {
+	return mIsBitmap;
+}
+
+void RowIdSet::intersect(const RowIdSet& other) {
+	if (mIsBitmap && other.mIsBitmap) {
+		for (std::size_t i = 0; i < mBitmap.size(); i++) {
+			mBitmap[i] &= other.mBitmap[i];
+		}
+
+		mSize = countBits(mBitmap);
+	} else if (!mIsBitmap && !other.mIsBitmap) {
+		std::vector<std::size_t> result;
+		std::set_intersection(
+			mRowIds.begin(), mRowIds.end(),
+			other.mRowIds.begin(), other.mRowIds.end(),
+			std::back_inserter(result));
+
+		mRowIds = std::move(result);
+		mSize = mRowIds.size();
+	} else {
+		// Probe the bitmap with the sorted row ids, which are the smaller set
+		auto& rowIdsSet = mIsBitmap ? other : *this;
+		auto& bitmapSet = mIsBitmap ? *this : other;
+
+		std::vector<std::size_t> result;
+		for (auto rowId : rowIdsSet.mRowIds) {
+			if (bitmapSet.contains(rowId)) {
+				result.push_back(rowId);
+			}
+		}
+
+		mBitmap.clear();
+		mIsBitmap = false;
+		mRowIds = std::move(result);
+		mSize = mRowIds.size();
+	}
+
+	compact();
+}
+
+void RowIdSet::unite(const RowIdSet& other) {
+	if (!mIsBitmap && !other.mIsBitmap) {
+		std::vector<std::size_t> result;
+		std::set_union(
+			mRowIds.begin(), mRowIds.end(),
+			other.mRowIds.begin(), other.mRowIds.end(),
+			std::back_inserter(result));
+
+		mRowIds = std::move(result);
+		mSize = mRowIds.size();
+	} else {
+		if (!mIsBitmap) {
+			toBitmap();
+		}
+
+		if (other.mIsBitmap) {
+			for (std::size_t i = 0; i < mBitmap.size(); i++) {
+				mBitmap[i] |= other.mBitmap[i];
+			}
+		} else {
+			for (auto rowId : other.mRowIds) {
+				mBitmap[rowId / BITS_PER_WORD] |= (std::uint64_t)1 << (rowId % BITS_PER_WORD);
+			}
+		}
+
+		mSize = countBits(mBitmap);
+	}
+
+	compact();
+}
+
+std::vector<std::size_t> RowIdSet::rowIds() const {
+	if (!mIsBitmap) {
+		return mRowIds;
+	}
+
+	std::vector<std::size_t> rowIds;
+	rowIds.reserve(mSize);
+	for (std::size_t wordIndex = 0; wordIndex < mBitmap.size(); wordIndex++) {
+		auto word = mBitmap[wordIndex];
+		while (word != 0) {
+			auto bitIndex = (std::size_t)__builtin_ctzll(word);
+			rowIds.push_back(wordIndex * BITS_PER_WORD + bitIndex);
+			word &= word - 1;
+		}
+	}
+
+	return rowIds;
+}
+
+void RowIdSet::sort(std::size_t numRows, std::vector<std::size_t>& rowIds) {
+	// Scanning a word of the bitmap is cheaper than the comparisons that a sort needs per row id
+	if (rowIds.size() * SORT_WORDS_PER_ROW_ID < numWords(numRows)) {
+		std::sort(rowIds.begin(), rowIds.end());
+		rowIds.erase(std::unique(rowIds.begin(), rowIds.end()), rowIds.end());
+		return;
+	}
+
+	std::vector<std::uint64_t> bitmap(numWords(numRows), 0);
+	for (auto rowId : rowIds) {
+		bitmap[rowId / BITS_PER_WORD] |= (std::uint64_t)1 << (rowId % BITS_PER_WORD);
+	}
+
+	std::size_t index = 0;
+	for (std::size_t wordIndex = 0; wordIndex < bitmap.size(); wordIndex++) {
+		auto word = bitmap[wordIndex];
+		while (word != 0) {
+			rowIds[index++] = wordIndex * BITS_PER_WORD + (std::size_t)__builtin_ctzll(word);
+			word &= word - 1;
+		}
+	}
+
+	rowIds.resize(index);
+}
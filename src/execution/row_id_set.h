@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/**
+ * Represents a set of row ids, used to combine the rows found by several index scans.
+ * Sparse sets are stored as sorted row ids and dense sets as a bitmap with one bit per row,
+ * whichever is smaller.
+ */
+class RowIdSet {
+private:
+	std::size_t mNumRows;
+	std::size_t mSize = 0;
+
+	bool mIsBitmap = false;
+	std::vector<std::size_t> mRowIds;
+	std::vector<std::uint64_t> mBitmap;
+
+	bool contains(std::size_t rowId) const;
+
+	void toBitmap();
+	void toRowIds();
+
+	/**
+	 * Changes to the smallest representation for the current size
+	 */
+	void compact();
+public:
+	/**
+	 * Creates a new set
+	 * @param numRows The number of rows in the table, where all row ids are less than it
+	 * @param rowIds The row ids in the set, in any order and without duplicates
+	 */
+	RowIdSet(std::size_t numRows, std::vector<std::size_t> rowIds);
+
+	/**
+	 * Returns the number of row ids in the set
+	 */
+	std::size_t size() const;
+
+	/**
+	 * Indicates if the set is stored as a bitmap
+	 */
+	bool isBitmap() const;
+
+	/**
+	 * Removes the row ids that are not in the given set
+	 * @param other The other set
+	 */
+	void intersect(const RowIdSet& other);
+
+	/**
+	 * Adds the row ids in the given set
+	 * @param other The other set
+	 */
+	void unite(const RowIdSet& other);
+
+	/**
+	 * Returns the row ids in increasing order
+	 */
+	std::vector<std::size_t> rowIds() const;
+
+	/**
+	 * Sorts the given row ids and removes duplicates. Unless very sparse, they are sorted through a bitmap in linear time.
+	 * @param numRows The number of rows in the table, where all row ids are less than it
+	 * @param rowIds The row ids to sort
+	 */
+	static void sort(std::size_t numRows, std::vector<std::size_t>& rowIds);
+};
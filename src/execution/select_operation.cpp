@@ -3,26 +3,63 @@
 #include "../helpers.h"
 #include "../query_expressions/ir_optimizer.h"
 #include "index_scanner.h"
+#include "row_id_set.h"
 #include "virtual_table.h"
+#include "filter_kernels.h"
+#include "parallel_scan.h"
+#include "hash_join.h"
+#include "top_rows.h"
 
 #include <iostream>
 #include <algorithm>
 #include <assert.h>
 
+namespace {
+	template<typename T>
+	void selectColumn(CompareOperator op,
+					  bool scanEncoded,
+					  const UnderlyingColumnStorage<T>& columnValues,
+					  std::size_t startRowIndex,
+					  std::size_t count,
+					  const T& value,
+					  std::vector<std::size_t>& selection) {
+		FilterKernels::selectColumn(op, columnValues, startRowIndex, count, value, selection);
+	}
+
+	// Only int32 columns are encoded
+	void selectColumn(CompareOperator op,
+					  bool scanEncoded,
+					  const UnderlyingColumnStorage<std::int32_t>& columnValues,
+					  std::size_t startRowIndex,
+					  std::size_t count,
+					  std::int32_t value,
+					  std::vector<std::size_t>& selection) {
+		if (scanEncoded) {
+			FilterKernels::selectEncodedColumn(op, columnValues, startRowIndex, count, value, selection);
+		} else {
+			FilterKernels::selectColumn(op, columnValues, startRowIndex, count, value, selection);
+		}
+	}
+}
+
 SelectOperationExecutor::SelectOperationExecutor(DatabaseEngine& databaseEngine,
 												 VirtualTableContainer& tableContainer,
 												 QuerySelectOperation* operation,
 												 std::vector<std::unique_ptr<ExpressionExecutionEngine>>& projectionExecutionEngines,
 												 ExpressionExecutionEngine& filterExecutionEngine,
-												 QueryResult& result)
+												 QueryResult& result,
+												 CachedScanPlan* cachedScanPlan)
 	: mDatabaseEngine(databaseEngine),
 	  mTableContainer(tableContainer),
 	  mTable(tableContainer.getTable(operation->table)),
 	  mOperation(operation),
+	  mCachedScanPlan(cachedScanPlan),
 	  mProjectionExecutionEngines(projectionExecutionEngines),
 	  mFilterExecutionEngine(filterExecutionEngine),
 	  mResult(result),
 	  mReducedProjections(operation->table) {
+	mExecutors.emplace_back(std::bind(&SelectOperationExecutor::executeTopRows, this));
+
 	if (databaseEngine.config().optimizeExecution) {
 		mExecutors.emplace_back(std::bind(&SelectOperationExecutor::executeNoFilter, this));
 		mExecutors.emplace_back(std::bind(&SelectOperationExecutor::executeFilterLeftIsColumn, this));
@@ -33,19 +70,10 @@ SelectOperationExecutor::SelectOperationExecutor(DatabaseEngine& databaseEngine,
 	mExecutors.emplace_back(std::bind(&SelectOperationExecutor::executeDefault, this));
 }
 
-std::vector<ColumnStorage>& SelectOperationExecutor::getWorkingStorage(const std::string& tableName) {
-	auto workingStorageIterator = mWorkingStorage.find(tableName);
-	if (workingStorageIterator != mWorkingStorage.end()) {
-		return *workingStorageIterator->second;
-	}
-
-	auto workingStorage = std::make_unique<std::vector<ColumnStorage>>();
-	auto workingStoragePtr = workingStorage.get();
-	mWorkingStorage[tableName] = std::move(workingStorage);
-	return *workingStoragePtr;
+void SelectOperationExecutor::addPlanStep(std::string step) {
+	mResult.plan.push_back(std::move(step));
 }
 
-
 bool SelectOperationExecutor::hasReducedToOneInstruction() const {
 	return this->mFilterExecutionEngine.instructions().size() == 1;
 }
@@ -59,7 +87,159 @@ void SelectOperationExecutor::addForOrdering(std::size_t rowIndex) {
 	assert(mOrderExecutionEngine->evaluationStackSize() == 0);
 }
 
+void SelectOperationExecutor::addForOrdering(ExpressionExecutionEngine& orderExecutionEngine,
+											 OrderingData& orderingData,
+											 const std::vector<std::size_t>& rowIndices) {
+	if (!orderExecutionEngine.canExecuteBatch()) {
+		for (auto rowIndex : rowIndices) {
+			orderExecutionEngine.execute(rowIndex);
+			for (auto& columnOrdering : orderingData) {
+				columnOrdering.push_back(orderExecutionEngine.popEvaluation().data);
+			}
+
+			assert(orderExecutionEngine.evaluationStackSize() == 0);
+		}
+
+		return;
+	}
+
+	for (std::size_t offset = 0; offset < rowIndices.size(); offset += EXPRESSION_BATCH_SIZE) {
+		RowBatch rows(rowIndices.data() + offset, std::min(EXPRESSION_BATCH_SIZE, rowIndices.size() - offset));
+		orderExecutionEngine.executeBatch(rows);
+
+		for (auto& columnOrdering : orderingData) {
+			auto& orderingBatch = orderExecutionEngine.popBatchEvaluation();
+
+			auto handleForType = [&](auto dummy) {
+				using Type = decltype(dummy);
+				auto values = orderingBatch.values<Type>();
+				for (std::size_t i = 0; i < orderingBatch.size(); i++) {
+					columnOrdering.push_back(QueryValue(values[i]).data);
+				}
+			};
+
+			handleGenericType(orderingBatch.type(), handleForType);
+		}
+	}
+}
+
+SelectScanWorker SelectOperationExecutor::createScanWorker() const {
+	SelectScanWorker worker;
+	worker.filterExecutionEngine = std::make_unique<ExpressionExecutionEngine>(mFilterExecutionEngine.clone());
+
+	for (auto& projection : mProjectionExecutionEngines) {
+		worker.projectionExecutionEngines.push_back(std::make_unique<ExpressionExecutionEngine>(projection->clone()));
+	}
+
+	if (mOrderExecutionEngine) {
+		worker.orderExecutionEngine = std::make_unique<ExpressionExecutionEngine>(mOrderExecutionEngine->clone());
+	}
+
+	return worker;
+}
+
+void SelectOperationExecutor::executeScan(ScanRowsFunction scanRows) {
+	auto numRows = mTable.numRows();
+
+	// Scan batch by batch until the limit has been reached
+	if (mOperation->limit.hasCount() && !mOrderResult) {
+		auto numRowsNeeded = mOperation->limit.numRowsNeeded();
+		auto worker = createScanWorker();
+		for (std::size_t startRowIndex = 0;
+			 startRowIndex < numRows && ExecutorHelpers::numResultRows(mResult) < numRowsNeeded;
+			 startRowIndex += EXPRESSION_BATCH_SIZE) {
+			scanRows(worker, mResult, mOrderingData, startRowIndex, std::min(startRowIndex + EXPRESSION_BATCH_SIZE, numRows));
+		}
+
+		return;
+	}
+
+	auto numWorkers = ParallelScan::numWorkers(mDatabaseEngine.config(), numRows);
+	std::vector<SelectScanWorker> workers;
+	for (std::size_t workerIndex = 0; workerIndex < numWorkers; workerIndex++) {
+		workers.push_back(createScanWorker());
+	}
+
+	if (!mExternalSort) {
+		executeScanRange(scanRows, workers, 0, numRows);
+		return;
+	}
+
+	// Scan a few morsels at a time, and spill the buffered rows before the next range could exceed the memory limit
+	auto maxBufferedRows = std::max(
+		mDatabaseEngine.config().sortMemoryLimit / mExternalSort->rowMemoryUsage(),
+		EXPRESSION_BATCH_SIZE);
+
+	// The ranges hold whole morsels when they can, which keeps the morsels within the column segments
+	auto rangeSize = std::min(SCAN_MORSEL_SIZE * numWorkers, maxBufferedRows);
+	if (rangeSize > SCAN_MORSEL_SIZE) {
+		rangeSize -= rangeSize % SCAN_MORSEL_SIZE;
+	}
+
+	for (std::size_t startRowIndex = 0; startRowIndex < numRows; startRowIndex += rangeSize) {
+		executeScanRange(scanRows, workers, startRowIndex, std::min(startRowIndex + rangeSize, numRows));
+
+		if (ExecutorHelpers::numResultRows(mResult) + rangeSize > maxBufferedRows) {
+			mExternalSort->addRun(mOrderingData, mResult);
+		}
+	}
+}
+
+void SelectOperationExecutor::executeScanRange(ScanRowsFunction scanRows,
+											   std::vector<SelectScanWorker>& workers,
+											   std::size_t startRowIndex,
+											   std::size_t endRowIndex) {
+	auto numRows = endRowIndex - startRowIndex;
+	auto numWorkers = std::min(workers.size(), ParallelScan::numMorsels(numRows));
+	if (numWorkers <= 1) {
+		scanRows(workers[0], mResult, mOrderingData, startRowIndex, endRowIndex);
+		return;
+	}
+
+	// Each morsel has its own output, which are merged in row order at the end
+	auto numMorsels = ParallelScan::numMorsels(numRows);
+	std::vector<QueryResult> morselResults(numMorsels);
+	std::vector<OrderingData> morselOrderingData(numMorsels, OrderingData(mOrderingData.size()));
+	for (auto& morselResult : morselResults) {
+		for (auto& column : mResult.columns) {
+			morselResult.columns.emplace_back(column.type());
+		}
+	}
+
+	ParallelScan::forEachMorsel(
+		numRows,
+		numWorkers,
+		[&](std::size_t workerIndex, const ScanMorsel& morsel) {
+			scanRows(
+				workers[workerIndex],
+				morselResults[morsel.index],
+				morselOrderingData[morsel.index],
+				startRowIndex + morsel.startRowIndex,
+				startRowIndex + morsel.endRowIndex);
+		});
+
+	for (std::size_t morselIndex = 0; morselIndex < numMorsels; morselIndex++) {
+		ExecutorHelpers::appendResult(mResult, morselResults[morselIndex]);
+
+		std::size_t orderingIndex = 0;
+		for (auto& columnOrdering : morselOrderingData[morselIndex]) {
+			mOrderingData[orderingIndex].insert(
+				mOrderingData[orderingIndex].end(),
+				columnOrdering.begin(),
+				columnOrdering.end());
+			orderingIndex++;
+		}
+
+		morselOrderingData[morselIndex].clear();
+	}
+}
+
 bool SelectOperationExecutor::executeNoFilter() {
+	// Copying whole columns can't stop at the limit or spill sorted runs
+	if (mOperation->limit.hasCount() || mExternalSort) {
+		return false;
+	}
+
 	if (hasReducedToOneInstruction() && mReducedProjections.allReduced) {
 		auto firstInstruction = this->mFilterExecutionEngine.instructions().front().get();
 		if (auto instruction = dynamic_cast<QueryValueExpressionIR*>(firstInstruction)) {
@@ -114,6 +294,37 @@ bool SelectOperationExecutor::executeNoFilter() {
 	return false;
 }
 
+template<typename T>
+void SelectOperationExecutor::executeFilterColumn(CompareOperator op,
+												  const UnderlyingColumnStorage<T>& columnValues,
+												  const T& value) {
+	// The comparison is done on the encoded values of encoded segments, and only the selected rows are read
+	auto scanEncoded = mDatabaseEngine.config().scanEncodedColumns;
+
+	executeScan([&](SelectScanWorker& worker,
+					QueryResult& result,
+					OrderingData& orderingData,
+					std::size_t scanStartRowIndex,
+					std::size_t scanEndRowIndex) {
+		std::vector<std::size_t> rowIndices;
+		for (std::size_t startRowIndex = scanStartRowIndex; startRowIndex < scanEndRowIndex; startRowIndex += EXPRESSION_BATCH_SIZE) {
+			selectColumn(
+				op,
+				scanEncoded,
+				columnValues,
+				startRowIndex,
+				std::min(EXPRESSION_BATCH_SIZE, scanEndRowIndex - startRowIndex),
+				value,
+				rowIndices);
+
+			ExecutorHelpers::addRowsToResult(this->mReducedProjections.storage, result, rowIndices);
+			if (mOrderResult) {
+				addForOrdering(*worker.orderExecutionEngine, orderingData, rowIndices);
+			}
+		}
+	});
+}
+
 bool SelectOperationExecutor::executeFilterLeftIsColumn() {
 	if (hasReducedToOneInstruction() && mReducedProjections.allReduced) {
 		auto firstInstruction = this->mFilterExecutionEngine.instructions().front().get();
@@ -124,15 +335,7 @@ bool SelectOperationExecutor::executeFilterLeftIsColumn() {
 				auto& lhsColumn = *(this->mFilterExecutionEngine.columnFromSlot(instruction->lhs)->storage());
 				auto& lhsColumnValues = lhsColumn.template getUnderlyingStorage<Type>();
 
-				for (std::size_t rowIndex = 0; rowIndex < lhsColumnValues.size(); rowIndex++) {
-					if (QueryExpressionHelpers::compare<Type>(instruction->op, lhsColumnValues[rowIndex], instruction->rhs)) {
-						ExecutorHelpers::addRowToResult(this->mReducedProjections.storage, this->mResult, rowIndex);
-
-						if (mOrderResult) {
-							addForOrdering(rowIndex);
-						}
-					}
-				}
+				executeFilterColumn(instruction->op, lhsColumnValues, instruction->rhs);
 
 				std::cout << "executed: executeFilterLeftIsColumn" << std::endl;
 				return true;
@@ -155,15 +358,7 @@ bool SelectOperationExecutor::executeFilterRightIsColumn() {
 				auto& rhsColumn = *(this->mFilterExecutionEngine.columnFromSlot(instruction->rhs)->storage());
 				auto& rhsColumnValues = rhsColumn.template getUnderlyingStorage<Type>();
 
-				for (std::size_t rowIndex = 0; rowIndex < rhsColumnValues.size(); rowIndex++) {
-					if (QueryExpressionHelpers::compare<Type>(instruction->op, instruction->lhs, rhsColumnValues[rowIndex])) {
-						ExecutorHelpers::addRowToResult(this->mReducedProjections.storage, this->mResult, rowIndex);
-
-						if (mOrderResult) {
-							addForOrdering(rowIndex);
-						}
-					}
-				}
+				executeFilterColumn(QueryExpressionHelpers::otherSideCompareOp(instruction->op), rhsColumnValues, instruction->lhs);
 
 				std::cout << "executed: executeFilterRightIsColumn" << std::endl;
 				return true;
@@ -191,18 +386,26 @@ bool SelectOperationExecutor::executeFilterBothColumn() {
 				auto& lhsColumnValues = lhsColumn.getUnderlyingStorage<Type>();
 				auto& rhsColumnValues = rhsColumn.getUnderlyingStorage<Type>();
 
-				for (std::size_t rowIndex = 0; rowIndex < lhsColumnValues.size(); rowIndex++) {
-					auto lhsValue = lhsColumnValues[rowIndex];
-					auto rhsValue = rhsColumnValues[rowIndex];
-
-					if (QueryExpressionHelpers::compare<Type>(instruction->op, lhsValue, rhsValue)) {
-						ExecutorHelpers::addRowToResult(this->mReducedProjections.storage, this->mResult, rowIndex);
-
-						if (mOrderResult) {
-							addForOrdering(rowIndex);
+				executeScan([&](SelectScanWorker& worker,
+								QueryResult& result,
+								OrderingData& orderingData,
+								std::size_t startRowIndex,
+								std::size_t endRowIndex) {
+					std::vector<std::size_t> rowIndices;
+					for (std::size_t rowIndex = startRowIndex; rowIndex < endRowIndex; rowIndex++) {
+						auto lhsValue = lhsColumnValues[rowIndex];
+						auto rhsValue = rhsColumnValues[rowIndex];
+
+						if (QueryExpressionHelpers::compare<Type>(instruction->op, lhsValue, rhsValue)) {
+							rowIndices.push_back(rowIndex);
 						}
 					}
-				}
+
+					ExecutorHelpers::addRowsToResult(this->mReducedProjections.storage, result, rowIndices);
+					if (mOrderResult) {
+						addForOrdering(*worker.orderExecutionEngine, orderingData, rowIndices);
+					}
+				});
 			};
 
 			handleGenericType(lhsColumn.type(), handleForType);
@@ -216,28 +419,191 @@ bool SelectOperationExecutor::executeFilterBothColumn() {
 
 bool SelectOperationExecutor::tryExecuteTreeIndexScan() {
 	// Don't try to use index if we have joined
-	if (!mWorkingStorage.empty()) {
+	if (mTable.hasSelection()) {
+		addPlanStep("Scan: sequential scan of joined rows");
 		return false;
 	}
 
-	auto& workingStorage = getWorkingStorage(mOperation->table);
-
+	// The scans found for a prepared statement only differ in their search values between executions
 	auto possibleIndexScans = mTreeIndexScanner.findPossibleIndexScans(mTable, mFilterExecutionEngine);
-	if (!possibleIndexScans.empty()) {
-		auto& indexScan = possibleIndexScans[0];
-		std::cout << "Using index: " << indexScan.index.column().name() << std::endl;
+	std::int64_t chosenIndexScan = -1;
+	PossibleIndexSetScan indexSetScan;
+	bool useIndexSetScan = false;
+
+	if (mCachedScanPlan != nullptr && mCachedScanPlan->valid) {
+		for (auto& step : mCachedScanPlan->planSteps) {
+			addPlanStep(step);
+		}
 
-		mTreeIndexScanner.execute(mTable, indexScan, workingStorage);
-		mFilterExecutionEngine.makeCompareAlwaysTrue(indexScan.instructionIndex);
+		chosenIndexScan = mCachedScanPlan->chosenIndexScan;
+		useIndexSetScan = mCachedScanPlan->useIndexSetScan;
+		if (useIndexSetScan) {
+			indexSetScan = mTreeIndexScanner.findIndexSetScan(mTable, mFilterExecutionEngine);
+			useIndexSetScan = indexSetScan.numScans() > 0;
+		}
+
+		if (chosenIndexScan >= (std::int64_t)possibleIndexScans.size()) {
+			chosenIndexScan = -1;
+		}
 	} else {
+		auto firstPlanStep = mResult.plan.size();
+		chosenIndexScan = mTreeIndexScanner.chooseIndexScan(mTable, possibleIndexScans);
+		auto chosenCost = chosenIndexScan == -1
+			? mTreeIndexScanner.estimateSequentialScanCost(mTable)
+			: mTreeIndexScanner.estimateIndexScanCost(mTable, possibleIndexScans[chosenIndexScan]);
+
+		// Combining several indices only pays off when it finds fewer rows to copy than the best single scan
+		indexSetScan = mTreeIndexScanner.findIndexSetScan(mTable, mFilterExecutionEngine);
+		useIndexSetScan = indexSetScan.numScans() > 1
+			&& mTreeIndexScanner.estimateIndexSetScanCost(mTable, indexSetScan).cost < chosenCost.cost;
+
+		if (useIndexSetScan) {
+			addPlanStep("Scan: " + mTreeIndexScanner.describe(mTable, indexSetScan));
+			chosenIndexScan = -1;
+		} else if (chosenIndexScan == -1) {
+			addPlanStep("Scan: " + mTreeIndexScanner.describeSequentialScan(mTable));
+		} else {
+			addPlanStep("Scan: " + mTreeIndexScanner.describe(mTable, possibleIndexScans[chosenIndexScan]));
+		}
+
+		for (std::size_t i = 0; i < possibleIndexScans.size(); i++) {
+			if ((std::int64_t)i != chosenIndexScan) {
+				addPlanStep("Rejected: " + mTreeIndexScanner.describe(mTable, possibleIndexScans[i]));
+			}
+		}
+
+		if (mCachedScanPlan != nullptr) {
+			mCachedScanPlan->valid = true;
+			mCachedScanPlan->planSteps.assign(mResult.plan.begin() + firstPlanStep, mResult.plan.end());
+			mCachedScanPlan->chosenIndexScan = chosenIndexScan;
+			mCachedScanPlan->useIndexSetScan = useIndexSetScan;
+		}
+	}
+
+	if ((chosenIndexScan == -1 && !useIndexSetScan) || mOperation->explain) {
 		return false;
 	}
 
+	std::vector<std::size_t> rowIndices;
+	if (useIndexSetScan) {
+		std::cout << "Using index set" << std::endl;
+		mTreeIndexScanner.findRowIndices(mTable, indexSetScan, rowIndices);
+		indexSetScan.makeComparesAlwaysTrue(mFilterExecutionEngine);
+	} else {
+		auto& indexScan = possibleIndexScans[chosenIndexScan];
+		std::cout << "Using index: " << indexScan.column().name() << std::endl;
+		mTreeIndexScanner.findRowIndices(indexScan, rowIndices);
+		indexScan.makeComparesAlwaysTrue(mFilterExecutionEngine);
+
+		// The rows are in key order, which is not needed as the ordering is done after the scan
+		if (mDatabaseEngine.config().sortIndexScanRows) {
+			RowIdSet::sort(mTable.underlying().numRows(), rowIndices);
+		}
+	}
+
 	ExpressionIROptimizer optimizer(mFilterExecutionEngine);
 	optimizer.optimize();
 
-	// Change storage to the result of the index scan
-	mTable.setStorage(workingStorage);
+	// Only the columns used by the rest of the query are gathered from the found rows
+	mTable.setSelection(std::move(rowIndices));
+	return true;
+}
+
+bool SelectOperationExecutor::tryExecuteIndexOrderedScan() {
+	if (!mOperation->join.empty || mOperation->order.columns.size() != 1) {
+		return false;
+	}
+
+	auto& orderColumn = mOperation->order.columns.front();
+	auto columnParts = QueryExpressionHelpers::splitColumnName(orderColumn.name, mOperation->table);
+	if (columnParts.first != mOperation->table) {
+		return false;
+	}
+
+	auto fullColumnName = QueryExpressionHelpers::fullColumnName(columnParts.first, columnParts.second);
+	const TreeIndex* orderIndex = nullptr;
+	for (auto& index : mTable.underlying().indices()) {
+		if (index->columnName() == fullColumnName) {
+			orderIndex = index.get();
+			break;
+		}
+	}
+
+	if (orderIndex == nullptr) {
+		return false;
+	}
+
+	// A filter on the ordering index limits the range to walk
+	auto possibleIndexScans = mTreeIndexScanner.findPossibleIndexScans(mTable, mFilterExecutionEngine);
+	const PossibleIndexScan* rangeIndexScan = nullptr;
+	for (auto& indexScan : possibleIndexScans) {
+		if (indexScan.treeIndex == orderIndex) {
+			rangeIndexScan = &indexScan;
+			break;
+		}
+	}
+
+	// Walking the index must be cheaper than the best scan followed by a sort
+	auto numRowsNeeded = mOperation->limit.numRowsNeeded();
+	auto indexOrderCost = mTreeIndexScanner.estimateIndexOrderScanCost(mTable, *orderIndex, rangeIndexScan, numRowsNeeded);
+
+	auto chosenIndexScan = mTreeIndexScanner.chooseIndexScan(mTable, possibleIndexScans);
+	auto scanCost = chosenIndexScan == -1
+		? mTreeIndexScanner.estimateSequentialScanCost(mTable)
+		: mTreeIndexScanner.estimateIndexScanCost(mTable, possibleIndexScans[chosenIndexScan]);
+	auto sortCost = mTreeIndexScanner.estimateSortCost(scanCost.numRows, numRowsNeeded);
+
+	if (indexOrderCost.cost >= scanCost.cost + sortCost) {
+		return false;
+	}
+
+	addPlanStep("Scan: " + mTreeIndexScanner.describeIndexOrderScan(mTable, *orderIndex, rangeIndexScan, numRowsNeeded));
+	if (mOperation->explain) {
+		return true;
+	}
+
+	std::cout << "Using index order: " << orderIndex->column().name() << std::endl;
+
+	if (rangeIndexScan != nullptr) {
+		rangeIndexScan->makeComparesAlwaysTrue(mFilterExecutionEngine);
+		ExpressionIROptimizer optimizer(mFilterExecutionEngine);
+		optimizer.optimize();
+	}
+
+	std::vector<std::size_t> candidateRowIndices;
+	std::vector<std::size_t> rowIndices;
+	candidateRowIndices.reserve(EXPRESSION_BATCH_SIZE);
+
+	auto addCandidateRows = [&]() {
+		ExecutorHelpers::filterRows(mFilterExecutionEngine, candidateRowIndices, rowIndices);
+		candidateRowIndices.clear();
+
+		auto numRowsLeft = numRowsNeeded - ExecutorHelpers::numResultRows(mResult);
+		if (rowIndices.size() > numRowsLeft) {
+			rowIndices.resize(numRowsLeft);
+		}
+
+		ExecutorHelpers::addRowsToResult(mProjectionExecutionEngines, mReducedProjections, mResult, rowIndices);
+		return ExecutorHelpers::numResultRows(mResult) < numRowsNeeded;
+	};
+
+	mTreeIndexScanner.forEachRowInOrder(
+		*orderIndex,
+		rangeIndexScan,
+		orderColumn.descending,
+		[&](std::size_t rowIndex) {
+			candidateRowIndices.push_back(rowIndex);
+			if (candidateRowIndices.size() == EXPRESSION_BATCH_SIZE) {
+				return addCandidateRows();
+			}
+
+			return true;
+		});
+
+	if (!candidateRowIndices.empty()) {
+		addCandidateRows();
+	}
+
 	return true;
 }
 
@@ -253,99 +619,92 @@ void SelectOperationExecutor::joinTables() {
 			mDatabaseEngine.config());
 	};
 
-	auto createWorkingStorageForTable = [&](VirtualTable& table) -> std::vector<ColumnStorage>& {
-		auto& schema = table.underlying().schema();
-		auto& workingStorage = getWorkingStorage(schema.name());
-		for (auto& column : schema.columns()) {
-			workingStorage.emplace_back(column);
-		}
-
-		return workingStorage;
-	};
-
 	auto joinOnExpressionEngine = createColumnAccessExecution(mOperation->join.joinOnTable, mOperation->join.joinOnColumn);
-	auto& joinOnTableStorage = createWorkingStorageForTable(joinTable);
-
 	auto joinFromExpressionEngine = createColumnAccessExecution(mOperation->table, mOperation->join.joinFromColumn);
-	auto& joinFromTableStorage = createWorkingStorageForTable(mTable);
 
-	auto findJoinIndex = [&](VirtualTable& table, const std::string& columnName) {
+	// Hash indices are preferred as the join is always on equality
+	auto findJoinIndexScan = [&](VirtualTable& table, const std::string& columnName) -> std::unique_ptr<PossibleIndexScan> {
 		auto fullColumnName = QueryExpressionHelpers::fullColumnName(
 			table.underlying().schema().name(),
 			columnName);
-		TreeIndex* joinIndex = nullptr;
+
+		for (auto& index : table.underlying().hashIndices()) {
+			if (index->columnName() == fullColumnName) {
+				return std::make_unique<PossibleIndexScan>(0, *index, QueryValue());
+			}
+		}
 
 		for (auto& index : table.underlying().indices()) {
 			if (index->columnName() == fullColumnName) {
-				joinIndex = index.get();
+				return std::make_unique<PossibleIndexScan>(0, *index, CompareOperator::Equal, QueryValue());
 			}
 		}
 
-		return joinIndex;
+		return {};
 	};
 
-	auto joinFromIndex = findJoinIndex(mTable, mOperation->join.joinFromColumn);
-	auto joinOnIndex = findJoinIndex(joinTable, mOperation->join.joinOnColumn);
+	auto joinFromIndexScan = findJoinIndexScan(mTable, mOperation->join.joinFromColumn);
+	auto joinOnIndexScan = findJoinIndexScan(joinTable, mOperation->join.joinOnColumn);
 
 	auto indexJoin = [&](VirtualTable& nonIndexTable,
 					     ExpressionExecutionEngine& nonIndexExecutionEngine,
-					     std::vector<ColumnStorage>& nonIndexStorage,
-					     VirtualTable& indexTable,
-					     TreeIndex& index,
-					     std::vector<ColumnStorage>& indexStorage) {
+					     std::vector<std::size_t>& nonIndexRowIndices,
+					     PossibleIndexScan& indexScan,
+					     std::vector<std::size_t>& indexRowIndices) {
 		for (std::size_t nonIndexRowIndex = 0; nonIndexRowIndex < nonIndexTable.numRows(); nonIndexRowIndex++) {
 			nonIndexExecutionEngine.execute(nonIndexRowIndex);
-			auto joinValue = nonIndexExecutionEngine.popEvaluation();
-
-			mTreeIndexScanner.execute(
-				indexTable,
-				PossibleIndexScan(0, index, CompareOperator::Equal, joinValue),
-				[&](std::size_t columnIndex, const ColumnDefinition& columnDefinition) {},
-				[&](std::size_t rowIndex, std::size_t columnIndex, const ColumnStorage* columnStorage, bool isFirstColumn) {
-					ExecutorHelpers::addColumnToResult(*columnStorage, indexStorage[columnIndex], rowIndex);
+			indexScan.indexSearchValue = nonIndexExecutionEngine.popEvaluation();
 
-					if (isFirstColumn) {
-						ExecutorHelpers::copyRow(nonIndexTable, nonIndexStorage, nonIndexRowIndex);
-					}
-				});
+			mTreeIndexScanner.findRowIndices(indexScan, indexRowIndices);
+			nonIndexRowIndices.resize(indexRowIndices.size(), nonIndexRowIndex);
 		}
 	};
 
-	if (joinFromIndex != nullptr) {
+	if (joinFromIndexScan != nullptr) {
+		addPlanStep("Join: index nested loop join on " + joinFromIndexScan->column().name());
+	} else if (joinOnIndexScan != nullptr) {
+		addPlanStep("Join: index nested loop join on " + joinOnIndexScan->column().name());
+	} else {
+		addPlanStep("Join: hash join");
+	}
+
+	if (mOperation->explain) {
+		return;
+	}
+
+	JoinedRowIndices joinedRows;
+	if (joinFromIndexScan != nullptr) {
 		indexJoin(
 			joinTable,
 			joinOnExpressionEngine,
-			joinOnTableStorage,
-			mTable,
-			*joinFromIndex,
-			joinFromTableStorage);
-	} else if (joinOnIndex != nullptr) {
+			joinedRows.rightRowIndices,
+			*joinFromIndexScan,
+			joinedRows.leftRowIndices);
+	} else if (joinOnIndexScan != nullptr) {
 		indexJoin(
 			mTable,
 			joinFromExpressionEngine,
-			joinFromTableStorage,
-			joinTable,
-			*joinOnIndex,
-			joinOnTableStorage);
+			joinedRows.leftRowIndices,
+			*joinOnIndexScan,
+			joinedRows.rightRowIndices);
 	} else {
-		for (std::size_t joinOnRowIndex = 0; joinOnRowIndex < joinTable.numRows(); joinOnRowIndex++) {
-			joinOnExpressionEngine.execute(joinOnRowIndex);
-			auto joinOnValue = joinOnExpressionEngine.popEvaluation();
-
-			for (std::size_t joinFromRowIndex = 0; joinFromRowIndex < mTable.numRows(); joinFromRowIndex++) {
-				joinFromExpressionEngine.execute(joinFromRowIndex);
-				auto joinFromValue = joinFromExpressionEngine.popEvaluation();
+		auto getJoinColumn = [&](VirtualTable& table, const std::string& columnName) -> ColumnStorage& {
+			auto columnParts = QueryExpressionHelpers::splitColumnName(
+				columnName,
+				table.underlying().schema().name());
+			return *table.getColumn(columnParts.second).storage();
+		};
 
-				if (joinOnValue == joinFromValue) {
-					ExecutorHelpers::copyRow(mTable, joinFromTableStorage, joinFromRowIndex);
-					ExecutorHelpers::copyRow(joinTable, joinOnTableStorage, joinOnRowIndex);
-				}
-			}
-		}
+		HashJoin hashJoin;
+		hashJoin.execute(
+			getJoinColumn(mTable, mOperation->join.joinFromColumn),
+			getJoinColumn(joinTable, mOperation->join.joinOnColumn),
+			joinedRows);
 	}
 
-	mTable.setStorage(joinFromTableStorage);
-	joinTable.setStorage(joinOnTableStorage);
+	// The joined rows are only gathered for the columns that the rest of the query uses
+	mTable.setSelection(std::move(joinedRows.leftRowIndices));
+	joinTable.setSelection(std::move(joinedRows.rightRowIndices));
 }
 
 void SelectOperationExecutor::prepareOrdering() {
@@ -367,22 +726,91 @@ void SelectOperationExecutor::prepareOrdering() {
 		numReturnValues));
 }
 
-bool SelectOperationExecutor::executeDefault() {
-	ExecutorHelpers::forEachRowFiltered(
-		mTable,
-		mFilterExecutionEngine,
-		[&](std::size_t rowIndex) {
-			ExecutorHelpers::addRowToResult(
-				mProjectionExecutionEngines,
-				mReducedProjections,
-				mResult,
-				rowIndex);
+bool SelectOperationExecutor::executeTopRows() {
+	if (!(mOrderResult && mOperation->limit.hasCount())) {
+		return false;
+	}
 
-			if (mOrderResult) {
-				addForOrdering(rowIndex);
-			}
+	auto numRows = mTable.numRows();
+	auto numWorkers = ParallelScan::numWorkers(mDatabaseEngine.config(), numRows);
+	auto createTopRows = [&]() {
+		return TopRows(
+			mOrderExecutionEngine->expressionTypes(),
+			mOperation->order.columns,
+			mOperation->limit.numRowsNeeded());
+	};
+
+	// Each worker keeps its own top rows, which are merged at the end
+	std::vector<SelectScanWorker> workers;
+	std::vector<TopRows> workerTopRows;
+	for (std::size_t workerIndex = 0; workerIndex < numWorkers; workerIndex++) {
+		workers.push_back(createScanWorker());
+		workerTopRows.push_back(createTopRows());
+	}
+
+	ParallelScan::forEachMorsel(
+		numRows,
+		numWorkers,
+		[&](std::size_t workerIndex, const ScanMorsel& morsel) {
+			auto& worker = workers[workerIndex];
+			auto& topRows = workerTopRows[workerIndex];
+			OrderingData orderingData(mOrderingData.size());
+
+			ExecutorHelpers::forEachBatchFiltered(
+				mTable,
+				*worker.filterExecutionEngine,
+				morsel.startRowIndex,
+				morsel.endRowIndex,
+				[&](const std::vector<std::size_t>& rowIndices) {
+					addForOrdering(*worker.orderExecutionEngine, orderingData, rowIndices);
+					topRows.add(orderingData, rowIndices);
+
+					for (auto& columnOrdering : orderingData) {
+						columnOrdering.clear();
+					}
+				});
 		});
 
+	auto& topRows = workerTopRows[0];
+	for (std::size_t workerIndex = 1; workerIndex < numWorkers; workerIndex++) {
+		topRows.merge(workerTopRows[workerIndex]);
+	}
+
+	ExecutorHelpers::addRowsToResult(
+		mProjectionExecutionEngines,
+		mReducedProjections,
+		mResult,
+		topRows.sortedRowIndices());
+
+	// The result is already in order
+	mOrderResult = false;
+	return true;
+}
+
+bool SelectOperationExecutor::executeDefault() {
+	executeScan([&](SelectScanWorker& worker,
+					QueryResult& result,
+					OrderingData& orderingData,
+					std::size_t startRowIndex,
+					std::size_t endRowIndex) {
+		ExecutorHelpers::forEachBatchFiltered(
+			mTable,
+			*worker.filterExecutionEngine,
+			startRowIndex,
+			endRowIndex,
+			[&](const std::vector<std::size_t>& rowIndices) {
+				ExecutorHelpers::addRowsToResult(
+					worker.projectionExecutionEngines,
+					mReducedProjections,
+					result,
+					rowIndices);
+
+				if (mOrderResult) {
+					addForOrdering(*worker.orderExecutionEngine, orderingData, rowIndices);
+				}
+			});
+	});
+
 	return true;
 }
 
@@ -391,14 +819,46 @@ void SelectOperationExecutor::execute() {
 		joinTables();
 	}
 
+	mReducedProjections.tryReduce(mOperation->projections, mTableContainer);
+
+	// Walking an index in order makes the ordering data and the sort unnecessary
+	if (tryExecuteIndexOrderedScan()) {
+		ExecutorHelpers::limitResult(mOperation->limit, mResult);
+		return;
+	}
+
 	if (!mOperation->order.empty()) {
 		prepareOrdering();
 	}
 
-	mReducedProjections.tryReduce(mOperation->projections, mTableContainer);
-
 	tryExecuteTreeIndexScan();
 
+	if (mOrderResult) {
+		if (mOperation->limit.hasCount()) {
+			addPlanStep("Sort: top " + std::to_string(mOperation->limit.numRowsNeeded()) + " rows");
+		} else if (mDatabaseEngine.config().sortMemoryLimit > 0) {
+			addPlanStep("Sort: all rows, spilling sorted runs to disk above "
+						+ std::to_string(mDatabaseEngine.config().sortMemoryLimit) + " bytes");
+
+			std::vector<ColumnType> resultTypes;
+			for (auto& column : mResult.columns) {
+				resultTypes.push_back(column.type());
+			}
+
+			mExternalSort = std::make_unique<ExternalSort>(
+				mDatabaseEngine.config(),
+				mOrderExecutionEngine->expressionTypes(),
+				mOperation->order.columns,
+				std::move(resultTypes));
+		} else {
+			addPlanStep("Sort: all rows");
+		}
+	}
+
+	if (mOperation->explain) {
+		return;
+	}
+
 	bool executed = false;
 	for (auto& executor : mExecutors) {
 		if (executor()) {
@@ -411,11 +871,17 @@ void SelectOperationExecutor::execute() {
 		throw std::runtime_error("Operation not executed.");
 	}
 
-	if (mOrderResult) {
+	if (mExternalSort && mExternalSort->numRuns() > 0) {
+		mExternalSort->addRun(mOrderingData, mResult);
+		mExternalSort->merge(mResult);
+	} else if (mOrderResult) {
 		ExecutorHelpers::orderResult(
+			mDatabaseEngine.config(),
 			mOrderExecutionEngine->expressionTypes(),
 			mOperation->order.columns,
 			mOrderingData,
 			mResult);
 	}
+
+	ExecutorHelpers::limitResult(mOperation->limit, mResult);
 }
\ No newline at end of file
@@ -3,22 +3,46 @@
 #include <memory>
 #include "helpers.h"
 #include "index_scanner.h"
+#include "external_sort.h"
 
 struct ExpressionExecutionEngine;
 struct QuerySelectOperation;
 struct QueryResult;
 
+/**
+ * The execution engines owned by a worker in a select scan
+ */
+struct SelectScanWorker {
+	std::unique_ptr<ExpressionExecutionEngine> filterExecutionEngine;
+	std::vector<std::unique_ptr<ExpressionExecutionEngine>> projectionExecutionEngines;
+	std::unique_ptr<ExpressionExecutionEngine> orderExecutionEngine;
+};
+
+/**
+ * The scan chosen for a select operation, which is reused by later executions of a prepared statement
+ */
+struct CachedScanPlan {
+	bool valid = false;
+	std::vector<std::string> planSteps;
+	std::int64_t chosenIndexScan = -1;
+	bool useIndexSetScan = false;
+};
+
 /**
  * Represents an executor for select operation
  */
 class SelectOperationExecutor {
 private:
+	using OrderingData = std::vector<std::vector<RawQueryValue>>;
+	using ScanRowsFunction = std::function<void (SelectScanWorker&, QueryResult&, OrderingData&, std::size_t, std::size_t)>;
+
 	DatabaseEngine& mDatabaseEngine;
 	VirtualTableContainer& mTableContainer;
 	VirtualTable& mTable;
 	QuerySelectOperation* mOperation;
 
 	TreeIndexScanner mTreeIndexScanner;
+	CachedScanPlan* mCachedScanPlan;
 
 	std::vector<std::unique_ptr<ExpressionExecutionEngine>>& mProjectionExecutionEngines;
 	ExpressionExecutionEngine& mFilterExecutionEngine;
@@ -26,28 +50,43 @@ private:
 
 	bool mOrderResult = false;
 	std::unique_ptr<ExpressionExecutionEngine> mOrderExecutionEngine;
-	std::vector<std::vector<RawQueryValue>> mOrderingData;
+	OrderingData mOrderingData;
+	std::unique_ptr<ExternalSort> mExternalSort;
 
-	std::unordered_map<std::string, std::unique_ptr<std::vector<ColumnStorage>>> mWorkingStorage;
 	ReducedProjections mReducedProjections;
 
 	std::vector<std::function<bool ()>> mExecutors;
 
-	std::vector<ColumnStorage>& getWorkingStorage(const std::string& tableName);
+	void addPlanStep(std::string step);
 
 	bool hasReducedToOneInstruction() const;
 
 	void addForOrdering(std::size_t rowIndex);
+	void addForOrdering(ExpressionExecutionEngine& orderExecutionEngine,
+						OrderingData& orderingData,
+						const std::vector<std::size_t>& rowIndices);
+
+	SelectScanWorker createScanWorker() const;
+	void executeScan(ScanRowsFunction scanRows);
+	void executeScanRange(ScanRowsFunction scanRows,
+						  std::vector<SelectScanWorker>& workers,
+						  std::size_t startRowIndex,
+						  std::size_t endRowIndex);
 
 	bool executeNoFilter();
 
+	template<typename T>
+	void executeFilterColumn(CompareOperator op, const UnderlyingColumnStorage<T>& columnValues, const T& value);
+
 	bool executeFilterLeftIsColumn();
 	bool executeFilterRightIsColumn();
 	bool executeFilterBothColumn();
 
+	bool tryExecuteIndexOrderedScan();
 	bool tryExecuteTreeIndexScan();
 	void joinTables();
 	void prepareOrdering();
+	bool executeTopRows();
 	bool executeDefault();
 public:
 	/**
@@ -58,13 +97,15 @@ public:
 	 * @param projectionExecutionEngines The projection execution engines
 	 * @param filterExecutionEngine The filter execution engine
 	 * @param result The result
+	 * @param cachedScanPlan The scan plan of a prepared statement, which is chosen by the first execution if not valid
 	 */
 	SelectOperationExecutor(DatabaseEngine& databaseEngine,
 							VirtualTableContainer& tableContainer,
 							QuerySelectOperation* operation,
 							std::vector<std::unique_ptr<ExpressionExecutionEngine>>& projectionExecutionEngines,
 							ExpressionExecutionEngine& filterExecutionEngine,
-							QueryResult& result);
+							QueryResult& result,
+							CachedScanPlan* cachedScanPlan = nullptr);
 
 	/**
 	 * Executes the operation
@@ -0,0 +1,113 @@
+#include "top_rows.h"
+#include <algorithm>
+
+TopRows::TopRows(std::vector<ColumnType> orderingDataTypes, std::vector<OrderingColumn> ordering, std::size_t count)
+	: mOrderingDataTypes(std::move(orderingDataTypes)),
+	  mOrdering(std::move(ordering)),
+	  mCount(count),
+	  mCandidateOrderingValues(mOrderingDataTypes.size()) {
+
+}
+
+int TopRows::compare(const RawQueryValue* lhsValues, std::size_t lhsRowIndex,
+					 const RawQueryValue* rhsValues, std::size_t rhsRowIndex) const {
+	for (std::size_t columnIndex = 0; columnIndex < mOrderingDataTypes.size(); columnIndex++) {
+		auto compareResult = handleGenericTypeResult(int, mOrderingDataTypes[columnIndex], [&](auto dummy) {
+			using Type = decltype(dummy);
+			auto lhs = lhsValues[columnIndex].getValue<Type>();
+			auto rhs = rhsValues[columnIndex].getValue<Type>();
+
+			if (lhs < rhs) {
+				return -1;
+			} else if (lhs > rhs) {
+				return 1;
+			}
+
+			return 0;
+		});
+
+		if (compareResult != 0) {
+			return mOrdering[columnIndex].descending ? -compareResult : compareResult;
+		}
+	}
+
+	if (lhsRowIndex < rhsRowIndex) {
+		return -1;
+	} else if (lhsRowIndex > rhsRowIndex) {
+		return 1;
+	}
+
+	return 0;
+}
+
+bool TopRows::entryBefore(std::size_t lhsEntry, std::size_t rhsEntry) const {
+	auto numColumns = mOrderingDataTypes.size();
+	return compare(
+		&mOrderingValues[lhsEntry * numColumns], mRowIndices[lhsEntry],
+		&mOrderingValues[rhsEntry * numColumns], mRowIndices[rhsEntry]) < 0;
+}
+
+void TopRows::add(const RawQueryValue* orderingValues, std::size_t rowIndex) {
+	auto numColumns = mOrderingDataTypes.size();
+	auto heapBefore = [&](std::size_t lhsEntry, std::size_t rhsEntry) {
+		return entryBefore(lhsEntry, rhsEntry);
+	};
+
+	if (mHeap.size() < mCount) {
+		auto entry = mRowIndices.size();
+		mOrderingValues.insert(mOrderingValues.end(), orderingValues, orderingValues + numColumns);
+		mRowIndices.push_back(rowIndex);
+		mHeap.push_back(entry);
+		std::push_heap(mHeap.begin(), mHeap.end(), heapBefore);
+		return;
+	}
+
+	if (mCount == 0) {
+		return;
+	}
+
+	// Replace the last kept row if the new row comes before it
+	auto lastEntry = mHeap.front();
+	if (compare(orderingValues, rowIndex, &mOrderingValues[lastEntry * numColumns], mRowIndices[lastEntry]) < 0) {
+		std::pop_heap(mHeap.begin(), mHeap.end(), heapBefore);
+		std::copy(orderingValues, orderingValues + numColumns, &mOrderingValues[lastEntry * numColumns]);
+		mRowIndices[lastEntry] = rowIndex;
+		std::push_heap(mHeap.begin(), mHeap.end(), heapBefore);
+	}
+}
+
+std::size_t TopRows::size() const {
+	return mHeap.size();
+}
+
+void TopRows::add(const std::vector<std::vector<RawQueryValue>>& orderingData, const std::vector<std::size_t>& rowIndices) {
+	for (std::size_t i = 0; i < rowIndices.size(); i++) {
+		for (std::size_t columnIndex = 0; columnIndex < orderingData.size(); columnIndex++) {
+			mCandidateOrderingValues[columnIndex] = orderingData[columnIndex][i];
+		}
+
+		add(mCandidateOrderingValues.data(), rowIndices[i]);
+	}
+}
+
+void TopRows::merge(const TopRows& other) {
+	auto numColumns = mOrderingDataTypes.size();
+	for (auto entry : other.mHeap) {
+		add(&other.mOrderingValues[entry * numColumns], other.mRowIndices[entry]);
+	}
+}
+
+std::vector<std::size_t> TopRows::sortedRowIndices() const {
+	auto sortedEntries = mHeap;
+	std::sort(sortedEntries.begin(), sortedEntries.end(), [&](std::size_t lhsEntry, std::size_t rhsEntry) {
+		return entryBefore(lhsEntry, rhsEntry);
+	});
+
+	std::vector<std::size_t> rowIndices;
+	rowIndices.reserve(sortedEntries.size());
+	for (auto entry : sortedEntries) {
+		rowIndices.push_back(mRowIndices[entry]);
+	}
+
+	return rowIndices;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <vector>
+#include "../common.h"
+#include "../query.h"
+
+/**
+ * Keeps the first rows of an ordering without sorting all the rows.
+ * The kept rows are stored in a bounded heap, where the top is the last of the kept rows.
+ * Rows that compare equal are ordered by their row index.
+ */
+class TopRows {
+private:
+	std::vector<ColumnType> mOrderingDataTypes;
+	std::vector<OrderingColumn> mOrdering;
+	std::size_t mCount;
+
+	// The ordering values of each kept row, stored row by row
+	std::vector<RawQueryValue> mOrderingValues;
+	std::vector<std::size_t> mRowIndices;
+	std::vector<std::size_t> mHeap;
+
+	std::vector<RawQueryValue> mCandidateOrderingValues;
+
+	/**
+	 * Compares the given ordering values
+	 * @return Negative if the lhs comes before the rhs, positive if after and zero if equal
+	 */
+	int compare(const RawQueryValue* lhsValues, std::size_t lhsRowIndex,
+				const RawQueryValue* rhsValues, std::size_t rhsRowIndex) const;
+
+	bool entryBefore(std::size_t lhsEntry, std::size_t rhsEntry) const;
+
+	void add(const RawQueryValue* orderingValues, std::size_t rowIndex);
+public:
+	/**
+	 * Creates a new top rows
+	 * @param orderingDataTypes The types of the ordering
+	 * @param ordering The ordering
+	 * @param count The number of rows to keep
+	 */
+	TopRows(std::vector<ColumnType> orderingDataTypes, std::vector<OrderingColumn> ordering, std::size_t count);
+
+	/**
+	 * Returns the number of kept rows
+	 */
+	std::size_t size() const;
+
+	/**
+	 * Adds the given rows
+	 * @param orderingData The ordering data of the rows, by column
+	 * @param rowIndices The indices of the rows
+	 */
+	void add(const std::vector<std::vector<RawQueryValue>>& orderingData, const std::vector<std::size_t>& rowIndices);
+
+	/**
+	 * Adds the rows kept by the given top rows
+	 * @param other The other top rows
+	 */
+	void merge(const TopRows& other);
+
+	/**
+	 * Returns the indices of the kept rows in order
+	 */
+	std::vector<std::size_t> sortedRowIndices() const;
+};
@@ -2,18 +2,24 @@
 #include "expression_execution.h"
 #include "../query.h"
 #include "index_scanner.h"
+#include "row_id_set.h"
 #include "../query_expressions/ir_optimizer.h"
+#include "parallel_scan.h"
 
 #include <iostream>
 
-UpdateOperationExecutor::UpdateOperationExecutor(VirtualTable& table,
+UpdateOperationExecutor::UpdateOperationExecutor(DatabaseEngine& databaseEngine,
+												 VirtualTable& table,
 												 QueryUpdateOperation* operation,
 												 std::vector<std::unique_ptr<ExpressionExecutionEngine>>& setExecutionEngines,
-												 ExpressionExecutionEngine& filterExecutionEngine)
-	: mTable(table),
+												 ExpressionExecutionEngine& filterExecutionEngine,
+												 std::vector<ColumnUpdate>* columnUpdates)
+	: mDatabaseEngine(databaseEngine),
+	  mTable(table),
 	  mOperation(operation),
 	  mSetExecutionEngines(setExecutionEngines),
-	  mFilterExecutionEngine(filterExecutionEngine) {
+	  mFilterExecutionEngine(filterExecutionEngine),
+	  mColumnUpdates(columnUpdates) {
 
 }
 
@@ -21,12 +27,28 @@ bool UpdateOperationExecutor::tryExecuteTreeIndexScan() {
 	TreeIndexScanner treeIndexScanner;
 
 	auto possibleIndexScans = treeIndexScanner.findPossibleIndexScans(mTable, mFilterExecutionEngine);
-	if (!possibleIndexScans.empty()) {
-		auto& indexScan = possibleIndexScans[0];
-		std::cout << "Using index: " << indexScan.index.column().name() << std::endl;
-
-		treeIndexScanner.execute(mTable, indexScan, mWorkingStorage, mWorkingRowIndexStorage);
-		mFilterExecutionEngine.makeCompareAlwaysTrue(indexScan.instructionIndex);
+	auto chosenIndexScan = treeIndexScanner.chooseIndexScan(mTable, possibleIndexScans);
+	auto chosenCost = chosenIndexScan == -1
+		? treeIndexScanner.estimateSequentialScanCost(mTable)
+		: treeIndexScanner.estimateIndexScanCost(mTable, possibleIndexScans[chosenIndexScan]);
+
+	auto indexSetScan = treeIndexScanner.findIndexSetScan(mTable, mFilterExecutionEngine);
+	if (indexSetScan.numScans() > 1
+		&& treeIndexScanner.estimateIndexSetScanCost(mTable, indexSetScan).cost < chosenCost.cost) {
+		std::cout << "Using index set" << std::endl;
+
+		treeIndexScanner.findRowIndices(mTable, indexSetScan, mIndexRowIndices);
+		indexSetScan.makeComparesAlwaysTrue(mFilterExecutionEngine);
+	} else if (chosenIndexScan != -1) {
+		auto& indexScan = possibleIndexScans[chosenIndexScan];
+		std::cout << "Using index: " << indexScan.column().name() << std::endl;
+
+		treeIndexScanner.findRowIndices(indexScan, mIndexRowIndices);
+		indexScan.makeComparesAlwaysTrue(mFilterExecutionEngine);
+
+		if (mDatabaseEngine.config().sortIndexScanRows) {
+			RowIdSet::sort(mTable.underlying().numRows(), mIndexRowIndices);
+		}
 	} else {
 		return false;
 	}
@@ -34,17 +56,70 @@ bool UpdateOperationExecutor::tryExecuteTreeIndexScan() {
 	ExpressionIROptimizer optimizer(mFilterExecutionEngine);
 	optimizer.optimize();
 
-	// Change storage to the result of the index scan
-	mTable.setStorage(mWorkingStorage);
+	mUseIndexRows = true;
 	return true;
 }
 
+void UpdateOperationExecutor::forEachRowFiltered(std::function<void (std::size_t)> applyRow) {
+	// The rest of the filter is evaluated directly on the rows found by the index
+	if (mUseIndexRows) {
+		std::vector<std::size_t> rowIndices;
+		ExecutorHelpers::filterRows(mFilterExecutionEngine, mIndexRowIndices, rowIndices);
+		for (auto rowIndex : rowIndices) {
+			applyRow(rowIndex);
+		}
+
+		return;
+	}
+
+	auto numRows = mTable.numRows();
+	auto numWorkers = ParallelScan::numWorkers(mDatabaseEngine.config(), numRows);
+	if (numWorkers == 1) {
+		ExecutorHelpers::forEachRowFiltered(mTable, mFilterExecutionEngine, applyRow);
+		return;
+	}
+
+	// Only the filtering is done in parallel as updating the indices is not thread safe
+	std::vector<std::unique_ptr<ExpressionExecutionEngine>> filterExecutionEngines;
+	for (std::size_t workerIndex = 0; workerIndex < numWorkers; workerIndex++) {
+		filterExecutionEngines.push_back(std::make_unique<ExpressionExecutionEngine>(mFilterExecutionEngine.clone()));
+	}
+
+	std::vector<std::vector<std::size_t>> morselRowIndices(ParallelScan::numMorsels(numRows));
+	ParallelScan::forEachMorsel(
+		numRows,
+		numWorkers,
+		[&](std::size_t workerIndex, const ScanMorsel& morsel) {
+			auto& rowIndices = morselRowIndices[morsel.index];
+			ExecutorHelpers::forEachBatchFiltered(
+				mTable,
+				*filterExecutionEngines[workerIndex],
+				morsel.startRowIndex,
+				morsel.endRowIndex,
+				[&](const std::vector<std::size_t>& batchRowIndices) {
+					rowIndices.insert(rowIndices.end(), batchRowIndices.begin(), batchRowIndices.end());
+				});
+		});
+
+	for (auto& rowIndices : morselRowIndices) {
+		for (auto rowIndex : rowIndices) {
+			applyRow(rowIndex);
+		}
+	}
+}
+
 void UpdateOperationExecutor::execute() {
 	tryExecuteTreeIndexScan();
 
-	ExecutorHelpers::forEachRowFiltered(
-		mTable,
-		mFilterExecutionEngine,
+	std::size_t firstColumnUpdate = 0;
+	if (mColumnUpdates != nullptr) {
+		firstColumnUpdate = mColumnUpdates->size();
+		for (auto& set : mOperation->sets) {
+			mColumnUpdates->emplace_back(mTable.underlying().schema().getDefinition(set->column));
+		}
+	}
+
+	forEachRowFiltered(
 		[&](std::size_t rowIndex) {
 			std::size_t setIndex = 0;
 			for (auto& setExecutionEngine : mSetExecutionEngines) {
@@ -53,30 +128,34 @@ void UpdateOperationExecutor::execute() {
 				setExecutionEngine->execute(rowIndex);
 				auto newValue = setExecutionEngine->popEvaluation();
 
-				std::size_t realRowIndex = rowIndex;
-				if (!mWorkingRowIndexStorage.empty()) {
-					realRowIndex = mWorkingRowIndexStorage[rowIndex];
-				}
-
 				auto handleForType = [&](auto dummy) {
 					using Type = decltype(dummy);
 					auto& underlyingStorage = mTable.underlying()
 						.getColumn(setColumnName)
 						.getUnderlyingStorage<Type>();
 
-					Type oldValueRaw = underlyingStorage[realRowIndex];
+					Type oldValueRaw = underlyingStorage[rowIndex];
 					Type newValueRaw = newValue.getValue<Type>();
 					mTable.underlying().updateIndices(
 						setColumnName,
 						oldValueRaw,
 						newValueRaw,
-						realRowIndex);
+						rowIndex);
 
-					underlyingStorage[realRowIndex] = newValueRaw;
+					underlyingStorage.set(rowIndex, newValueRaw);
+
+					if (mColumnUpdates != nullptr) {
+						auto& columnUpdate = (*mColumnUpdates)[firstColumnUpdate + setIndex];
+						columnUpdate.rowIndices.push_back(rowIndex);
+						columnUpdate.values.getUnderlyingStorage<Type>().push_back(newValueRaw);
+					}
 				};
 
 				handleGenericType(newValue.type, handleForType);
 				setIndex++;
 			}
 		});
+
+	// The segments that were written to are encoded again
+	mTable.underlying().encodeColumns();
 }
@@ -6,33 +6,41 @@
 
 struct ExpressionExecutionEngine;
 struct QueryUpdateOperation;
+struct ColumnUpdate;
 
 /**
  * Represents an executor for an update operation
  */
 class UpdateOperationExecutor {
 private:
+	DatabaseEngine& mDatabaseEngine;
 	VirtualTable& mTable;
 	QueryUpdateOperation* mOperation;
 	std::vector<std::unique_ptr<ExpressionExecutionEngine>>& mSetExecutionEngines;
 	ExpressionExecutionEngine& mFilterExecutionEngine;
+	std::vector<ColumnUpdate>* mColumnUpdates;
 
-	std::vector<ColumnStorage> mWorkingStorage;
-	std::vector<std::size_t> mWorkingRowIndexStorage;
+	bool mUseIndexRows = false;
+	std::vector<std::size_t> mIndexRowIndices;
 
 	bool tryExecuteTreeIndexScan();
+	void forEachRowFiltered(std::function<void (std::size_t)> applyRow);
 public:
 	/**
 	 * Creates a new update operation executor
+	 * @param databaseEngine The database engine
 	 * @param table The table
 	 * @param operation The operation
 	 * @param setExecutionEngines The set execution engines
 	 * @param filterExecutionEngine The filter execution engine
+	 * @param columnUpdates If not null, the updated rows and their new values are added to this
 	 */
-	UpdateOperationExecutor(VirtualTable& table,
+	UpdateOperationExecutor(DatabaseEngine& databaseEngine,
+							VirtualTable& table,
 							QueryUpdateOperation* operation,
 							std::vector<std::unique_ptr<ExpressionExecutionEngine>>& setExecutionEngines,
-							ExpressionExecutionEngine& filterExecutionEngine);
+							ExpressionExecutionEngine& filterExecutionEngine,
+							std::vector<ColumnUpdate>* columnUpdates = nullptr);
 
 	/**
 	 * Executes the operation
@@ -2,22 +2,52 @@
 #include "../storage.h"
 #include "../table.h"
 #include "../database_engine.h"
+#include "helpers.h"
 
 VirtualColumn::VirtualColumn(ColumnStorage* storage)
-	: mStorage(storage) {
+	: mBaseStorage(storage), mStorage(storage) {
 
 }
 
+VirtualColumn::~VirtualColumn() = default;
+
 ColumnType VirtualColumn::type() const {
-	return mStorage->type();
+	return mBaseStorage->type();
+}
+
+ColumnStorage* VirtualColumn::gather() const {
+	// Several scan workers can use the column at the same time
+	std::lock_guard<std::mutex> lock(mGatherMutex);
+	auto storage = mStorage.load(std::memory_order_relaxed);
+	if (storage != nullptr) {
+		return storage;
+	}
+
+	mGatheredStorage = std::make_unique<ColumnStorage>(mBaseStorage->type());
+	ExecutorHelpers::addColumnToResult(*mBaseStorage, *mGatheredStorage, *mSelection);
+
+	storage = mGatheredStorage.get();
+	mStorage.store(storage, std::memory_order_release);
+	return storage;
 }
 
 ColumnStorage* VirtualColumn::storage() const {
-	return mStorage;
+	auto storage = mStorage.load(std::memory_order_acquire);
+	if (storage == nullptr) {
+		storage = gather();
+	}
+
+	return storage;
 }
 
-void VirtualColumn::setStorage(ColumnStorage* storage) {
-	mStorage = storage;
+bool VirtualColumn::isMaterialized() const {
+	return mStorage.load(std::memory_order_acquire) != nullptr;
+}
+
+void VirtualColumn::setSelection(std::shared_ptr<const std::vector<std::size_t>> selection) {
+	mSelection = std::move(selection);
+	mGatheredStorage.reset();
+	mStorage.store(mSelection == nullptr ? mBaseStorage : nullptr, std::memory_order_release);
 }
 
 VirtualTable::VirtualTable(Table& table)
@@ -40,6 +70,10 @@ VirtualColumn& VirtualTable::getColumn(const std::string& name) {
 	}
 
 	auto virtualColumn = std::make_unique<VirtualColumn>(&mTable.getColumn(name));
+	if (mSelection != nullptr) {
+		virtualColumn->setSelection(mSelection);
+	}
+
 	auto virtualColumnPtr = virtualColumn.get();
 	mColumns[name] = std::move(virtualColumn);
 	return *virtualColumnPtr;
@@ -49,11 +83,23 @@ std::size_t VirtualTable::numRows() const {
 	return mNumRows;
 }
 
-void VirtualTable::setStorage(std::vector<ColumnStorage>& storage) {
-	mNumRows = storage[0].size();
+bool VirtualTable::hasSelection() const {
+	return mSelection != nullptr;
+}
+
+void VirtualTable::setSelection(std::vector<std::size_t> rowIndices) {
+	// Selecting from a selection refers to the rows of the underlying table directly
+	if (mSelection != nullptr) {
+		for (auto& rowIndex : rowIndices) {
+			rowIndex = (*mSelection)[rowIndex];
+		}
+	}
+
+	mNumRows = rowIndices.size();
+	mSelection = std::make_shared<const std::vector<std::size_t>>(std::move(rowIndices));
 
-	for (std::size_t columnIndex = 0; columnIndex < storage.size(); columnIndex++) {
-		mColumns[mTable.schema().columns()[columnIndex].name()]->setStorage(&storage[columnIndex]);
+	for (auto& column : mColumns) {
+		column.second->setSelection(mSelection);
 	}
 }
 
@@ -1,7 +1,10 @@
 #pragma once
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "../common.h"
 
@@ -11,18 +14,28 @@ class Schema;
 class TreeIndex;
 
 /**
- * Represents a column for a virtual table
+ * Represents a column for a virtual table.
+ * If the table has a selection, the selected values are gathered from the base storage the first time the column is used.
  */
 class VirtualColumn {
 private:
-	ColumnStorage* mStorage;
+	ColumnStorage* mBaseStorage;
+	std::shared_ptr<const std::vector<std::size_t>> mSelection;
+
+	mutable std::mutex mGatherMutex;
+	mutable std::unique_ptr<ColumnStorage> mGatheredStorage;
+	mutable std::atomic<ColumnStorage*> mStorage;
+
+	ColumnStorage* gather() const;
 public:
 	/**
 	 * Creates a new virtual column
-	 * @param storage The storage
+	 * @param storage The base storage
 	 */
 	explicit VirtualColumn(ColumnStorage* storage);
 
+	~VirtualColumn();
+
 	VirtualColumn(const VirtualColumn&) = delete;
 	VirtualColumn& operator=(const VirtualColumn&) = delete;
 
@@ -32,15 +45,20 @@ public:
 	ColumnType type() const;
 
 	/**
-	 * Returns the storage of the column
+	 * Returns the storage of the column, which gathers the selected values if not already done
 	 */
 	ColumnStorage* storage() const;
 
 	/**
-	 * Sets the storage
-	 * @param storage The new storage
+	 * Indicates if the values of the column are available without gathering
 	 */
-	void setStorage(ColumnStorage* storage);
+	bool isMaterialized() const;
+
+	/**
+	 * Sets the rows of the base storage that the column consists of
+	 * @param selection The selected rows. Nullptr selects all the rows.
+	 */
+	void setSelection(std::shared_ptr<const std::vector<std::size_t>> selection);
 };
 
 /**
@@ -51,6 +69,7 @@ private:
 	Table& mTable;
 	std::unordered_map<std::string, std::unique_ptr<VirtualColumn>> mColumns;
 	std::size_t mNumRows;
+	std::shared_ptr<const std::vector<std::size_t>> mSelection;
 public:
 	/**
 	 * Creates a new virtual table
@@ -83,10 +102,16 @@ public:
 	std::size_t numRows() const;
 
 	/**
-	 * Sets the storage of the virtual table to the given
-	 * @param storage The new storage
+	 * Indicates if the table is a selection of the rows of the underlying table
+	 */
+	bool hasSelection() const;
+
+	/**
+	 * Selects the given rows, which become the rows of the virtual table.
+	 * No values are copied: each column gathers its values when it is first used.
+	 * @param rowIndices The indices of the rows to select, relative to the current rows of the virtual table
 	 */
-	void setStorage(std::vector<ColumnStorage>& storage);
+	void setSelection(std::vector<std::size_t> rowIndices);
 };
 
 class DatabaseEngine;
@@ -0,0 +1,115 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <exception>
+
+struct WorkerPool::Job {
+	std::function<void (std::size_t)> applyWorker;
+	std::size_t numWorkers;
+	std::size_t nextWorkerIndex = 1;
+	std::size_t numRunning = 0;
+	std::exception_ptr error;
+};
+
+WorkerPool::WorkerPool(std::size_t numThreads) {
+	for (std::size_t i = 0; i < numThreads; i++) {
+		mThreads.emplace_back(&WorkerPool::runThread, this);
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> guard(mMutex);
+		mStop = true;
+	}
+
+	mJobAdded.notify_all();
+	for (auto& thread : mThreads) {
+		thread.join();
+	}
+}
+
+WorkerPool& WorkerPool::shared() {
+	static WorkerPool pool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+	return pool;
+}
+
+void WorkerPool::runThread() {
+	std::unique_lock<std::mutex> lock(mMutex);
+	while (true) {
+		mJobAdded.wait(lock, [&]() { return mStop || !mJobs.empty(); });
+		if (mStop) {
+			return;
+		}
+
+		auto job = mJobs.front();
+		auto workerIndex = job->nextWorkerIndex++;
+		if (job->nextWorkerIndex == job->numWorkers) {
+			mJobs.pop_front();
+		}
+
+		job->numRunning++;
+		lock.unlock();
+
+		std::exception_ptr error;
+		try {
+			job->applyWorker(workerIndex);
+		} catch (...) {
+			error = std::current_exception();
+		}
+
+		lock.lock();
+		if (error && !job->error) {
+			job->error = error;
+		}
+
+		job->numRunning--;
+		if (job->numRunning == 0) {
+			mJobDone.notify_all();
+		}
+	}
+}
+
+void WorkerPool::run(std::size_t numWorkers, std::function<void (std::size_t)> applyWorker) {
+	if (numWorkers <= 1 || mThreads.empty()) {
+		applyWorker(0);
+		return;
+	}
+
+	auto job = std::make_shared<Job>();
+	job->applyWorker = std::move(applyWorker);
+	job->numWorkers = numWorkers;
+
+	{
+		std::lock_guard<std::mutex> guard(mMutex);
+		mJobs.push_back(job);
+	}
+
+	mJobAdded.notify_all();
+
+	std::exception_ptr error;
+	try {
+		job->applyWorker(0);
+	} catch (...) {
+		error = std::current_exception();
+	}
+
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	// Skip the workers that have not started yet
+	auto jobIterator = std::find(mJobs.begin(), mJobs.end(), job);
+	if (jobIterator != mJobs.end()) {
+		mJobs.erase(jobIterator);
+	}
+
+	mJobDone.wait(lock, [&]() { return job->numRunning == 0; });
+
+	if (!error) {
+		error = job->error;
+	}
+
+	lock.unlock();
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
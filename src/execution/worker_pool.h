@@ -0,0 +1,51 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Represents a pool of threads that is shared by all parallel operations, which avoids starting new threads for each operation
+ */
+class WorkerPool {
+private:
+	struct Job;
+
+	std::vector<std::thread> mThreads;
+	std::mutex mMutex;
+	std::condition_variable mJobAdded;
+	std::condition_variable mJobDone;
+	std::deque<std::shared_ptr<Job>> mJobs;
+	bool mStop = false;
+
+	void runThread();
+public:
+	/**
+	 * Creates a new worker pool
+	 * @param numThreads The number of threads
+	 */
+	explicit WorkerPool(std::size_t numThreads);
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	/**
+	 * Returns the pool that is shared by the whole process, with one thread less than the hardware threads
+	 */
+	static WorkerPool& shared();
+
+	/**
+	 * Runs the given function on up to the given number of workers. The calling thread is worker zero.
+	 * The workers must share the work between them, as the workers that have not started when worker zero
+	 * is done are skipped. This also makes it safe to run from inside a worker.
+	 * If a worker throws, the exception is rethrown after all started workers are done.
+	 * @param numWorkers The number of workers
+	 * @param applyWorker Function that takes the worker index
+	 */
+	void run(std::size_t numWorkers, std::function<void (std::size_t)> applyWorker);
+};
@@ -0,0 +1,233 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+ * Represents an in-memory hash table that maps keys to values, where multiple values can have the same key.
+ * Entries are chained per bucket and entries with the same key are kept in insertion order.
+ * @tparam Key The type of the key
+ * @tparam Value The type of the value
+ */
+template<typename Key, typename Value>
+class HashMultiMap {
+public:
+	using key_type = Key;
+	using mapped_type = Value;
+	using value_type = std::pair<Key, Value>;
+private:
+	static constexpr std::size_t NO_ENTRY = std::numeric_limits<std::size_t>::max();
+	static constexpr std::size_t MIN_BUCKET_BITS = 4;
+
+	std::vector<value_type> mEntries;
+	std::vector<std::size_t> mNext;
+	std::vector<std::size_t> mFreeEntries;
+
+	// The first and last entry in the chain of each bucket
+	std::vector<std::size_t> mHeads;
+	std::vector<std::size_t> mTails;
+
+	std::size_t mShift = 64;
+	std::size_t mSize = 0;
+
+	inline std::size_t bucket(const Key& key) const {
+		// Fibonacci hashing, as std::hash is the identity for integers
+		auto hash = (std::uint64_t)std::hash<Key>()(key) * 0x9E3779B97F4A7C15ull;
+		return (std::size_t)(hash >> mShift);
+	}
+
+	void appendToBucket(std::size_t bucketIndex, std::size_t entryIndex) {
+		mNext[entryIndex] = NO_ENTRY;
+
+		auto& tail = mTails[bucketIndex];
+		if (tail == NO_ENTRY) {
+			mHeads[bucketIndex] = entryIndex;
+		} else {
+			mNext[tail] = entryIndex;
+		}
+
+		tail = entryIndex;
+	}
+
+	/**
+	 * Changes the number of buckets. The order of the entries within each chain is preserved.
+	 * @param numBits The number of bits in the bucket index
+	 */
+	void rehash(std::size_t numBits) {
+		auto oldHeads = std::move(mHeads);
+
+		mShift = 64 - numBits;
+		mHeads.assign((std::size_t)1 << numBits, NO_ENTRY);
+		mTails.assign((std::size_t)1 << numBits, NO_ENTRY);
+
+		for (auto entryIndex : oldHeads) {
+			while (entryIndex != NO_ENTRY) {
+				auto nextEntryIndex = mNext[entryIndex];
+				appendToBucket(bucket(mEntries[entryIndex].first), entryIndex);
+				entryIndex = nextEntryIndex;
+			}
+		}
+	}
+public:
+	HashMultiMap() = default;
+
+	HashMultiMap(const HashMultiMap&) = delete;
+	HashMultiMap& operator=(const HashMultiMap&) = delete;
+
+	HashMultiMap(HashMultiMap&&) = default;
+	HashMultiMap& operator=(HashMultiMap&&) = default;
+
+	/**
+	 * Returns the number of entries
+	 */
+	std::size_t size() const {
+		return mSize;
+	}
+
+	/**
+	 * Indicates if the map is empty
+	 */
+	bool empty() const {
+		return mSize == 0;
+	}
+
+	/**
+	 * Returns the number of bytes used by the entries and the buckets
+	 */
+	std::size_t memoryUsage() const {
+		return mEntries.capacity() * sizeof(value_type)
+			   + (mNext.capacity() + mFreeEntries.capacity() + mHeads.capacity() + mTails.capacity()) * sizeof(std::size_t);
+	}
+
+	/**
+	 * Makes room for the given number of entries without growing the buckets or the entries
+	 * @param numEntries The number of entries
+	 */
+	void reserve(std::size_t numEntries) {
+		mEntries.reserve(numEntries);
+		mNext.reserve(numEntries);
+
+		auto numBits = mHeads.empty() ? MIN_BUCKET_BITS : 64 - mShift;
+		auto newNumBits = numBits;
+		while (((std::size_t)1 << newNumBits) < numEntries) {
+			newNumBits++;
+		}
+
+		if (mHeads.empty() || newNumBits != numBits) {
+			rehash(newNumBits);
+		}
+	}
+
+	/**
+	 * Inserts the given entry after all the entries with the same key
+	 * @param key The key
+	 * @param value The value
+	 */
+	void emplace(const Key& key, const Value& value) {
+		if (mSize + 1 > mHeads.size()) {
+			auto numBits = 64 - mShift;
+			rehash(mHeads.empty() ? MIN_BUCKET_BITS : numBits + 1);
+		}
+
+		std::size_t entryIndex;
+		if (!mFreeEntries.empty()) {
+			entryIndex = mFreeEntries.back();
+			mFreeEntries.pop_back();
+			mEntries[entryIndex] = value_type(key, value);
+		} else {
+			entryIndex = mEntries.size();
+			mEntries.emplace_back(key, value);
+			mNext.push_back(NO_ENTRY);
+		}
+
+		appendToBucket(bucket(key), entryIndex);
+		mSize++;
+	}
+
+	/**
+	 * Erases the first entry with the given key and value
+	 * @param key The key
+	 * @param value The value
+	 * @return True if an entry was erased
+	 */
+	bool erase(const Key& key, const Value& value) {
+		if (mHeads.empty()) {
+			return false;
+		}
+
+		auto bucketIndex = bucket(key);
+		auto previousEntryIndex = NO_ENTRY;
+		for (auto entryIndex = mHeads[bucketIndex]; entryIndex != NO_ENTRY; entryIndex = mNext[entryIndex]) {
+			auto& entry = mEntries[entryIndex];
+			if (entry.first == key && entry.second == value) {
+				if (previousEntryIndex == NO_ENTRY) {
+					mHeads[bucketIndex] = mNext[entryIndex];
+				} else {
+					mNext[previousEntryIndex] = mNext[entryIndex];
+				}
+
+				if (mTails[bucketIndex] == entryIndex) {
+					mTails[bucketIndex] = previousEntryIndex;
+				}
+
+				mFreeEntries.push_back(entryIndex);
+				mSize--;
+				return true;
+			}
+
+			previousEntryIndex = entryIndex;
+		}
+
+		return false;
+	}
+
+	/**
+	 * Applies the given function on the value of each entry with the given key, in insertion order
+	 * @param key The key
+	 * @param applyValue The function to apply
+	 */
+	template<typename F>
+	inline void forEachValue(const Key& key, F applyValue) const {
+		if (mHeads.empty()) {
+			return;
+		}
+
+		for (auto entryIndex = mHeads[bucket(key)]; entryIndex != NO_ENTRY; entryIndex = mNext[entryIndex]) {
+			auto& entry = mEntries[entryIndex];
+			if (entry.first == key) {
+				applyValue(entry.second);
+			}
+		}
+	}
+
+	/**
+	 * Returns the number of entries with the given key
+	 * @param key The key
+	 */
+	std::size_t count(const Key& key) const {
+		std::size_t numEntries = 0;
+		forEachValue(key, [&](const Value&) { numEntries++; });
+		return numEntries;
+	}
+
+	/**
+	 * Removes all the entries
+	 */
+	void clear() {
+		mEntries.clear();
+		mNext.clear();
+		mFreeEntries.clear();
+		mHeads.clear();
+		mTails.clear();
+		mShift = 64;
+		mSize = 0;
+	}
+};
+
+template<typename Key, typename Value>
+constexpr std::size_t HashMultiMap<Key, Value>::NO_ENTRY;
+
+template<typename Key, typename Value>
+constexpr std::size_t HashMultiMap<Key, Value>::MIN_BUCKET_BITS;
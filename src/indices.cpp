@@ -11,13 +11,33 @@ namespace {
 
 		return handleGenericTypeResult(std::unique_ptr<std::uint8_t[]>, type, handleForType);
 	}
+
+	std::unique_ptr<std::uint8_t[]> createHashIndexStorage(ColumnType type) {
+		auto handleForType = [&](auto dummy) {
+			using Type = decltype(dummy);
+			return std::unique_ptr<std::uint8_t[]>((std::uint8_t*)(new HashIndex::UnderlyingStorage<Type>()));
+		};
+
+		return handleGenericTypeResult(std::unique_ptr<std::uint8_t[]>, type, handleForType);
+	}
 }
 
+constexpr std::size_t TreeIndex::MERGE_RATIO;
+
 TreeIndex::TreeIndex(const Schema& schema, const ColumnDefinition& column)
 	: mSchema(schema), mColumn(column), mUnderlyingStorage(createTreeIndexStorage(column.type())) {
 
 }
 
+TreeIndex::~TreeIndex() {
+	auto handleForType = [&](auto dummy) {
+		using Type = decltype(dummy);
+		delete (UnderlyingStorage<Type>*)mUnderlyingStorage.release();
+	};
+
+	handleGenericType(mColumn.type(), handleForType);
+}
+
 std::string TreeIndex::columnName() const {
 	return mSchema.name() + "." + mColumn.name();
 }
@@ -26,3 +46,24 @@ const ColumnDefinition& TreeIndex::column() const {
 	return mColumn;
 }
 
+HashIndex::HashIndex(const Schema& schema, const ColumnDefinition& column)
+	: mSchema(schema), mColumn(column), mUnderlyingStorage(createHashIndexStorage(column.type())) {
+
+}
+
+HashIndex::~HashIndex() {
+	auto handleForType = [&](auto dummy) {
+		using Type = decltype(dummy);
+		delete (UnderlyingStorage<Type>*)mUnderlyingStorage.release();
+	};
+
+	handleGenericType(mColumn.type(), handleForType);
+}
+
+std::string HashIndex::columnName() const {
+	return mSchema.name() + "." + mColumn.name();
+}
+
+const ColumnDefinition& HashIndex::column() const {
+	return mColumn;
+}
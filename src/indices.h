@@ -1,22 +1,39 @@
 #pragma once
 #include <unordered_map>
-#include <map>
 #include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include "bplus_tree.h"
+#include "hash_multimap.h"
+#include "storage.h"
 
 class ColumnDefinition;
 class Schema;
 
+/**
+ * The type of an index
+ */
+enum class IndexType {
+	Tree,
+	Hash
+};
+
 /**
  * Represents a Tree index
  */
 class TreeIndex {
 private:
+	// Inserting fewer entries than the existing entries divided by this is done one entry at a time instead of merging
+	static constexpr std::size_t MERGE_RATIO = 16;
+
 	const Schema& mSchema;
 	const ColumnDefinition& mColumn;
 	std::unique_ptr<std::uint8_t[]> mUnderlyingStorage;
 public:
 	template<typename T>
-	using UnderlyingStorage = std::multimap<T, std::size_t>;
+	using UnderlyingStorage = BPlusTree<T, std::size_t>;
 
 	/**
 	 * Creates a new tree index
@@ -24,6 +41,10 @@ public:
 	 * @param column The column to index on
 	 */
 	TreeIndex(const Schema& schema, const ColumnDefinition& column);
+	~TreeIndex();
+
+	TreeIndex(const TreeIndex&) = delete;
+	TreeIndex& operator=(const TreeIndex&) = delete;
 
 	/**
 	 * Returns the full name of the column being indexed on
@@ -65,6 +86,35 @@ public:
 		underlyingIndex.emplace(value, rowIndex);
 	}
 
+	/**
+	 * Inserts index entries for the values starting at the given row index.
+	 * The new entries are sorted and, unless they are few compared to the existing entries, merged in one pass.
+	 * @tparam T The type of the values
+	 * @param values The values of the column
+	 * @param firstRowIndex The row index of the first value to insert
+	 */
+	template<typename T>
+	void insertAll(const UnderlyingColumnStorage<T>& values, std::size_t firstRowIndex) {
+		auto& underlyingIndex = getUnderlyingStorage<T>();
+
+		std::vector<std::pair<T, std::size_t>> entries;
+		entries.reserve(values.size() - firstRowIndex);
+		for (auto rowIndex = firstRowIndex; rowIndex < values.size(); rowIndex++) {
+			entries.emplace_back(values[rowIndex], rowIndex);
+		}
+
+		// The row indices are unique, so this keeps the entries with the same key in row order
+		std::sort(entries.begin(), entries.end());
+
+		if (entries.size() * MERGE_RATIO < underlyingIndex.size()) {
+			for (auto& entry : entries) {
+				underlyingIndex.emplace(entry.first, entry.second);
+			}
+		} else {
+			underlyingIndex.insertSorted(entries);
+		}
+	}
+
 	/**
 	 * Updates the index entry for the given value
 	 * @tparam T The type of the value
@@ -86,4 +136,96 @@ public:
 
 		underlyingIndex.emplace(newValue, rowIndex);
 	}
-};
\ No newline at end of file
+};
+
+/**
+ * Represents a hash index. Only supports equality lookups, but these are done in constant time.
+ */
+class HashIndex {
+private:
+	const Schema& mSchema;
+	const ColumnDefinition& mColumn;
+	std::unique_ptr<std::uint8_t[]> mUnderlyingStorage;
+public:
+	template<typename T>
+	using UnderlyingStorage = HashMultiMap<T, std::size_t>;
+
+	/**
+	 * Creates a new hash index
+	 * @param schema The schema to add the index for
+	 * @param column The column to index on
+	 */
+	HashIndex(const Schema& schema, const ColumnDefinition& column);
+	~HashIndex();
+
+	HashIndex(const HashIndex&) = delete;
+	HashIndex& operator=(const HashIndex&) = delete;
+
+	/**
+	 * Returns the full name of the column being indexed on
+	 */
+	std::string columnName() const;
+
+	/**
+	 * Returns the column that is index on
+	 */
+	const ColumnDefinition& column() const;
+
+	/**
+	 * Returns the underlying storage
+	 * @tparam T The type of the value
+	 */
+	template<typename T>
+	const UnderlyingStorage<T>& getUnderlyingStorage() const {
+		return *((UnderlyingStorage<T>*)mUnderlyingStorage.get());
+	}
+
+	/**
+	 * Returns the underlying storage
+	 * @tparam T The type of the value
+	 */
+	template<typename T>
+	UnderlyingStorage<T>& getUnderlyingStorage() {
+		return *((UnderlyingStorage<T>*)mUnderlyingStorage.get());
+	}
+
+	/**
+	 * Inserts an index entry for the given value
+	 * @tparam T The type of the value
+	 * @param value The value
+	 * @param rowIndex The row index of the value
+	 */
+	template<typename T>
+	void insert(const T& value, std::size_t rowIndex) {
+		getUnderlyingStorage<T>().emplace(value, rowIndex);
+	}
+
+	/**
+	 * Inserts index entries for the values starting at the given row index
+	 * @tparam T The type of the values
+	 * @param values The values of the column
+	 * @param firstRowIndex The row index of the first value to insert
+	 */
+	template<typename T>
+	void insertAll(const UnderlyingColumnStorage<T>& values, std::size_t firstRowIndex) {
+		auto& underlyingIndex = getUnderlyingStorage<T>();
+		underlyingIndex.reserve(underlyingIndex.size() + (values.size() - firstRowIndex));
+		for (auto rowIndex = firstRowIndex; rowIndex < values.size(); rowIndex++) {
+			underlyingIndex.emplace(values[rowIndex], rowIndex);
+		}
+	}
+
+	/**
+	 * Updates the index entry for the given value
+	 * @tparam T The type of the value
+	 * @param oldValue The old value
+	 * @param newValue The new value
+	 * @param rowIndex The row index for the value
+	 */
+	template<typename T>
+	void update(const T& oldValue, const T& newValue, std::size_t rowIndex) {
+		auto& underlyingIndex = getUnderlyingStorage<T>();
+		underlyingIndex.erase(oldValue, rowIndex);
+		underlyingIndex.emplace(newValue, rowIndex);
+	}
+};
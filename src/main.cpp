@@ -5,6 +5,10 @@
 #include "table.h"
 #include "database_engine.h"
 #include "helpers.h"
+#include "storage.h"
+#include "execution/index_scanner.h"
+#include "execution/row_id_set.h"
+#include "execution/virtual_table.h"
 
 Query createQuery(std::unique_ptr<QueryOperation> operation) {
 	return Query(std::move(operation));
@@ -217,6 +221,74 @@ int main() {
 		databaseEngine.execute(selectQuery, result);
 	}
 
+	for (auto batchExecution : { false, true }) {
+		databaseEngine.config().batchExecution = batchExecution;
+		auto filterQuery = createQuery(databaseEngine.parse("SELECT x, y * 2.0 FROM test_table WHERE z > 100 AND x < 150000"));
+
+		QueryResult filterResult;
+		Timing timing(std::string("execute filter query (batch execution: ") + (batchExecution ? "on" : "off") + "): ");
+		databaseEngine.execute(filterQuery, filterResult);
+	}
+
+	for (std::size_t parallelism : { 1, 0 }) {
+		databaseEngine.config().parallelism = parallelism;
+		auto filterQuery = createQuery(databaseEngine.parse("SELECT x, y * 2.0 FROM test_table WHERE z > 100 AND x < 150000"));
+
+		QueryResult filterResult;
+		Timing timing("execute filter query (parallelism: " + std::to_string(parallelism) + "): ");
+		databaseEngine.execute(filterQuery, filterResult);
+	}
+
+	// Gathers the rows found by an index range scan, which are in key order unless sorted by row id.
+	// The table is larger than the caches, where the random accesses of the key order are the slowest.
+	DatabaseEngine gatherDatabaseEngine;
+	gatherDatabaseEngine.addTable("gather_table", std::make_unique<Table>(Schema(
+		"gather_table",
+		{
+			ColumnDefinition(0, "key", ColumnType::Int32),
+			ColumnDefinition(1, "a", ColumnType::Int32),
+			ColumnDefinition(2, "b", ColumnType::Float32),
+			ColumnDefinition(3, "c", ColumnType::Int32),
+		},
+		{ "key" }
+	)));
+
+	auto& gatherTable = gatherDatabaseEngine.getTable("gather_table");
+	std::uniform_int_distribution<int> distributionKey(0, 99999);
+	for (std::size_t i = 0; i < count * 20; i++) {
+		gatherTable.insertRow(
+			std::make_pair(std::string("key"), (std::int32_t)distributionKey(random)),
+			std::make_pair(std::string("a"), (std::int32_t)i),
+			std::make_pair(std::string("b"), generateY()),
+			std::make_pair(std::string("c"), generateZ()));
+	}
+
+	for (auto selectivity : { 0.01, 0.05, 0.1, 0.2 }) {
+		for (auto sortRows : { false, true }) {
+			TreeIndexScanner indexScanner;
+			PossibleIndexScan indexScan(
+				0,
+				*gatherTable.indices().front(),
+				CompareOperator::LessThan,
+				QueryValue((std::int32_t)(selectivity * 100000)));
+
+			std::vector<std::size_t> rowIndices;
+			indexScanner.findRowIndices(indexScan, rowIndices);
+
+			VirtualTable virtualTable(gatherTable);
+			Timing timing(
+				"gather " + std::to_string(rowIndices.size()) + " index rows (sorted: " + (sortRows ? "on" : "off") + "): ");
+			if (sortRows) {
+				RowIdSet::sort(gatherTable.numRows(), rowIndices);
+			}
+
+			virtualTable.setSelection(std::move(rowIndices));
+			for (auto& column : gatherTable.schema().columns()) {
+				virtualTable.getColumn(column.name()).storage();
+			}
+		}
+	}
+
 //	auto& x = table.getColumnValues<std::int32_t>("x");
 //	auto& y = table.getColumnValues<float>("y");
 
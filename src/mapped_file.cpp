@@ -0,0 +1,47 @@
+#include "mapped_file.h"
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path) {
+	auto fileDescriptor = open(path.c_str(), O_RDONLY);
+	if (fileDescriptor == -1) {
+		throw std::runtime_error("Could not open '" + path + "'.");
+	}
+
+	struct stat fileStatus;
+	if (fstat(fileDescriptor, &fileStatus) != 0) {
+		close(fileDescriptor);
+		throw std::runtime_error("Could not open '" + path + "'.");
+	}
+
+	mSize = (std::size_t)fileStatus.st_size;
+	if (mSize > 0) {
+		auto data = mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0);
+		if (data == MAP_FAILED) {
+			close(fileDescriptor);
+			throw std::runtime_error("Could not map '" + path + "'.");
+		}
+
+		mData = (std::uint8_t*)data;
+	}
+
+	// The mapping keeps the file alive, even if it is replaced
+	close(fileDescriptor);
+}
+
+MappedFile::~MappedFile() {
+	if (mData != nullptr) {
+		munmap(mData, mSize);
+	}
+}
+
+std::uint8_t* MappedFile::data() const {
+	return mData;
+}
+
+std::size_t MappedFile::size() const {
+	return mSize;
+}
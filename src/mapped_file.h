@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Represents a file that is mapped into memory.
+ * The mapping is private: the pages are shared with other processes until written to, and writes never reach the file.
+ */
+class MappedFile {
+private:
+	std::uint8_t* mData = nullptr;
+	std::size_t mSize = 0;
+public:
+	/**
+	 * Maps the given file
+	 * @param path The path of the file
+	 */
+	explicit MappedFile(const std::string& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/**
+	 * Returns the start of the mapping
+	 */
+	std::uint8_t* data() const;
+
+	/**
+	 * Returns the size of the file
+	 */
+	std::size_t size() const;
+};
@@ -0,0 +1,83 @@
+#include "prepared_statement.h"
+#include "database_engine.h"
+#include "query.h"
+#include "query_parser/parser.h"
+#include "execution/executor.h"
+
+PreparedStatement::PreparedStatement(DatabaseEngine& databaseEngine, std::string text)
+	: mDatabaseEngine(databaseEngine),
+	  mText(std::move(text)) {
+	std::vector<QueryValueExpression*> parameters;
+	mOperation = parse(parameters);
+	mNumParameters = parameters.size();
+}
+
+PreparedStatement::~PreparedStatement() = default;
+
+std::unique_ptr<QueryOperation> PreparedStatement::parse(std::vector<QueryValueExpression*>& parameters) const {
+	QueryParser parser(Tokenizer::tokenize(mText));
+	auto operation = parser.parse();
+	parameters = parser.parameters();
+	return operation;
+}
+
+std::shared_ptr<CompiledSelectPlan> PreparedStatement::compiledPlan(const std::vector<ColumnType>& parameterTypes) const {
+	std::lock_guard<std::mutex> guard(mCompiledPlanMutex);
+
+	// The compiled plan refers to the indices of the tables and was type checked for the parameter types
+	if (mCompiledPlan
+		&& mCompiledCatalogVersion == mDatabaseEngine.catalogVersion()
+		&& mCompiledParameterTypes == parameterTypes) {
+		return mCompiledPlan;
+	}
+
+	return nullptr;
+}
+
+std::size_t PreparedStatement::numParameters() const {
+	return mNumParameters;
+}
+
+bool PreparedStatement::isCompiled() const {
+	std::lock_guard<std::mutex> guard(mCompiledPlanMutex);
+	return mCompiledPlan && mCompiledCatalogVersion == mDatabaseEngine.catalogVersion();
+}
+
+void PreparedStatement::execute(const std::vector<QueryValue>& parameters, QueryResult& result) {
+	if (parameters.size() != mNumParameters) {
+		throw std::runtime_error(
+			"Expected " + std::to_string(mNumParameters)
+			+ " parameter(s), but got " + std::to_string(parameters.size()) + ".");
+	}
+
+	std::vector<ColumnType> parameterTypes;
+	for (auto& parameter : parameters) {
+		parameterTypes.push_back(parameter.type);
+	}
+
+	auto plan = compiledPlan(parameterTypes);
+	if (plan) {
+		OperationExecutorVisitor operationExecutor(mDatabaseEngine, result, plan.get(), &parameters);
+		mOperation->accept(operationExecutor);
+		return;
+	}
+
+	// The operations that are not cached are compiled from a parse of their own, where the parameters are bound as values
+	auto catalogVersion = mDatabaseEngine.catalogVersion();
+	std::vector<QueryValueExpression*> operationParameters;
+	auto operation = parse(operationParameters);
+	for (std::size_t i = 0; i < parameters.size(); i++) {
+		operationParameters[i]->value = parameters[i];
+	}
+
+	auto newPlan = std::make_shared<CompiledSelectPlan>();
+	OperationExecutorVisitor operationExecutor(mDatabaseEngine, result, newPlan.get(), &parameters);
+	operation->accept(operationExecutor);
+
+	if (newPlan->filterExecutionEngine) {
+		std::lock_guard<std::mutex> guard(mCompiledPlanMutex);
+		mCompiledPlan = std::move(newPlan);
+		mCompiledCatalogVersion = catalogVersion;
+		mCompiledParameterTypes = parameterTypes;
+	}
+}
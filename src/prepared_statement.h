@@ -0,0 +1,65 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common.h"
+
+class DatabaseEngine;
+struct QueryOperation;
+struct QueryValueExpression;
+struct QueryResult;
+struct CompiledSelectPlan;
+
+/**
+ * Represents a prepared statement, where the values marked with '?' are bound for each execution.
+ * The execution engines and the scan of a select are compiled by the first execution and reused by the following,
+ * until the tables of the database or the types of the parameters change.
+ * The compiled plan is only read by the executions, which bind their parameters to their own copies of its execution engines.
+ * An execution that compiles does so from its own parse of the statement, which lets concurrent executions run at the same time.
+ */
+class PreparedStatement {
+private:
+	DatabaseEngine& mDatabaseEngine;
+	std::string mText;
+	std::unique_ptr<QueryOperation> mOperation;
+	std::size_t mNumParameters = 0;
+
+	std::shared_ptr<CompiledSelectPlan> mCompiledPlan;
+	std::size_t mCompiledCatalogVersion = 0;
+	std::vector<ColumnType> mCompiledParameterTypes;
+	mutable std::mutex mCompiledPlanMutex;
+
+	std::unique_ptr<QueryOperation> parse(std::vector<QueryValueExpression*>& parameters) const;
+	std::shared_ptr<CompiledSelectPlan> compiledPlan(const std::vector<ColumnType>& parameterTypes) const;
+public:
+	/**
+	 * Creates a new prepared statement
+	 * @param databaseEngine The database engine
+	 * @param text The text of the statement, where each '?' is a parameter
+	 */
+	PreparedStatement(DatabaseEngine& databaseEngine, std::string text);
+
+	~PreparedStatement();
+
+	PreparedStatement(const PreparedStatement&) = delete;
+	PreparedStatement& operator=(const PreparedStatement&) = delete;
+
+	/**
+	 * Returns the number of parameters
+	 */
+	std::size_t numParameters() const;
+
+	/**
+	 * Indicates if the statement has a compiled plan that the next execution can reuse
+	 */
+	bool isCompiled() const;
+
+	/**
+	 * Executes the statement
+	 * @param parameters The values of the parameters
+	 * @param result The result
+	 */
+	void execute(const std::vector<QueryValue>& parameters, QueryResult& result);
+};
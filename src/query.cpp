@@ -20,17 +20,65 @@ JoinClause::JoinClause(const std::string& joinFromColumn, const std::string& joi
 
 }
 
+GroupingClause::GroupingClause(std::vector<std::string> columns)
+	: columns(std::move(columns)) {
+
+}
+
+bool GroupingClause::empty() const {
+	return columns.empty();
+}
+
+LimitClause::LimitClause(std::size_t count, std::size_t offset)
+	: count(count), offset(offset) {
+
+}
+
+bool LimitClause::empty() const {
+	return !hasCount() && offset == 0;
+}
+
+bool LimitClause::hasCount() const {
+	return count != std::numeric_limits<std::size_t>::max();
+}
+
+std::size_t LimitClause::numRowsNeeded() const {
+	if (!hasCount() || count > std::numeric_limits<std::size_t>::max() - offset) {
+		return std::numeric_limits<std::size_t>::max();
+	}
+
+	return offset + count;
+}
+
 QuerySelectOperation::QuerySelectOperation(std::string table,
 										   std::vector<std::unique_ptr<QueryExpression>> projection,
 										   std::unique_ptr<QueryExpression> filter,
 										   JoinClause join,
-										   OrderingClause order)
+										   OrderingClause order,
+										   GroupingClause group,
+										   LimitClause limit)
 	: table(std::move(table)),
 	  projections(std::move(projection)),
 	  filter(std::move(filter)),
 	  join(std::move(join)),
-	  order(std::move(order)) {
+	  order(std::move(order)),
+	  group(std::move(group)),
+	  limit(limit) {
+
+}
+
+bool QuerySelectOperation::isAggregation() const {
+	if (!group.empty()) {
+		return true;
+	}
+
+	for (auto& projection : projections) {
+		if (dynamic_cast<QueryAggregateExpression*>(projection.get()) != nullptr) {
+			return true;
+		}
+	}
 
+	return false;
 }
 
 void QuerySelectOperation::accept(QueryOperationVisitor& visitor) {
@@ -3,6 +3,7 @@
 #include <vector>
 #include <memory>
 #include <unordered_map>
+#include <limits>
 
 #include "storage.h"
 #include "query_expressions/expressions.h"
@@ -79,6 +80,58 @@ struct JoinClause {
 			   const std::string& joinOnColumn);
 };
 
+/**
+ * Represents a grouping clause
+ */
+struct GroupingClause {
+	std::vector<std::string> columns;
+
+	GroupingClause() = default;
+
+	/**
+	 * Creates a new grouping clause
+	 * @param columns The columns to group by
+	 */
+	explicit GroupingClause(std::vector<std::string> columns);
+
+	/**
+	 * Indicates if the grouping is empty
+	 */
+	bool empty() const;
+};
+
+/**
+ * Represents a limit clause
+ */
+struct LimitClause {
+	std::size_t count = std::numeric_limits<std::size_t>::max();
+	std::size_t offset = 0;
+
+	LimitClause() = default;
+
+	/**
+	 * Creates a new limit clause
+	 * @param count The maximum number of rows
+	 * @param offset The number of rows to skip
+	 */
+	explicit LimitClause(std::size_t count, std::size_t offset = 0);
+
+	/**
+	 * Indicates if the limit is empty, which means that all rows are returned
+	 */
+	bool empty() const;
+
+	/**
+	 * Indicates if the number of rows is limited
+	 */
+	bool hasCount() const;
+
+	/**
+	 * Returns the number of rows needed before the offset is applied
+	 */
+	std::size_t numRowsNeeded() const;
+};
+
 /**
  * Represents a select operation
  */
@@ -88,6 +141,9 @@ struct QuerySelectOperation : public QueryOperation {
 	std::unique_ptr<QueryExpression> filter;
 	JoinClause join;
 	OrderingClause order;
+	GroupingClause group;
+	LimitClause limit;
+	bool explain = false;
 
 	/**
 	 * Creates a new select operation
@@ -96,12 +152,21 @@ struct QuerySelectOperation : public QueryOperation {
 	 * @param filter The filtering
 	 * @param join The join
 	 * @param order The ordering
+	 * @param group The grouping
+	 * @param limit The limit
 	 */
 	QuerySelectOperation(std::string table,
 						 std::vector<std::unique_ptr<QueryExpression>> projection,
 						 std::unique_ptr<QueryExpression> filter = {},
 						 JoinClause join = {},
-						 OrderingClause order = {});
+						 OrderingClause order = {},
+						 GroupingClause group = {},
+						 LimitClause limit = {});
+
+	/**
+	 * Indicates if the operation aggregates rows, either by grouping or by having aggregate projections
+	 */
+	bool isAggregation() const;
 
 	virtual void accept(QueryOperationVisitor& visitor) override;
 };
@@ -167,6 +232,9 @@ struct Query {
 struct QueryResult {
 	std::vector<ColumnStorage> columns;
 
+	// The steps chosen when executing the query. For explained queries, only the plan is produced.
+	std::vector<std::string> plan;
+
 	/**
 	 * Returns the underlying storage for the given column
 	 * @tparam T Type of the data
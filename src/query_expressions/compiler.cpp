@@ -68,13 +68,13 @@ void QueryExpressionCompilerVisitor::visit(QueryExpression* parent, QueryColumnR
 }
 
 void QueryExpressionCompilerVisitor::visit(QueryExpression* parent, QueryValueExpression* expression) {
-	mExecutionEngine.addInstruction(std::make_unique<QueryValueExpressionIR>(expression->value));
+	mExecutionEngine.addInstruction(std::make_unique<QueryValueExpressionIR>(expression->value, expression->parameterIndex));
 	mTypeEvaluationStack.push(expression->value.type);
 }
 
-void QueryExpressionCompilerVisitor::visit(QueryExpression* parent, QueryAndExpression* expression) {
-	expression->lhs->accept(*this, expression);
-	expression->rhs->accept(*this, expression);
+void QueryExpressionCompilerVisitor::compileBoolOperands(QueryExpression* parent, QueryExpression* lhs, QueryExpression* rhs) {
+	lhs->accept(*this, parent);
+	rhs->accept(*this, parent);
 
 	if (mTypeEvaluationStack.size() < 2) {
 		throw std::runtime_error("Expected two values on the stack.");
@@ -95,9 +95,18 @@ void QueryExpressionCompilerVisitor::visit(QueryExpression* parent, QueryAndExpr
 	}
 
 	mTypeEvaluationStack.push(ColumnType::Bool);
+}
+
+void QueryExpressionCompilerVisitor::visit(QueryExpression* parent, QueryAndExpression* expression) {
+	compileBoolOperands(expression, expression->lhs.get(), expression->rhs.get());
 	mExecutionEngine.addInstruction(std::make_unique<AndExpressionIR>());
 }
 
+void QueryExpressionCompilerVisitor::visit(QueryExpression* parent, QueryOrExpression* expression) {
+	compileBoolOperands(expression, expression->lhs.get(), expression->rhs.get());
+	mExecutionEngine.addInstruction(std::make_unique<OrExpressionIR>());
+}
+
 void QueryExpressionCompilerVisitor::visit(QueryExpression* parent, QueryCompareExpression* expression) {
 	expression->lhs->accept(*this, expression);
 	expression->rhs->accept(*this, expression);
@@ -149,3 +158,8 @@ void QueryExpressionCompilerVisitor::visit(QueryExpression* parent, QueryAssignE
 			+ std::to_string((int)mTypeEvaluationStack.top()) + "'.");
 	}
 }
+
+void QueryExpressionCompilerVisitor::visit(QueryExpression* parent, QueryAggregateExpression* expression) {
+	// The arguments are compiled by the aggregate executor
+	throw std::runtime_error("Aggregate functions are only allowed as projections.");
+}
@@ -16,6 +16,8 @@ private:
 	std::stack<ColumnType> mTypeEvaluationStack;
 	bool mOptimize;
 	std::size_t mNumReturnValues;
+
+	void compileBoolOperands(QueryExpression* parent, QueryExpression* lhs, QueryExpression* rhs);
 public:
 	/**
 	 * Creates a new query expression compiler
@@ -42,7 +44,9 @@ public:
 	virtual void visit(QueryExpression* parent, QueryColumnReferenceExpression* expression) override;
 	virtual void visit(QueryExpression* parent, QueryValueExpression* expression) override;
 	virtual void visit(QueryExpression* parent, QueryAndExpression* expression) override;
+	virtual void visit(QueryExpression* parent, QueryOrExpression* expression) override;
 	virtual void visit(QueryExpression* parent, QueryCompareExpression* expression) override;
 	virtual void visit(QueryExpression* parent, QueryMathExpression* expression) override;
 	virtual void visit(QueryExpression* parent, QueryAssignExpression* expression) override;
+	virtual void visit(QueryExpression* parent, QueryAggregateExpression* expression) override;
 };
\ No newline at end of file
@@ -83,6 +83,29 @@ void QueryAndExpression::update(QueryExpression* oldExpression,	std::unique_ptr<
 	throw std::runtime_error("old expression not sub-expression.");
 }
 
+QueryOrExpression::QueryOrExpression(std::unique_ptr<QueryExpression> lhs, std::unique_ptr<QueryExpression> rhs)
+	: lhs(std::move(lhs)), rhs(std::move(rhs)) {
+
+}
+
+void QueryOrExpression::accept(QueryExpressionVisitor& visitor, QueryExpression* parent) {
+	visitor.visit(parent, this);
+}
+
+void QueryOrExpression::update(QueryExpression* oldExpression,	std::unique_ptr<QueryExpression> newExpression) {
+	if (oldExpression == lhs.get()) {
+		lhs = std::move(newExpression);
+		return;
+	}
+
+	if (oldExpression == rhs.get()) {
+		rhs = std::move(newExpression);
+		return;
+	}
+
+	throw std::runtime_error("old expression not sub-expression.");
+}
+
 QueryCompareExpression::QueryCompareExpression(std::unique_ptr<QueryExpression> lhs,
 											   std::unique_ptr<QueryExpression> rhs,
 											   CompareOperator op)
@@ -150,3 +173,21 @@ void QueryAssignExpression::update(QueryExpression* oldExpression, std::unique_p
 
 	throw std::runtime_error("old expression not sub-expression.");
 }
+
+QueryAggregateExpression::QueryAggregateExpression(AggregateFunction function, std::unique_ptr<QueryExpression> argument)
+	: function(function), argument(std::move(argument)) {
+
+}
+
+void QueryAggregateExpression::accept(QueryExpressionVisitor& visitor, QueryExpression* parent) {
+	visitor.visit(parent, this);
+}
+
+void QueryAggregateExpression::update(QueryExpression* oldExpression, std::unique_ptr<QueryExpression> newExpression) {
+	if (oldExpression == argument.get()) {
+		argument = std::move(newExpression);
+		return;
+	}
+
+	throw std::runtime_error("old expression not sub-expression.");
+}
@@ -80,6 +80,9 @@ struct QueryColumnReferenceExpression : public QueryExpression {
 struct QueryValueExpression : public QueryExpression {
 	QueryValue value;
 
+	// The index of the parameter that binds the value in a prepared statement, or -1 for a constant
+	std::int64_t parameterIndex = -1;
+
 	/**
 	 * Creates a new value expression
 	 * @param value The value
@@ -107,6 +110,24 @@ struct QueryAndExpression : public QueryExpression {
 	virtual void update(QueryExpression* oldExpression, std::unique_ptr<QueryExpression> newExpression) override;
 };
 
+/**
+ * Represents or query expression
+ */
+struct QueryOrExpression : public QueryExpression {
+	std::unique_ptr<QueryExpression> lhs;
+	std::unique_ptr<QueryExpression> rhs;
+
+	/**
+	 * Creates a new Or expression
+	 * @param lhs The lhs
+	 * @param rhs The rhs
+	 */
+	QueryOrExpression(std::unique_ptr<QueryExpression> lhs, std::unique_ptr<QueryExpression> rhs);
+
+	virtual void accept(QueryExpressionVisitor& visitor, QueryExpression* parent) override;
+	virtual void update(QueryExpression* oldExpression, std::unique_ptr<QueryExpression> newExpression) override;
+};
+
 /**
  * Represents a query compare expression
  */
@@ -169,6 +190,24 @@ struct QueryAssignExpression : public QueryExpression {
 	virtual void update(QueryExpression* oldExpression, std::unique_ptr<QueryExpression> newExpression) override;
 };
 
+/**
+ * Represents an aggregate function over the rows in a group
+ */
+struct QueryAggregateExpression : public QueryExpression {
+	AggregateFunction function;
+	std::unique_ptr<QueryExpression> argument;
+
+	/**
+	 * Creates a new aggregate expression
+	 * @param function The aggregate function
+	 * @param argument The argument of the function. Null for counting all rows.
+	 */
+	QueryAggregateExpression(AggregateFunction function, std::unique_ptr<QueryExpression> argument = {});
+
+	virtual void accept(QueryExpressionVisitor& visitor, QueryExpression* parent) override;
+	virtual void update(QueryExpression* oldExpression, std::unique_ptr<QueryExpression> newExpression) override;
+};
+
 /**
  * Helper functions for query expressions
  */
@@ -30,13 +30,12 @@ bool ExpressionIROptimizer::optimizeCompare(InstructionsIterator& it, Expression
 		if (lhsValue != nullptr && rhsColumn != nullptr) {
 			auto handleForType = [&](auto dummy) {
 				using Type = decltype(dummy);
-				this->replaceInstructions(
-					it,
-					std::make_unique<CompareExpressionLeftValueKnownTypeRightColumnIR<Type>>(
-						lhsValue->value.getValue<Type>(),
-						rhsColumn->columnSlot,
-						compareInstruction->op),
-					3);
+				auto newInstruction = std::make_unique<CompareExpressionLeftValueKnownTypeRightColumnIR<Type>>(
+					lhsValue->value.getValue<Type>(),
+					rhsColumn->columnSlot,
+					compareInstruction->op);
+				newInstruction->parameterIndex = lhsValue->parameterIndex;
+				this->replaceInstructions(it, std::move(newInstruction), 3);
 			};
 
 			handleGenericType(lhsValue->value.type, handleForType);
@@ -44,13 +43,12 @@ bool ExpressionIROptimizer::optimizeCompare(InstructionsIterator& it, Expression
 		} else if (lhsColumn != nullptr && rhsValue != nullptr) {
 			auto handleForType = [&](auto dummy) {
 				using Type = decltype(dummy);
-				this->replaceInstructions(
-					it,
-					std::make_unique<CompareExpressionLeftColumnRightValueKnownTypeIR<Type>>(
-						lhsColumn->columnSlot,
-						rhsValue->value.getValue<Type>(),
-						compareInstruction->op),
-					3);
+				auto newInstruction = std::make_unique<CompareExpressionLeftColumnRightValueKnownTypeIR<Type>>(
+					lhsColumn->columnSlot,
+					rhsValue->value.getValue<Type>(),
+					compareInstruction->op);
+				newInstruction->parameterIndex = rhsValue->parameterIndex;
+				this->replaceInstructions(it, std::move(newInstruction), 3);
 			};
 
 			handleGenericType(rhsValue->value.type, handleForType);
@@ -78,6 +76,17 @@ bool ExpressionIROptimizer::optimizeAnd(InstructionsIterator& it, ExpressionIR*
 		auto rhsValue = dynamic_cast<QueryValueExpressionIR*>(rhs.get());
 		auto lhsValue = dynamic_cast<QueryValueExpressionIR*>(lhs.get());
 
+		// The lhs is only the instruction before the rhs if the rhs has no operands
+		if (rhs->numOperands() != 0) {
+			return false;
+		}
+
+		// A parameter changes between executions, which means that it can't be folded
+		if ((lhsValue != nullptr && lhsValue->parameterIndex != -1)
+			|| (rhsValue != nullptr && rhsValue->parameterIndex != -1)) {
+			return false;
+		}
+
 		if (lhsValue != nullptr && rhsValue == nullptr) {
 			if (lhsValue->value.getValue<bool>()) {
 				it = mExecutionEngine.instructions().erase(it - 2);
@@ -100,7 +109,7 @@ bool ExpressionIROptimizer::optimizeAnd(InstructionsIterator& it, ExpressionIR*
 			replaceInstructions(
 				it,
 				std::make_unique<QueryValueExpressionIR>(
-					QueryValue(lhsValue->value.getValue<bool>() == rhsValue->value.getValue<bool>())),
+					QueryValue(lhsValue->value.getValue<bool>() && rhsValue->value.getValue<bool>())),
 				3);
 			return true;
 		}
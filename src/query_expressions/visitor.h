@@ -12,7 +12,9 @@ struct QueryExpressionVisitor {
 	virtual void visit(QueryExpression* parent, QueryColumnReferenceExpression* expression) = 0;
 	virtual void visit(QueryExpression* parent, QueryValueExpression* expression) = 0;
 	virtual void visit(QueryExpression* parent, QueryAndExpression* expression) = 0;
+	virtual void visit(QueryExpression* parent, QueryOrExpression* expression) = 0;
 	virtual void visit(QueryExpression* parent, QueryCompareExpression* expression) = 0;
 	virtual void visit(QueryExpression* parent, QueryMathExpression* expression) = 0;
 	virtual void visit(QueryExpression* parent, QueryAssignExpression* expression) = 0;
+	virtual void visit(QueryExpression* parent, QueryAggregateExpression* expression) = 0;
 };
\ No newline at end of file
@@ -8,6 +8,14 @@
 
 namespace {
 	std::unordered_set<char> twoCharOps = { '<', '>', '!', '=' };
+
+	std::unordered_map<std::string, AggregateFunction> aggregateFunctions = {
+		{ "count", AggregateFunction::Count },
+		{ "sum", AggregateFunction::Sum },
+		{ "min", AggregateFunction::Min },
+		{ "max", AggregateFunction::Max },
+		{ "avg", AggregateFunction::Average },
+	};
 }
 
 std::vector<Token> Tokenizer::tokenize(std::string str) {
@@ -42,6 +50,12 @@ std::vector<Token> Tokenizer::tokenize(std::string str) {
 			continue;
 		}
 
+		//Parameter of a prepared statement
+		if (current == '?') {
+			tokens.emplace_back(TokenType::Parameter);
+			continue;
+		}
+
 		//Number
 		if (std::isdigit(current)) {
 			std::string number { current };
@@ -109,18 +123,24 @@ std::vector<Token> Tokenizer::tokenize(std::string str) {
 
 			static std::unordered_map<std::string, TokenType> keywords {
 				{ "select", TokenType::Select },
+				{ "explain", TokenType::Explain },
 				{ "update", TokenType::Update },
 				{ "insert", TokenType::Insert },
 				{ "from", TokenType::From },
 				{ "where", TokenType::Where },
 				{ "order", TokenType::Order },
+				{ "group", TokenType::Group },
 				{ "by", TokenType::By },
+				{ "limit", TokenType::Limit },
+				{ "offset", TokenType::Offset },
 				{ "asc", TokenType::Asc },
 				{ "desc", TokenType::Desc },
 				{ "inner", TokenType::Inner },
 				{ "join", TokenType::Join },
 				{ "on", TokenType::On },
 				{ "and", TokenType::And },
+				{ "or", TokenType::Or },
+				{ "between", TokenType::Between },
 				{ "set", TokenType::Set },
 				{ "into", TokenType::Into },
 				{ "values", TokenType::Values },
@@ -207,6 +227,14 @@ int QueryParser::getTokenPrecedence() {
 		return 3;
 	}
 
+	if (mCurrentToken.type() == TokenType::Or) {
+		return 2;
+	}
+
+	if (mCurrentToken.type() == TokenType::Between) {
+		return 5;
+	}
+
 	if (mCurrentToken.type() != TokenType::Operator) {
 		return -1;
 	}
@@ -258,6 +286,14 @@ std::unique_ptr<QueryValueExpression> QueryParser::parseBoolExpression() {
 	return std::make_unique<QueryValueExpression>(QueryValue(value));
 }
 
+std::unique_ptr<QueryValueExpression> QueryParser::parseParameterExpression() {
+	nextToken();
+	auto expression = std::make_unique<QueryValueExpression>(QueryValue());
+	expression->parameterIndex = (std::int64_t)mParameters.size();
+	mParameters.push_back(expression.get());
+	return expression;
+}
+
 std::unique_ptr<QueryExpression> QueryParser::parseIdentifierExpression() {
 	std::string identifier = mCurrentToken.identifier();
 
@@ -268,34 +304,28 @@ std::unique_ptr<QueryExpression> QueryParser::parseIdentifierExpression() {
 		return std::make_unique<QueryColumnReferenceExpression>(identifier);
 	}
 
-	throw std::runtime_error("not implemented");
+	//Aggregate function call
+	auto identifierLower = identifier;
+	std::transform(identifierLower.begin(), identifierLower.end(), identifierLower.begin(), ::tolower);
 
-//	//Function call
-//	nextToken(); //Eat the '('
-//	std::vector<std::unique_ptr<QueryExpression>> arguments;
-//
-//	if (mCurrentToken.type() != TokenType::RightParenthesis) {
-//		while (true) {
-//			auto arg = parseExpression();
-//			arguments.push_back(std::move(arg));
-//
-//			if (mCurrentToken.type() == TokenType::RightParenthesis) {
-//				break;
-//			}
-//
-//			if (mCurrentToken.type() != TokenType::Comma) {
-//				parseError("Expected ',' or ')' in argument list.");
-//			}
-//
-//			nextToken();
-//		}
-//	}
-//
-//	//Eat the ')'
-//	nextToken();
-//
-//	return std::unique_ptr<FunctionCallExpression>(
-//		new FunctionCallExpression(identifier, std::move(arguments)));
+	auto aggregateFunction = aggregateFunctions.find(identifierLower);
+	if (aggregateFunction == aggregateFunctions.end()) {
+		parseError("'" + identifier + "' is not a defined function.");
+	}
+
+	nextToken(); //Eat the '('
+
+	std::unique_ptr<QueryExpression> argument;
+	if (aggregateFunction->second == AggregateFunction::Count
+		&& mCurrentToken.type() == TokenType::Operator
+		&& mCurrentToken.operatorValue() == OperatorChar('*')) {
+		nextToken(); //Eat the '*'
+	} else {
+		argument = parseExpression();
+	}
+
+	assertAndConsume(TokenType::RightParenthesis, "Expected ')'.");
+	return std::make_unique<QueryAggregateExpression>(aggregateFunction->second, std::move(argument));
 }
 
 std::unique_ptr<QueryExpression> QueryParser::parseParenthesisExpression() {
@@ -313,6 +343,8 @@ std::unique_ptr<QueryValueExpression> QueryParser::parseValueExpression() {
 			return parseFloat32Expression();
 		case TokenType::Bool:
 			return parseBoolExpression();
+		case TokenType::Parameter:
+			return parseParameterExpression();
 		default:
 			return {};
 	}
@@ -349,6 +381,11 @@ std::unique_ptr<QueryExpression> QueryParser::parseBinaryOpRHS(int precedence, s
 		auto opTokenType = mCurrentToken.type();
 		nextToken(); //Eat the operator
 
+		if (opTokenType == TokenType::Between) {
+			lhs = parseBetween(std::move(lhs));
+			continue;
+		}
+
 		//Parse the unary expression after the binary operator
 		auto rhs = parseUnaryExpression();
 
@@ -381,12 +418,40 @@ std::unique_ptr<QueryExpression> QueryParser::parseBinaryOpRHS(int precedence, s
 			lhs = std::make_unique<QueryCompareExpression>(std::move(lhs), std::move(rhs), CompareOperator::NotEqual);
 		} else if (opTokenType == TokenType::And) {
 			lhs = std::make_unique<QueryAndExpression>(std::move(lhs), std::move(rhs));
+		} else if (opTokenType == TokenType::Or) {
+			lhs = std::make_unique<QueryOrExpression>(std::move(lhs), std::move(rhs));
 		} else {
 			throw std::runtime_error("Not a valid operator.");
 		}
 	}
 }
 
+std::unique_ptr<QueryExpression> QueryParser::parseBetween(std::unique_ptr<QueryExpression> lhs) {
+	// The bounds bind tighter than 'and', which separates them
+	auto betweenPrecedence = mOperators.at(OperatorChar('<'));
+	auto lowerBound = parseBinaryOpRHS(betweenPrecedence + 1, parseUnaryExpression());
+	assertAndConsume(TokenType::And, "Expected 'and' keyword.");
+	auto upperBound = parseBinaryOpRHS(betweenPrecedence + 1, parseUnaryExpression());
+
+	// The column is used in both compares, which requires a copy of the expression
+	auto columnExpression = dynamic_cast<QueryColumnReferenceExpression*>(lhs.get());
+	if (columnExpression == nullptr) {
+		parseError("Expected a column before between.");
+	}
+
+	auto lowerCompare = std::make_unique<QueryCompareExpression>(
+		std::move(lhs),
+		std::move(lowerBound),
+		CompareOperator::GreaterThanOrEqual);
+
+	auto upperCompare = std::make_unique<QueryCompareExpression>(
+		std::make_unique<QueryColumnReferenceExpression>(columnExpression->name),
+		std::move(upperBound),
+		CompareOperator::LessThanOrEqual);
+
+	return std::make_unique<QueryAndExpression>(std::move(lowerCompare), std::move(upperCompare));
+}
+
 std::unique_ptr<QueryExpression> QueryParser::parseUnaryExpression() {
 	return parsePrimaryExpression();
 
@@ -444,6 +509,44 @@ void QueryParser::parseOrder(OrderingClause& ordering) {
 	}
 }
 
+void QueryParser::parseGroup(GroupingClause& grouping) {
+	nextToken();
+	assertAndConsume(TokenType::By, "Expected 'by' keyword.");
+
+	while (true) {
+		grouping.columns.push_back(consumeIdentifier());
+
+		if (mCurrentToken.type() == TokenType::Comma) {
+			nextToken();
+		} else {
+			break;
+		}
+	}
+}
+
+std::size_t QueryParser::consumeCount() {
+	if (mCurrentToken.type() != TokenType::Int32 || mCurrentToken.int32Value() < 0) {
+		parseError("Expected a non-negative integer.");
+	}
+
+	auto count = (std::size_t)mCurrentToken.int32Value();
+	nextToken();
+
+	return count;
+}
+
+void QueryParser::parseLimit(LimitClause& limit) {
+	if (mCurrentToken.type() == TokenType::Limit) {
+		nextToken();
+		limit.count = consumeCount();
+	}
+
+	if (mCurrentToken.type() == TokenType::Offset) {
+		nextToken();
+		limit.offset = consumeCount();
+	}
+}
+
 void QueryParser::parseJoin(JoinClause& join) {
 	nextToken();
 
@@ -484,6 +587,8 @@ std::unique_ptr<QueryOperation> QueryParser::parseSelect() {
 	std::unique_ptr<QueryExpression> filterExpression;
 	OrderingClause ordering;
 	JoinClause join;
+	GroupingClause grouping;
+	LimitClause limit;
 
 	if (mCurrentToken.type() != TokenType::EndOfTokens) {
 		while (true) {
@@ -492,6 +597,9 @@ std::unique_ptr<QueryOperation> QueryParser::parseSelect() {
 					nextToken();
 					filterExpression = parseExpression();
 					break;
+				case TokenType::Group:
+					parseGroup(grouping);
+					break;
 				case TokenType::Order:
 					parseOrder(ordering);
 					break;
@@ -499,8 +607,12 @@ std::unique_ptr<QueryOperation> QueryParser::parseSelect() {
 					parseJoin(join);
 					break;
 				}
+				case TokenType::Limit:
+				case TokenType::Offset:
+					parseLimit(limit);
+					break;
 				default:
-					parseError("Expected where, order or inner.");
+					parseError("Expected where, group, order, inner, limit or offset.");
 					return nullptr;
 			}
 
@@ -515,7 +627,20 @@ std::unique_ptr<QueryOperation> QueryParser::parseSelect() {
 		std::move(projections),
 		std::move(filterExpression),
 		join,
-		ordering);
+		ordering,
+		grouping,
+		limit);
+}
+
+std::unique_ptr<QueryOperation> QueryParser::parseExplain() {
+	nextToken();
+	if (mCurrentToken.type() != TokenType::Select) {
+		parseError("Expected select after explain.");
+	}
+
+	auto operation = parseSelect();
+	static_cast<QuerySelectOperation*>(operation.get())->explain = true;
+	return operation;
 }
 
 std::unique_ptr<QueryOperation> QueryParser::parseUpdate() {
@@ -576,16 +701,33 @@ std::unique_ptr<QueryOperation> QueryParser::parseInsert() {
 
 	assertAndConsume(TokenType::RightParenthesis, "Expected ')'");
 	assertAndConsume(TokenType::Values, "Expected 'values' keyword");
-	assertAndConsume(TokenType::LeftParenthesis, "Expected '('");
 
-	std::vector<QueryValue> values;
+	std::vector<std::vector<QueryValue>> rows;
 	while (true) {
-		auto valueExpression = parseValueExpression();
-		if (!valueExpression) {
-			parseError("Expected a value.");
+		assertAndConsume(TokenType::LeftParenthesis, "Expected '('");
+
+		std::vector<QueryValue> values;
+		while (true) {
+			if (mCurrentToken.type() == TokenType::Parameter) {
+				parseError("Parameters are not supported in insert.");
+			}
+
+			auto valueExpression = parseValueExpression();
+			if (!valueExpression) {
+				parseError("Expected a value.");
+			}
+
+			values.push_back(valueExpression->value);
+			if (mCurrentToken.type() != TokenType::Comma) {
+				break;
+			} else {
+				nextToken();
+			}
 		}
 
-		values.push_back(valueExpression->value);
+		assertAndConsume(TokenType::RightParenthesis, "Expected ')'");
+		rows.push_back(std::move(values));
+
 		if (mCurrentToken.type() != TokenType::Comma) {
 			break;
 		} else {
@@ -593,12 +735,10 @@ std::unique_ptr<QueryOperation> QueryParser::parseInsert() {
 		}
 	}
 
-	assertAndConsume(TokenType::RightParenthesis, "Expected ')'");
-
 	return std::make_unique<QueryInsertOperation>(
 		tableName,
 		columnNames,
-		std::vector<std::vector<QueryValue>> { values });
+		std::move(rows));
 }
 
 std::unique_ptr<QueryOperation> QueryParser::parse() {
@@ -610,7 +750,13 @@ std::unique_ptr<QueryOperation> QueryParser::parse() {
 			return parseUpdate();
 		case TokenType::Insert:
 			return parseInsert();
+		case TokenType::Explain:
+			return parseExplain();
 		default:
-			throw std::runtime_error("Expected: select, update or insert.");
+			throw std::runtime_error("Expected: select, update, insert or explain.");
 	}
 }
+
+const std::vector<QueryValueExpression*>& QueryParser::parameters() const {
+	return mParameters;
+}
@@ -30,6 +30,7 @@ private:
 	Token mCurrentToken;
 	int mTokenIndex;
 	std::unordered_map<OperatorChar, int> mOperators;
+	std::vector<QueryValueExpression*> mParameters;
 
 	/**
 	 * Signals that a parse error has occurred
@@ -80,6 +81,11 @@ private:
 	 */
 	std::unique_ptr<QueryValueExpression> parseBoolExpression();
 
+	/**
+	 * Parses a parameter expression, whose value is bound when a prepared statement is executed
+	 */
+	std::unique_ptr<QueryValueExpression> parseParameterExpression();
+
 	/**
 	 * Parses an identifier expression
 	 */
@@ -107,6 +113,13 @@ private:
 	 */
 	std::unique_ptr<QueryExpression> parseBinaryOpRHS(int precedence, std::unique_ptr<QueryExpression> lhs);
 
+	/**
+	 * Parses a between expression, where the between keyword has been consumed.
+	 * The expression is parsed as lhs >= lower and lhs <= upper.
+	 * @param lhs The left side, which must be a column
+	 */
+	std::unique_ptr<QueryExpression> parseBetween(std::unique_ptr<QueryExpression> lhs);
+
 	/**
 	 * Parses a unary expression
 	 */
@@ -123,6 +136,23 @@ private:
 	 */
 	void parseOrder(OrderingClause& ordering);
 
+	/**
+	 * Parses a grouping clause
+	 * @param grouping The grouping clause
+	 */
+	void parseGroup(GroupingClause& grouping);
+
+	/**
+	 * Consumes a count, such as in a limit clause
+	 */
+	std::size_t consumeCount();
+
+	/**
+	 * Parses a limit clause, with an optional offset
+	 * @param limit The limit clause
+	 */
+	void parseLimit(LimitClause& limit);
+
 	/**
 	 * Parses a join clause
 	 * @param join The join clause
@@ -134,6 +164,11 @@ private:
 	 */
 	std::unique_ptr<QueryOperation> parseSelect();
 
+	/**
+	 * Parses an explained select operation
+	 */
+	std::unique_ptr<QueryOperation> parseExplain();
+
 	/**
 	 * Parses an update operation
 	 */
@@ -154,4 +189,9 @@ public:
 	 * Parses the tokens
 	 */
 	std::unique_ptr<QueryOperation> parse();
+
+	/**
+	 * Returns the parameter expressions of the parsed operation, in parameter order
+	 */
+	const std::vector<QueryValueExpression*>& parameters() const;
 };
\ No newline at end of file
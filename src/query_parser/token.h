@@ -13,21 +13,28 @@ enum class TokenType : unsigned char {
 	Operator,
 	Identifier,
 	Select,
+	Explain,
 	Update,
 	Insert,
 	From,
 	Where,
 	Order,
+	Group,
 	By,
+	Limit,
+	Offset,
 	Asc,
 	Desc,
 	Inner,
 	Join,
 	On,
 	And,
+	Or,
+	Between,
 	Set,
 	Into,
 	Values,
+	Parameter,
 	LeftParenthesis,
 	RightParenthesis,
 	Comma,
@@ -0,0 +1,221 @@
+#include "statistics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	// The finalizer of SplitMix64, which spreads the bits of the value over the whole hash
+	std::uint64_t hashBits(std::uint64_t bits) {
+		bits ^= bits >> 30;
+		bits *= 0xBF58476D1CE4E5B9ull;
+		bits ^= bits >> 27;
+		bits *= 0x94D049BB133111EBull;
+		bits ^= bits >> 31;
+		return bits;
+	}
+}
+
+constexpr std::size_t HyperLogLog::REGISTER_BITS;
+constexpr std::size_t HyperLogLog::NUM_REGISTERS;
+
+HyperLogLog::HyperLogLog()
+	: mRegisters(NUM_REGISTERS, 0) {
+
+}
+
+void HyperLogLog::add(std::uint64_t hash) {
+	auto registerIndex = hash >> (64 - REGISTER_BITS);
+	auto remainingBits = hash << REGISTER_BITS;
+
+	// The position of the first set bit in the remaining bits
+	std::uint8_t rank = 1;
+	while (rank <= 64 - REGISTER_BITS && (remainingBits & (1ull << 63)) == 0) {
+		remainingBits <<= 1;
+		rank++;
+	}
+
+	mRegisters[registerIndex] = std::max(mRegisters[registerIndex], rank);
+}
+
+double HyperLogLog::estimate() const {
+	double sum = 0.0;
+	std::size_t numZeroRegisters = 0;
+	for (auto value : mRegisters) {
+		sum += std::ldexp(1.0, -(int)value);
+		if (value == 0) {
+			numZeroRegisters++;
+		}
+	}
+
+	auto numRegisters = (double)NUM_REGISTERS;
+	auto alpha = 0.7213 / (1.0 + 1.079 / numRegisters);
+	auto estimate = alpha * numRegisters * numRegisters / sum;
+
+	// Linear counting is more accurate for small sets
+	if (estimate <= 2.5 * numRegisters && numZeroRegisters > 0) {
+		estimate = numRegisters * std::log(numRegisters / (double)numZeroRegisters);
+	}
+
+	return estimate;
+}
+
+void HyperLogLog::clear() {
+	std::fill(mRegisters.begin(), mRegisters.end(), 0);
+}
+
+bool EquiDepthHistogram::empty() const {
+	return bounds.empty();
+}
+
+double EquiDepthHistogram::fractionLessThan(double value) const {
+	if (bounds.empty() || value <= min) {
+		return 0.0;
+	}
+
+	if (value > bounds.back()) {
+		return 1.0;
+	}
+
+	auto bucketIndex = (std::size_t)(std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin());
+	auto lowerBound = bucketIndex == 0 ? min : bounds[bucketIndex - 1];
+	auto upperBound = bounds[bucketIndex];
+
+	// Assume that the values are uniformly distributed within the bucket
+	double fractionOfBucket = 0.0;
+	if (upperBound > lowerBound) {
+		fractionOfBucket = (value - lowerBound) / (upperBound - lowerBound);
+	}
+
+	return (bucketIndex + fractionOfBucket) / bounds.size();
+}
+
+constexpr std::size_t ColumnStatistics::SAMPLE_SIZE;
+constexpr std::size_t ColumnStatistics::NUM_HISTOGRAM_BUCKETS;
+
+ColumnStatistics::ColumnStatistics(ColumnType type)
+	: mType(type) {
+
+}
+
+void ColumnStatistics::addValue(double value, std::uint64_t bits, std::size_t rowIndex) {
+	if (mCount == 0) {
+		mMin = value;
+		mMax = value;
+	} else {
+		mMin = std::min(mMin, value);
+		mMax = std::max(mMax, value);
+	}
+
+	mDistinctValues.add(hashBits(bits));
+
+	// Reservoir sampling: the n:th value replaces a sampled value with probability SAMPLE_SIZE / n
+	if (mSample.size() < SAMPLE_SIZE) {
+		mRowIndexToSample[rowIndex] = mSample.size();
+		mSample.push_back(value);
+		mSampleRowIndices.push_back(rowIndex);
+		mHistogramValid = false;
+	} else {
+		auto sampleIndex = (std::size_t)(mRandom() % (mCount + 1));
+		if (sampleIndex < SAMPLE_SIZE) {
+			mRowIndexToSample.erase(mSampleRowIndices[sampleIndex]);
+			mRowIndexToSample[rowIndex] = sampleIndex;
+			mSample[sampleIndex] = value;
+			mSampleRowIndices[sampleIndex] = rowIndex;
+			mHistogramValid = false;
+		}
+	}
+
+	mCount++;
+}
+
+void ColumnStatistics::updateValue(double newValue, std::uint64_t newBits, std::size_t rowIndex) {
+	mMin = std::min(mMin, newValue);
+	mMax = std::max(mMax, newValue);
+	mDistinctValues.add(hashBits(newBits));
+
+	auto sampleIterator = mRowIndexToSample.find(rowIndex);
+	if (sampleIterator != mRowIndexToSample.end()) {
+		mSample[sampleIterator->second] = newValue;
+		mHistogramValid = false;
+	}
+}
+
+ColumnType ColumnStatistics::type() const {
+	return mType;
+}
+
+std::size_t ColumnStatistics::count() const {
+	return mCount;
+}
+
+double ColumnStatistics::min() const {
+	return mMin;
+}
+
+double ColumnStatistics::max() const {
+	return mMax;
+}
+
+double ColumnStatistics::distinctCount() const {
+	if (mCount == 0) {
+		return 0.0;
+	}
+
+	return std::min(std::max(mDistinctValues.estimate(), 1.0), (double)mCount);
+}
+
+const EquiDepthHistogram& ColumnStatistics::histogram() const {
+	if (!mHistogramValid) {
+		auto sortedSample = mSample;
+		std::sort(sortedSample.begin(), sortedSample.end());
+
+		mHistogram.bounds.clear();
+		if (!sortedSample.empty()) {
+			auto numBuckets = std::min(NUM_HISTOGRAM_BUCKETS, sortedSample.size());
+			mHistogram.min = sortedSample.front();
+			for (std::size_t bucketIndex = 0; bucketIndex < numBuckets; bucketIndex++) {
+				mHistogram.bounds.push_back(sortedSample[(bucketIndex + 1) * sortedSample.size() / numBuckets - 1]);
+			}
+		}
+
+		mHistogramValid = true;
+	}
+
+	return mHistogram;
+}
+
+double ColumnStatistics::estimateSelectivity(CompareOperator op, double value) const {
+	if (mCount == 0) {
+		return 0.0;
+	}
+
+	double equalFraction = 0.0;
+	if (value >= mMin && value <= mMax) {
+		equalFraction = 1.0 / distinctCount();
+	}
+
+	auto lessThanFraction = histogram().fractionLessThan(value);
+
+	double selectivity = 0.0;
+	switch (op) {
+		case CompareOperator::Equal:
+			selectivity = equalFraction;
+			break;
+		case CompareOperator::NotEqual:
+			selectivity = 1.0 - equalFraction;
+			break;
+		case CompareOperator::LessThan:
+			selectivity = lessThanFraction;
+			break;
+		case CompareOperator::LessThanOrEqual:
+			selectivity = lessThanFraction + equalFraction;
+			break;
+		case CompareOperator::GreaterThan:
+			selectivity = 1.0 - lessThanFraction - equalFraction;
+			break;
+		case CompareOperator::GreaterThanOrEqual:
+			selectivity = 1.0 - lessThanFraction;
+			break;
+	}
+
+	return std::min(std::max(selectivity, 0.0), 1.0);
+}
@@ -0,0 +1,170 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "common.h"
+
+/**
+ * Estimates the number of distinct values in a set using HyperLogLog
+ */
+class HyperLogLog {
+private:
+	static constexpr std::size_t REGISTER_BITS = 11;
+	static constexpr std::size_t NUM_REGISTERS = (std::size_t)1 << REGISTER_BITS;
+
+	std::vector<std::uint8_t> mRegisters;
+public:
+	HyperLogLog();
+
+	/**
+	 * Adds the value with the given hash
+	 * @param hash The 64 bits hash of the value
+	 */
+	void add(std::uint64_t hash);
+
+	/**
+	 * Returns the estimated number of distinct values added
+	 */
+	double estimate() const;
+
+	/**
+	 * Removes all the values
+	 */
+	void clear();
+};
+
+/**
+ * Represents an equi-depth histogram, where each bucket holds about the same number of values
+ */
+struct EquiDepthHistogram {
+	// The upper bound of each bucket. The lower bound of the first bucket is the minimum value.
+	std::vector<double> bounds;
+	double min = 0.0;
+
+	/**
+	 * Indicates if the histogram is empty
+	 */
+	bool empty() const;
+
+	/**
+	 * Estimates the fraction of values that are less than the given value
+	 * @param value The value
+	 */
+	double fractionLessThan(double value) const;
+};
+
+/**
+ * Represents statistics about the values of a column.
+ * The statistics are updated incrementally, which means that after updates they are estimates:
+ * the min/max only grow and the distinct count never decreases.
+ */
+class ColumnStatistics {
+private:
+	static constexpr std::size_t SAMPLE_SIZE = 1024;
+	static constexpr std::size_t NUM_HISTOGRAM_BUCKETS = 32;
+
+	ColumnType mType;
+	std::size_t mCount = 0;
+	double mMin = 0.0;
+	double mMax = 0.0;
+
+	HyperLogLog mDistinctValues;
+
+	// Reservoir sample of the values, used to build the histogram
+	std::vector<double> mSample;
+	std::vector<std::size_t> mSampleRowIndices;
+	std::unordered_map<std::size_t, std::size_t> mRowIndexToSample;
+	std::mt19937_64 mRandom;
+
+	mutable EquiDepthHistogram mHistogram;
+	mutable bool mHistogramValid = false;
+
+	template<typename T>
+	static std::uint64_t valueBits(const T& value) {
+		std::uint64_t bits = 0;
+		std::memcpy(&bits, &value, sizeof(T));
+		return bits;
+	}
+
+	static std::uint64_t valueBits(const float& value) {
+		// -0.0 and 0.0 are the same value
+		float normalizedValue = value == 0.0f ? 0.0f : value;
+		std::uint32_t bits = 0;
+		std::memcpy(&bits, &normalizedValue, sizeof(float));
+		return bits;
+	}
+
+	void addValue(double value, std::uint64_t bits, std::size_t rowIndex);
+	void updateValue(double newValue, std::uint64_t newBits, std::size_t rowIndex);
+public:
+	/**
+	 * Creates new statistics for a column
+	 * @param type The type of the column
+	 */
+	explicit ColumnStatistics(ColumnType type);
+
+	/**
+	 * Adds the given value
+	 * @tparam T The type of the value
+	 * @param value The value
+	 * @param rowIndex The row index of the value
+	 */
+	template<typename T>
+	void insert(const T& value, std::size_t rowIndex) {
+		addValue((double)value, valueBits(value), rowIndex);
+	}
+
+	/**
+	 * Updates the given value
+	 * @tparam T The type of the value
+	 * @param oldValue The old value
+	 * @param newValue The new value
+	 * @param rowIndex The row index of the value
+	 */
+	template<typename T>
+	void update(const T& oldValue, const T& newValue, std::size_t rowIndex) {
+		if (valueBits(oldValue) != valueBits(newValue)) {
+			updateValue((double)newValue, valueBits(newValue), rowIndex);
+		}
+	}
+
+	/**
+	 * Returns the type of the column
+	 */
+	ColumnType type() const;
+
+	/**
+	 * Returns the number of values, which is the same as the number of non-null values
+	 */
+	std::size_t count() const;
+
+	/**
+	 * Returns the smallest value. Zero if there are no values.
+	 */
+	double min() const;
+
+	/**
+	 * Returns the largest value. Zero if there are no values.
+	 */
+	double max() const;
+
+	/**
+	 * Returns the estimated number of distinct values
+	 */
+	double distinctCount() const;
+
+	/**
+	 * Returns the histogram, which is rebuilt from the sample if the values have changed
+	 */
+	const EquiDepthHistogram& histogram() const;
+
+	/**
+	 * Estimates the fraction of the values that satisfies a comparison with the given value
+	 * @param op The comparison, where the column is the left hand side
+	 * @param value The value
+	 */
+	double estimateSelectivity(CompareOperator op, double value) const;
+};
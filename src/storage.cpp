@@ -20,6 +20,75 @@ ColumnStorage::ColumnStorage(const ColumnDefinition& column)
 
 }
 
+ColumnStorage::~ColumnStorage() {
+	destroyUnderlyingStorage();
+}
+
+ColumnStorage& ColumnStorage::operator=(ColumnStorage&& other) {
+	if (this != &other) {
+		destroyUnderlyingStorage();
+		mType = other.mType;
+		mUnderlyingStorage = std::move(other.mUnderlyingStorage);
+	}
+
+	return *this;
+}
+
+void ColumnStorage::destroyUnderlyingStorage() {
+	if (mUnderlyingStorage == nullptr) {
+		return;
+	}
+
+	auto handleForType = [&](auto dummy) {
+		using Type = decltype(dummy);
+		delete (UnderlyingColumnStorage<Type>*)mUnderlyingStorage.release();
+	};
+
+	handleGenericType(mType, handleForType);
+}
+
+ColumnStorage ColumnStorage::fromMappedFile(ColumnType type,
+											 std::shared_ptr<MappedFile> mappedFile,
+											 std::size_t offset,
+											 std::size_t numValues) {
+	ColumnStorage storage(type);
+	if (numValues == 0) {
+		return storage;
+	}
+
+	auto values = mappedFile->data() + offset;
+	if (type == ColumnType::Bool) {
+		auto& boolValues = storage.getUnderlyingStorage<bool>();
+		boolValues.reserve(numValues);
+		for (std::size_t i = 0; i < numValues; i++) {
+			boolValues.push_back(values[i] != 0);
+		}
+
+		return storage;
+	}
+
+	auto handleForType = [&](auto dummy) {
+		using Type = decltype(dummy);
+		storage.getUnderlyingStorage<Type>() = UnderlyingColumnStorage<Type>::fromMappedValues(
+			mappedFile,
+			(Type*)values,
+			numValues);
+	};
+
+	handleGenericType(type, handleForType);
+	return storage;
+}
+
+ColumnStorage ColumnStorage::copy() const {
+	ColumnStorage column(mType);
+	handleGenericType(mType, [&](auto dummy) {
+		using Type = decltype(dummy);
+		column.getUnderlyingStorage<Type>() = getUnderlyingStorage<Type>();
+	});
+
+	return column;
+}
+
 ColumnType ColumnStorage::type() const {
 	return mType;
 }
@@ -33,6 +102,10 @@ std::size_t ColumnStorage::size() const {
 	return handleGenericTypeResult(std::size_t, mType, handleForType);
 }
 
+std::size_t ColumnStorage::numSegments() const {
+	return (size() + COLUMN_SEGMENT_SIZE - 1) / COLUMN_SEGMENT_SIZE;
+}
+
 QueryValue ColumnStorage::getValue(std::size_t index) const {
 	auto handleForType = [&](auto dummy) {
 		using Type = decltype(dummy);
@@ -1,12 +1,686 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
 #include "common.h"
+#include "mapped_file.h"
+#include "column_encoding.h"
 
 struct ColumnDefinition;
 
+/**
+ * The number of rows in a column segment
+ */
+constexpr std::size_t COLUMN_SEGMENT_SIZE = 64 * 1024;
+
+/**
+ * Represents rows of a column within one segment, where each segment holds COLUMN_SEGMENT_SIZE rows.
+ * Segments are the unit that columns grow by, that is encoded, and that scan morsels are placed within.
+ */
+struct ColumnSegment {
+	std::size_t index;
+	std::size_t startRowIndex;
+	std::size_t endRowIndex;
+};
+
+/**
+ * Stores the values of a column in segments of COLUMN_SEGMENT_SIZE values that are allocated separately.
+ * Growing a column allocates new segments, which leaves the values in full segments in place. Only the first segment
+ * grows geometrically until it is full, which keeps small columns small.
+ * The segments can be placed in a mapped file, in which case a segment is copied into memory before values are
+ * appended to it. Resizing a column leaves the new values uninitialized.
+ * Full segments of int32 values in memory can be encoded, which frees their values. Reading an encoded segment decodes
+ * it, while writing to it decodes it back into values until it is encoded again. Segments in a mapped file are read
+ * from it as they are, which keeps opening a database from reading the files.
+ * @tparam T The type of the values
+ */
+template<typename T>
+class SegmentedColumnStorage {
+private:
+	static constexpr std::size_t MIN_FIRST_SEGMENT_SIZE = 16;
+
+	// The values of each segment, which is null when the segment is encoded
+	std::vector<T*> mSegments;
+	std::vector<std::unique_ptr<T[]>> mOwnedSegments;
+	std::vector<std::unique_ptr<EncodedSegment>> mEncodedSegments;
+	std::shared_ptr<MappedFile> mMappedFile;
+	std::size_t mSize = 0;
+	std::size_t mFirstSegmentCapacity = 0;
+
+	// The full segments before this have been encoded, unless their values were stored smaller as they are
+	std::size_t mNumEncodingCheckedSegments = 0;
+	std::vector<std::size_t> mDecodedSegments;
+
+	// Only int32 segments are encoded, which leaves decoding out of the other types when compiled
+	using IsEncodable = std::is_same<T, std::int32_t>;
+
+	std::size_t capacity() const {
+		if (mSegments.size() <= 1) {
+			return mFirstSegmentCapacity;
+		}
+
+		return mSegments.size() * COLUMN_SEGMENT_SIZE;
+	}
+
+	bool isSegmentMapped(std::size_t segmentIndex) const {
+		return mOwnedSegments[segmentIndex] == nullptr && mEncodedSegments[segmentIndex] == nullptr;
+	}
+
+	void addSegment(T* values) {
+		mSegments.push_back(values);
+		mOwnedSegments.emplace_back();
+		mEncodedSegments.emplace_back();
+	}
+
+	void addSegment(std::unique_ptr<T[]> values) {
+		addSegment(values.get());
+		mOwnedSegments.back() = std::move(values);
+	}
+
+	/**
+	 * Moves the first segment into an owned segment of the given capacity
+	 * @param newCapacity The new capacity
+	 */
+	void reallocateFirstSegment(std::size_t newCapacity) {
+		std::unique_ptr<T[]> newSegment(new T[newCapacity]);
+		if (!mSegments.empty()) {
+			std::copy(mSegments[0], mSegments[0] + std::min(mSize, newCapacity), newSegment.get());
+			mSegments[0] = newSegment.get();
+			mOwnedSegments[0] = std::move(newSegment);
+		} else {
+			addSegment(std::move(newSegment));
+		}
+
+		mFirstSegmentCapacity = newCapacity;
+	}
+
+	/**
+	 * Copies the last segment into memory if it is mapped and not full, as values are then appended to it
+	 */
+	void ownPartialSegment() {
+		auto segmentIndex = mSize / COLUMN_SEGMENT_SIZE;
+		if (mSize % COLUMN_SEGMENT_SIZE == 0 || !isSegmentMapped(segmentIndex)) {
+			return;
+		}
+
+		if (segmentIndex == 0) {
+			reallocateFirstSegment(mFirstSegmentCapacity);
+			return;
+		}
+
+		std::unique_ptr<T[]> newSegment(new T[COLUMN_SEGMENT_SIZE]);
+		std::copy(mSegments[segmentIndex], mSegments[segmentIndex] + mSize % COLUMN_SEGMENT_SIZE, newSegment.get());
+		mSegments[segmentIndex] = newSegment.get();
+		mOwnedSegments[segmentIndex] = std::move(newSegment);
+	}
+
+	/**
+	 * Returns the values of the given segment to write to. An encoded segment is decoded back into values first,
+	 * which are encoded again by the next call to encodeFullSegments.
+	 * @param segmentIndex The segment
+	 */
+	T* writableSegment(std::size_t segmentIndex) {
+		return writableSegment(segmentIndex, IsEncodable());
+	}
+
+	T* writableSegment(std::size_t segmentIndex, std::false_type) {
+		return mSegments[segmentIndex];
+	}
+
+	T* writableSegment(std::size_t segmentIndex, std::true_type) {
+		auto& encodedSegment = mEncodedSegments[segmentIndex];
+		if (encodedSegment != nullptr) {
+			std::unique_ptr<T[]> newSegment(new T[COLUMN_SEGMENT_SIZE]);
+			encodedSegment->decode(0, encodedSegment->numRows, newSegment.get());
+			mSegments[segmentIndex] = newSegment.get();
+			mOwnedSegments[segmentIndex] = std::move(newSegment);
+			encodedSegment.reset();
+			mDecodedSegments.push_back(segmentIndex);
+		}
+
+		return mSegments[segmentIndex];
+	}
+
+	T valueAt(std::size_t index, std::false_type) const {
+		return mSegments[index / COLUMN_SEGMENT_SIZE][index % COLUMN_SEGMENT_SIZE];
+	}
+
+	T valueAt(std::size_t index, std::true_type) const {
+		auto values = mSegments[index / COLUMN_SEGMENT_SIZE];
+		if (values != nullptr) {
+			return values[index % COLUMN_SEGMENT_SIZE];
+		}
+
+		return mEncodedSegments[index / COLUMN_SEGMENT_SIZE]->decode(index % COLUMN_SEGMENT_SIZE);
+	}
+
+	/**
+	 * Returns the given values within one segment, where the values of an encoded segment are decoded into the buffer
+	 * @param index The first value
+	 * @param count The number of values
+	 * @param buffer The buffer, which is allocated with the given size when first needed
+	 * @param bufferSize The number of values that the buffer holds
+	 */
+	const T* readableValues(std::size_t index,
+							std::size_t count,
+							std::unique_ptr<T[]>& buffer,
+							std::size_t bufferSize,
+							std::false_type) const {
+		return mSegments[index / COLUMN_SEGMENT_SIZE] + index % COLUMN_SEGMENT_SIZE;
+	}
+
+	const T* readableValues(std::size_t index,
+							std::size_t count,
+							std::unique_ptr<T[]>& buffer,
+							std::size_t bufferSize,
+							std::true_type) const {
+		auto values = mSegments[index / COLUMN_SEGMENT_SIZE];
+		if (values != nullptr) {
+			return values + index % COLUMN_SEGMENT_SIZE;
+		}
+
+		if (buffer == nullptr) {
+			buffer.reset(new T[bufferSize]);
+		}
+
+		mEncodedSegments[index / COLUMN_SEGMENT_SIZE]->decode(index % COLUMN_SEGMENT_SIZE, count, buffer.get());
+		return buffer.get();
+	}
+
+	/**
+	 * Copies the segments of the given storage, which this must not have any
+	 * @param other The storage
+	 */
+	void copyFrom(const SegmentedColumnStorage& other) {
+		for (std::size_t segmentIndex = 0; segmentIndex < other.numSegments(); segmentIndex++) {
+			auto& encodedSegment = other.mEncodedSegments[segmentIndex];
+			if (encodedSegment != nullptr) {
+				addSegment(nullptr);
+				mEncodedSegments.back() = std::make_unique<EncodedSegment>(*encodedSegment);
+				continue;
+			}
+
+			auto values = other.mSegments[segmentIndex];
+			auto count = std::min(COLUMN_SEGMENT_SIZE, other.mSize - segmentIndex * COLUMN_SEGMENT_SIZE);
+			std::unique_ptr<T[]> newSegment(new T[other.mSize > COLUMN_SEGMENT_SIZE ? COLUMN_SEGMENT_SIZE : count]);
+			std::copy(values, values + count, newSegment.get());
+			addSegment(std::move(newSegment));
+		}
+
+		mSize = other.mSize;
+		mFirstSegmentCapacity = std::min(mSize, COLUMN_SEGMENT_SIZE);
+		mNumEncodingCheckedSegments = other.mNumEncodingCheckedSegments;
+		mDecodedSegments = other.mDecodedSegments;
+	}
+
+	/**
+	 * Encodes the given full segment, unless it is mapped or its values are stored smaller as they are
+	 * @param segmentIndex The segment
+	 */
+	void encodeSegment(std::size_t segmentIndex) {
+		auto values = mSegments[segmentIndex];
+		if (values == nullptr || isSegmentMapped(segmentIndex)) {
+			return;
+		}
+
+		auto encodedSegment = std::make_unique<EncodedSegment>(EncodedSegment::encode(values, COLUMN_SEGMENT_SIZE));
+		if (encodedSegment->encoding == SegmentEncoding::Plain) {
+			return;
+		}
+
+		mSegments[segmentIndex] = nullptr;
+		mOwnedSegments[segmentIndex].reset();
+		mEncodedSegments[segmentIndex] = std::move(encodedSegment);
+	}
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+
+	/**
+	 * Iterates over the values of the storage
+	 */
+	class const_iterator {
+	private:
+		const SegmentedColumnStorage* mStorage = nullptr;
+		std::size_t mIndex = 0;
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const T*;
+		using reference = T;
+
+		const_iterator() = default;
+
+		const_iterator(const SegmentedColumnStorage* storage, std::size_t index)
+			: mStorage(storage), mIndex(index) {
+
+		}
+
+		reference operator*() const { return (*mStorage)[mIndex]; }
+		reference operator[](difference_type offset) const { return (*mStorage)[mIndex + offset]; }
+
+		const_iterator& operator++() { mIndex++; return *this; }
+		const_iterator operator++(int) { auto copy = *this; mIndex++; return copy; }
+		const_iterator& operator--() { mIndex--; return *this; }
+		const_iterator operator--(int) { auto copy = *this; mIndex--; return copy; }
+		const_iterator& operator+=(difference_type offset) { mIndex += offset; return *this; }
+		const_iterator& operator-=(difference_type offset) { mIndex -= offset; return *this; }
+		const_iterator operator+(difference_type offset) const { return const_iterator(mStorage, mIndex + offset); }
+		const_iterator operator-(difference_type offset) const { return const_iterator(mStorage, mIndex - offset); }
+		difference_type operator-(const const_iterator& other) const { return (difference_type)mIndex - (difference_type)other.mIndex; }
+
+		bool operator==(const const_iterator& other) const { return mIndex == other.mIndex; }
+		bool operator!=(const const_iterator& other) const { return mIndex != other.mIndex; }
+		bool operator<(const const_iterator& other) const { return mIndex < other.mIndex; }
+		bool operator>(const const_iterator& other) const { return mIndex > other.mIndex; }
+		bool operator<=(const const_iterator& other) const { return mIndex <= other.mIndex; }
+		bool operator>=(const const_iterator& other) const { return mIndex >= other.mIndex; }
+
+		/**
+		 * Returns the index of the value
+		 */
+		std::size_t index() const {
+			return mIndex;
+		}
+	};
+
+	SegmentedColumnStorage() = default;
+
+	/**
+	 * Creates storage with the given number of uninitialized values
+	 * @param size The number of values
+	 */
+	explicit SegmentedColumnStorage(std::size_t size) {
+		resize(size);
+	}
+
+	/**
+	 * Creates storage with the given number of copies of a value
+	 * @param size The number of values
+	 * @param value The value
+	 */
+	SegmentedColumnStorage(std::size_t size, const T& value) {
+		resize(size);
+		forEachWritableSegment(0, size, [&](T* values, std::size_t startIndex, std::size_t count) {
+			std::fill(values, values + count, value);
+		});
+	}
+
+	/**
+	 * Creates storage with a copy of the given values
+	 * @param first The first value
+	 * @param last The value after the last value
+	 */
+	template<typename InputIterator, typename = typename std::iterator_traits<InputIterator>::iterator_category>
+	SegmentedColumnStorage(InputIterator first, InputIterator last) {
+		for (; first != last; ++first) {
+			push_back(*first);
+		}
+	}
+
+	/**
+	 * Copies of a column are never placed in the mapped file, while encoded segments are copied as they are
+	 */
+	SegmentedColumnStorage(const SegmentedColumnStorage& other) {
+		copyFrom(other);
+	}
+
+	SegmentedColumnStorage& operator=(const SegmentedColumnStorage& other) {
+		if (this != &other) {
+			clear();
+			copyFrom(other);
+		}
+
+		return *this;
+	}
+
+	SegmentedColumnStorage(SegmentedColumnStorage&& other) noexcept {
+		swap(other);
+	}
+
+	SegmentedColumnStorage& operator=(SegmentedColumnStorage&& other) noexcept {
+		if (this != &other) {
+			SegmentedColumnStorage empty;
+			swap(empty);
+			swap(other);
+		}
+
+		return *this;
+	}
+
+	/**
+	 * Creates storage whose values are in the given mapped file
+	 * @param mappedFile The mapped file
+	 * @param values The values in the mapped file
+	 * @param numValues The number of values
+	 */
+	static SegmentedColumnStorage fromMappedValues(std::shared_ptr<MappedFile> mappedFile, T* values, std::size_t numValues) {
+		SegmentedColumnStorage storage;
+		for (std::size_t startIndex = 0; startIndex < numValues; startIndex += COLUMN_SEGMENT_SIZE) {
+			storage.addSegment(values + startIndex);
+		}
+
+		storage.mMappedFile = std::move(mappedFile);
+		storage.mSize = numValues;
+		storage.mFirstSegmentCapacity = std::min(numValues, COLUMN_SEGMENT_SIZE);
+		return storage;
+	}
+
+	/**
+	 * Returns the number of values
+	 */
+	std::size_t size() const {
+		return mSize;
+	}
+
+	/**
+	 * Indicates if there are no values
+	 */
+	bool empty() const {
+		return mSize == 0;
+	}
+
+	/**
+	 * Returns the number of segments that hold values
+	 */
+	std::size_t numSegments() const {
+		return (mSize + COLUMN_SEGMENT_SIZE - 1) / COLUMN_SEGMENT_SIZE;
+	}
+
+	/**
+	 * Returns the number of segments that are placed in a mapped file
+	 */
+	std::size_t numMappedSegments() const {
+		std::size_t numMapped = 0;
+		for (std::size_t segmentIndex = 0; segmentIndex < numSegments(); segmentIndex++) {
+			if (isSegmentMapped(segmentIndex)) {
+				numMapped++;
+			}
+		}
+
+		return numMapped;
+	}
+
+	/**
+	 * Returns the given segment if it is encoded, otherwise null
+	 * @param segmentIndex The segment
+	 */
+	const EncodedSegment* encodedSegment(std::size_t segmentIndex) const {
+		return mEncodedSegments[segmentIndex].get();
+	}
+
+	/**
+	 * Returns the values of the given segment, which is null if it is encoded
+	 * @param segmentIndex The segment
+	 */
+	const T* segmentValues(std::size_t segmentIndex) const {
+		return mSegments[segmentIndex];
+	}
+
+	/**
+	 * Returns the number of bytes used by the values, where mapped values are not counted
+	 */
+	std::size_t numBytes() const {
+		std::size_t numBytes = 0;
+		for (std::size_t segmentIndex = 0; segmentIndex < mSegments.size(); segmentIndex++) {
+			if (mEncodedSegments[segmentIndex] != nullptr) {
+				numBytes += mEncodedSegments[segmentIndex]->numBytes();
+			} else if (mOwnedSegments[segmentIndex] != nullptr) {
+				numBytes += (segmentIndex == 0 ? mFirstSegmentCapacity : COLUMN_SEGMENT_SIZE) * sizeof(T);
+			}
+		}
+
+		return numBytes;
+	}
+
+	T operator[](std::size_t index) const {
+		return valueAt(index, IsEncodable());
+	}
+
+	T at(std::size_t index) const {
+		if (index >= mSize) {
+			throw std::out_of_range("The index is out of range.");
+		}
+
+		return (*this)[index];
+	}
+
+	T front() const {
+		return (*this)[0];
+	}
+
+	T back() const {
+		return (*this)[mSize - 1];
+	}
+
+	const_iterator begin() const {
+		return const_iterator(this, 0);
+	}
+
+	const_iterator end() const {
+		return const_iterator(this, mSize);
+	}
+
+	/**
+	 * Sets the value at the given index, which decodes its segment if it is encoded
+	 * @param index The index
+	 * @param value The value
+	 */
+	void set(std::size_t index, const T& value) {
+		writableSegment(index / COLUMN_SEGMENT_SIZE)[index % COLUMN_SEGMENT_SIZE] = value;
+	}
+
+	/**
+	 * Makes room for the given number of values. Segments after the first are allocated whole.
+	 * @param newCapacity The number of values
+	 */
+	void reserve(std::size_t newCapacity) {
+		if (newCapacity <= capacity()) {
+			return;
+		}
+
+		if (mSegments.size() <= 1 && mFirstSegmentCapacity < COLUMN_SEGMENT_SIZE) {
+			reallocateFirstSegment(std::min(newCapacity, COLUMN_SEGMENT_SIZE));
+		}
+
+		while (capacity() < newCapacity) {
+			std::unique_ptr<T[]> newSegment(new T[COLUMN_SEGMENT_SIZE]);
+			addSegment(std::move(newSegment));
+		}
+	}
+
+	/**
+	 * Changes the number of values, where new values are uninitialized
+	 * @param newSize The number of values
+	 */
+	void resize(std::size_t newSize) {
+		if (newSize > mSize) {
+			if (mMappedFile != nullptr) {
+				ownPartialSegment();
+			}
+
+			reserve(newSize);
+		} else if (newSize % COLUMN_SEGMENT_SIZE != 0) {
+			// Values are appended to the last segment, which is then no longer full
+			writableSegment(newSize / COLUMN_SEGMENT_SIZE);
+		}
+
+		mSize = newSize;
+		mNumEncodingCheckedSegments = std::min(mNumEncodingCheckedSegments, mSize / COLUMN_SEGMENT_SIZE);
+	}
+
+	void push_back(const T& value) {
+		if (mSize == capacity()) {
+			if (mSegments.size() <= 1 && mFirstSegmentCapacity < COLUMN_SEGMENT_SIZE) {
+				reallocateFirstSegment(std::min(std::max(2 * mFirstSegmentCapacity, MIN_FIRST_SEGMENT_SIZE), COLUMN_SEGMENT_SIZE));
+			} else {
+				reserve(mSize + 1);
+			}
+		} else if (mMappedFile != nullptr) {
+			ownPartialSegment();
+		}
+
+		mSegments[mSize / COLUMN_SEGMENT_SIZE][mSize % COLUMN_SEGMENT_SIZE] = value;
+		mSize++;
+	}
+
+	/**
+	 * Appends the given values
+	 * @param values The values
+	 * @param count The number of values
+	 */
+	void append(const T* values, std::size_t count) {
+		auto startIndex = mSize;
+		resize(mSize + count);
+		forEachWritableSegment(startIndex, mSize, [&](T* segmentValues, std::size_t segmentStartIndex, std::size_t segmentCount) {
+			std::copy(values + (segmentStartIndex - startIndex), values + (segmentStartIndex - startIndex) + segmentCount, segmentValues);
+		});
+	}
+
+	/**
+	 * Appends the values in the given storage
+	 * @param other The storage
+	 */
+	void append(const SegmentedColumnStorage& other) {
+		reserve(mSize + other.size());
+		other.forEachSegment(0, other.size(), [&](const T* values, std::size_t startIndex, std::size_t count) {
+			append(values, count);
+		});
+	}
+
+	/**
+	 * Removes the values in the given range, moving the values after it
+	 * @param first The first value to remove
+	 * @param last The value after the last value to remove
+	 */
+	void erase(const_iterator first, const_iterator last) {
+		auto numRemoved = last.index() - first.index();
+		if (numRemoved == 0) {
+			return;
+		}
+
+		for (auto index = last.index(); index < mSize; index++) {
+			set(index - numRemoved, (*this)[index]);
+		}
+
+		resize(mSize - numRemoved);
+	}
+
+	/**
+	 * Removes all values and frees the segments
+	 */
+	void clear() {
+		mSegments.clear();
+		mOwnedSegments.clear();
+		mEncodedSegments.clear();
+		mMappedFile.reset();
+		mSize = 0;
+		mFirstSegmentCapacity = 0;
+		mNumEncodingCheckedSegments = 0;
+		mDecodedSegments.clear();
+	}
+
+	void swap(SegmentedColumnStorage& other) noexcept {
+		mSegments.swap(other.mSegments);
+		mOwnedSegments.swap(other.mOwnedSegments);
+		mEncodedSegments.swap(other.mEncodedSegments);
+		mMappedFile.swap(other.mMappedFile);
+		std::swap(mSize, other.mSize);
+		std::swap(mFirstSegmentCapacity, other.mFirstSegmentCapacity);
+		std::swap(mNumEncodingCheckedSegments, other.mNumEncodingCheckedSegments);
+		mDecodedSegments.swap(other.mDecodedSegments);
+	}
+
+	/**
+	 * Encodes the full segments in memory that are new or have been written to since they were encoded.
+	 * This only exists for int32 values, and must not be done while the values are being read.
+	 */
+	template<typename U = T, typename = typename std::enable_if<std::is_same<U, std::int32_t>::value>::type>
+	void encodeFullSegments() {
+		auto numFullSegments = mSize / COLUMN_SEGMENT_SIZE;
+		for (auto segmentIndex : mDecodedSegments) {
+			if (segmentIndex < numFullSegments) {
+				encodeSegment(segmentIndex);
+			}
+		}
+
+		for (; mNumEncodingCheckedSegments < numFullSegments; mNumEncodingCheckedSegments++) {
+			encodeSegment(mNumEncodingCheckedSegments);
+		}
+
+		mDecodedSegments.clear();
+	}
+
+	/**
+	 * Applies the given function on the values of each segment that overlaps the given range, which are contiguous.
+	 * Encoded segments are decoded into a buffer that is only valid during the call.
+	 * @param startIndex The first value
+	 * @param endIndex The value after the last value
+	 * @param applyValues Function that takes the values, the index of the first value and the number of values
+	 */
+	template<typename F>
+	void forEachSegment(std::size_t startIndex, std::size_t endIndex, F applyValues) const {
+		std::unique_ptr<T[]> decodedValues;
+		for (auto index = startIndex; index < endIndex;) {
+			auto segmentIndex = index / COLUMN_SEGMENT_SIZE;
+			auto segmentEndIndex = std::min((segmentIndex + 1) * COLUMN_SEGMENT_SIZE, endIndex);
+			auto values = readableValues(
+				index,
+				segmentEndIndex - index,
+				decodedValues,
+				std::min(endIndex - startIndex, COLUMN_SEGMENT_SIZE),
+				IsEncodable());
+			applyValues(values, index, segmentEndIndex - index);
+			index = segmentEndIndex;
+		}
+	}
+
+	/**
+	 * Applies the given function on the values of each segment that overlaps the given range, to write them.
+	 * Encoded segments are decoded first.
+	 * @param startIndex The first value
+	 * @param endIndex The value after the last value
+	 * @param applyValues Function that takes the values, the index of the first value and the number of values
+	 */
+	template<typename F>
+	void forEachWritableSegment(std::size_t startIndex, std::size_t endIndex, F applyValues) {
+		for (auto index = startIndex; index < endIndex;) {
+			auto segmentIndex = index / COLUMN_SEGMENT_SIZE;
+			auto segmentEndIndex = std::min((segmentIndex + 1) * COLUMN_SEGMENT_SIZE, endIndex);
+			applyValues(writableSegment(segmentIndex) + index % COLUMN_SEGMENT_SIZE, index, segmentEndIndex - index);
+			index = segmentEndIndex;
+		}
+	}
+};
+
+template<typename T>
+constexpr std::size_t SegmentedColumnStorage<T>::MIN_FIRST_SEGMENT_SIZE;
+
+template<typename T>
+using UnderlyingColumnStorage = SegmentedColumnStorage<T>;
+
 template<typename T>
-using UnderlyingColumnStorage = std::vector<T>;
+bool operator==(const UnderlyingColumnStorage<T>& lhs, const std::vector<T>& rhs) {
+	return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template<typename T>
+bool operator==(const std::vector<T>& lhs, const UnderlyingColumnStorage<T>& rhs) {
+	return rhs == lhs;
+}
+
+template<typename T>
+bool operator!=(const UnderlyingColumnStorage<T>& lhs, const std::vector<T>& rhs) {
+	return !(lhs == rhs);
+}
+
+template<typename T>
+bool operator!=(const std::vector<T>& lhs, const UnderlyingColumnStorage<T>& rhs) {
+	return !(rhs == lhs);
+}
 
 /**
  * Represents the storage of a column
@@ -15,6 +689,8 @@ class ColumnStorage {
 private:
 	ColumnType mType;
 	std::unique_ptr<std::uint8_t[]> mUnderlyingStorage;
+
+	void destroyUnderlyingStorage();
 public:
 	/**
 	 * Creates new storage for a column of the given type
@@ -28,11 +704,18 @@ public:
 	 */
 	explicit ColumnStorage(const ColumnDefinition& column);
 
+	~ColumnStorage();
+
 	ColumnStorage(const ColumnStorage&) = delete;
 	ColumnStorage& operator=(const ColumnStorage&) = delete;
 
 	ColumnStorage(ColumnStorage&&) = default;
-	ColumnStorage& operator=(ColumnStorage&&) = default;
+	ColumnStorage& operator=(ColumnStorage&& other);
+
+	/**
+	 * Returns a copy of the values, which is stored in memory even if the values are mapped
+	 */
+	ColumnStorage copy() const;
 
 	/**
 	 * Returns the type of the column
@@ -44,12 +727,48 @@ public:
 	 */
 	std::size_t size() const;
 
+	/**
+	 * Returns the number of segments
+	 */
+	std::size_t numSegments() const;
+
+	/**
+	 * Applies the given function on each segment that overlaps the given rows, with the segment limited to the rows
+	 * @param startRowIndex The first row
+	 * @param endRowIndex The row after the last row
+	 * @param applySegment Function that takes the segment
+	 */
+	template<typename F>
+	static void forEachSegment(std::size_t startRowIndex, std::size_t endRowIndex, F applySegment) {
+		for (auto rowIndex = startRowIndex; rowIndex < endRowIndex;) {
+			ColumnSegment segment;
+			segment.index = rowIndex / COLUMN_SEGMENT_SIZE;
+			segment.startRowIndex = rowIndex;
+			segment.endRowIndex = std::min((segment.index + 1) * COLUMN_SEGMENT_SIZE, endRowIndex);
+			applySegment(segment);
+			rowIndex = segment.endRowIndex;
+		}
+	}
+
 	/**
 	 * Returns the value at the given index
 	 * @param index The index
 	 */
 	QueryValue getValue(std::size_t index) const;
 
+	/**
+	 * Creates storage for a column whose values are in the given mapped file. The values are used without reading them,
+	 * except for bool columns which are stored as one byte per value.
+	 * @param type The type
+	 * @param mappedFile The mapped file
+	 * @param offset The offset of the first value in the file
+	 * @param numValues The number of values
+	 */
+	static ColumnStorage fromMappedFile(ColumnType type,
+										std::shared_ptr<MappedFile> mappedFile,
+										std::size_t offset,
+										std::size_t numValues);
+
 	/**
 	 * Create underlying storage for the given type
 	 * @param type The type of the data
@@ -16,7 +16,25 @@ std::size_t ColumnDefinition::index() const {
 	return mIndex;
 }
 
-Schema::Schema(const std::string& name, std::vector<ColumnDefinition> columns, std::vector<std::string> indices)
+IndexDefinition::IndexDefinition(const std::string& column, IndexType type)
+	: mColumn(column), mType(type) {
+
+}
+
+IndexDefinition::IndexDefinition(const char* column, IndexType type)
+	: mColumn(column), mType(type) {
+
+}
+
+const std::string& IndexDefinition::column() const {
+	return mColumn;
+}
+
+IndexType IndexDefinition::type() const {
+	return mType;
+}
+
+Schema::Schema(const std::string& name, std::vector<ColumnDefinition> columns, std::vector<IndexDefinition> indices)
 	: mName(name), mColumns(std::move(columns)), mIndices(std::move(indices)) {
 
 }
@@ -35,7 +53,7 @@ const ColumnDefinition& Schema::getDefinition(const std::string& name) const {
 	throw std::runtime_error("Element not found.");
 }
 
-const std::vector<std::string>& Schema::indices() const {
+const std::vector<IndexDefinition>& Schema::indices() const {
 	return mIndices;
 }
 
@@ -43,14 +61,28 @@ const std::vector<ColumnDefinition>& Schema::columns() const {
 	return mColumns;
 }
 
+ColumnUpdate::ColumnUpdate(const ColumnDefinition& column)
+	: column(column.name()), values(column.type()) {
+
+}
+
 Table::Table(Schema schema)
 	: mSchema(std::move(schema)) {
-	for (auto& indexColumn : mSchema.indices()) {
-		mIndices.push_back(std::make_unique<TreeIndex>(mSchema, mSchema.getDefinition(indexColumn)));
+	for (auto& index : mSchema.indices()) {
+		auto& column = mSchema.getDefinition(index.column());
+		switch (index.type()) {
+			case IndexType::Tree:
+				mIndices.push_back(std::make_unique<TreeIndex>(mSchema, column));
+				break;
+			case IndexType::Hash:
+				mHashIndices.push_back(std::make_unique<HashIndex>(mSchema, column));
+				break;
+		}
 	}
 
 	for (auto& column : mSchema.columns()) {
 		mColumnsStorage.emplace(column.name(), ColumnStorage(column));
+		mColumnStatistics.emplace(column.name(), ColumnStatistics(column.type()));
 	}
 
 	for (auto& column : mSchema.columns()) {
@@ -66,10 +98,120 @@ const std::vector<std::unique_ptr<TreeIndex>>& Table::indices() const {
 	return mIndices;
 }
 
+const std::vector<std::unique_ptr<HashIndex>>& Table::hashIndices() const {
+	return mHashIndices;
+}
+
 std::size_t Table::numRows() const {
 	return mColumnsStorage.begin()->second.size();
 }
 
+void Table::applyUpdate(const ColumnUpdate& update) {
+	auto& column = mColumnsStorage.at(update.column);
+	if (update.values.type() != column.type() || update.values.size() != update.rowIndices.size()) {
+		throw std::runtime_error("Invalid update.");
+	}
+
+	handleGenericType(column.type(), [&](auto dummy) {
+		using Type = decltype(dummy);
+		auto& values = column.getUnderlyingStorage<Type>();
+		auto& newValues = update.values.getUnderlyingStorage<Type>();
+		for (std::size_t i = 0; i < update.rowIndices.size(); i++) {
+			auto rowIndex = update.rowIndices[i];
+			if (rowIndex >= values.size()) {
+				throw std::runtime_error("Invalid update.");
+			}
+
+			Type oldValue = values[rowIndex];
+			Type newValue = newValues[i];
+			updateIndices(update.column, oldValue, newValue, rowIndex);
+			values.set(rowIndex, newValue);
+		}
+	});
+
+	encodeColumns();
+}
+
+ColumnStatistics& Table::caughtUpStatistics(const std::string& name) const {
+	auto& statistics = mColumnStatistics.at(name);
+	auto& column = mColumnsStorage.at(name);
+
+	handleGenericType(column.type(), [&](auto dummy) {
+		using Type = decltype(dummy);
+		auto& values = column.getUnderlyingStorage<Type>();
+		for (auto rowIndex = statistics.count(); rowIndex < values.size(); rowIndex++) {
+			statistics.insert((Type)values[rowIndex], rowIndex);
+		}
+	});
+
+	return statistics;
+}
+
+ColumnStatistics Table::statistics(const std::string& name) const {
+	std::lock_guard<std::mutex> guard(mStatisticsMutex);
+	return caughtUpStatistics(name);
+}
+
+double Table::estimateSelectivity(const std::string& name, CompareOperator op, double value) const {
+	std::lock_guard<std::mutex> guard(mStatisticsMutex);
+	return caughtUpStatistics(name).estimateSelectivity(op, value);
+}
+
+void Table::encodeColumns() {
+	for (auto& column : mColumnIndexToStorage) {
+		if (column->type() == ColumnType::Int32) {
+			column->getUnderlyingStorage<std::int32_t>().encodeFullSegments();
+		}
+	}
+}
+
+void Table::appendColumns(std::vector<ColumnStorage> columns) {
+	auto& columnDefinitions = mSchema.columns();
+	if (columns.size() != columnDefinitions.size()) {
+		throw std::runtime_error("Wrong number of columns.");
+	}
+
+	for (std::size_t columnIndex = 0; columnIndex < columns.size(); columnIndex++) {
+		if (columns[columnIndex].type() != columnDefinitions[columnIndex].type()) {
+			throw std::runtime_error("Wrong type.");
+		}
+
+		if (columns[columnIndex].size() != columns[0].size()) {
+			throw std::runtime_error("Wrong number of values.");
+		}
+	}
+
+	auto firstRowIndex = numRows();
+	for (std::size_t columnIndex = 0; columnIndex < columns.size(); columnIndex++) {
+		auto& column = columnDefinitions[columnIndex];
+
+		handleGenericType(column.type(), [&](auto dummy) {
+			using Type = decltype(dummy);
+			auto& values = mColumnIndexToStorage[columnIndex]->getUnderlyingStorage<Type>();
+			auto& newValues = columns[columnIndex].getUnderlyingStorage<Type>();
+			if (values.empty()) {
+				values.swap(newValues);
+			} else {
+				values.append(newValues);
+			}
+
+			for (auto& index : mIndices) {
+				if (index->column().name() == column.name()) {
+					index->insertAll(values, firstRowIndex);
+				}
+			}
+
+			for (auto& index : mHashIndices) {
+				if (index->column().name() == column.name()) {
+					index->insertAll(values, firstRowIndex);
+				}
+			}
+		});
+	}
+
+	encodeColumns();
+}
+
 ColumnStorage& Table::getColumn(const std::string& name) {
 	return mColumnsStorage.at(name);
 }
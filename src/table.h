@@ -3,10 +3,13 @@
 #include <vector>
 #include <memory>
 #include <unordered_map>
+#include <mutex>
 
 #include "storage.h"
 #include "common.h"
 #include "indices.h"
+#include "statistics.h"
+#include "column_encoding.h"
 
 /**
  * Represents a column in a database schema
@@ -41,6 +44,39 @@ public:
 	std::size_t index() const;
 };
 
+/**
+ * Represents the definition of an index in a database schema
+ */
+class IndexDefinition {
+private:
+	std::string mColumn;
+	IndexType mType;
+public:
+	/**
+	 * Creates a new index definition
+	 * @param column The name of the column to index on
+	 * @param type The type of the index
+	 */
+	IndexDefinition(const std::string& column, IndexType type = IndexType::Tree);
+
+	/**
+	 * Creates a new index definition
+	 * @param column The name of the column to index on
+	 * @param type The type of the index
+	 */
+	IndexDefinition(const char* column, IndexType type = IndexType::Tree);
+
+	/**
+	 * Returns the name of the column being indexed on
+	 */
+	const std::string& column() const;
+
+	/**
+	 * Returns the type of the index
+	 */
+	IndexType type() const;
+};
+
 /**
  * Represents the schema for a database table
  */
@@ -48,7 +84,7 @@ class Schema {
 private:
 	std::string mName;
 	std::vector<ColumnDefinition> mColumns;
-	std::vector<std::string> mIndices;
+	std::vector<IndexDefinition> mIndices;
 public:
 	/**
 	 * Creates a new schema
@@ -56,7 +92,7 @@ public:
 	 * @param columns The columns
 	 * @param indices The indices
 	 */
-	Schema(const std::string& name, std::vector<ColumnDefinition> columns, std::vector<std::string> indices);
+	Schema(const std::string& name, std::vector<ColumnDefinition> columns, std::vector<IndexDefinition> indices);
 	
 	/**
 	 * Returns the name of the schema
@@ -77,7 +113,22 @@ public:
 	/**
 	 * Returns the indices
 	 */
-	const std::vector<std::string>& indices() const;
+	const std::vector<IndexDefinition>& indices() const;
+};
+
+/**
+ * The new values of a column for some of its rows
+ */
+struct ColumnUpdate {
+	std::string column;
+	std::vector<std::size_t> rowIndices;
+	ColumnStorage values;
+
+	/**
+	 * Creates a new update without any rows
+	 * @param column The column being updated
+	 */
+	explicit ColumnUpdate(const ColumnDefinition& column);
 };
 
 /**
@@ -90,6 +141,18 @@ private:
 	std::vector<ColumnStorage*> mColumnIndexToStorage;
 
 	std::vector<std::unique_ptr<TreeIndex>> mIndices;
+	std::vector<std::unique_ptr<HashIndex>> mHashIndices;
+
+	// The statistics of a column can be behind its values, in which case they are caught up when used.
+	// They are read by concurrent queries while being written by inserts and updates, which both hold the mutex.
+	mutable std::unordered_map<std::string, ColumnStatistics> mColumnStatistics;
+	mutable std::mutex mStatisticsMutex;
+
+	/**
+	 * Returns the statistics for the given column, caught up with its values. The statistics mutex must be held.
+	 * @param name The name of the column
+	 */
+	ColumnStatistics& caughtUpStatistics(const std::string& name) const;
 public:
 	/**
 	 * Creates a new table
@@ -106,15 +169,40 @@ public:
 	const Schema& schema() const;
 
 	/**
-	 * Returns the indices
+	 * Returns the tree indices
 	 */
 	const std::vector<std::unique_ptr<TreeIndex>>& indices() const;
 
+	/**
+	 * Returns the hash indices
+	 */
+	const std::vector<std::unique_ptr<HashIndex>>& hashIndices() const;
+
 	/**
 	 * Returns the number of rows in the table
 	 */
 	std::size_t numRows() const;
 
+	/**
+	 * Returns a copy of the statistics for the given column
+	 * @param name The name of the column
+	 */
+	ColumnStatistics statistics(const std::string& name) const;
+
+	/**
+	 * Estimates the fraction of the rows of the given column that match the given comparison
+	 * @param name The name of the column
+	 * @param op The operator
+	 * @param value The value to compare with
+	 */
+	double estimateSelectivity(const std::string& name, CompareOperator op, double value) const;
+
+	/**
+	 * Encodes the full segments of the int32 columns that are new or have been written to since they were encoded.
+	 * This is done by the inserts and updates, which must not run at the same time as queries read the columns.
+	 */
+	void encodeColumns();
+
 	/**
 	 * Inserts a new entry for a column into the table
 	 * @tparam T The type of the data
@@ -125,15 +213,40 @@ public:
 	void insertColumn(const std::string& name, T value) {
 		auto& columnStorage = mColumnsStorage.at(name);
 		std::size_t rowIndex = columnStorage.size();
-		columnStorage.getUnderlyingStorage<T>().push_back(value);
+		auto& values = columnStorage.getUnderlyingStorage<T>();
+		values.push_back(value);
+		if (values.size() % COLUMN_SEGMENT_SIZE == 0) {
+			encodeColumns();
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(mStatisticsMutex);
+			auto& statistics = mColumnStatistics.at(name);
+			if (statistics.count() == rowIndex) {
+				statistics.insert(value, rowIndex);
+			}
+		}
 
 		for (auto& index : mIndices) {
 			if (index->column().name() == name) {
 				index->insert(value, rowIndex);
 			}
 		}
+
+		for (auto& index : mHashIndices) {
+			if (index->column().name() == name) {
+				index->insert(value, rowIndex);
+			}
+		}
 	}
 
+	/**
+	 * Appends the rows in the given columns to the table, which is much faster than inserting one row at a time.
+	 * The indices are built for the new rows in one batch, while the statistics are built when first used.
+	 * @param columns The columns of the rows, in the order of the schema
+	 */
+	void appendColumns(std::vector<ColumnStorage> columns);
+
 	inline void insertRow() {
 
 	}
@@ -153,7 +266,7 @@ public:
 	}
 
 	/**
-	 * Updates the indices for the given value
+	 * Updates the indices and statistics for the given value
 	 * @tparam T The type of the value
 	 * @param name The name of column
 	 * @param oldValue The old value
@@ -162,13 +275,33 @@ public:
 	 */
 	template<typename T>
 	void updateIndices(const std::string& name, const T& oldValue, const T& newValue, std::size_t rowIndex) {
+		{
+			std::lock_guard<std::mutex> guard(mStatisticsMutex);
+			auto& statistics = mColumnStatistics.at(name);
+			if (rowIndex < statistics.count()) {
+				statistics.update(oldValue, newValue, rowIndex);
+			}
+		}
+
 		for (auto& index : mIndices) {
 			if (index->column().name() == name) {
 				index->update(oldValue, newValue, rowIndex);
 			}
 		}
+
+		for (auto& index : mHashIndices) {
+			if (index->column().name() == name) {
+				index->update(oldValue, newValue, rowIndex);
+			}
+		}
 	}
 
+	/**
+	 * Sets the new values of the given update, and updates the indices and statistics
+	 * @param update The update
+	 */
+	void applyUpdate(const ColumnUpdate& update);
+
 	/**
 	 * Returns the underlying storage for the given column
 	 * @tparam T The type of the column values
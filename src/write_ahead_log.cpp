@@ -0,0 +1,542 @@
+#include "write_ahead_log.h"
+#include "database_engine.h"
+#include "mapped_file.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+	const char WAL_FILE_MAGIC[8] = { 'W', 'A', 'L', 'O', 'G', '\0', '\0', '\0' };
+	constexpr std::uint32_t WAL_FILE_VERSION = 1;
+
+	struct WalFileHeader {
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t reserved;
+		std::uint64_t position;
+	};
+
+	// Each record starts with the size of its payload, the checksum and the type of the record
+	constexpr std::size_t RECORD_HEADER_SIZE = sizeof(std::uint32_t) + sizeof(std::uint32_t) + sizeof(std::uint8_t);
+
+	enum RecordType : std::uint8_t {
+		CREATE_TABLE_RECORD = 1,
+		INSERT_RECORD = 2,
+		UPDATE_RECORD = 3
+	};
+
+	std::uint32_t checksum(std::uint8_t recordType, const std::uint8_t* payload, std::size_t size) {
+		// FNV-1a
+		std::uint32_t hash = 2166136261u;
+		hash = (hash ^ recordType) * 16777619u;
+		for (std::size_t i = 0; i < size; i++) {
+			hash = (hash ^ payload[i]) * 16777619u;
+		}
+
+		return hash;
+	}
+
+	/**
+	 * Encodes the payload of a record
+	 */
+	class RecordWriter {
+	private:
+		std::vector<std::uint8_t> mData;
+
+		void writeBytes(const void* data, std::size_t size) {
+			auto bytes = (const std::uint8_t*)data;
+			mData.insert(mData.end(), bytes, bytes + size);
+		}
+	public:
+		template<typename T>
+		void write(const T& value) {
+			writeBytes(&value, sizeof(T));
+		}
+
+		void writeString(const std::string& value) {
+			write((std::uint32_t)value.size());
+			writeBytes(value.data(), value.size());
+		}
+
+		void writeColumn(const ColumnStorage& column) {
+			write((std::uint8_t)column.type());
+			write((std::uint64_t)column.size());
+
+			// Bool values are stored as one byte per value
+			if (column.type() == ColumnType::Bool) {
+				for (auto value : column.getUnderlyingStorage<bool>()) {
+					write((std::uint8_t)value);
+				}
+
+				return;
+			}
+
+			auto handleForType = [&](auto dummy) {
+				using Type = decltype(dummy);
+				auto& values = column.getUnderlyingStorage<Type>();
+				values.forEachSegment(0, values.size(), [&](const Type* segmentValues, std::size_t startIndex, std::size_t count) {
+					writeBytes(segmentValues, count * sizeof(Type));
+				});
+			};
+
+			handleTypeResult<void>(
+				column.type(),
+				[&]() {},
+				[&]() { handleForType((std::int32_t)0); },
+				[&]() { handleForType((float)0); });
+		}
+
+		const std::vector<std::uint8_t>& data() const {
+			return mData;
+		}
+	};
+
+	/**
+	 * Decodes the payload of a record
+	 */
+	class RecordReader {
+	private:
+		const std::uint8_t* mData;
+		std::size_t mSize;
+		std::size_t mOffset = 0;
+
+		void readBytes(void* data, std::size_t size) {
+			if (size > mSize - mOffset) {
+				throw std::runtime_error("Invalid record in the write-ahead log.");
+			}
+
+			std::memcpy(data, mData + mOffset, size);
+			mOffset += size;
+		}
+	public:
+		RecordReader(const std::uint8_t* data, std::size_t size)
+			: mData(data), mSize(size) {
+
+		}
+
+		template<typename T>
+		T read() {
+			T value;
+			readBytes(&value, sizeof(T));
+			return value;
+		}
+
+		std::string readString() {
+			std::string value(read<std::uint32_t>(), '\0');
+			readBytes(&value[0], value.size());
+			return value;
+		}
+
+		ColumnType readType() {
+			auto type = read<std::uint8_t>();
+			if (type > (std::uint8_t)ColumnType::Float32) {
+				throw std::runtime_error("Invalid record in the write-ahead log.");
+			}
+
+			return (ColumnType)type;
+		}
+
+		ColumnStorage readColumn() {
+			auto type = readType();
+			auto numValues = read<std::uint64_t>();
+
+			ColumnStorage column(type);
+			if (type == ColumnType::Bool) {
+				auto& values = column.getUnderlyingStorage<bool>();
+				for (std::uint64_t i = 0; i < numValues; i++) {
+					values.push_back(read<std::uint8_t>() != 0);
+				}
+
+				return column;
+			}
+
+			auto handleForType = [&](auto dummy) {
+				using Type = decltype(dummy);
+				if (numValues > (mSize - mOffset) / sizeof(Type)) {
+					throw std::runtime_error("Invalid record in the write-ahead log.");
+				}
+
+				auto& values = column.getUnderlyingStorage<Type>();
+				values.resize(numValues);
+				values.forEachWritableSegment(0, values.size(), [&](Type* segmentValues, std::size_t startIndex, std::size_t count) {
+					readBytes(segmentValues, count * sizeof(Type));
+				});
+			};
+
+			handleTypeResult<void>(
+				type,
+				[&]() {},
+				[&]() { handleForType((std::int32_t)0); },
+				[&]() { handleForType((float)0); });
+			return column;
+		}
+	};
+
+	void writeAll(int fileDescriptor, const std::uint8_t* data, std::size_t size) {
+		while (size > 0) {
+			auto numWritten = write(fileDescriptor, data, size);
+			if (numWritten < 0) {
+				throw std::runtime_error("Could not write to the write-ahead log.");
+			}
+
+			data += numWritten;
+			size -= (std::size_t)numWritten;
+		}
+	}
+
+	/**
+	 * Creates a log that starts at the given position with the given records, replacing any existing log
+	 */
+	int createLogFile(const std::string& path, std::uint64_t position, const std::vector<std::uint8_t>& records = {}) {
+		WalFileHeader header = {};
+		std::memcpy(header.magic, WAL_FILE_MAGIC, sizeof(WAL_FILE_MAGIC));
+		header.version = WAL_FILE_VERSION;
+		header.position = position;
+
+		auto temporaryPath = path + ".tmp";
+		auto fileDescriptor = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fileDescriptor == -1) {
+			throw std::runtime_error("Could not create the write-ahead log '" + path + "'.");
+		}
+
+		try {
+			writeAll(fileDescriptor, (const std::uint8_t*)&header, sizeof(header));
+			writeAll(fileDescriptor, records.data(), records.size());
+		} catch (...) {
+			close(fileDescriptor);
+			throw;
+		}
+
+		if (fdatasync(fileDescriptor) != 0 || close(fileDescriptor) != 0 || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+			throw std::runtime_error("Could not create the write-ahead log '" + path + "'.");
+		}
+
+		fileDescriptor = open(path.c_str(), O_WRONLY | O_APPEND);
+		if (fileDescriptor == -1) {
+			throw std::runtime_error("Could not open the write-ahead log '" + path + "'.");
+		}
+
+		return fileDescriptor;
+	}
+
+	void readAll(const std::string& path, std::uint64_t offset, std::vector<std::uint8_t>& data) {
+		auto fileDescriptor = open(path.c_str(), O_RDONLY);
+		if (fileDescriptor == -1) {
+			throw std::runtime_error("Could not read the write-ahead log '" + path + "'.");
+		}
+
+		std::size_t numRead = 0;
+		while (numRead < data.size()) {
+			auto result = pread(fileDescriptor, data.data() + numRead, data.size() - numRead, (off_t)(offset + numRead));
+			if (result <= 0) {
+				close(fileDescriptor);
+				throw std::runtime_error("Could not read the write-ahead log '" + path + "'.");
+			}
+
+			numRead += (std::size_t)result;
+		}
+
+		close(fileDescriptor);
+	}
+
+	void applyRecord(std::uint8_t recordType, RecordReader& reader, DatabaseEngine& databaseEngine) {
+		switch (recordType) {
+			case CREATE_TABLE_RECORD: {
+				auto name = reader.readString();
+				auto schemaName = reader.readString();
+
+				std::vector<ColumnDefinition> columns;
+				auto numColumns = reader.read<std::uint32_t>();
+				for (std::uint32_t i = 0; i < numColumns; i++) {
+					auto columnName = reader.readString();
+					columns.emplace_back(i, columnName, reader.readType());
+				}
+
+				std::vector<IndexDefinition> indices;
+				auto numIndices = reader.read<std::uint32_t>();
+				for (std::uint32_t i = 0; i < numIndices; i++) {
+					auto column = reader.readString();
+					indices.emplace_back(column, reader.read<std::uint8_t>() == 1 ? IndexType::Hash : IndexType::Tree);
+				}
+
+				databaseEngine.addTable(name, std::make_unique<Table>(Schema(schemaName, columns, indices)));
+				break;
+			}
+			case INSERT_RECORD: {
+				auto& table = databaseEngine.getTable(reader.readString());
+
+				std::vector<ColumnStorage> columns;
+				auto numColumns = reader.read<std::uint32_t>();
+				for (std::uint32_t i = 0; i < numColumns; i++) {
+					columns.push_back(reader.readColumn());
+				}
+
+				table.appendColumns(std::move(columns));
+				break;
+			}
+			case UPDATE_RECORD: {
+				auto& table = databaseEngine.getTable(reader.readString());
+
+				auto numUpdates = reader.read<std::uint32_t>();
+				for (std::uint32_t i = 0; i < numUpdates; i++) {
+					ColumnUpdate update(table.schema().getDefinition(reader.readString()));
+					auto numRows = reader.read<std::uint64_t>();
+					for (std::uint64_t row = 0; row < numRows; row++) {
+						update.rowIndices.push_back((std::size_t)reader.read<std::uint64_t>());
+					}
+
+					update.values = reader.readColumn();
+					table.applyUpdate(update);
+				}
+
+				break;
+			}
+			default:
+				throw std::runtime_error("Invalid record in the write-ahead log.");
+		}
+	}
+}
+
+WriteAheadLog::WriteAheadLog(const std::string& path, WalSyncMode syncMode, std::uint64_t position)
+	: mPath(path), mSyncMode(syncMode), mNumSyncs(0) {
+	mFileDescriptor = open(path.c_str(), O_WRONLY | O_APPEND);
+	if (mFileDescriptor == -1) {
+		mFileDescriptor = createLogFile(path, position);
+		mBasePosition = position;
+		mPosition = position;
+	} else {
+		// The log continues after its last record
+		WalFileHeader header;
+		struct stat fileStatus;
+		auto readDescriptor = open(path.c_str(), O_RDONLY);
+		auto valid = readDescriptor != -1
+			&& pread(readDescriptor, &header, sizeof(header), 0) == (ssize_t)sizeof(header)
+			&& fstat(readDescriptor, &fileStatus) == 0
+			&& std::memcmp(header.magic, WAL_FILE_MAGIC, sizeof(WAL_FILE_MAGIC)) == 0;
+		if (readDescriptor != -1) {
+			close(readDescriptor);
+		}
+
+		if (!valid) {
+			close(mFileDescriptor);
+			throw std::runtime_error("The write-ahead log '" + path + "' is invalid.");
+		}
+
+		mBasePosition = header.position;
+		mPosition = header.position + ((std::uint64_t)fileStatus.st_size - sizeof(header));
+	}
+
+	mSyncedPosition = mPosition;
+}
+
+WriteAheadLog::~WriteAheadLog() {
+	close(mFileDescriptor);
+}
+
+void WriteAheadLog::replay(const std::string& path, std::uint64_t position, DatabaseEngine& databaseEngine) {
+	if (access(path.c_str(), F_OK) != 0) {
+		return;
+	}
+
+	std::size_t validSize = 0;
+	std::size_t fileSize = 0;
+	{
+		MappedFile file(path);
+		fileSize = file.size();
+
+		WalFileHeader header;
+		if (file.size() < sizeof(header)) {
+			throw std::runtime_error("The write-ahead log '" + path + "' is invalid.");
+		}
+
+		std::memcpy(&header, file.data(), sizeof(header));
+		if (std::memcmp(header.magic, WAL_FILE_MAGIC, sizeof(WAL_FILE_MAGIC)) != 0 || header.version != WAL_FILE_VERSION) {
+			throw std::runtime_error("The write-ahead log '" + path + "' is invalid.");
+		}
+
+		if (header.position > position) {
+			throw std::runtime_error("The write-ahead log '" + path + "' does not continue the table files.");
+		}
+
+		// The records before the given position are already in the table files
+		auto recordPosition = header.position;
+		auto offset = sizeof(header);
+		while (offset + RECORD_HEADER_SIZE <= file.size()) {
+			auto record = file.data() + offset;
+			std::uint32_t payloadSize;
+			std::uint32_t recordChecksum;
+			std::memcpy(&payloadSize, record, sizeof(std::uint32_t));
+			std::memcpy(&recordChecksum, record + sizeof(std::uint32_t), sizeof(std::uint32_t));
+			auto recordType = record[2 * sizeof(std::uint32_t)];
+
+			auto payload = record + RECORD_HEADER_SIZE;
+			if (payloadSize > file.size() - offset - RECORD_HEADER_SIZE
+				|| checksum(recordType, payload, payloadSize) != recordChecksum) {
+				break;
+			}
+
+			if (recordPosition >= position) {
+				RecordReader reader(payload, payloadSize);
+				applyRecord(recordType, reader, databaseEngine);
+			}
+
+			recordPosition += RECORD_HEADER_SIZE + payloadSize;
+			offset += RECORD_HEADER_SIZE + payloadSize;
+		}
+
+		validSize = offset;
+	}
+
+	// A record that was being written when the database stopped is removed, as it was never committed
+	if (validSize < fileSize && ::truncate(path.c_str(), (off_t)validSize) != 0) {
+		throw std::runtime_error("Could not truncate the write-ahead log '" + path + "'.");
+	}
+}
+
+std::uint64_t WriteAheadLog::position() {
+	std::lock_guard<std::mutex> guard(mMutex);
+	return mPosition;
+}
+
+std::uint64_t WriteAheadLog::size() {
+	std::lock_guard<std::mutex> guard(mMutex);
+	return mPosition - mBasePosition;
+}
+
+std::size_t WriteAheadLog::numSyncs() const {
+	return mNumSyncs;
+}
+
+std::uint64_t WriteAheadLog::append(std::uint8_t recordType, const std::vector<std::uint8_t>& payload) {
+	// The record is written at once, which keeps the records of concurrent statements apart
+	std::vector<std::uint8_t> record(RECORD_HEADER_SIZE + payload.size());
+	auto payloadSize = (std::uint32_t)payload.size();
+	auto recordChecksum = checksum(recordType, payload.data(), payload.size());
+	std::memcpy(record.data(), &payloadSize, sizeof(std::uint32_t));
+	std::memcpy(record.data() + sizeof(std::uint32_t), &recordChecksum, sizeof(std::uint32_t));
+	record[2 * sizeof(std::uint32_t)] = recordType;
+	std::copy(payload.begin(), payload.end(), record.begin() + RECORD_HEADER_SIZE);
+
+	std::lock_guard<std::mutex> guard(mMutex);
+	writeAll(mFileDescriptor, record.data(), record.size());
+	mPosition += record.size();
+	return mPosition;
+}
+
+void WriteAheadLog::sync(std::unique_lock<std::mutex>& lock) {
+	// One sync runs at a time, which keeps truncate from replacing the file while it is synced
+	mSynced.wait(lock, [&]() { return !mSyncing; });
+	mSyncing = true;
+	auto syncPosition = mPosition;
+	lock.unlock();
+
+	auto synced = fdatasync(mFileDescriptor) == 0;
+
+	lock.lock();
+	mSyncing = false;
+	mSynced.notify_all();
+	if (!synced) {
+		throw std::runtime_error("Could not sync the write-ahead log.");
+	}
+
+	mNumSyncs++;
+	mSyncedPosition = std::max(mSyncedPosition, syncPosition);
+}
+
+std::uint64_t WriteAheadLog::logCreateTable(const std::string& name, const Schema& schema) {
+	RecordWriter writer;
+	writer.writeString(name);
+	writer.writeString(schema.name());
+
+	writer.write((std::uint32_t)schema.columns().size());
+	for (auto& column : schema.columns()) {
+		writer.writeString(column.name());
+		writer.write((std::uint8_t)column.type());
+	}
+
+	writer.write((std::uint32_t)schema.indices().size());
+	for (auto& index : schema.indices()) {
+		writer.writeString(index.column());
+		writer.write((std::uint8_t)(index.type() == IndexType::Hash ? 1 : 0));
+	}
+
+	return append(CREATE_TABLE_RECORD, writer.data());
+}
+
+std::uint64_t WriteAheadLog::logInsert(const std::string& table, const std::vector<ColumnStorage>& columns) {
+	RecordWriter writer;
+	writer.writeString(table);
+	writer.write((std::uint32_t)columns.size());
+	for (auto& column : columns) {
+		writer.writeColumn(column);
+	}
+
+	return append(INSERT_RECORD, writer.data());
+}
+
+std::uint64_t WriteAheadLog::logUpdate(const std::string& table, const std::vector<ColumnUpdate>& updates) {
+	RecordWriter writer;
+	writer.writeString(table);
+	writer.write((std::uint32_t)updates.size());
+	for (auto& update : updates) {
+		writer.writeString(update.column);
+		writer.write((std::uint64_t)update.rowIndices.size());
+		for (auto rowIndex : update.rowIndices) {
+			writer.write((std::uint64_t)rowIndex);
+		}
+
+		writer.writeColumn(update.values);
+	}
+
+	return append(UPDATE_RECORD, writer.data());
+}
+
+void WriteAheadLog::commit(std::uint64_t position) {
+	if (mSyncMode == WalSyncMode::None) {
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	if (mSyncMode == WalSyncMode::EveryStatement) {
+		sync(lock);
+		return;
+	}
+
+	while (mSyncedPosition < position) {
+		if (mSyncing) {
+			mSynced.wait(lock);
+			continue;
+		}
+
+		// The sync covers all the records written so far, including those of the commits that wait for it
+		sync(lock);
+	}
+}
+
+std::uint64_t WriteAheadLog::truncate(std::uint64_t position) {
+	std::unique_lock<std::mutex> lock(mMutex);
+	mSynced.wait(lock, [&]() { return !mSyncing; });
+	if (position <= mBasePosition) {
+		return 0;
+	}
+
+	if (position > mPosition) {
+		throw std::runtime_error("The write-ahead log does not contain the position.");
+	}
+
+	// Records are not appended meanwhile, which keeps the copy of the last records complete
+	std::vector<std::uint8_t> records(mPosition - position);
+	readAll(mPath, sizeof(WalFileHeader) + (position - mBasePosition), records);
+
+	auto fileDescriptor = createLogFile(mPath, position, records);
+	close(mFileDescriptor);
+	mFileDescriptor = fileDescriptor;
+
+	auto numRemoved = position - mBasePosition;
+	mBasePosition = position;
+	mSyncedPosition = mPosition;
+	return numRemoved;
+}
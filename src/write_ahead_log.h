@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class DatabaseEngine;
+class Schema;
+class ColumnStorage;
+struct ColumnUpdate;
+
+/**
+ * When the write-ahead log is synced to disk
+ */
+enum class WalSyncMode {
+	// Never synced, which leaves it to the operating system
+	None,
+	// Statements that commit at the same time share one sync
+	Group,
+	// Each statement is synced on its own
+	EveryStatement
+};
+
+/**
+ * Represents a write-ahead log, which makes the changes to the tables durable before they are stored in the table files.
+ * Each change is appended as a checksummed binary record. A position in the log counts the bytes of the records
+ * since the database was created, which lets the table files tell which records they already contain.
+ */
+class WriteAheadLog {
+private:
+	std::string mPath;
+	WalSyncMode mSyncMode;
+	int mFileDescriptor = -1;
+
+	std::mutex mMutex;
+	std::condition_variable mSynced;
+	std::uint64_t mBasePosition = 0;
+	std::uint64_t mPosition = 0;
+	std::uint64_t mSyncedPosition = 0;
+	bool mSyncing = false;
+	std::atomic<std::size_t> mNumSyncs;
+
+	std::uint64_t append(std::uint8_t recordType, const std::vector<std::uint8_t>& payload);
+	void sync(std::unique_lock<std::mutex>& lock);
+public:
+	/**
+	 * Opens the log at the given path, which is created if it does not exist
+	 * @param path The path of the log
+	 * @param syncMode When the log is synced
+	 * @param position The position of a created log
+	 */
+	WriteAheadLog(const std::string& path, WalSyncMode syncMode, std::uint64_t position);
+	~WriteAheadLog();
+
+	WriteAheadLog(const WriteAheadLog&) = delete;
+	WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+	/**
+	 * Applies the records in the log at the given path that come after the given position to the given database.
+	 * The log ends at the first incomplete or corrupt record, which is removed.
+	 * @param path The path of the log
+	 * @param position The position of the first record to apply
+	 * @param databaseEngine The database
+	 */
+	static void replay(const std::string& path, std::uint64_t position, DatabaseEngine& databaseEngine);
+
+	/**
+	 * Returns the position after the last record
+	 */
+	std::uint64_t position();
+
+	/**
+	 * Returns the number of bytes of the records in the log
+	 */
+	std::uint64_t size();
+
+	/**
+	 * Returns the number of times the log has been synced
+	 */
+	std::size_t numSyncs() const;
+
+	/**
+	 * Logs that a table has been created
+	 * @param name The name of the table
+	 * @param schema The schema of the table
+	 * @return The position to commit
+	 */
+	std::uint64_t logCreateTable(const std::string& name, const Schema& schema);
+
+	/**
+	 * Logs that rows have been inserted into a table
+	 * @param table The name of the table
+	 * @param columns The inserted columns, in the order of the schema
+	 * @return The position to commit
+	 */
+	std::uint64_t logInsert(const std::string& table, const std::vector<ColumnStorage>& columns);
+
+	/**
+	 * Logs that rows have been updated in a table
+	 * @param table The name of the table
+	 * @param updates The updates of the columns
+	 * @return The position to commit
+	 */
+	std::uint64_t logUpdate(const std::string& table, const std::vector<ColumnUpdate>& updates);
+
+	/**
+	 * Waits until the records up to the given position are durable, depending on the sync mode
+	 * @param position The position
+	 */
+	void commit(std::uint64_t position);
+
+	/**
+	 * Removes the records before the given position, which must be stored in the table files.
+	 * The records after it are kept, which lets changes be logged while the table files are written.
+	 * @param position The position
+	 * @return The number of bytes removed
+	 */
+	std::uint64_t truncate(std::uint64_t position);
+};
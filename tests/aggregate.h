@@ -0,0 +1,176 @@
+#pragma once
+#include <cxxtest/TestSuite.h>
+#include <algorithm>
+#include <map>
+#include <limits>
+
+#include "../src/common.h"
+#include "../src/query_parser/parser.h"
+#include "test_helpers.h"
+
+class AggregateTestSuite : public CxxTest::TestSuite {
+public:
+	void testCount() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+
+		auto query = createQuery(databaseEngine->parse("SELECT COUNT(*) FROM test_table WHERE x < 500"));
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns.size(), 1);
+		TS_ASSERT_EQUALS(result.columns[0].size(), 1);
+		TS_ASSERT_EQUALS(result.columns[0].getValue(0), QueryValue(500));
+	}
+
+	void testAggregates() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+
+		auto query = createQuery(databaseEngine->parse(
+			"SELECT SUM(x), MIN(z), MAX(z), AVG(y), COUNT(z) FROM test_table WHERE z > 250"));
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns.size(), 5);
+		TS_ASSERT_EQUALS(result.columns[0].size(), 1);
+
+		std::int32_t sumX = 0;
+		std::int32_t minZ = std::numeric_limits<std::int32_t>::max();
+		std::int32_t maxZ = std::numeric_limits<std::int32_t>::min();
+		double sumY = 0.0;
+		std::int32_t count = 0;
+		for (auto& row : tableData) {
+			auto z = row[2].getValue<std::int32_t>();
+			if (z > 250) {
+				sumX += row[0].getValue<std::int32_t>();
+				minZ = std::min(minZ, z);
+				maxZ = std::max(maxZ, z);
+				sumY += row[1].getValue<float>();
+				count++;
+			}
+		}
+
+		TS_ASSERT_EQUALS(result.columns[0].getValue(0), QueryValue(sumX));
+		TS_ASSERT_EQUALS(result.columns[1].getValue(0), QueryValue(minZ));
+		TS_ASSERT_EQUALS(result.columns[2].getValue(0), QueryValue(maxZ));
+		TS_ASSERT_DELTA(result.columns[3].getValue(0).getValue<float>(), sumY / count, 0.01);
+		TS_ASSERT_EQUALS(result.columns[4].getValue(0), QueryValue(count));
+	}
+
+	void testAggregateEmpty() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+
+		auto query = createQuery(databaseEngine->parse("SELECT COUNT(*), SUM(x) FROM test_table WHERE x < 0"));
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns.size(), 2);
+		TS_ASSERT_EQUALS(result.columns[0].size(), 1);
+		TS_ASSERT_EQUALS(result.columns[0].getValue(0), QueryValue(0));
+		TS_ASSERT_EQUALS(result.columns[1].getValue(0), QueryValue(0));
+	}
+
+	void testGroup() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+
+		auto query = createQuery(databaseEngine->parse(
+			"SELECT z, COUNT(*), SUM(x) FROM test_table GROUP BY z ORDER BY z"));
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+
+		std::map<std::int32_t, std::pair<std::int32_t, std::int32_t>> expectedGroups;
+		for (auto& row : tableData) {
+			auto& group = expectedGroups[row[2].getValue<std::int32_t>()];
+			group.first++;
+			group.second += row[0].getValue<std::int32_t>();
+		}
+
+		TS_ASSERT_EQUALS(result.columns.size(), 3);
+		TS_ASSERT_EQUALS(result.columns[0].size(), expectedGroups.size());
+
+		std::size_t i = 0;
+		for (auto& group : expectedGroups) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), QueryValue(group.first), i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), QueryValue(group.second.first), i, 1);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[2].getValue(i), QueryValue(group.second.second), i, 2);
+			i++;
+		}
+	}
+
+	void testGroupWithLimit() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+
+		auto query = createQuery(databaseEngine->parse(
+			"SELECT z, COUNT(*) FROM test_table GROUP BY z ORDER BY z LIMIT 5 OFFSET 2"));
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+
+		std::map<std::int32_t, std::int32_t> expectedGroups;
+		for (auto& row : tableData) {
+			expectedGroups[row[2].getValue<std::int32_t>()]++;
+		}
+
+		TS_ASSERT_EQUALS(result.columns.size(), 2);
+		TS_ASSERT_EQUALS(result.columns[0].size(), 5);
+
+		auto group = std::next(expectedGroups.begin(), 2);
+		for (std::size_t i = 0; i < result.columns[0].size(); i++, ++group) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), QueryValue(group->first), i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), QueryValue(group->second), i, 1);
+		}
+	}
+
+	void testGroupMultipleColumns() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+
+		auto query = createQuery(databaseEngine->parse(
+			"SELECT MAX(y), z, x FROM test_table WHERE x < 300 GROUP BY z, x"));
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+
+		std::map<std::pair<std::int32_t, std::int32_t>, float> expectedGroups;
+		for (auto& row : tableData) {
+			auto x = row[0].getValue<std::int32_t>();
+			if (x < 300) {
+				auto key = std::make_pair(row[2].getValue<std::int32_t>(), x);
+				auto y = row[1].getValue<float>();
+				auto group = expectedGroups.find(key);
+				if (group == expectedGroups.end()) {
+					expectedGroups[key] = y;
+				} else {
+					group->second = std::max(group->second, y);
+				}
+			}
+		}
+
+		TS_ASSERT_EQUALS(result.columns.size(), 3);
+		TS_ASSERT_EQUALS(result.columns[0].size(), expectedGroups.size());
+
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			auto key = std::make_pair(
+				result.columns[1].getValue(i).getValue<std::int32_t>(),
+				result.columns[2].getValue(i).getValue<std::int32_t>());
+
+			TS_ASSERT_EQUALS(expectedGroups.count(key), 1);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), QueryValue(expectedGroups[key]), i, 0);
+		}
+	}
+
+	void testGroupInvalidProjection() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+
+		auto query = createQuery(databaseEngine->parse("SELECT x, COUNT(*) FROM test_table GROUP BY z"));
+
+		QueryResult result;
+		TS_ASSERT_THROWS_ANYTHING(databaseEngine->execute(query, result));
+	}
+};
@@ -0,0 +1,185 @@
+#pragma once
+#include <cxxtest/TestSuite.h>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "../src/bplus_tree.h"
+
+namespace {
+	using SmallTree = BPlusTree<std::int32_t, std::size_t, 4, 4>;
+	using ExpectedTree = std::multimap<std::int32_t, std::size_t>;
+
+	template<typename Iterator>
+	std::vector<std::pair<std::int32_t, std::size_t>> collect(Iterator begin, Iterator end) {
+		std::vector<std::pair<std::int32_t, std::size_t>> entries;
+		for (auto it = begin; it != end; ++it) {
+			entries.emplace_back(it->first, it->second);
+		}
+
+		return entries;
+	}
+
+	void assertSameEntries(const SmallTree& tree, const ExpectedTree& expected) {
+		TS_ASSERT_EQUALS(tree.size(), expected.size());
+		TS_ASSERT(collect(tree.begin(), tree.end()) == collect(expected.begin(), expected.end()));
+		TS_ASSERT(collect(tree.rbegin(), tree.rend()) == collect(expected.rbegin(), expected.rend()));
+	}
+
+	void assertSameRanges(const SmallTree& tree, const ExpectedTree& expected, std::int32_t minKey, std::int32_t maxKey) {
+		for (auto key = minKey; key <= maxKey; key++) {
+			TS_ASSERT(collect(tree.lower_bound(key), tree.end()) == collect(expected.lower_bound(key), expected.end()));
+			TS_ASSERT(collect(tree.upper_bound(key), tree.end()) == collect(expected.upper_bound(key), expected.end()));
+
+			auto treeRange = tree.equal_range(key);
+			auto expectedRange = expected.equal_range(key);
+			TS_ASSERT(collect(treeRange.first, treeRange.second) == collect(expectedRange.first, expectedRange.second));
+
+			using TreeReverseIterator = SmallTree::const_reverse_iterator;
+			using ExpectedReverseIterator = ExpectedTree::const_reverse_iterator;
+			TS_ASSERT(collect(TreeReverseIterator(tree.lower_bound(key)), tree.rend())
+					  == collect(ExpectedReverseIterator(expected.lower_bound(key)), expected.crend()));
+		}
+	}
+}
+
+class BPlusTreeTestSuite : public CxxTest::TestSuite {
+public:
+	void testEmpty() {
+		SmallTree tree;
+		TS_ASSERT(tree.empty());
+		TS_ASSERT(tree.begin() == tree.end());
+		TS_ASSERT(tree.lower_bound(5) == tree.end());
+		TS_ASSERT(tree.upper_bound(5) == tree.end());
+	}
+
+	void testSequentialInsert() {
+		SmallTree tree;
+		ExpectedTree expected;
+		for (std::int32_t i = 0; i < 1000; i++) {
+			tree.emplace(i, (std::size_t)i);
+			expected.emplace(i, (std::size_t)i);
+		}
+
+		assertSameEntries(tree, expected);
+		assertSameRanges(tree, expected, -1, 1000);
+	}
+
+	void testDuplicates() {
+		SmallTree tree;
+		ExpectedTree expected;
+
+		std::mt19937 random(1337);
+		std::uniform_int_distribution<std::int32_t> distribution(0, 20);
+		for (std::size_t i = 0; i < 1000; i++) {
+			auto key = distribution(random);
+			tree.emplace(key, i);
+			expected.emplace(key, i);
+		}
+
+		assertSameEntries(tree, expected);
+		assertSameRanges(tree, expected, -1, 21);
+	}
+
+	void testErase() {
+		SmallTree tree;
+		ExpectedTree expected;
+
+		std::mt19937 random(1337);
+		std::uniform_int_distribution<std::int32_t> distribution(0, 200);
+		for (std::size_t i = 0; i < 2000; i++) {
+			auto key = distribution(random);
+			tree.emplace(key, i);
+			expected.emplace(key, i);
+		}
+
+		// Erase like TreeIndex::update does, then insert again with a new key
+		for (std::size_t i = 0; i < 2000; i += 3) {
+			auto oldKey = distribution(random);
+			auto newKey = distribution(random);
+
+			auto treeRange = tree.equal_range(oldKey);
+			if (treeRange.first != treeRange.second) {
+				auto value = treeRange.first->second;
+				tree.erase(treeRange.first);
+
+				auto expectedRange = expected.equal_range(oldKey);
+				for (auto it = expectedRange.first; it != expectedRange.second; ++it) {
+					if (it->second == value) {
+						expected.erase(it);
+						break;
+					}
+				}
+
+				tree.emplace(newKey, value);
+				expected.emplace(newKey, value);
+			}
+		}
+
+		assertSameEntries(tree, expected);
+		assertSameRanges(tree, expected, -1, 201);
+	}
+
+	void testEraseAll() {
+		SmallTree tree;
+		for (std::int32_t i = 0; i < 100; i++) {
+			tree.emplace(i % 10, (std::size_t)i);
+		}
+
+		for (std::int32_t key = 0; key < 10; key++) {
+			auto range = tree.equal_range(key);
+			auto it = range.first;
+			while (it != tree.end() && it->first == key) {
+				it = tree.erase(it);
+			}
+		}
+
+		TS_ASSERT(tree.empty());
+		TS_ASSERT(tree.begin() == tree.end());
+		TS_ASSERT(tree.rbegin() == tree.rend());
+		TS_ASSERT(tree.lower_bound(3) == tree.end());
+
+		tree.emplace(5, 1);
+		TS_ASSERT_EQUALS(tree.begin()->first, 5);
+		TS_ASSERT_EQUALS(tree.begin()->second, 1);
+	}
+
+	void testInsertSorted() {
+		SmallTree tree;
+		ExpectedTree expected;
+
+		std::mt19937 random(1337);
+		std::uniform_int_distribution<std::int32_t> distribution(0, 100);
+		std::size_t value = 0;
+		for (auto numEntries : { 1, 2, 500, 3, 2000 }) {
+			std::vector<SmallTree::value_type> entries;
+			for (auto i = 0; i < numEntries; i++) {
+				auto key = distribution(random);
+				entries.emplace_back(key, value);
+				expected.emplace(key, value);
+				value++;
+			}
+
+			std::stable_sort(entries.begin(), entries.end(), [](const SmallTree::value_type& x, const SmallTree::value_type& y) {
+				return x.first < y.first;
+			});
+
+			tree.insertSorted(entries);
+			assertSameEntries(tree, expected);
+		}
+
+		assertSameRanges(tree, expected, -1, 101);
+
+		// The built tree can still be changed one entry at a time
+		for (std::int32_t i = 0; i < 500; i++) {
+			auto key = distribution(random);
+			tree.emplace(key, value);
+			expected.emplace(key, value);
+			value++;
+		}
+
+		assertSameEntries(tree, expected);
+		assertSameRanges(tree, expected, -1, 101);
+	}
+};
@@ -0,0 +1,138 @@
+#pragma once
+#include <cxxtest/TestSuite.h>
+#include <sys/stat.h>
+#include <thread>
+
+#include "../src/database_files.h"
+#include "test_helpers.h"
+
+class CheckpointTestSuite : public CxxTest::TestSuite {
+private:
+	DatabaseConfiguration checkpointConfig(std::size_t checkpointWalSize = 0) {
+		auto config = defaultTestConfig();
+		config.walSyncMode = WalSyncMode::None;
+		config.checkpointWalSize = checkpointWalSize;
+		return config;
+	}
+
+	std::size_t numCheckpointedRows(const std::string& directory) {
+		std::uint64_t walPosition = 0;
+		auto tables = DatabaseFiles::open(directory, walPosition);
+		return tables.count("test_table") > 0 ? tables.at("test_table")->numRows() : 0;
+	}
+public:
+	void testCheckpoint() {
+		TemporaryDirectory directory;
+		auto databaseEngine = openTestDatabase(directory.path, checkpointConfig());
+		addEmptyTestTable(*databaseEngine);
+		insertTestRows(*databaseEngine, 0, 100);
+
+		auto walSize = databaseEngine->writeAheadLog()->size();
+		auto metrics = databaseEngine->checkpoint();
+		TS_ASSERT_EQUALS(metrics.walPosition, walSize);
+		TS_ASSERT_EQUALS(metrics.numRows, 100);
+		TS_ASSERT(metrics.numBytes > 100 * (sizeof(std::int32_t) + sizeof(float)));
+		TS_ASSERT_EQUALS(metrics.numWalBytesRemoved, walSize);
+		TS_ASSERT(metrics.totalTime >= metrics.snapshotTime);
+		TS_ASSERT_EQUALS(databaseEngine->writeAheadLog()->size(), 0);
+		TS_ASSERT_EQUALS(numCheckpointedRows(directory.path), 100);
+
+		insertTestRows(*databaseEngine, 100, 10);
+		TS_ASSERT_EQUALS(databaseEngine->checkpointMetrics().size(), 1);
+
+		auto openedEngine = openTestDatabase(directory.path, checkpointConfig());
+		auto& table = openedEngine->getTable("test_table");
+		TS_ASSERT_EQUALS(table.numRows(), 110);
+		TS_ASSERT_EQUALS(table.getColumn("x").getValue(105), QueryValue(105));
+		TS_ASSERT_EQUALS(table.getColumn("y").getValue(50), QueryValue(50.0f));
+	}
+
+	void testBackgroundCheckpoint() {
+		TemporaryDirectory directory;
+		{
+			auto databaseEngine = openTestDatabase(directory.path, checkpointConfig(1024));
+			addEmptyTestTable(*databaseEngine);
+			for (std::int32_t i = 0; i < 200; i++) {
+				insertTestRows(*databaseEngine, i * 10, 10);
+			}
+
+			// The log is checkpointed whenever it grows past its limit, while rows are inserted
+			for (std::size_t i = 0; i < 500 && databaseEngine->checkpointMetrics().empty(); i++) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			}
+
+			TS_ASSERT(!databaseEngine->checkpointMetrics().empty());
+		}
+
+		TS_ASSERT(numCheckpointedRows(directory.path) > 0);
+		auto openedEngine = openTestDatabase(directory.path, checkpointConfig());
+		auto& table = openedEngine->getTable("test_table");
+		TS_ASSERT_EQUALS(table.numRows(), 2000);
+		for (std::size_t i = 0; i < table.numRows(); i++) {
+			TS_ASSERT_EQUALS(table.getColumn("x").getValue(i), QueryValue((std::int32_t)i));
+		}
+	}
+
+	void testCheckpointWhileInserting() {
+		TemporaryDirectory directory;
+		{
+			auto databaseEngine = openTestDatabase(directory.path, checkpointConfig());
+			addEmptyTestTable(*databaseEngine);
+
+			std::thread inserter([&]() {
+				for (std::int32_t i = 0; i < 100; i++) {
+					insertTestRows(*databaseEngine, i * 5, 5);
+				}
+			});
+
+			for (std::size_t i = 0; i < 10; i++) {
+				databaseEngine->checkpoint();
+			}
+
+			inserter.join();
+			TS_ASSERT_EQUALS(databaseEngine->checkpointMetrics().size(), 10);
+		}
+
+		auto openedEngine = openTestDatabase(directory.path, checkpointConfig());
+		auto& table = openedEngine->getTable("test_table");
+		TS_ASSERT_EQUALS(table.numRows(), 500);
+		for (std::size_t i = 0; i < table.numRows(); i++) {
+			TS_ASSERT_EQUALS(table.getColumn("x").getValue(i), QueryValue((std::int32_t)i));
+		}
+	}
+
+	void testCrashBeforeCatalog() {
+		TemporaryDirectory directory;
+		auto temporaryCatalogPath = directory.path + "/catalog.tmp";
+		{
+			auto databaseEngine = openTestDatabase(directory.path, checkpointConfig());
+			addEmptyTestTable(*databaseEngine);
+			insertTestRows(*databaseEngine, 0, 100);
+			databaseEngine->checkpoint();
+			insertTestRows(*databaseEngine, 100, 20);
+
+			// The catalog can't be replaced, like a crash after the column files of the checkpoint have been written
+			auto walSize = databaseEngine->writeAheadLog()->size();
+			TS_ASSERT_EQUALS(mkdir(temporaryCatalogPath.c_str(), 0700), 0);
+			TS_ASSERT_THROWS_ANYTHING(databaseEngine->checkpoint());
+			TS_ASSERT_EQUALS(databaseEngine->writeAheadLog()->size(), walSize);
+			TS_ASSERT_EQUALS(numCheckpointedRows(directory.path), 100);
+		}
+
+		// The previous checkpoint and the log still hold every row
+		rmdir(temporaryCatalogPath.c_str());
+		auto openedEngine = openTestDatabase(directory.path, checkpointConfig());
+		auto& table = openedEngine->getTable("test_table");
+		TS_ASSERT_EQUALS(table.numRows(), 120);
+		TS_ASSERT_EQUALS(table.getColumn("x").getValue(110), QueryValue(110));
+
+		openedEngine->checkpoint();
+		TS_ASSERT_EQUALS(numCheckpointedRows(directory.path), 120);
+	}
+
+	void testNotOpened() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+		TS_ASSERT_THROWS_ANYTHING(databaseEngine->checkpoint());
+	}
+};
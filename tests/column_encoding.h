@@ -0,0 +1,259 @@
+#pragma once
+#include <cxxtest/TestSuite.h>
+#include <random>
+#include <vector>
+
+#include "../src/column_encoding.h"
+#include "../src/execution/filter_kernels.h"
+#include "test_helpers.h"
+
+namespace {
+	UnderlyingColumnStorage<std::int32_t> toColumn(const std::vector<std::int32_t>& values) {
+		return UnderlyingColumnStorage<std::int32_t>(values.begin(), values.end());
+	}
+
+	void testSelectEncoded(const UnderlyingColumnStorage<std::int32_t>& values,
+						   std::int32_t value,
+						   std::size_t startRowIndex,
+						   std::size_t count) {
+		for (auto op : { CompareOperator::Equal,
+						 CompareOperator::NotEqual,
+						 CompareOperator::LessThan,
+						 CompareOperator::LessThanOrEqual,
+						 CompareOperator::GreaterThan,
+						 CompareOperator::GreaterThanOrEqual }) {
+			std::vector<std::size_t> expectedSelection;
+			for (auto rowIndex = startRowIndex; rowIndex < startRowIndex + count; rowIndex++) {
+				if (QueryExpressionHelpers::compare<std::int32_t>(op, values[rowIndex], value)) {
+					expectedSelection.push_back(rowIndex);
+				}
+			}
+
+			std::vector<std::size_t> selection;
+			FilterKernels::selectColumn(op, values, startRowIndex, count, value, selection);
+			TS_ASSERT_EQUALS(selection, expectedSelection);
+
+			FilterKernels::selectEncodedColumn(op, values, startRowIndex, count, value, selection);
+			TS_ASSERT_EQUALS(selection, expectedSelection);
+		}
+	}
+}
+
+class ColumnEncodingTestSuite : public CxxTest::TestSuite {
+public:
+	void testBitPacking() {
+		for (std::size_t bitWidth : { 0, 1, 7, 13, 31, 32 }) {
+			std::mt19937 random(1337);
+			std::vector<std::uint32_t> values;
+			for (std::size_t i = 0; i < 1000; i++) {
+				values.push_back(bitWidth == 0 ? 0 : (std::uint32_t)(random() & ((1ull << bitWidth) - 1)));
+			}
+
+			BitPackedArray packed(values, bitWidth);
+			TS_ASSERT_EQUALS(packed.size(), values.size());
+
+			std::vector<std::uint32_t> unpacked(values.size() - 3);
+			packed.unpack(3, unpacked.size(), unpacked.data());
+			for (std::size_t i = 0; i < values.size(); i++) {
+				TS_ASSERT_EQUALS(packed.get(i), values[i]);
+				if (i >= 3) {
+					TS_ASSERT_EQUALS(unpacked[i - 3], values[i]);
+				}
+			}
+		}
+
+		TS_ASSERT_EQUALS(BitPackedArray::bitWidthOf(0), 0);
+		TS_ASSERT_EQUALS(BitPackedArray::bitWidthOf(255), 8);
+		TS_ASSERT_EQUALS(BitPackedArray::bitWidthOf(256), 9);
+	}
+
+	void testSegments() {
+		std::vector<ColumnSegment> segments;
+		ColumnStorage::forEachSegment(1000, 2 * COLUMN_SEGMENT_SIZE + 5, [&](const ColumnSegment& segment) {
+			segments.push_back(segment);
+		});
+
+		TS_ASSERT_EQUALS(segments.size(), 3);
+		TS_ASSERT_EQUALS(segments[0].index, 0);
+		TS_ASSERT_EQUALS(segments[0].startRowIndex, 1000);
+		TS_ASSERT_EQUALS(segments[0].endRowIndex, COLUMN_SEGMENT_SIZE);
+		TS_ASSERT_EQUALS(segments[1].startRowIndex, COLUMN_SEGMENT_SIZE);
+		TS_ASSERT_EQUALS(segments[2].index, 2);
+		TS_ASSERT_EQUALS(segments[2].endRowIndex, 2 * COLUMN_SEGMENT_SIZE + 5);
+
+		// Full segments stay in place as the values grow
+		UnderlyingColumnStorage<std::int32_t> values;
+		for (std::int32_t i = 0; i < (std::int32_t)COLUMN_SEGMENT_SIZE; i++) {
+			values.push_back(i);
+		}
+
+		auto firstSegment = values.segmentValues(0);
+		UnderlyingColumnStorage<std::int32_t> newValues(2 * COLUMN_SEGMENT_SIZE + 5, 7);
+		values.append(newValues);
+		values.push_back(8);
+		TS_ASSERT_EQUALS(values.segmentValues(0), firstSegment);
+		TS_ASSERT_EQUALS(values.size(), 3 * COLUMN_SEGMENT_SIZE + 6);
+		TS_ASSERT_EQUALS(values.numSegments(), 4);
+		TS_ASSERT_EQUALS(values[COLUMN_SEGMENT_SIZE - 1], (std::int32_t)COLUMN_SEGMENT_SIZE - 1);
+		TS_ASSERT_EQUALS(values[3 * COLUMN_SEGMENT_SIZE + 4], 7);
+		TS_ASSERT_EQUALS(values.back(), 8);
+
+		std::size_t numValues = 0;
+		values.forEachSegment(1000, values.size(), [&](const std::int32_t* segmentValues, std::size_t startIndex, std::size_t count) {
+			TS_ASSERT_EQUALS(segmentValues, values.segmentValues(startIndex / COLUMN_SEGMENT_SIZE) + startIndex % COLUMN_SEGMENT_SIZE);
+			numValues += count;
+		});
+		TS_ASSERT_EQUALS(numValues, values.size() - 1000);
+
+		values.erase(values.begin(), values.begin() + 10);
+		TS_ASSERT_EQUALS(values[0], 10);
+		TS_ASSERT_EQUALS(values.size(), 3 * COLUMN_SEGMENT_SIZE - 4);
+	}
+
+	void testChooseEncoding() {
+		std::mt19937 random(1337);
+		std::vector<std::int32_t> ids;
+		std::vector<std::int32_t> codes;
+		std::vector<std::int32_t> runs;
+		std::vector<std::int32_t> randomValues;
+		for (std::int32_t i = 0; i < 10000; i++) {
+			ids.push_back(1000000 + i);
+			codes.push_back((std::int32_t)(random() % 5) * 1000000 - 2000000);
+			runs.push_back(i / 1000);
+			randomValues.push_back((std::int32_t)random());
+		}
+
+		auto idsSegment = EncodedSegment::encode(ids.data(), ids.size());
+		auto codesSegment = EncodedSegment::encode(codes.data(), codes.size());
+		auto runsSegment = EncodedSegment::encode(runs.data(), runs.size());
+		auto randomSegment = EncodedSegment::encode(randomValues.data(), randomValues.size());
+		TS_ASSERT_EQUALS(idsSegment.encoding, SegmentEncoding::FrameOfReference);
+		TS_ASSERT_EQUALS(codesSegment.encoding, SegmentEncoding::Dictionary);
+		TS_ASSERT_EQUALS(runsSegment.encoding, SegmentEncoding::RunLength);
+		TS_ASSERT_EQUALS(randomSegment.encoding, SegmentEncoding::Plain);
+		TS_ASSERT_LESS_THAN(idsSegment.numBytes(), ids.size() * 2);
+		TS_ASSERT_LESS_THAN(codesSegment.numBytes(), codes.size());
+
+		for (std::size_t i = 0; i < ids.size(); i++) {
+			TS_ASSERT_EQUALS(idsSegment.decode(i), ids[i]);
+			TS_ASSERT_EQUALS(codesSegment.decode(i), codes[i]);
+			TS_ASSERT_EQUALS(runsSegment.decode(i), runs[i]);
+			TS_ASSERT_EQUALS(randomSegment.decode(i), randomValues[i]);
+		}
+
+		for (auto segment : { &idsSegment, &codesSegment, &runsSegment, &randomSegment }) {
+			std::vector<std::int32_t> decoded(5000);
+			segment->decode(2999, decoded.size(), decoded.data());
+			for (std::size_t i = 0; i < decoded.size(); i++) {
+				TS_ASSERT_EQUALS(decoded[i], segment->decode(2999 + i));
+			}
+		}
+	}
+
+	void testSelect() {
+		// Each segment is encoded differently, while the random values are stored as they are
+		std::mt19937 random(1337);
+		std::vector<std::int32_t> values;
+		for (std::size_t i = 0; i < COLUMN_SEGMENT_SIZE; i++) {
+			values.push_back((std::int32_t)i);
+		}
+
+		for (std::size_t i = 0; i < COLUMN_SEGMENT_SIZE; i++) {
+			values.push_back((std::int32_t)(random() % 4) * 100000);
+		}
+
+		for (std::size_t i = 0; i < COLUMN_SEGMENT_SIZE; i++) {
+			values.push_back((std::int32_t)(i / 5000) * 100);
+		}
+
+		for (std::size_t i = 0; i < COLUMN_SEGMENT_SIZE + 1000; i++) {
+			values.push_back((std::int32_t)random());
+		}
+
+		auto column = toColumn(values);
+		column.encodeFullSegments();
+		TS_ASSERT_EQUALS(column.size(), values.size());
+		TS_ASSERT_EQUALS(column.numSegments(), 5);
+		TS_ASSERT_EQUALS(column.encodedSegment(0)->encoding, SegmentEncoding::FrameOfReference);
+		TS_ASSERT_EQUALS(column.encodedSegment(1)->encoding, SegmentEncoding::Dictionary);
+		TS_ASSERT_EQUALS(column.encodedSegment(2)->encoding, SegmentEncoding::RunLength);
+		TS_ASSERT(column.encodedSegment(3) == nullptr);
+		TS_ASSERT(column.encodedSegment(4) == nullptr);
+		TS_ASSERT(column.segmentValues(0) == nullptr);
+		TS_ASSERT_LESS_THAN(column.numBytes(), values.size() * sizeof(std::int32_t) * 3 / 4);
+
+		// The encoded segments are decoded when read
+		TS_ASSERT(std::equal(column.begin(), column.end(), values.begin()));
+		std::size_t numValues = 0;
+		column.forEachSegment(60000, 3 * COLUMN_SEGMENT_SIZE + 10, [&](const std::int32_t* segmentValues, std::size_t startIndex, std::size_t count) {
+			TS_ASSERT(std::equal(segmentValues, segmentValues + count, values.begin() + startIndex));
+			numValues += count;
+		});
+		TS_ASSERT_EQUALS(numValues, 3 * COLUMN_SEGMENT_SIZE + 10 - 60000);
+
+		for (auto value : { -1, 0, 500, 100000, 200001, 1000, 65535, 1000000 }) {
+			testSelectEncoded(column, value, 0, column.size());
+			testSelectEncoded(column, value, 60000, 10000);
+			testSelectEncoded(column, value, 2 * COLUMN_SEGMENT_SIZE + 4999, 5002);
+		}
+	}
+
+	void testUpdate() {
+		std::vector<std::int32_t> values(COLUMN_SEGMENT_SIZE + 10, 7);
+		auto column = toColumn(values);
+		column.encodeFullSegments();
+		TS_ASSERT(column.segmentValues(0) == nullptr);
+		TS_ASSERT_LESS_THAN(column.encodedSegment(0)->numBytes(), 64);
+
+		// Writing to an encoded segment decodes it until it is encoded again
+		column.set(100, 8);
+		TS_ASSERT(column.encodedSegment(0) == nullptr);
+		TS_ASSERT_EQUALS(column[100], 8);
+		column.push_back(9);
+		column.encodeFullSegments();
+		TS_ASSERT(column.segmentValues(0) == nullptr);
+		TS_ASSERT_EQUALS(column.size(), values.size() + 1);
+		TS_ASSERT_EQUALS(column[99], 7);
+		TS_ASSERT_EQUALS(column[100], 8);
+		TS_ASSERT_EQUALS(column.back(), 9);
+		testSelectEncoded(column, 8, 0, column.size());
+
+		// Copies keep the segments encoded
+		auto copy = column;
+		TS_ASSERT(copy.segmentValues(0) == nullptr);
+		TS_ASSERT(std::equal(copy.begin(), copy.end(), column.begin()));
+		TS_ASSERT_EQUALS(copy.size(), column.size());
+
+		// Removing rows from the end decodes the segment that values are then appended to
+		column.resize(1000);
+		TS_ASSERT(column.encodedSegment(0) == nullptr);
+		column.push_back(10);
+		TS_ASSERT_EQUALS(column[100], 8);
+		TS_ASSERT_EQUALS(column.back(), 10);
+	}
+
+	void testTable() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, defaultTestConfig(), {}, COLUMN_SEGMENT_SIZE + 100);
+		auto& table = databaseEngine->getTable("test_table");
+		auto& x = table.getColumnValues<std::int32_t>("x");
+		TS_ASSERT(x.encodedSegment(0) != nullptr);
+		TS_ASSERT(x.encodedSegment(1) == nullptr);
+		TS_ASSERT_EQUALS(x[500], 500);
+
+		// Projections decode the encoded values
+		QueryResult result;
+		databaseEngine->execute(createQuery(databaseEngine->parse("SELECT x, z FROM test_table WHERE x >= 65000")), result);
+		TS_ASSERT_EQUALS(result.columns[0].size(), tableData.size() - 65000);
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[65000 + i][0], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), tableData[65000 + i][2], i, 1);
+		}
+
+		databaseEngine->execute(createQuery(databaseEngine->parse("UPDATE test_table SET x = 5000 WHERE x == 500")), result);
+		TS_ASSERT(x.encodedSegment(0) != nullptr);
+		TS_ASSERT_EQUALS(x[500], 5000);
+		TS_ASSERT_EQUALS(x[501], 501);
+		TS_ASSERT_EQUALS(table.getColumn("y").getUnderlyingStorage<float>().encodedSegment(0), nullptr);
+	}
+};
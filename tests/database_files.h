@@ -0,0 +1,198 @@
+#pragma once
+#include <cxxtest/TestSuite.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../src/database_files.h"
+#include "test_helpers.h"
+
+class DatabaseFilesTestSuite : public CxxTest::TestSuite {
+private:
+	void addFlagsTable(DatabaseEngine& databaseEngine) {
+		Schema schema("flags", { ColumnDefinition(0, "id", ColumnType::Int32), ColumnDefinition(1, "flag", ColumnType::Bool) }, {});
+		databaseEngine.addTable("flags", std::make_unique<Table>(std::move(schema)));
+
+		auto& table = databaseEngine.getTable("flags");
+		for (std::int32_t i = 0; i < 100; i++) {
+			table.insertRow(std::make_pair(std::string("id"), i), std::make_pair(std::string("flag"), i % 3 == 0));
+		}
+	}
+
+	std::vector<std::string> columnFileNames(const std::string& directory) {
+		std::vector<std::string> names;
+		auto entries = opendir(directory.c_str());
+		while (auto entry = readdir(entries)) {
+			std::string name = entry->d_name;
+			if (name.size() > 7 && name.substr(name.size() - 7) == ".column") {
+				names.push_back(name);
+			}
+		}
+
+		closedir(entries);
+		std::sort(names.begin(), names.end());
+		return names;
+	}
+
+	template<typename T>
+	bool isMapped(const Table& table, const std::string& column) {
+		return table.getColumn(column).getUnderlyingStorage<T>().numMappedSegments() > 0;
+	}
+public:
+	void testSaveAndOpen() {
+		TemporaryDirectory directory;
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(
+			tableData,
+			defaultTestConfig(),
+			{ IndexDefinition("x", IndexType::Hash), IndexDefinition("z") });
+		addFlagsTable(*databaseEngine);
+		databaseEngine->save(directory.path);
+
+		auto openedEngine = openTestDatabase(directory.path);
+		auto& table = openedEngine->getTable("test_table");
+		TS_ASSERT_EQUALS(table.numRows(), tableData.size());
+		TS_ASSERT_EQUALS(table.indices().size(), 1);
+		TS_ASSERT_EQUALS(table.hashIndices().size(), 1);
+		TS_ASSERT(isMapped<std::int32_t>(table, "x"));
+		TS_ASSERT(isMapped<float>(table, "y"));
+
+		for (std::size_t i = 0; i < tableData.size(); i++) {
+			for (std::size_t columnIndex = 0; columnIndex < 3; columnIndex++) {
+				auto& column = table.getColumn(table.schema().columns()[columnIndex].name());
+				ASSERT_EQUALS_DB_ENTRY(column.getValue(i), tableData[i][columnIndex], i, columnIndex);
+			}
+		}
+
+		auto& flagsTable = openedEngine->getTable("flags");
+		TS_ASSERT_EQUALS(flagsTable.numRows(), 100);
+		for (std::size_t i = 0; i < flagsTable.numRows(); i++) {
+			TS_ASSERT_EQUALS(flagsTable.getColumn("flag").getValue(i), QueryValue(i % 3 == 0));
+		}
+
+		auto query = createQuery(openedEngine->parse("SELECT x, y FROM test_table WHERE z >= 500 AND x < 100"));
+		QueryResult result;
+		openedEngine->execute(query, result);
+
+		std::size_t resultIndex = 0;
+		for (std::size_t i = 0; i < 100; i++) {
+			if (tableData[i][2].getValue<std::int32_t>() >= 500) {
+				ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(resultIndex), tableData[i][0], resultIndex, 0);
+				ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(resultIndex), tableData[i][1], resultIndex, 1);
+				resultIndex++;
+			}
+		}
+
+		TS_ASSERT_EQUALS(result.columns[0].size(), resultIndex);
+		TS_ASSERT_EQUALS(table.statistics("z").count(), tableData.size());
+	}
+
+	void testOpenMapsFullSegments() {
+		TemporaryDirectory directory;
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, defaultTestConfig(), {}, 3 * COLUMN_SEGMENT_SIZE + 10);
+		auto& savedValues = databaseEngine->getTable("test_table").getColumnValues<std::int32_t>("x");
+		TS_ASSERT(savedValues.encodedSegment(0) != nullptr);
+		databaseEngine->save(directory.path);
+
+		// The values are read from the files as they are, rather than encoded when opened
+		auto openedEngine = openTestDatabase(directory.path);
+		auto& table = openedEngine->getTable("test_table");
+		auto& values = table.getColumnValues<std::int32_t>("x");
+		TS_ASSERT_EQUALS(values.numSegments(), 4);
+		TS_ASSERT_EQUALS(values.numMappedSegments(), values.numSegments());
+		TS_ASSERT(values.encodedSegment(2) == nullptr);
+		TS_ASSERT_EQUALS(table.getColumnValues<float>("y").numMappedSegments(), 4);
+		TS_ASSERT_EQUALS(table.getColumnValues<std::int32_t>("z").numMappedSegments(), 4);
+		TS_ASSERT_EQUALS(values.numBytes(), 0);
+
+		for (std::size_t i : { (std::size_t)0, COLUMN_SEGMENT_SIZE + 17, tableData.size() - 1 }) {
+			for (std::size_t columnIndex = 0; columnIndex < 3; columnIndex++) {
+				auto& column = table.getColumn(table.schema().columns()[columnIndex].name());
+				ASSERT_EQUALS_DB_ENTRY(column.getValue(i), tableData[i][columnIndex], i, columnIndex);
+			}
+		}
+
+		QueryResult result;
+		openedEngine->execute(createQuery(openedEngine->parse("SELECT x FROM test_table WHERE x >= 196600")), result);
+		TS_ASSERT_EQUALS(result.columns[0].size(), tableData.size() - 196600);
+	}
+
+	void testChangeOpened() {
+		TemporaryDirectory directory;
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+		databaseEngine->save(directory.path);
+
+		// Changes are made to private copies of the mapped pages, until the tables are saved again
+		auto openedEngine = openTestDatabase(directory.path);
+		QueryResult result;
+		openedEngine->execute(createQuery(openedEngine->parse("UPDATE test_table SET z = 5000 WHERE x < 10")), result);
+		openedEngine->execute(createQuery(openedEngine->parse("INSERT INTO test_table (x, y, z) VALUES (1000, 1.0, 1)")), result);
+
+		auto& table = openedEngine->getTable("test_table");
+		TS_ASSERT_EQUALS(table.numRows(), tableData.size() + 1);
+		TS_ASSERT_EQUALS(table.getColumn("z").getValue(5), QueryValue(5000));
+		TS_ASSERT(!isMapped<std::int32_t>(table, "x"));
+
+		// The table files are unchanged, while the changes are in the write-ahead log
+		std::uint64_t walPosition = 0;
+		auto tables = DatabaseFiles::open(directory.path, walPosition);
+		TS_ASSERT_EQUALS(tables.at("test_table")->numRows(), tableData.size());
+		TS_ASSERT_EQUALS(tables.at("test_table")->getColumn("z").getValue(5), tableData[5][2]);
+
+		auto otherEngine = openTestDatabase(directory.path);
+		TS_ASSERT_EQUALS(otherEngine->getTable("test_table").numRows(), tableData.size() + 1);
+		TS_ASSERT_EQUALS(otherEngine->getTable("test_table").getColumn("z").getValue(5), QueryValue(5000));
+
+		openedEngine->save(directory.path);
+		auto savedEngine = openTestDatabase(directory.path);
+		TS_ASSERT_EQUALS(savedEngine->getTable("test_table").numRows(), tableData.size() + 1);
+		TS_ASSERT_EQUALS(savedEngine->getTable("test_table").getColumn("z").getValue(5), QueryValue(5000));
+		TS_ASSERT_EQUALS(savedEngine->getTable("test_table").getColumn("x").getValue(tableData.size()), QueryValue(1000));
+	}
+
+	void testInvalidFiles() {
+		TemporaryDirectory directory;
+		auto databaseEngine = std::make_unique<DatabaseEngine>(defaultTestConfig());
+		TS_ASSERT_THROWS_ANYTHING(databaseEngine->open(directory.path + "/missing"));
+
+		std::vector<std::vector<QueryValue>> tableData;
+		auto savedEngine = setupTest(tableData);
+		savedEngine->save(directory.path);
+		TS_ASSERT_EQUALS(truncate((directory.path + "/test_table.y.1.column").c_str(), 100), 0);
+		TS_ASSERT_THROWS_ANYTHING(databaseEngine->open(directory.path));
+	}
+
+	void testCrashBeforeCatalog() {
+		TemporaryDirectory directory;
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+		databaseEngine->save(directory.path);
+		TS_ASSERT_EQUALS(
+			columnFileNames(directory.path),
+			std::vector<std::string>({ "test_table.x.1.column", "test_table.y.1.column", "test_table.z.1.column" }));
+
+		// The catalog can't be replaced, like a crash after the column files of the next save have been written
+		QueryResult result;
+		databaseEngine->execute(createQuery(databaseEngine->parse("INSERT INTO test_table (x, y, z) VALUES (1000, 1.0, 1)")), result);
+		auto temporaryCatalogPath = directory.path + "/catalog.tmp";
+		TS_ASSERT_EQUALS(mkdir(temporaryCatalogPath.c_str(), 0700), 0);
+		TS_ASSERT_THROWS_ANYTHING(databaseEngine->save(directory.path));
+		TS_ASSERT_EQUALS(columnFileNames(directory.path).size(), 6);
+
+		auto openedEngine = openTestDatabase(directory.path);
+		TS_ASSERT_EQUALS(openedEngine->getTable("test_table").numRows(), tableData.size());
+		TS_ASSERT_EQUALS(openedEngine->getTable("test_table").getColumn("z").getValue(5), tableData[5][2]);
+
+		// The next save replaces the catalog, and removes the files of the earlier epochs
+		rmdir(temporaryCatalogPath.c_str());
+		databaseEngine->save(directory.path);
+		TS_ASSERT_EQUALS(
+			columnFileNames(directory.path),
+			std::vector<std::string>({ "test_table.x.2.column", "test_table.y.2.column", "test_table.z.2.column" }));
+
+		auto savedEngine = openTestDatabase(directory.path);
+		TS_ASSERT_EQUALS(savedEngine->getTable("test_table").numRows(), tableData.size() + 1);
+	}
+};
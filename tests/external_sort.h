@@ -0,0 +1,96 @@
+#pragma once
+#include <cxxtest/TestSuite.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../src/database_engine.h"
+#include "../src/execution/external_sort.h"
+
+class ExternalSortTestSuite : public CxxTest::TestSuite {
+private:
+	void addRows(std::vector<std::vector<RawQueryValue>>& orderingData,
+				 QueryResult& result,
+				 const std::vector<std::int32_t>& keys,
+				 std::int32_t firstRowId) {
+		for (std::size_t i = 0; i < keys.size(); i++) {
+			orderingData[0].push_back(QueryValue(keys[i]).data);
+			result.columns[0].getUnderlyingStorage<std::int32_t>().push_back(firstRowId + (std::int32_t)i);
+			result.columns[1].getUnderlyingStorage<bool>().push_back(keys[i] % 2 == 0);
+			result.columns[2].getUnderlyingStorage<float>().push_back(keys[i] * 0.5f);
+		}
+	}
+
+	QueryResult createResult() {
+		QueryResult result;
+		result.columns.emplace_back(ColumnType::Int32);
+		result.columns.emplace_back(ColumnType::Bool);
+		result.columns.emplace_back(ColumnType::Float32);
+		return result;
+	}
+public:
+	void testMerge() {
+		DatabaseConfiguration config;
+		ExternalSort externalSort(
+			config,
+			{ ColumnType::Int32 },
+			{ OrderingColumn { "x", true } },
+			{ ColumnType::Int32, ColumnType::Bool, ColumnType::Float32 });
+
+		std::mt19937 random(1337);
+		std::uniform_int_distribution<std::int32_t> distribution(-100, 100);
+
+		// The row id of each row is its position when added
+		std::vector<std::int32_t> allKeys;
+		std::vector<std::vector<RawQueryValue>> orderingData(1);
+		auto result = createResult();
+		for (auto numRows : { 1000, 10, 3000 }) {
+			std::vector<std::int32_t> keys;
+			for (std::int32_t i = 0; i < numRows; i++) {
+				keys.push_back(distribution(random));
+			}
+
+			addRows(orderingData, result, keys, (std::int32_t)allKeys.size());
+			allKeys.insert(allKeys.end(), keys.begin(), keys.end());
+			externalSort.addRun(orderingData, result);
+
+			TS_ASSERT(orderingData[0].empty());
+			TS_ASSERT_EQUALS(result.columns[0].size(), 0);
+		}
+
+		TS_ASSERT_EQUALS(externalSort.numRuns(), 3);
+		externalSort.merge(result);
+
+		std::vector<std::int32_t> expectedRowIds(allKeys.size());
+		for (std::size_t i = 0; i < expectedRowIds.size(); i++) {
+			expectedRowIds[i] = (std::int32_t)i;
+		}
+
+		std::stable_sort(expectedRowIds.begin(), expectedRowIds.end(), [&](std::int32_t x, std::int32_t y) {
+			return allKeys[x] > allKeys[y];
+		});
+
+		TS_ASSERT_EQUALS(result.columns[0].size(), allKeys.size());
+		TS_ASSERT_EQUALS(result.getColumn<std::int32_t>(0), expectedRowIds);
+		for (std::size_t i = 0; i < expectedRowIds.size(); i++) {
+			auto key = allKeys[expectedRowIds[i]];
+			TS_ASSERT_EQUALS(result.getColumn<bool>(1)[i], key % 2 == 0);
+			TS_ASSERT_EQUALS(result.getColumn<float>(2)[i], key * 0.5f);
+		}
+	}
+
+	void testInvalidDirectory() {
+		DatabaseConfiguration config;
+		config.sortDirectory = "/non_existing_directory";
+		ExternalSort externalSort(config, { ColumnType::Int32 }, { OrderingColumn { "x", false } }, { ColumnType::Int32 });
+
+		std::vector<std::vector<RawQueryValue>> orderingData(1);
+		orderingData[0].push_back(QueryValue(1).data);
+
+		QueryResult result;
+		result.columns.emplace_back(ColumnType::Int32);
+		result.columns[0].getUnderlyingStorage<std::int32_t>().push_back(1);
+
+		TS_ASSERT_THROWS_ANYTHING(externalSort.addRun(orderingData, result));
+	}
+};
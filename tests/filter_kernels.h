@@ -0,0 +1,107 @@
+#pragma once
+#include <cxxtest/TestSuite.h>
+#include <random>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "../src/execution/filter_kernels.h"
+
+namespace {
+	std::vector<FilterInstructionSet> supportedInstructionSets() {
+		std::vector<FilterInstructionSet> instructionSets { FilterInstructionSet::Scalar };
+		if (FilterKernels::bestInstructionSet() != FilterInstructionSet::Scalar) {
+			instructionSets.push_back(FilterInstructionSet::SSE2);
+		}
+
+		if (FilterKernels::bestInstructionSet() == FilterInstructionSet::AVX2) {
+			instructionSets.push_back(FilterInstructionSet::AVX2);
+		}
+
+		return instructionSets;
+	}
+
+	std::vector<CompareOperator> allCompareOperators() {
+		return {
+			CompareOperator::Equal,
+			CompareOperator::NotEqual,
+			CompareOperator::LessThan,
+			CompareOperator::LessThanOrEqual,
+			CompareOperator::GreaterThan,
+			CompareOperator::GreaterThanOrEqual
+		};
+	}
+
+	template<typename T>
+	void testKernels(const std::vector<T>& values, T value) {
+		for (auto instructionSet : supportedInstructionSets()) {
+			for (auto op : allCompareOperators()) {
+				std::size_t startRowIndex = 100;
+
+				std::vector<std::size_t> expectedSelection;
+				for (std::size_t i = 0; i < values.size(); i++) {
+					if (QueryExpressionHelpers::compare(op, values[i], value)) {
+						expectedSelection.push_back(startRowIndex + i);
+					}
+				}
+
+				std::vector<std::size_t> selection(values.size());
+				selection.resize(FilterKernels::select(
+					instructionSet,
+					op,
+					values.data(),
+					values.size(),
+					value,
+					startRowIndex,
+					selection.data()));
+				TS_ASSERT_EQUALS(selection, expectedSelection);
+
+				std::unique_ptr<bool[]> result(new bool[values.size()]);
+				FilterKernels::compare(instructionSet, op, values.data(), values.size(), value, result.get());
+				for (std::size_t i = 0; i < values.size(); i++) {
+					TS_ASSERT_EQUALS(result[i], QueryExpressionHelpers::compare(op, values[i], value));
+				}
+			}
+		}
+	}
+}
+
+class FilterKernelsTestSuite : public CxxTest::TestSuite {
+public:
+	void testInt32() {
+		std::mt19937 random(1337);
+		std::uniform_int_distribution<std::int32_t> distribution(-50, 50);
+
+		std::vector<std::int32_t> values;
+		for (std::size_t i = 0; i < 1003; i++) {
+			values.push_back(distribution(random));
+		}
+
+		testKernels<std::int32_t>(values, 0);
+		testKernels<std::int32_t>(values, 17);
+		testKernels<std::int32_t>(values, -1000);
+	}
+
+	void testFloat32() {
+		std::mt19937 random(1337);
+		std::uniform_real_distribution<float> distribution(0.0f, 1000.0f);
+
+		std::vector<float> values;
+		for (std::size_t i = 0; i < 1003; i++) {
+			values.push_back(std::floor(distribution(random)));
+		}
+
+		testKernels<float>(values, 900.0f);
+		testKernels<float>(values, 1500.0f);
+	}
+
+	void testFloat32NaN() {
+		std::vector<float> values { 1.0f, std::nanf(""), 3.0f, 4.0f, std::nanf(""), 6.0f, 7.0f, 8.0f, 9.0f };
+		testKernels<float>(values, 4.0f);
+	}
+
+	void testSmall() {
+		testKernels<std::int32_t>({}, 0);
+		testKernels<std::int32_t>({ 1, 2, 3 }, 2);
+	}
+};
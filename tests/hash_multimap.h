@@ -0,0 +1,120 @@
+#pragma once
+#include <cxxtest/TestSuite.h>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "../src/hash_multimap.h"
+
+namespace {
+	using TestHashMap = HashMultiMap<std::int32_t, std::size_t>;
+	using ExpectedHashMap = std::multimap<std::int32_t, std::size_t>;
+
+	std::vector<std::size_t> collectValues(const TestHashMap& map, std::int32_t key) {
+		std::vector<std::size_t> values;
+		map.forEachValue(key, [&](std::size_t value) {
+			values.push_back(value);
+		});
+
+		return values;
+	}
+
+	std::vector<std::size_t> collectValues(const ExpectedHashMap& map, std::int32_t key) {
+		std::vector<std::size_t> values;
+		auto range = map.equal_range(key);
+		for (auto it = range.first; it != range.second; ++it) {
+			values.push_back(it->second);
+		}
+
+		return values;
+	}
+
+	void assertSameValues(const TestHashMap& map, const ExpectedHashMap& expected, std::int32_t minKey, std::int32_t maxKey) {
+		TS_ASSERT_EQUALS(map.size(), expected.size());
+		for (auto key = minKey; key <= maxKey; key++) {
+			TS_ASSERT(collectValues(map, key) == collectValues(expected, key));
+		}
+	}
+}
+
+class HashMultiMapTestSuite : public CxxTest::TestSuite {
+public:
+	void testEmpty() {
+		TestHashMap map;
+		TS_ASSERT(map.empty());
+		TS_ASSERT_EQUALS(map.count(5), 0);
+		TS_ASSERT(!map.erase(5, 0));
+	}
+
+	void testDuplicates() {
+		TestHashMap map;
+		ExpectedHashMap expected;
+
+		std::mt19937 random(1337);
+		std::uniform_int_distribution<std::int32_t> distribution(0, 100);
+		for (std::size_t i = 0; i < 5000; i++) {
+			auto key = distribution(random);
+			map.emplace(key, i);
+			expected.emplace(key, i);
+		}
+
+		assertSameValues(map, expected, -1, 101);
+	}
+
+	void testErase() {
+		TestHashMap map;
+		ExpectedHashMap expected;
+
+		std::mt19937 random(1337);
+		std::uniform_int_distribution<std::int32_t> distribution(0, 200);
+		std::vector<std::int32_t> keys;
+		for (std::size_t i = 0; i < 2000; i++) {
+			auto key = distribution(random);
+			keys.push_back(key);
+			map.emplace(key, i);
+			expected.emplace(key, i);
+		}
+
+		// Erase like HashIndex::update does, then insert again with a new key
+		for (std::size_t i = 0; i < 2000; i += 3) {
+			auto newKey = distribution(random);
+			TS_ASSERT(map.erase(keys[i], i));
+
+			auto expectedRange = expected.equal_range(keys[i]);
+			for (auto it = expectedRange.first; it != expectedRange.second; ++it) {
+				if (it->second == i) {
+					expected.erase(it);
+					break;
+				}
+			}
+
+			keys[i] = newKey;
+			map.emplace(newKey, i);
+			expected.emplace(newKey, i);
+		}
+
+		assertSameValues(map, expected, -1, 201);
+	}
+
+	void testReserve() {
+		TestHashMap map;
+		ExpectedHashMap expected;
+
+		std::mt19937 random(1337);
+		std::uniform_int_distribution<std::int32_t> distribution(0, 100);
+		for (std::size_t i = 0; i < 100; i++) {
+			auto key = distribution(random);
+			map.emplace(key, i);
+			expected.emplace(key, i);
+		}
+
+		map.reserve(5000);
+		for (std::size_t i = 100; i < 5000; i++) {
+			auto key = distribution(random);
+			map.emplace(key, i);
+			expected.emplace(key, i);
+		}
+
+		assertSameValues(map, expected, -1, 101);
+	}
+};
@@ -0,0 +1,121 @@
+#pragma once
+#include <cxxtest/TestSuite.h>
+#include <algorithm>
+#include <random>
+
+#include "test_helpers.h"
+
+class InsertTestSuite : public CxxTest::TestSuite {
+private:
+	std::vector<std::int32_t> selectX(DatabaseEngine& databaseEngine, const std::string& text) {
+		auto query = createQuery(databaseEngine.parse(text));
+		QueryResult result;
+		databaseEngine.execute(query, result);
+
+		auto& column = result.getColumn<std::int32_t>(0);
+		std::vector<std::int32_t> values(column.begin(), column.end());
+		std::sort(values.begin(), values.end());
+		return values;
+	}
+public:
+	void testInsert() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(
+			tableData,
+			defaultTestConfig(),
+			{ IndexDefinition("x"), IndexDefinition("z", IndexType::Hash) });
+
+		auto query = createQuery(databaseEngine->parse(
+			"INSERT INTO test_table (z, x, y) VALUES (5000, 1000, 1.0), (5001, 1001, 2.0), (5000, 1002, 3.0)"));
+		QueryResult result;
+		databaseEngine->execute(query, result);
+
+		auto& table = databaseEngine->getTable("test_table");
+		TS_ASSERT_EQUALS(table.numRows(), 1003);
+		TS_ASSERT_EQUALS(table.statistics("x").count(), 1003);
+		TS_ASSERT_EQUALS(table.getColumn("y").getValue(1001), QueryValue(2.0f));
+		TS_ASSERT_EQUALS(table.getColumn("z").getValue(1001), QueryValue(5001));
+
+		TS_ASSERT_EQUALS(selectX(*databaseEngine, "SELECT x FROM test_table WHERE x >= 999"), std::vector<std::int32_t>({ 999, 1000, 1001, 1002 }));
+		TS_ASSERT_EQUALS(selectX(*databaseEngine, "SELECT x FROM test_table WHERE z == 5000"), std::vector<std::int32_t>({ 1000, 1002 }));
+	}
+
+	void testInsertInvalid() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+
+		// Nothing is inserted when a row is invalid
+		auto wrongType = createQuery(databaseEngine->parse("INSERT INTO test_table (x, y, z) VALUES (1, 1.0, 1), (2, 2, 2)"));
+		auto wrongNumValues = createQuery(databaseEngine->parse("INSERT INTO test_table (x, y, z) VALUES (1, 1.0, 1), (2, 2.0)"));
+		auto wrongNumColumns = createQuery(databaseEngine->parse("INSERT INTO test_table (x, y) VALUES (1, 1.0)"));
+
+		QueryResult result;
+		TS_ASSERT_THROWS_ANYTHING(databaseEngine->execute(wrongType, result));
+		TS_ASSERT_THROWS_ANYTHING(databaseEngine->execute(wrongNumValues, result));
+		TS_ASSERT_THROWS_ANYTHING(databaseEngine->execute(wrongNumColumns, result));
+		TS_ASSERT_EQUALS(databaseEngine->getTable("test_table").numRows(), tableData.size());
+	}
+
+	void testAppendColumns() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(
+			tableData,
+			defaultTestConfig(),
+			{ IndexDefinition("z"), IndexDefinition("x", IndexType::Hash) },
+			0);
+
+		std::mt19937 random(1337);
+		std::uniform_int_distribution<std::int32_t> distribution(0, 100);
+
+		// The first batch is moved into the empty table, the others are merged into the existing rows and indices
+		auto& table = databaseEngine->getTable("test_table");
+		for (auto numRows : { 3000, 10, 5000 }) {
+			std::vector<ColumnStorage> columns;
+			columns.emplace_back(ColumnType::Int32);
+			columns.emplace_back(ColumnType::Float32);
+			columns.emplace_back(ColumnType::Int32);
+
+			for (std::int32_t i = 0; i < numRows; i++) {
+				auto x = (std::int32_t)tableData.size();
+				auto y = (float)i;
+				auto z = distribution(random);
+				columns[0].getUnderlyingStorage<std::int32_t>().push_back(x);
+				columns[1].getUnderlyingStorage<float>().push_back(y);
+				columns[2].getUnderlyingStorage<std::int32_t>().push_back(z);
+				tableData.push_back({ QueryValue(x), QueryValue(y), QueryValue(z) });
+			}
+
+			table.appendColumns(std::move(columns));
+			TS_ASSERT_EQUALS(table.numRows(), tableData.size());
+		}
+
+		TS_ASSERT_EQUALS(table.getColumn("x").numSegments(), 1);
+
+		TS_ASSERT_EQUALS(table.statistics("z").count(), tableData.size());
+		TS_ASSERT_EQUALS(table.indices()[0]->getUnderlyingStorage<std::int32_t>().size(), tableData.size());
+		TS_ASSERT_EQUALS(table.hashIndices()[0]->getUnderlyingStorage<std::int32_t>().size(), tableData.size());
+
+		for (auto z : { 0, 42, 100 }) {
+			std::vector<std::int32_t> expectedX;
+			for (auto& row : tableData) {
+				if (row[2].getValue<std::int32_t>() >= z && row[2].getValue<std::int32_t>() <= z + 1) {
+					expectedX.push_back(row[0].getValue<std::int32_t>());
+				}
+			}
+
+			auto text = "SELECT x FROM test_table WHERE z >= " + std::to_string(z) + " AND z <= " + std::to_string(z + 1);
+			TS_ASSERT_EQUALS(selectX(*databaseEngine, text), expectedX);
+		}
+
+		for (auto x : { 0, 2999, 3000, 8009 }) {
+			auto text = "SELECT x FROM test_table WHERE x == " + std::to_string(x);
+			TS_ASSERT_EQUALS(selectX(*databaseEngine, text), std::vector<std::int32_t>({ x }));
+		}
+
+		std::vector<ColumnStorage> wrongTypes;
+		wrongTypes.emplace_back(ColumnType::Int32);
+		wrongTypes.emplace_back(ColumnType::Int32);
+		wrongTypes.emplace_back(ColumnType::Int32);
+		TS_ASSERT_THROWS_ANYTHING(table.appendColumns(std::move(wrongTypes)));
+	}
+};
@@ -8,8 +8,8 @@
 
 std::unique_ptr<DatabaseEngine> setupJoinTest(std::vector<std::vector<QueryValue>>& tableData1,
 											  std::vector<std::vector<QueryValue>>& tableData2,
-											  std::initializer_list<std::string> indices1 = {},
-											  std::initializer_list<std::string> indices2 = {},
+											  std::initializer_list<IndexDefinition> indices1 = {},
+											  std::initializer_list<IndexDefinition> indices2 = {},
 											  std::int32_t count1 = 1000,
 											  std::int32_t count2 = 1000) {
 	Schema table1Schema(
@@ -260,6 +260,122 @@ public:
 		}
 	}
 
+	void testIndexJoin() {
+		for (auto indexType : { IndexType::Tree, IndexType::Hash }) {
+			std::vector<std::vector<QueryValue>> tableData1;
+			std::vector<std::vector<QueryValue>> tableData2;
+			auto databaseEngine = setupJoinTest(tableData1, tableData2, {}, { IndexDefinition("x", indexType) });
+
+			std::vector<std::vector<QueryValue>> expectedResults;
+			for (std::size_t i = 0; i < tableData1.size(); i++) {
+				for (std::size_t j = 0; j < tableData2.size(); j++) {
+					auto left = tableData1[i][2].getValue<std::int32_t>();
+					auto right = tableData2[j][1].getValue<std::int32_t>();
+					if (left == right) {
+						std::vector<QueryValue> row;
+
+						row.push_back(tableData1[i][2]);
+						row.push_back(tableData2[j][1]);
+						row.push_back(tableData1[i][1]);
+						row.push_back(tableData2[j][2]);
+
+						expectedResults.push_back(std::move(row));
+					}
+				}
+			}
+
+			auto query = createQuery(std::make_unique<QuerySelectOperation>(
+				"test_table1",
+				QueryExpressionHelpers::createColumnReferences({
+					"test_table1.z",
+					"test_table2.x",
+					"test_table1.y",
+					"test_table2.y"
+				}),
+				std::unique_ptr<QueryExpression>(),
+				JoinClause("z", "test_table2", "x"),
+				OrderingClause({
+					OrderingColumn { "test_table1.i", false },
+					OrderingColumn { "test_table2.i", false },
+				})
+			));
+
+			QueryResult result;
+			databaseEngine->execute(query, result);
+
+			TS_ASSERT_EQUALS(result.columns.size(), 4);
+			TS_ASSERT_EQUALS(result.columns[0].size(), expectedResults.size());
+
+			for (std::size_t rowIndex = 0; rowIndex < result.columns[0].size(); rowIndex++) {
+				for (std::size_t columnIndex = 0; columnIndex < 4; columnIndex++) {
+					ASSERT_EQUALS_DB_ENTRY(
+						result.columns[columnIndex].getValue(rowIndex),
+						expectedResults[rowIndex][columnIndex],
+						rowIndex,
+						columnIndex);
+				}
+			}
+		}
+	}
+
+	void testDifferentSizes() {
+		for (auto counts : { std::make_pair(300, 1000), std::make_pair(1000, 300) }) {
+			std::vector<std::vector<QueryValue>> tableData1;
+			std::vector<std::vector<QueryValue>> tableData2;
+			auto databaseEngine = setupJoinTest(tableData1, tableData2, {}, {}, counts.first, counts.second);
+
+			std::vector<std::vector<QueryValue>> expectedResults;
+			for (std::size_t i = 0; i < tableData1.size(); i++) {
+				for (std::size_t j = 0; j < tableData2.size(); j++) {
+					auto left = tableData1[i][2].getValue<std::int32_t>();
+					auto right = tableData2[j][1].getValue<std::int32_t>();
+					if (left == right) {
+						std::vector<QueryValue> row;
+
+						row.push_back(tableData1[i][0]);
+						row.push_back(tableData2[j][0]);
+						row.push_back(tableData1[i][2]);
+						row.push_back(tableData2[j][1]);
+
+						expectedResults.push_back(std::move(row));
+					}
+				}
+			}
+
+			auto query = createQuery(std::make_unique<QuerySelectOperation>(
+				"test_table1",
+				QueryExpressionHelpers::createColumnReferences({
+					"test_table1.i",
+					"test_table2.i",
+					"test_table1.z",
+					"test_table2.x"
+				}),
+				std::unique_ptr<QueryExpression>(),
+				JoinClause("z", "test_table2", "x"),
+				OrderingClause({
+					OrderingColumn { "test_table1.i", false },
+					OrderingColumn { "test_table2.i", false },
+				})
+			));
+
+			QueryResult result;
+			databaseEngine->execute(query, result);
+
+			TS_ASSERT_EQUALS(result.columns.size(), 4);
+			TS_ASSERT_EQUALS(result.columns[0].size(), expectedResults.size());
+
+			for (std::size_t rowIndex = 0; rowIndex < result.columns[0].size(); rowIndex++) {
+				for (std::size_t columnIndex = 0; columnIndex < 4; columnIndex++) {
+					ASSERT_EQUALS_DB_ENTRY(
+						result.columns[columnIndex].getValue(rowIndex),
+						expectedResults[rowIndex][columnIndex],
+						rowIndex,
+						columnIndex);
+				}
+			}
+		}
+	}
+
 	void testFiltering1() {
 		std::vector<std::vector<QueryValue>> tableData1;
 		std::vector<std::vector<QueryValue>> tableData2;
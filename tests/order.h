@@ -134,4 +134,77 @@ public:
 			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[sortedIndices[i]][2], i, 0);
 		}
 	}
-};
\ No newline at end of file
+
+	void testRadixSortOrdering() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, defaultTestConfig(), {}, 10000);
+		auto query = createQuery(databaseEngine->parse("SELECT x FROM test_table ORDER BY z DESC, y"));
+
+		// Enough rows for the radix sort, which keeps the rows that compare equal in row order
+		std::vector<std::size_t> sortedIndices;
+		for (std::size_t i = 0; i < tableData.size(); i++) {
+			sortedIndices.push_back(i);
+		}
+
+		std::stable_sort(
+			sortedIndices.begin(),
+			sortedIndices.end(),
+			[&](std::size_t x, std::size_t y) {
+				auto lhsZ = tableData[x][2].getValue<std::int32_t>();
+				auto rhsZ = tableData[y][2].getValue<std::int32_t>();
+				if (lhsZ != rhsZ) {
+					return lhsZ > rhsZ;
+				}
+
+				return tableData[x][1].getValue<float>() < tableData[y][1].getValue<float>();
+			});
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns[0].size(), tableData.size());
+
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[sortedIndices[i]][0], i, 0);
+		}
+	}
+
+	void testExternalSortOrdering() {
+		auto config = defaultTestConfig();
+		config.sortMemoryLimit = 64 * 1024;
+
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, config, {}, 10000);
+		auto query = createQuery(databaseEngine->parse("SELECT x, y FROM test_table WHERE x >= 100 ORDER BY z DESC, y"));
+
+		std::vector<std::size_t> sortedIndices;
+		for (std::size_t i = 100; i < tableData.size(); i++) {
+			sortedIndices.push_back(i);
+		}
+
+		// The runs are merged in the order they were spilled, which keeps the rows that compare equal in row order
+		std::stable_sort(
+			sortedIndices.begin(),
+			sortedIndices.end(),
+			[&](std::size_t x, std::size_t y) {
+				auto lhsZ = tableData[x][2].getValue<std::int32_t>();
+				auto rhsZ = tableData[y][2].getValue<std::int32_t>();
+				if (lhsZ != rhsZ) {
+					return lhsZ > rhsZ;
+				}
+
+				return tableData[x][1].getValue<float>() < tableData[y][1].getValue<float>();
+			});
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns[0].size(), sortedIndices.size());
+		TS_ASSERT(std::any_of(result.plan.begin(), result.plan.end(), [](const std::string& step) {
+			return step.find("spilling sorted runs") != std::string::npos;
+		}));
+
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[sortedIndices[i]][0], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), tableData[sortedIndices[i]][1], i, 1);
+		}
+	}
+};
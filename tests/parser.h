@@ -218,6 +218,53 @@ public:
 		TS_ASSERT_EQUALS(compareExpressionSub11->value, QueryValue(10));
 	}
 
+	void testSelectOr1() {
+		auto tokens = Tokenizer::tokenize("SELECT x FROM test_table WHERE x > 5 AND x < 10 OR x == 20");
+		QueryParser parser(tokens);
+		auto operation = parser.parse();
+		auto selectOperation = dynamic_cast<QuerySelectOperation*>(operation.get());
+		TS_ASSERT_DIFFERS(selectOperation, nullptr);
+
+		// And binds tighter than or
+		auto orExpression = dynamic_cast<QueryOrExpression*>(selectOperation->filter.get());
+		TS_ASSERT_DIFFERS(orExpression, nullptr);
+		TS_ASSERT_DIFFERS(dynamic_cast<QueryAndExpression*>(orExpression->lhs.get()), nullptr);
+
+		auto compareExpression = dynamic_cast<QueryCompareExpression*>(orExpression->rhs.get());
+		TS_ASSERT_DIFFERS(compareExpression, nullptr);
+		TS_ASSERT_EQUALS(compareExpression->op, CompareOperator::Equal);
+	}
+
+	void testSelectBetween1() {
+		auto tokens = Tokenizer::tokenize("SELECT x FROM test_table WHERE x BETWEEN 5 AND 2 * 5 AND y > 1");
+		QueryParser parser(tokens);
+		auto operation = parser.parse();
+		auto selectOperation = dynamic_cast<QuerySelectOperation*>(operation.get());
+		TS_ASSERT_DIFFERS(selectOperation, nullptr);
+
+		auto andExpression = dynamic_cast<QueryAndExpression*>(selectOperation->filter.get());
+		TS_ASSERT_DIFFERS(andExpression, nullptr);
+		TS_ASSERT_DIFFERS(dynamic_cast<QueryCompareExpression*>(andExpression->rhs.get()), nullptr);
+
+		auto betweenExpression = dynamic_cast<QueryAndExpression*>(andExpression->lhs.get());
+		TS_ASSERT_DIFFERS(betweenExpression, nullptr);
+
+		auto lowerExpression = dynamic_cast<QueryCompareExpression*>(betweenExpression->lhs.get());
+		TS_ASSERT_DIFFERS(lowerExpression, nullptr);
+		TS_ASSERT_EQUALS(lowerExpression->op, CompareOperator::GreaterThanOrEqual);
+		TS_ASSERT_EQUALS(dynamic_cast<QueryColumnReferenceExpression*>(lowerExpression->lhs.get())->name, "x");
+		TS_ASSERT_EQUALS(dynamic_cast<QueryValueExpression*>(lowerExpression->rhs.get())->value, QueryValue(5));
+
+		auto upperExpression = dynamic_cast<QueryCompareExpression*>(betweenExpression->rhs.get());
+		TS_ASSERT_DIFFERS(upperExpression, nullptr);
+		TS_ASSERT_EQUALS(upperExpression->op, CompareOperator::LessThanOrEqual);
+		TS_ASSERT_EQUALS(dynamic_cast<QueryColumnReferenceExpression*>(upperExpression->lhs.get())->name, "x");
+		TS_ASSERT_DIFFERS(dynamic_cast<QueryMathExpression*>(upperExpression->rhs.get()), nullptr);
+
+		TS_ASSERT_THROWS_ANYTHING(QueryParser(Tokenizer::tokenize("SELECT x FROM test_table WHERE x BETWEEN 5")).parse());
+		TS_ASSERT_THROWS_ANYTHING(QueryParser(Tokenizer::tokenize("SELECT x FROM test_table WHERE x + 1 BETWEEN 5 AND 10")).parse());
+	}
+
 	void testSelectOrder1() {
 		auto tokens = Tokenizer::tokenize("SELECT x FROM test_table ORDER BY x");
 		QueryParser parser(tokens);
@@ -518,4 +565,105 @@ public:
 		TS_ASSERT_EQUALS(insertOperation->values[0][2], QueryValue(false));
 
 	}
-};
\ No newline at end of file
+
+	void testInsert2() {
+		auto tokens = Tokenizer::tokenize("INSERT INTO test_table (x, y) VALUES (10, 12.0), (11, 13.0), (12, 14.0)");
+		QueryParser parser(tokens);
+		auto operation = parser.parse();
+		auto insertOperation = dynamic_cast<QueryInsertOperation*>(operation.get());
+
+		TS_ASSERT_DIFFERS(insertOperation, nullptr);
+		TS_ASSERT_EQUALS(insertOperation->columns.size(), 2);
+		TS_ASSERT_EQUALS(insertOperation->values.size(), 3);
+		for (std::size_t i = 0; i < insertOperation->values.size(); i++) {
+			TS_ASSERT_EQUALS(insertOperation->values[i].size(), 2);
+			TS_ASSERT_EQUALS(insertOperation->values[i][0], QueryValue(10 + (std::int32_t)i));
+			TS_ASSERT_EQUALS(insertOperation->values[i][1], QueryValue(12.0f + i));
+		}
+	}
+
+	void testSelectAggregate1() {
+		auto tokens = Tokenizer::tokenize("SELECT COUNT(*), sum(x + 1) FROM test_table");
+		QueryParser parser(tokens);
+		auto operation = parser.parse();
+		auto selectOperation = dynamic_cast<QuerySelectOperation*>(operation.get());
+
+		TS_ASSERT_DIFFERS(selectOperation, nullptr);
+		TS_ASSERT_EQUALS(selectOperation->projections.size(), 2);
+		TS_ASSERT_EQUALS(selectOperation->group.empty(), true);
+		TS_ASSERT_EQUALS(selectOperation->isAggregation(), true);
+
+		auto projection0 = dynamic_cast<QueryAggregateExpression*>(selectOperation->projections[0].get());
+		TS_ASSERT_DIFFERS(projection0, nullptr);
+		TS_ASSERT_EQUALS(projection0->function, AggregateFunction::Count);
+		TS_ASSERT_EQUALS(projection0->argument.get(), nullptr);
+
+		auto projection1 = dynamic_cast<QueryAggregateExpression*>(selectOperation->projections[1].get());
+		TS_ASSERT_DIFFERS(projection1, nullptr);
+		TS_ASSERT_EQUALS(projection1->function, AggregateFunction::Sum);
+		TS_ASSERT_DIFFERS(dynamic_cast<QueryMathExpression*>(projection1->argument.get()), nullptr);
+	}
+
+	void testSelectGroup1() {
+		auto tokens = Tokenizer::tokenize("SELECT z, AVG(y) FROM test_table WHERE x < 10 GROUP BY z, x ORDER BY z");
+		QueryParser parser(tokens);
+		auto operation = parser.parse();
+		auto selectOperation = dynamic_cast<QuerySelectOperation*>(operation.get());
+
+		TS_ASSERT_DIFFERS(selectOperation, nullptr);
+		TS_ASSERT_EQUALS(selectOperation->projections.size(), 2);
+		TS_ASSERT_DIFFERS(selectOperation->filter.get(), nullptr);
+		TS_ASSERT_EQUALS(selectOperation->order.columns.size(), 1);
+
+		TS_ASSERT_EQUALS(selectOperation->group.columns.size(), 2);
+		TS_ASSERT_EQUALS(selectOperation->group.columns[0], "z");
+		TS_ASSERT_EQUALS(selectOperation->group.columns[1], "x");
+
+		auto projection1 = dynamic_cast<QueryAggregateExpression*>(selectOperation->projections[1].get());
+		TS_ASSERT_DIFFERS(projection1, nullptr);
+		TS_ASSERT_EQUALS(projection1->function, AggregateFunction::Average);
+	}
+
+	void testSelectAggregateInvalid() {
+		TS_ASSERT_THROWS_ANYTHING(QueryParser(Tokenizer::tokenize("SELECT foo(x) FROM test_table")).parse());
+		TS_ASSERT_THROWS_ANYTHING(QueryParser(Tokenizer::tokenize("SELECT sum(*) FROM test_table")).parse());
+	}
+
+	void testSelectLimit1() {
+		auto tokens = Tokenizer::tokenize("SELECT x FROM test_table WHERE x > 10 ORDER BY x LIMIT 20 OFFSET 5");
+		QueryParser parser(tokens);
+		auto operation = parser.parse();
+		auto selectOperation = dynamic_cast<QuerySelectOperation*>(operation.get());
+
+		TS_ASSERT_DIFFERS(selectOperation, nullptr);
+		TS_ASSERT_EQUALS(selectOperation->order.columns.size(), 1);
+		TS_ASSERT_EQUALS(selectOperation->limit.hasCount(), true);
+		TS_ASSERT_EQUALS(selectOperation->limit.count, 20);
+		TS_ASSERT_EQUALS(selectOperation->limit.offset, 5);
+	}
+
+	void testSelectLimit2() {
+		auto tokens = Tokenizer::tokenize("SELECT x FROM test_table OFFSET 5");
+		QueryParser parser(tokens);
+		auto operation = parser.parse();
+		auto selectOperation = dynamic_cast<QuerySelectOperation*>(operation.get());
+
+		TS_ASSERT_DIFFERS(selectOperation, nullptr);
+		TS_ASSERT_EQUALS(selectOperation->limit.hasCount(), false);
+		TS_ASSERT_EQUALS(selectOperation->limit.offset, 5);
+
+		TS_ASSERT_THROWS_ANYTHING(QueryParser(Tokenizer::tokenize("SELECT x FROM test_table LIMIT y")).parse());
+	}
+
+	void testExplain() {
+		auto tokens = Tokenizer::tokenize("EXPLAIN SELECT x FROM test_table WHERE x > 10");
+		QueryParser parser(tokens);
+		auto operation = parser.parse();
+		auto selectOperation = dynamic_cast<QuerySelectOperation*>(operation.get());
+
+		TS_ASSERT_DIFFERS(selectOperation, nullptr);
+		TS_ASSERT_EQUALS(selectOperation->explain, true);
+
+		TS_ASSERT_THROWS_ANYTHING(QueryParser(Tokenizer::tokenize("EXPLAIN UPDATE test_table SET x = 1")).parse());
+	}
+};
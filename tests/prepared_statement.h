@@ -0,0 +1,166 @@
+#pragma once
+#include <cxxtest/TestSuite.h>
+#include <algorithm>
+#include <thread>
+
+#include "../src/prepared_statement.h"
+#include "test_helpers.h"
+
+class PreparedStatementTestSuite : public CxxTest::TestSuite {
+public:
+	void testSelect() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+		auto statement = databaseEngine->prepare("SELECT x, y FROM test_table WHERE x >= ? AND y < ?");
+		TS_ASSERT_EQUALS(statement->numParameters(), 2);
+		TS_ASSERT(!statement->isCompiled());
+
+		for (auto minX : { 100, 500, 900 }) {
+			QueryResult result;
+			statement->execute({ QueryValue(minX), QueryValue(500.0f) }, result);
+			TS_ASSERT(statement->isCompiled());
+
+			std::size_t resultIndex = 0;
+			for (std::size_t i = 0; i < tableData.size(); i++) {
+				if (tableData[i][0].getValue<std::int32_t>() >= minX && tableData[i][1].getValue<float>() < 500.0f) {
+					ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(resultIndex), tableData[i][0], resultIndex, 0);
+					ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(resultIndex), tableData[i][1], resultIndex, 1);
+					resultIndex++;
+				}
+			}
+
+			TS_ASSERT_EQUALS(result.columns[0].size(), resultIndex);
+		}
+	}
+
+	void testIndexScan() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(
+			tableData,
+			defaultTestConfig(),
+			{ IndexDefinition("x", IndexType::Hash), IndexDefinition("z") });
+
+		auto statement = databaseEngine->prepare("SELECT x, z FROM test_table WHERE x == ?");
+		for (auto x : { 10, 999, 2000, 10 }) {
+			QueryResult result;
+			statement->execute({ QueryValue(x) }, result);
+
+			if (x < (std::int32_t)tableData.size()) {
+				TS_ASSERT_EQUALS(result.columns[0].size(), 1);
+				ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(0), tableData[x][0], 0, 0);
+				ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(0), tableData[x][2], 0, 1);
+			} else {
+				TS_ASSERT_EQUALS(result.columns[0].size(), 0);
+			}
+
+			TS_ASSERT(!result.plan.empty());
+			if (defaultTestConfig().optimizeExpressions) {
+				TS_ASSERT_EQUALS(result.plan[0].find("Scan: hash index on x"), 0);
+			}
+		}
+	}
+
+	void testUpdate() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+		auto statement = databaseEngine->prepare("UPDATE test_table SET z = ? WHERE x == ?");
+
+		for (std::int32_t x = 0; x < 10; x++) {
+			QueryResult result;
+			statement->execute({ QueryValue(x * 100), QueryValue(x) }, result);
+		}
+
+		auto query = createQuery(databaseEngine->parse("SELECT z FROM test_table WHERE x < 20"));
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns[0].size(), 20);
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			auto expected = i < 10 ? QueryValue((std::int32_t)i * 100) : tableData[i][2];
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), expected, i, 0);
+		}
+	}
+
+	void testAggregate() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+		auto statement = databaseEngine->prepare("SELECT count(*) FROM test_table WHERE x < ?");
+
+		for (auto maxX : { 10, 500 }) {
+			QueryResult result;
+			statement->execute({ QueryValue(maxX) }, result);
+			TS_ASSERT_EQUALS(result.columns[0].size(), 1);
+			TS_ASSERT_EQUALS(result.columns[0].getValue(0).getValue<std::int32_t>(), maxX);
+		}
+	}
+
+	void testParameterTypes() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+		auto statement = databaseEngine->prepare("SELECT x FROM test_table WHERE y < ?");
+
+		QueryResult result;
+		TS_ASSERT_THROWS_ANYTHING(statement->execute({ QueryValue(5) }, result));
+		TS_ASSERT_THROWS_ANYTHING(statement->execute({}, result));
+
+		// A different type compiles the statement again
+		QueryResult floatResult;
+		statement->execute({ QueryValue(100.0f) }, floatResult);
+		TS_ASSERT(statement->isCompiled());
+		for (std::size_t i = 0; i < floatResult.columns[0].size(); i++) {
+			auto x = floatResult.columns[0].getValue(i).getValue<std::int32_t>();
+			TS_ASSERT(tableData[x][1].getValue<float>() < 100.0f);
+		}
+
+		TS_ASSERT_THROWS_ANYTHING(databaseEngine->parse("SELECT x FROM test_table WHERE x == ?"));
+	}
+
+	void testPlanCache() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+		auto statement = databaseEngine->prepare("SELECT x FROM test_table WHERE x < ?");
+		TS_ASSERT(databaseEngine->prepare("SELECT x FROM test_table WHERE x < ?") == statement);
+
+		QueryResult result;
+		statement->execute({ QueryValue(10) }, result);
+		TS_ASSERT(statement->isCompiled());
+
+		// Adding a table invalidates the compiled plan
+		Schema schema("other_table", { ColumnDefinition(0, "x", ColumnType::Int32) }, { "x" });
+		databaseEngine->addTable("other_table", std::make_unique<Table>(std::move(schema)));
+		TS_ASSERT(!statement->isCompiled());
+
+		QueryResult newResult;
+		statement->execute({ QueryValue(20) }, newResult);
+		TS_ASSERT(statement->isCompiled());
+		TS_ASSERT_EQUALS(newResult.columns[0].size(), 20);
+	}
+
+	void testConcurrentSessions() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+		const std::size_t numThreads = 4;
+
+		// Each session prepares the same text, and must only see the rows of its own parameter values
+		std::vector<std::thread> threads;
+		std::vector<std::size_t> numWrongRows(numThreads, 0);
+		for (std::size_t threadIndex = 0; threadIndex < numThreads; threadIndex++) {
+			threads.emplace_back([&, threadIndex]() {
+				auto statement = databaseEngine->prepare("SELECT x FROM test_table WHERE x < ?");
+				auto maxX = (std::int32_t)(threadIndex + 1) * 10;
+				for (std::size_t i = 0; i < 50; i++) {
+					QueryResult result;
+					statement->execute({ QueryValue(maxX) }, result);
+					if (result.columns[0].size() != (std::size_t)maxX) {
+						numWrongRows[threadIndex]++;
+					}
+				}
+			});
+		}
+
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		TS_ASSERT_EQUALS(numWrongRows, std::vector<std::size_t>(numThreads, 0));
+	}
+};
@@ -0,0 +1,142 @@
+#pragma once
+#include <cxxtest/TestSuite.h>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "../src/execution/radix_sort.h"
+
+namespace {
+	template<typename T>
+	RawQueryValue rawValue(T value) {
+		return QueryValue(value).data;
+	}
+
+	// The expected ordering, from a stable comparison sort
+	std::vector<std::size_t> stableSortedIndices(const std::vector<ColumnType>& orderingDataTypes,
+												 const std::vector<OrderingColumn>& ordering,
+												 const std::vector<std::vector<RawQueryValue>>& orderingData) {
+		std::vector<std::size_t> indices(orderingData[0].size());
+		for (std::size_t i = 0; i < indices.size(); i++) {
+			indices[i] = i;
+		}
+
+		std::stable_sort(indices.begin(), indices.end(), [&](std::size_t x, std::size_t y) {
+			for (std::size_t columnIndex = 0; columnIndex < ordering.size(); columnIndex++) {
+				auto compareResult = handleGenericTypeResult(int, orderingDataTypes[columnIndex], [&](auto dummy) {
+					using Type = decltype(dummy);
+					auto lhs = orderingData[columnIndex][x].getValue<Type>();
+					auto rhs = orderingData[columnIndex][y].getValue<Type>();
+					if (lhs == rhs) {
+						return -1;
+					}
+
+					return (int)(ordering[columnIndex].descending ? lhs > rhs : lhs < rhs);
+				});
+
+				if (compareResult >= 0) {
+					return (bool)compareResult;
+				}
+			}
+
+			return false;
+		});
+
+		return indices;
+	}
+}
+
+class RadixSortTestSuite : public CxxTest::TestSuite {
+public:
+	void testInt32() {
+		std::mt19937 random(1337);
+		std::uniform_int_distribution<std::int32_t> distribution(
+			std::numeric_limits<std::int32_t>::min(),
+			std::numeric_limits<std::int32_t>::max());
+
+		std::vector<std::vector<RawQueryValue>> orderingData(1);
+		for (std::size_t i = 0; i < 10000; i++) {
+			orderingData[0].push_back(rawValue(distribution(random)));
+		}
+
+		for (auto descending : { false, true }) {
+			std::vector<ColumnType> types { ColumnType::Int32 };
+			std::vector<OrderingColumn> ordering { OrderingColumn { "x", descending } };
+			TS_ASSERT_EQUALS(
+				RadixSort::sortedIndices(types, ordering, orderingData),
+				stableSortedIndices(types, ordering, orderingData));
+		}
+	}
+
+	void testFloat32() {
+		std::mt19937 random(1337);
+		std::uniform_real_distribution<float> distribution(-1000.0f, 1000.0f);
+
+		std::vector<std::vector<RawQueryValue>> orderingData(1);
+		for (std::size_t i = 0; i < 10000; i++) {
+			orderingData[0].push_back(rawValue(distribution(random)));
+		}
+
+		for (auto value : { 0.0f, -0.0f, 0.0f, std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity() }) {
+			orderingData[0].push_back(rawValue(value));
+		}
+
+		for (auto descending : { false, true }) {
+			std::vector<ColumnType> types { ColumnType::Float32 };
+			std::vector<OrderingColumn> ordering { OrderingColumn { "y", descending } };
+			TS_ASSERT_EQUALS(
+				RadixSort::sortedIndices(types, ordering, orderingData),
+				stableSortedIndices(types, ordering, orderingData));
+		}
+	}
+
+	void testMultipleColumns() {
+		std::mt19937 random(1337);
+		std::uniform_int_distribution<std::int32_t> distributionX(-10, 10);
+		std::uniform_real_distribution<float> distributionY(-5.0f, 5.0f);
+		std::bernoulli_distribution distributionZ(0.5);
+
+		std::vector<std::vector<RawQueryValue>> orderingData(3);
+		for (std::size_t i = 0; i < 10000; i++) {
+			orderingData[0].push_back(rawValue((bool)distributionZ(random)));
+			orderingData[1].push_back(rawValue(distributionX(random)));
+			orderingData[2].push_back(rawValue(std::round(distributionY(random))));
+		}
+
+		std::vector<ColumnType> types { ColumnType::Bool, ColumnType::Int32, ColumnType::Float32 };
+		std::vector<OrderingColumn> ordering {
+			OrderingColumn { "z", true },
+			OrderingColumn { "x", false },
+			OrderingColumn { "y", true }
+		};
+
+		TS_ASSERT_EQUALS(
+			RadixSort::sortedIndices(types, ordering, orderingData),
+			stableSortedIndices(types, ordering, orderingData));
+	}
+
+	void testParallel() {
+		std::mt19937 random(1337);
+		std::uniform_int_distribution<std::int32_t> distributionX(-1000, 1000);
+		std::uniform_real_distribution<float> distributionY(-1000.0f, 1000.0f);
+
+		std::vector<std::vector<RawQueryValue>> orderingData(2);
+		for (std::size_t i = 0; i < 200000; i++) {
+			orderingData[0].push_back(rawValue(distributionX(random)));
+			orderingData[1].push_back(rawValue(distributionY(random)));
+		}
+
+		// The morsels of each pass are split between the workers
+		std::vector<ColumnType> types { ColumnType::Int32, ColumnType::Float32 };
+		std::vector<OrderingColumn> ordering { OrderingColumn { "x", true }, OrderingColumn { "y", false } };
+		TS_ASSERT_EQUALS(
+			RadixSort::sortedIndices(types, ordering, orderingData, 4),
+			stableSortedIndices(types, ordering, orderingData));
+	}
+
+	void testEmpty() {
+		std::vector<std::vector<RawQueryValue>> orderingData(1);
+		TS_ASSERT(RadixSort::sortedIndices({ ColumnType::Int32 }, { OrderingColumn { "x", false } }, orderingData).empty());
+	}
+};
@@ -0,0 +1,120 @@
+#pragma once
+#include <cxxtest/TestSuite.h>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "../src/execution/row_id_set.h"
+
+namespace {
+	std::vector<std::size_t> randomRowIds(std::mt19937& random, std::size_t numRows, std::size_t count) {
+		std::vector<std::size_t> rowIds(numRows);
+		for (std::size_t i = 0; i < numRows; i++) {
+			rowIds[i] = i;
+		}
+
+		std::shuffle(rowIds.begin(), rowIds.end(), random);
+		rowIds.resize(count);
+		return rowIds;
+	}
+
+	std::vector<std::size_t> sorted(std::vector<std::size_t> rowIds) {
+		std::sort(rowIds.begin(), rowIds.end());
+		return rowIds;
+	}
+}
+
+class RowIdSetTestSuite : public CxxTest::TestSuite {
+public:
+	void testRepresentation() {
+		RowIdSet sparseSet(10000, { 5, 3, 9000 });
+		TS_ASSERT_EQUALS(sparseSet.isBitmap(), false);
+		TS_ASSERT_EQUALS(sparseSet.size(), 3);
+		TS_ASSERT_EQUALS(sparseSet.rowIds(), std::vector<std::size_t>({ 3, 5, 9000 }));
+
+		std::mt19937 random(1337);
+		auto rowIds = randomRowIds(random, 10000, 5000);
+		RowIdSet denseSet(10000, rowIds);
+		TS_ASSERT_EQUALS(denseSet.isBitmap(), true);
+		TS_ASSERT_EQUALS(denseSet.size(), 5000);
+		TS_ASSERT_EQUALS(denseSet.rowIds(), sorted(rowIds));
+	}
+
+	void testIntersect() {
+		std::mt19937 random(1337);
+		std::size_t numRows = 10000;
+
+		// Combinations of sparse and dense sets
+		for (auto lhsCount : { 20, 5000 }) {
+			for (auto rhsCount : { 30, 7000 }) {
+				auto lhsRowIds = sorted(randomRowIds(random, numRows, lhsCount));
+				auto rhsRowIds = sorted(randomRowIds(random, numRows, rhsCount));
+
+				std::vector<std::size_t> expected;
+				std::set_intersection(
+					lhsRowIds.begin(), lhsRowIds.end(),
+					rhsRowIds.begin(), rhsRowIds.end(),
+					std::back_inserter(expected));
+
+				RowIdSet set(numRows, lhsRowIds);
+				set.intersect(RowIdSet(numRows, rhsRowIds));
+				TS_ASSERT_EQUALS(set.size(), expected.size());
+				TS_ASSERT_EQUALS(set.rowIds(), expected);
+			}
+		}
+	}
+
+	void testUnite() {
+		std::mt19937 random(1337);
+		std::size_t numRows = 10000;
+
+		for (auto lhsCount : { 0, 20, 5000 }) {
+			for (auto rhsCount : { 30, 7000 }) {
+				auto lhsRowIds = sorted(randomRowIds(random, numRows, lhsCount));
+				auto rhsRowIds = sorted(randomRowIds(random, numRows, rhsCount));
+
+				std::vector<std::size_t> expected;
+				std::set_union(
+					lhsRowIds.begin(), lhsRowIds.end(),
+					rhsRowIds.begin(), rhsRowIds.end(),
+					std::back_inserter(expected));
+
+				RowIdSet set(numRows, lhsRowIds);
+				set.unite(RowIdSet(numRows, rhsRowIds));
+				TS_ASSERT_EQUALS(set.size(), expected.size());
+				TS_ASSERT_EQUALS(set.rowIds(), expected);
+			}
+		}
+	}
+
+	void testShrinkToRowIds() {
+		RowIdSet set(1000, { 1, 2, 3, 500, 501, 502, 503, 504, 505, 506, 507, 508, 509, 510, 511, 512, 513, 999 });
+		TS_ASSERT_EQUALS(set.isBitmap(), true);
+
+		set.intersect(RowIdSet(1000, { 2, 999 }));
+		TS_ASSERT_EQUALS(set.isBitmap(), false);
+		TS_ASSERT_EQUALS(set.rowIds(), std::vector<std::size_t>({ 2, 999 }));
+	}
+
+	void testSort() {
+		std::mt19937 random(1337);
+		for (std::size_t count : { 10, 500, 10000 }) {
+			auto rowIds = randomRowIds(random, 10000, count);
+			auto expected = sorted(rowIds);
+
+			RowIdSet::sort(10000, rowIds);
+			TS_ASSERT_EQUALS(rowIds, expected);
+		}
+
+		// Duplicates are removed by both the comparison sort and the bitmap
+		for (std::size_t count : { 10, 5000 }) {
+			auto rowIds = randomRowIds(random, 10000, count);
+			auto expected = sorted(rowIds);
+			rowIds.insert(rowIds.end(), rowIds.begin(), rowIds.begin() + count / 2);
+
+			RowIdSet::sort(10000, rowIds);
+			TS_ASSERT_EQUALS(rowIds, expected);
+		}
+	}
+};
@@ -277,7 +277,8 @@ public:
 		std::vector<std::vector<QueryValue>> tableData;
 		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig(), { "z" });
 
-		std::int32_t searchValue = 200;
+		// Selective enough for the index scan to be cheaper, where the found rows are sorted back into row order
+		std::int32_t searchValue = 50;
 
 		auto query = createQuery(std::make_unique<QuerySelectOperation>(
 			"test_table",
@@ -290,30 +291,22 @@ public:
 
 		std::vector<QueryValue> column1;
 		std::vector<QueryValue> column3;
-		std::vector<std::size_t> sortIndices;
 
 		for (std::size_t i = 0; i < tableData.size(); i++) {
 			if (tableData[i][2].getValue<std::int32_t>() < searchValue) {
 				column1.push_back(tableData[i][0]);
 				column3.push_back(tableData[i][2]);
-				sortIndices.push_back(sortIndices.size());
 			}
 		}
 
-		std::sort(
-			sortIndices.begin(),
-			sortIndices.end(),
-			[&](auto& x, auto& y) {
-				return column3[x].template getValue<std::int32_t>() < column3[y].template getValue<std::int32_t>();
-			});
-
 		QueryResult result;
 		databaseEngine->execute(query, result);
 		TS_ASSERT_EQUALS(result.columns.size(), 2);
 		TS_ASSERT_EQUALS(result.columns[0].size(), column1.size());
 
 		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
-			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), column3[sortIndices[i]], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), column1[i], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), column3[i], i, 1);
 		}
 	}
 
@@ -321,7 +314,7 @@ public:
 		std::vector<std::vector<QueryValue>> tableData;
 		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig(), { "z" });
 
-		std::int32_t searchValue = 200;
+		std::int32_t searchValue = 50;
 
 		auto query = createQuery(std::make_unique<QuerySelectOperation>(
 			"test_table",
@@ -334,30 +327,22 @@ public:
 
 		std::vector<QueryValue> column1;
 		std::vector<QueryValue> column3;
-		std::vector<std::size_t> sortIndices;
 
 		for (std::size_t i = 0; i < tableData.size(); i++) {
 			if (tableData[i][2].getValue<std::int32_t>() <= searchValue) {
 				column1.push_back(tableData[i][0]);
 				column3.push_back(tableData[i][2]);
-				sortIndices.push_back(sortIndices.size());
 			}
 		}
 
-		std::sort(
-			sortIndices.begin(),
-			sortIndices.end(),
-			[&](auto& x, auto& y) {
-				return column3[x].template getValue<std::int32_t>() < column3[y].template getValue<std::int32_t>();
-			});
-
 		QueryResult result;
 		databaseEngine->execute(query, result);
 		TS_ASSERT_EQUALS(result.columns.size(), 2);
 		TS_ASSERT_EQUALS(result.columns[0].size(), column1.size());
 
 		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
-			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), column3[sortIndices[i]], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), column1[i], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), column3[i], i, 1);
 		}
 	}
 
@@ -365,7 +350,7 @@ public:
 		std::vector<std::vector<QueryValue>> tableData;
 		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig(), { "z" });
 
-		std::int32_t searchValue = 200;
+		std::int32_t searchValue = 950;
 
 		auto query = createQuery(std::make_unique<QuerySelectOperation>(
 			"test_table",
@@ -378,30 +363,22 @@ public:
 
 		std::vector<QueryValue> column1;
 		std::vector<QueryValue> column3;
-		std::vector<std::size_t> sortIndices;
 
 		for (std::size_t i = 0; i < tableData.size(); i++) {
 			if (tableData[i][2].getValue<std::int32_t>() > searchValue) {
 				column1.push_back(tableData[i][0]);
 				column3.push_back(tableData[i][2]);
-				sortIndices.push_back(sortIndices.size());
 			}
 		}
 
-		std::sort(
-			sortIndices.begin(),
-			sortIndices.end(),
-			[&](auto& x, auto& y) {
-				return column3[x].template getValue<std::int32_t>() < column3[y].template getValue<std::int32_t>();
-			});
-
 		QueryResult result;
 		databaseEngine->execute(query, result);
 		TS_ASSERT_EQUALS(result.columns.size(), 2);
 		TS_ASSERT_EQUALS(result.columns[0].size(), column1.size());
 
 		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
-			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), column3[sortIndices[i]], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), column1[i], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), column3[i], i, 1);
 		}
 	}
 
@@ -409,7 +386,7 @@ public:
 		std::vector<std::vector<QueryValue>> tableData;
 		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig(), { "z" });
 
-		std::int32_t searchValue = 200;
+		std::int32_t searchValue = 950;
 
 		auto query = createQuery(std::make_unique<QuerySelectOperation>(
 			"test_table",
@@ -422,30 +399,22 @@ public:
 
 		std::vector<QueryValue> column1;
 		std::vector<QueryValue> column3;
-		std::vector<std::size_t> sortIndices;
 
 		for (std::size_t i = 0; i < tableData.size(); i++) {
 			if (tableData[i][2].getValue<std::int32_t>() >= searchValue) {
 				column1.push_back(tableData[i][0]);
 				column3.push_back(tableData[i][2]);
-				sortIndices.push_back(sortIndices.size());
 			}
 		}
 
-		std::sort(
-			sortIndices.begin(),
-			sortIndices.end(),
-			[&](auto& x, auto& y) {
-				return column3[x].template getValue<std::int32_t>() < column3[y].template getValue<std::int32_t>();
-			});
-
 		QueryResult result;
 		databaseEngine->execute(query, result);
 		TS_ASSERT_EQUALS(result.columns.size(), 2);
 		TS_ASSERT_EQUALS(result.columns[0].size(), column1.size());
 
 		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
-			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), column3[sortIndices[i]], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), column1[i], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), column3[i], i, 1);
 		}
 	}
 
@@ -493,6 +462,80 @@ public:
 		}
 	}
 
+	void testHashIndex() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig(), { IndexDefinition("z", IndexType::Hash) });
+
+		std::int32_t searchValue = 200;
+
+		auto query = createQuery(std::make_unique<QuerySelectOperation>(
+			"test_table",
+			QueryExpressionHelpers::createColumnReferences({ "x", "z" }),
+			std::make_unique<QueryCompareExpression>(
+				createColumn("z"),
+				createValue(QueryValue(searchValue)),
+				CompareOperator::Equal)
+		));
+
+		std::vector<std::size_t> expectedRows;
+		for (std::size_t i = 0; i < tableData.size(); i++) {
+			if (tableData[i][2].getValue<std::int32_t>() == searchValue) {
+				expectedRows.push_back(i);
+			}
+		}
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns.size(), 2);
+		TS_ASSERT_EQUALS(result.columns[0].size(), expectedRows.size());
+
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[expectedRows[i]][0], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), tableData[expectedRows[i]][2], i, 1);
+		}
+	}
+
+	void testHashIndexWithTreeIndex() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(
+			tableData,
+			optimizeExpressionsTestConfig(),
+			{ "x", "z", IndexDefinition("z", IndexType::Hash) });
+
+		std::int32_t searchValue = 200;
+
+		auto query = createQuery(std::make_unique<QuerySelectOperation>(
+			"test_table",
+			QueryExpressionHelpers::createColumnReferences({ "x", "z" }),
+			std::make_unique<QueryAndExpression>(
+				std::make_unique<QueryCompareExpression>(
+					createColumn("x"),
+					createValue(QueryValue(500)),
+					CompareOperator::LessThan),
+				std::make_unique<QueryCompareExpression>(
+					createColumn("z"),
+					createValue(QueryValue(searchValue)),
+					CompareOperator::Equal))
+		));
+
+		std::vector<std::size_t> expectedRows;
+		for (std::size_t i = 0; i < tableData.size(); i++) {
+			if (tableData[i][0].getValue<std::int32_t>() < 500 && tableData[i][2].getValue<std::int32_t>() == searchValue) {
+				expectedRows.push_back(i);
+			}
+		}
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns.size(), 2);
+		TS_ASSERT_EQUALS(result.columns[0].size(), expectedRows.size());
+
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[expectedRows[i]][0], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), tableData[expectedRows[i]][2], i, 1);
+		}
+	}
+
 	void testComplexIndexing() {
 		std::vector<std::vector<QueryValue>> tableData;
 		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig());
@@ -522,4 +565,336 @@ public:
 			ASSERT_EQUALS_DB_ENTRY(result.columns[2].getValue(i), tableData[resultOffset + i][2], i, 2);
 		}
 	}
-};
\ No newline at end of file
+
+	void testIndexOrdering() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig(), { "z" });
+
+		std::vector<std::unique_ptr<QueryExpression>> projections;
+		projections.emplace_back(createColumn("x"));
+		projections.emplace_back(std::make_unique<QueryMathExpression>(
+			createColumn("y"),
+			createValue(QueryValue(2.0f)),
+			MathOperator::Mul));
+
+		auto query = createQuery(std::make_unique<QuerySelectOperation>(
+			"test_table",
+			std::move(projections),
+			std::make_unique<QueryCompareExpression>(
+				createColumn("y"),
+				createValue(QueryValue(300.0f)),
+				CompareOperator::GreaterThan),
+			JoinClause(),
+			OrderingClause("z")
+		));
+
+		// Rows with the same value are kept in insertion order by the index
+		std::vector<std::size_t> expectedRows;
+		for (std::size_t i = 0; i < tableData.size(); i++) {
+			if (tableData[i][1].getValue<float>() > 300.0f) {
+				expectedRows.push_back(i);
+			}
+		}
+
+		std::stable_sort(
+			expectedRows.begin(),
+			expectedRows.end(),
+			[&](std::size_t x, std::size_t y) {
+				return tableData[x][2].getValue<std::int32_t>() < tableData[y][2].getValue<std::int32_t>();
+			});
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns.size(), 2);
+		TS_ASSERT_EQUALS(result.columns[0].size(), expectedRows.size());
+
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[expectedRows[i]][0], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(
+				result.columns[1].getValue(i),
+				QueryValue(tableData[expectedRows[i]][1].getValue<float>() * 2.0f),
+				i,
+				1);
+		}
+	}
+
+	void testIndexOrderingDescendingWithRange() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig(), { "z" });
+
+		auto query = createQuery(std::make_unique<QuerySelectOperation>(
+			"test_table",
+			QueryExpressionHelpers::createColumnReferences({ "x", "z" }),
+			std::make_unique<QueryCompareExpression>(
+				createColumn("z"),
+				createValue(QueryValue(400)),
+				CompareOperator::LessThan),
+			JoinClause(),
+			OrderingClause("z", true),
+			GroupingClause(),
+			LimitClause(30, 5)
+		));
+
+		// The index is walked backwards, which also reverses rows with the same value
+		std::vector<std::size_t> expectedRows;
+		for (std::size_t i = 0; i < tableData.size(); i++) {
+			if (tableData[i][2].getValue<std::int32_t>() < 400) {
+				expectedRows.push_back(i);
+			}
+		}
+
+		std::sort(
+			expectedRows.begin(),
+			expectedRows.end(),
+			[&](std::size_t x, std::size_t y) {
+				auto lhs = tableData[x][2].getValue<std::int32_t>();
+				auto rhs = tableData[y][2].getValue<std::int32_t>();
+				return lhs > rhs || (lhs == rhs && x > y);
+			});
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns.size(), 2);
+		TS_ASSERT_EQUALS(result.columns[0].size(), 30);
+
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[expectedRows[i + 5]][0], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), tableData[expectedRows[i + 5]][2], i, 1);
+		}
+	}
+
+	void testIndexCostChoosesSequentialScan() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig(), { "x" });
+		auto query = createQuery(databaseEngine->parse("SELECT x FROM test_table WHERE x > 5"));
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns[0].size(), tableData.size() - 6);
+
+		// Almost all rows match, which makes copying them through the index slower than a sequential scan
+		TS_ASSERT_EQUALS(result.plan.size(), 2);
+		TS_ASSERT_EQUALS(result.plan[0].find("Scan: sequential scan"), 0);
+		TS_ASSERT_EQUALS(result.plan[1].find("Rejected: tree index on x"), 0);
+
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[i + 6][0], i, 0);
+		}
+	}
+
+	void testIndexCostChoosesMostSelective() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig(), { "x", "z" });
+		auto query = createQuery(databaseEngine->parse("SELECT x, z FROM test_table WHERE x < 900 AND z == 500"));
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+
+		TS_ASSERT_EQUALS(result.plan.size(), 2);
+		TS_ASSERT_EQUALS(result.plan[0].find("Scan: tree index on z"), 0);
+		TS_ASSERT_EQUALS(result.plan[1].find("Rejected: tree index on x"), 0);
+
+		std::size_t expectedCount = 0;
+		for (auto& row : tableData) {
+			if (row[0].getValue<std::int32_t>() < 900 && row[2].getValue<std::int32_t>() == 500) {
+				expectedCount++;
+			}
+		}
+
+		TS_ASSERT_EQUALS(result.columns[0].size(), expectedCount);
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			TS_ASSERT(result.columns[0].getValue(i).getValue<std::int32_t>() < 900);
+			TS_ASSERT_EQUALS(result.columns[1].getValue(i).getValue<std::int32_t>(), 500);
+		}
+	}
+
+	void testExplain() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig(), { "x" });
+		auto query = createQuery(databaseEngine->parse("EXPLAIN SELECT x FROM test_table WHERE x == 500 ORDER BY y LIMIT 10"));
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns.size(), 1);
+		TS_ASSERT_EQUALS(result.columns[0].size(), 0);
+
+		TS_ASSERT_EQUALS(result.plan.size(), 2);
+		TS_ASSERT_EQUALS(result.plan[0].find("Scan: tree index on x (rows=1 "), 0);
+		TS_ASSERT_EQUALS(result.plan[1], "Sort: top 10 rows");
+	}
+
+	void testIndexRange() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig(), { "x" });
+		auto query = createQuery(databaseEngine->parse("SELECT x, z FROM test_table WHERE x > 100 AND x <= 150"));
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.plan.size(), 1);
+		TS_ASSERT_EQUALS(result.plan[0].find("Scan: tree index range on x"), 0);
+
+		TS_ASSERT_EQUALS(result.columns[0].size(), 50);
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[i + 101][0], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), tableData[i + 101][2], i, 1);
+		}
+	}
+
+	void testIndexRangeBetween() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig(), { "z" });
+		auto query = createQuery(databaseEngine->parse("SELECT x, z FROM test_table WHERE z BETWEEN 100 AND 120 ORDER BY z"));
+
+		std::vector<std::size_t> expectedRows;
+		for (std::size_t i = 0; i < tableData.size(); i++) {
+			auto z = tableData[i][2].getValue<std::int32_t>();
+			if (z >= 100 && z <= 120) {
+				expectedRows.push_back(i);
+			}
+		}
+
+		std::stable_sort(
+			expectedRows.begin(),
+			expectedRows.end(),
+			[&](std::size_t x, std::size_t y) {
+				return tableData[x][2].getValue<std::int32_t>() < tableData[y][2].getValue<std::int32_t>();
+			});
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns[0].size(), expectedRows.size());
+
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[expectedRows[i]][0], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), tableData[expectedRows[i]][2], i, 1);
+		}
+	}
+
+	void testIndexRangeEmpty() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig(), { "x" });
+
+		for (auto filter : { "x > 500 AND x < 400", "x > 500 AND x < 500", "x >= 500 AND x < 500" }) {
+			auto query = createQuery(databaseEngine->parse(std::string("SELECT x FROM test_table WHERE ") + filter));
+
+			QueryResult result;
+			databaseEngine->execute(query, result);
+			TS_ASSERT_EQUALS(result.columns[0].size(), 0);
+		}
+
+		auto query = createQuery(databaseEngine->parse("SELECT x FROM test_table WHERE x >= 500 AND x <= 500"));
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns[0].size(), 1);
+	}
+
+	void testIndexRangeRowOrder() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig(), { "z" });
+
+		std::vector<std::size_t> expectedRows;
+		for (std::size_t i = 0; i < tableData.size(); i++) {
+			auto z = tableData[i][2].getValue<std::int32_t>();
+			if (z >= 100 && z < 140) {
+				expectedRows.push_back(i);
+			}
+		}
+
+		// The rows found by the index are gathered in row order unless disabled, where they are in key order
+		for (auto sortIndexScanRows : { true, false }) {
+			databaseEngine->config().sortIndexScanRows = sortIndexScanRows;
+			auto query = createQuery(databaseEngine->parse("SELECT x, z FROM test_table WHERE z >= 100 AND z < 140"));
+
+			QueryResult result;
+			databaseEngine->execute(query, result);
+			TS_ASSERT_EQUALS(result.plan[0].find("Scan: tree index range on z"), 0);
+			TS_ASSERT_EQUALS(result.columns[0].size(), expectedRows.size());
+
+			std::vector<std::size_t> resultRows;
+			for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+				resultRows.push_back((std::size_t)result.columns[0].getValue(i).getValue<std::int32_t>());
+				ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), tableData[resultRows.back()][2], i, 1);
+			}
+
+			TS_ASSERT_EQUALS(std::is_sorted(resultRows.begin(), resultRows.end()), sortIndexScanRows);
+			std::sort(resultRows.begin(), resultRows.end());
+			TS_ASSERT_EQUALS(resultRows, expectedRows);
+		}
+	}
+
+	void testIndexIntersection() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig(), { "x", IndexDefinition("z", IndexType::Hash), "z" }, 10000);
+		auto query = createQuery(databaseEngine->parse("SELECT x, z FROM test_table WHERE x < 1000 AND z < 100"));
+
+		std::vector<std::size_t> expectedRows;
+		for (std::size_t i = 0; i < tableData.size(); i++) {
+			if (tableData[i][0].getValue<std::int32_t>() < 1000 && tableData[i][2].getValue<std::int32_t>() < 100) {
+				expectedRows.push_back(i);
+			}
+		}
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.plan[0].find("Scan: index set of [tree index on "), 0);
+		TS_ASSERT_DIFFERS(result.plan[0].find("] and [tree index on "), std::string::npos);
+
+		// The rows are found in row order
+		TS_ASSERT_EQUALS(result.columns[0].size(), expectedRows.size());
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[expectedRows[i]][0], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), tableData[expectedRows[i]][2], i, 1);
+		}
+	}
+
+	void testIndexUnion() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig(), { "x", IndexDefinition("z", IndexType::Hash) });
+		auto query = createQuery(databaseEngine->parse(
+			"SELECT x, z FROM test_table WHERE (z == 5 OR z == 7 OR x == 20) AND y < 800.0"));
+
+		std::vector<std::size_t> expectedRows;
+		for (std::size_t i = 0; i < tableData.size(); i++) {
+			auto x = tableData[i][0].getValue<std::int32_t>();
+			auto y = tableData[i][1].getValue<float>();
+			auto z = tableData[i][2].getValue<std::int32_t>();
+			if ((z == 5 || z == 7 || x == 20) && y < 800.0f) {
+				expectedRows.push_back(i);
+			}
+		}
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.plan.size(), 1);
+		TS_ASSERT_EQUALS(result.plan[0].find("Scan: index set of [hash index on z or hash index on z or tree index on x]"), 0);
+
+		TS_ASSERT_EQUALS(result.columns[0].size(), expectedRows.size());
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[expectedRows[i]][0], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), tableData[expectedRows[i]][2], i, 1);
+		}
+	}
+
+	void testIndexNotUsedBelowOr() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig(), { "z" });
+		auto query = createQuery(databaseEngine->parse("SELECT x FROM test_table WHERE z == 5 OR y < 10.0"));
+
+		std::vector<std::size_t> expectedRows;
+		for (std::size_t i = 0; i < tableData.size(); i++) {
+			if (tableData[i][2].getValue<std::int32_t>() == 5 || tableData[i][1].getValue<float>() < 10.0f) {
+				expectedRows.push_back(i);
+			}
+		}
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.plan.size(), 1);
+		TS_ASSERT_EQUALS(result.plan[0].find("Scan: sequential scan"), 0);
+
+		TS_ASSERT_EQUALS(result.columns[0].size(), expectedRows.size());
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[expectedRows[i]][0], i, 0);
+		}
+	}
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include <iostream>
+#include <algorithm>
 #include <cxxtest/TestSuite.h>
 #include "test_helpers.h"
 
@@ -205,6 +206,33 @@ public:
 		}
 	}
 
+	void testOrFiltering() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+		auto query = createQuery(databaseEngine->parse(
+			"SELECT x, z FROM test_table WHERE z < 100 OR z > 900 AND y < 500.0 OR x == 42"));
+
+		std::vector<std::size_t> expectedRows;
+		for (std::size_t i = 0; i < tableData.size(); i++) {
+			auto x = tableData[i][0].getValue<std::int32_t>();
+			auto y = tableData[i][1].getValue<float>();
+			auto z = tableData[i][2].getValue<std::int32_t>();
+			if (z < 100 || (z > 900 && y < 500.0f) || x == 42) {
+				expectedRows.push_back(i);
+			}
+		}
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns.size(), 2);
+		TS_ASSERT_EQUALS(result.columns[0].size(), expectedRows.size());
+
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[expectedRows[i]][0], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), tableData[expectedRows[i]][2], i, 1);
+		}
+	}
+
 	void testOrdering() {
 		std::vector<std::vector<QueryValue>> tableData;
 		auto databaseEngine = setupTest(tableData);
@@ -270,4 +298,249 @@ public:
 			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[i][0], i, 0);
 		}
 	}
+
+	void testBatchExecution() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, defaultTestConfig(), {}, 5000);
+
+		std::vector<std::unique_ptr<QueryExpression>> projections;
+		projections.emplace_back(createColumn("x"));
+		projections.emplace_back(std::make_unique<QueryMathExpression>(
+			createColumn("y"),
+			createValue(QueryValue(2.0f)),
+			MathOperator::Mul));
+
+		auto query = createQuery(std::make_unique<QuerySelectOperation>(
+			"test_table",
+			std::move(projections),
+			std::make_unique<QueryAndExpression>(
+				std::make_unique<QueryCompareExpression>(
+					createColumn("y"),
+					createValue(QueryValue(100.0f)),
+					CompareOperator::GreaterThan),
+				std::make_unique<QueryCompareExpression>(
+					createColumn("z"),
+					createColumn("x"),
+					CompareOperator::LessThan)),
+			JoinClause(),
+			OrderingClause("y", true)
+		));
+
+		std::vector<std::size_t> expectedRows;
+		for (std::size_t i = 0; i < tableData.size(); i++) {
+			if (tableData[i][1].getValue<float>() > 100.0f
+				&& tableData[i][2].getValue<std::int32_t>() < tableData[i][0].getValue<std::int32_t>()) {
+				expectedRows.push_back(i);
+			}
+		}
+
+		std::stable_sort(
+			expectedRows.begin(),
+			expectedRows.end(),
+			[&](std::size_t x, std::size_t y) {
+				return tableData[x][1].getValue<float>() > tableData[y][1].getValue<float>();
+			});
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns.size(), 2);
+		TS_ASSERT_EQUALS(result.columns[0].size(), expectedRows.size());
+
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[expectedRows[i]][0], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(
+				result.columns[1].getValue(i),
+				QueryValue(tableData[expectedRows[i]][1].getValue<float>() * 2.0f),
+				i,
+				1);
+		}
+	}
+
+	void testParallelScan() {
+		auto config = defaultTestConfig();
+		config.parallelism = 4;
+
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, config, {}, 100000);
+
+		std::vector<std::size_t> expectedRows;
+		for (std::size_t i = 0; i < tableData.size(); i++) {
+			if (tableData[i][2].getValue<std::int32_t>() > 500) {
+				expectedRows.push_back(i);
+			}
+		}
+
+		auto createFilter = []() {
+			return std::make_unique<QueryCompareExpression>(
+				createColumn("z"),
+				createValue(QueryValue(500)),
+				CompareOperator::GreaterThan);
+		};
+
+		{
+			std::vector<std::unique_ptr<QueryExpression>> projections;
+			projections.emplace_back(createColumn("x"));
+			projections.emplace_back(createColumn("y"));
+
+			auto query = createQuery(std::make_unique<QuerySelectOperation>(
+				"test_table",
+				std::move(projections),
+				createFilter()
+			));
+
+			QueryResult result;
+			databaseEngine->execute(query, result);
+			TS_ASSERT_EQUALS(result.columns[0].size(), expectedRows.size());
+
+			for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+				ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[expectedRows[i]][0], i, 0);
+				ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), tableData[expectedRows[i]][1], i, 1);
+			}
+		}
+
+		{
+			std::vector<std::unique_ptr<QueryExpression>> projections;
+			projections.emplace_back(createColumn("x"));
+			projections.emplace_back(std::make_unique<QueryMathExpression>(
+				createColumn("y"),
+				createValue(QueryValue(2.0f)),
+				MathOperator::Mul));
+
+			auto query = createQuery(std::make_unique<QuerySelectOperation>(
+				"test_table",
+				std::move(projections),
+				createFilter()
+			));
+
+			QueryResult result;
+			databaseEngine->execute(query, result);
+			TS_ASSERT_EQUALS(result.columns[0].size(), expectedRows.size());
+
+			for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+				ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[expectedRows[i]][0], i, 0);
+				ASSERT_EQUALS_DB_ENTRY(
+					result.columns[1].getValue(i),
+					QueryValue(tableData[expectedRows[i]][1].getValue<float>() * 2.0f),
+					i,
+					1);
+			}
+		}
+	}
+
+	void testLimit() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+
+		std::vector<std::size_t> expectedRows;
+		for (std::size_t i = 0; i < tableData.size(); i++) {
+			if (tableData[i][2].getValue<std::int32_t>() > 500) {
+				expectedRows.push_back(i);
+			}
+		}
+
+		auto query = createQuery(std::make_unique<QuerySelectOperation>(
+			"test_table",
+			QueryExpressionHelpers::createColumnReferences({ "x", "y" }),
+			std::make_unique<QueryCompareExpression>(
+				createColumn("z"),
+				createValue(QueryValue(500)),
+				CompareOperator::GreaterThan),
+			JoinClause(),
+			OrderingClause(),
+			GroupingClause(),
+			LimitClause(20, 10)
+		));
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns.size(), 2);
+		TS_ASSERT_EQUALS(result.columns[0].size(), 20);
+		TS_ASSERT_EQUALS(result.columns[1].size(), 20);
+
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[expectedRows[i + 10]][0], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(result.columns[1].getValue(i), tableData[expectedRows[i + 10]][1], i, 1);
+		}
+	}
+
+	void testLimitPastEnd() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+
+		auto query = createQuery(std::make_unique<QuerySelectOperation>(
+			"test_table",
+			QueryExpressionHelpers::createColumnReferences({ "x" }),
+			std::unique_ptr<QueryExpression>(),
+			JoinClause(),
+			OrderingClause(),
+			GroupingClause(),
+			LimitClause(100, 950)
+		));
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns[0].size(), 50);
+
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[i + 950][0], i, 0);
+		}
+	}
+
+	void testOrderingWithLimit() {
+		auto config = defaultTestConfig();
+		config.parallelism = 4;
+
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, config, {}, 100000);
+
+		std::vector<std::size_t> expectedRows;
+		for (std::size_t i = 0; i < tableData.size(); i++) {
+			if (tableData[i][1].getValue<float>() > 100.0f) {
+				expectedRows.push_back(i);
+			}
+		}
+
+		// Rows with the same z are ordered by their position
+		std::stable_sort(
+			expectedRows.begin(),
+			expectedRows.end(),
+			[&](std::size_t x, std::size_t y) {
+				return tableData[x][2].getValue<std::int32_t>() > tableData[y][2].getValue<std::int32_t>();
+			});
+
+		std::vector<std::unique_ptr<QueryExpression>> projections;
+		projections.emplace_back(createColumn("x"));
+		projections.emplace_back(std::make_unique<QueryMathExpression>(
+			createColumn("y"),
+			createValue(QueryValue(2.0f)),
+			MathOperator::Mul));
+
+		auto query = createQuery(std::make_unique<QuerySelectOperation>(
+			"test_table",
+			std::move(projections),
+			std::make_unique<QueryCompareExpression>(
+				createColumn("y"),
+				createValue(QueryValue(100.0f)),
+				CompareOperator::GreaterThan),
+			JoinClause(),
+			OrderingClause("z", true),
+			GroupingClause(),
+			LimitClause(300, 25)
+		));
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+		TS_ASSERT_EQUALS(result.columns.size(), 2);
+		TS_ASSERT_EQUALS(result.columns[0].size(), 300);
+
+		for (std::size_t i = 0; i < result.columns[0].size(); i++) {
+			auto rowIndex = expectedRows[i + 25];
+			ASSERT_EQUALS_DB_ENTRY(result.columns[0].getValue(i), tableData[rowIndex][0], i, 0);
+			ASSERT_EQUALS_DB_ENTRY(
+				result.columns[1].getValue(i),
+				QueryValue(tableData[rowIndex][1].getValue<float>() * 2.0f),
+				i,
+				1);
+		}
+	}
 };
\ No newline at end of file
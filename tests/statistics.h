@@ -0,0 +1,95 @@
+#pragma once
+#include <cxxtest/TestSuite.h>
+#include <algorithm>
+#include <random>
+#include <set>
+
+#include "../src/statistics.h"
+#include "test_helpers.h"
+
+class StatisticsTestSuite : public CxxTest::TestSuite {
+public:
+	void testDistinctCount() {
+		for (std::int32_t numDistinct : { 10, 1000, 100000 }) {
+			ColumnStatistics statistics(ColumnType::Int32);
+			for (std::size_t i = 0; i < 200000; i++) {
+				statistics.insert((std::int32_t)(i % numDistinct), i);
+			}
+
+			TS_ASSERT_EQUALS(statistics.count(), 200000);
+			TS_ASSERT_DELTA(statistics.distinctCount(), numDistinct, numDistinct * 0.05);
+		}
+	}
+
+	void testHistogram() {
+		ColumnStatistics statistics(ColumnType::Float32);
+
+		std::mt19937 random(1337);
+		std::uniform_real_distribution<float> distribution(0.0f, 1000.0f);
+		for (std::size_t i = 0; i < 100000; i++) {
+			statistics.insert(distribution(random), i);
+		}
+
+		TS_ASSERT(statistics.min() >= 0.0 && statistics.min() < 1.0);
+		TS_ASSERT(statistics.max() <= 1000.0 && statistics.max() > 999.0);
+		TS_ASSERT(!statistics.histogram().empty());
+
+		TS_ASSERT_DELTA(statistics.estimateSelectivity(CompareOperator::LessThan, 250.0), 0.25, 0.05);
+		TS_ASSERT_DELTA(statistics.estimateSelectivity(CompareOperator::GreaterThanOrEqual, 900.0), 0.1, 0.05);
+		TS_ASSERT_EQUALS(statistics.estimateSelectivity(CompareOperator::LessThan, -1.0), 0.0);
+		TS_ASSERT_EQUALS(statistics.estimateSelectivity(CompareOperator::GreaterThan, 2000.0), 0.0);
+		TS_ASSERT_EQUALS(statistics.estimateSelectivity(CompareOperator::Equal, 2000.0), 0.0);
+	}
+
+	void testSkewedHistogram() {
+		ColumnStatistics statistics(ColumnType::Int32);
+		for (std::size_t i = 0; i < 100000; i++) {
+			statistics.insert((std::int32_t)(i % 10 == 0 ? 1000 + i : i % 10), i);
+		}
+
+		// 90% of the values are in 1..9, which a min/max based estimate would not see
+		TS_ASSERT_DELTA(statistics.estimateSelectivity(CompareOperator::LessThan, 100.0), 0.9, 0.05);
+	}
+
+	void testTableStatistics() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+		auto& table = databaseEngine->getTable("test_table");
+
+		std::set<std::int32_t> distinctZ;
+		std::int32_t minZ = std::numeric_limits<std::int32_t>::max();
+		std::int32_t maxZ = std::numeric_limits<std::int32_t>::min();
+		for (auto& row : tableData) {
+			auto z = row[2].getValue<std::int32_t>();
+			distinctZ.insert(z);
+			minZ = std::min(minZ, z);
+			maxZ = std::max(maxZ, z);
+		}
+
+		auto statistics = table.statistics("z");
+		TS_ASSERT_EQUALS(statistics.type(), ColumnType::Int32);
+		TS_ASSERT_EQUALS(statistics.count(), tableData.size());
+		TS_ASSERT_EQUALS(statistics.min(), minZ);
+		TS_ASSERT_EQUALS(statistics.max(), maxZ);
+		TS_ASSERT_DELTA(statistics.distinctCount(), distinctZ.size(), distinctZ.size() * 0.05);
+
+		auto statisticsX = table.statistics("x");
+		TS_ASSERT_EQUALS(statisticsX.min(), 0);
+		TS_ASSERT_EQUALS(statisticsX.max(), tableData.size() - 1);
+		TS_ASSERT_DELTA(statisticsX.estimateSelectivity(CompareOperator::LessThan, 500.0), 0.5, 0.05);
+	}
+
+	void testTableStatisticsUpdate() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+
+		auto query = createQuery(databaseEngine->parse("UPDATE test_table SET x = x + 5000 WHERE x < 500"));
+		QueryResult result;
+		databaseEngine->execute(query, result);
+
+		auto statistics = databaseEngine->getTable("test_table").statistics("x");
+		TS_ASSERT_EQUALS(statistics.count(), tableData.size());
+		TS_ASSERT_EQUALS(statistics.max(), 5499);
+		TS_ASSERT_DELTA(statistics.estimateSelectivity(CompareOperator::GreaterThanOrEqual, 5000.0), 0.5, 0.05);
+	}
+};
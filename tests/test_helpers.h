@@ -1,5 +1,9 @@
 #pragma once
+#include <cstdio>
+#include <dirent.h>
 #include <random>
+#include <stdlib.h>
+#include <unistd.h>
 
 #include "../src/database_engine.h"
 #include "../src/query.h"
@@ -7,6 +11,38 @@
 #define TS_ASSERT_EQUALS_WITH_MESSAGE(x,y,m) ___TS_ASSERT_EQUALS(__FILE__,__LINE__,x,y,m)
 #define ASSERT_EQUALS_DB_ENTRY(x,y,r,c) TS_ASSERT_EQUALS_WITH_MESSAGE(x, y, ("At row " + std::to_string(r) + ", col " + std::to_string(c)).c_str())
 
+/**
+ * A temporary directory that is removed with its files
+ */
+struct TemporaryDirectory {
+	std::string path;
+
+	TemporaryDirectory() {
+		char directory[] = "/tmp/database_test_XXXXXX";
+		if (mkdtemp(directory) == nullptr) {
+			throw std::runtime_error("Could not create a temporary directory.");
+		}
+
+		path = directory;
+	}
+
+	~TemporaryDirectory() {
+		auto directory = opendir(path.c_str());
+		if (directory != nullptr) {
+			while (auto entry = readdir(directory)) {
+				std::string name = entry->d_name;
+				if (name != "." && name != "..") {
+					std::remove((path + "/" + name).c_str());
+				}
+			}
+
+			closedir(directory);
+		}
+
+		rmdir(path.c_str());
+	}
+};
+
 Query createQuery(std::unique_ptr<QueryOperation> operation) {
 	return Query(std::move(operation));
 }
@@ -52,7 +88,7 @@ DatabaseConfiguration optimizeAllTestConfig() {
 
 std::unique_ptr<DatabaseEngine> setupTest(std::vector<std::vector<QueryValue>>& tableData,
 										  DatabaseConfiguration config = defaultTestConfig(),
-										  std::initializer_list<std::string> indices = {},
+										  std::initializer_list<IndexDefinition> indices = {},
 										  std::size_t count = 1000) {
 	Schema schema(
 		"test_table",
@@ -91,6 +127,49 @@ std::unique_ptr<DatabaseEngine> setupTest(std::vector<std::vector<QueryValue>>&
 	return databaseEngine;
 }
 
+/**
+ * Opens the database in the given directory
+ * @param directory The directory
+ * @param config The configuration
+ */
+std::unique_ptr<DatabaseEngine> openTestDatabase(const std::string& directory, DatabaseConfiguration config = defaultTestConfig()) {
+	auto databaseEngine = std::make_unique<DatabaseEngine>(config);
+	databaseEngine->open(directory);
+	return databaseEngine;
+}
+
+/**
+ * Adds an empty test table, with a tree index on x and a hash index on z
+ * @param databaseEngine The database engine
+ */
+void addEmptyTestTable(DatabaseEngine& databaseEngine) {
+	Schema schema(
+		"test_table",
+		{
+			ColumnDefinition(0, "x", ColumnType::Int32),
+			ColumnDefinition(1, "y", ColumnType::Float32),
+			ColumnDefinition(2, "z", ColumnType::Int32),
+		},
+		{ IndexDefinition("x"), IndexDefinition("z", IndexType::Hash) });
+	databaseEngine.addTable("test_table", std::make_unique<Table>(std::move(schema)));
+}
+
+/**
+ * Inserts rows into the test table with one statement, where y is x as a float and z is x modulo 10
+ * @param databaseEngine The database engine
+ * @param firstX The x of the first row
+ * @param numRows The number of rows
+ */
+void insertTestRows(DatabaseEngine& databaseEngine, std::int32_t firstX, std::int32_t numRows) {
+	std::string text = "INSERT INTO test_table (x, y, z) VALUES ";
+	for (std::int32_t x = firstX; x < firstX + numRows; x++) {
+		text += (x > firstX ? ", (" : "(") + std::to_string(x) + ", " + std::to_string(x) + ".0, " + std::to_string(x % 10) + ")";
+	}
+
+	QueryResult result;
+	databaseEngine.execute(Query(databaseEngine.parse(text)), result);
+}
+
 std::unique_ptr<QueryValueExpression> createValue(QueryValue value) {
 	return std::make_unique<QueryValueExpression>(value);
 }
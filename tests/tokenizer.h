@@ -154,6 +154,14 @@ public:
 		TS_ASSERT_EQUALS(tokens.size(), 1);
 		TS_ASSERT_EQUALS(tokens[0].type(), TokenType::And);
 
+		tokens = Tokenizer::tokenize("or");
+		TS_ASSERT_EQUALS(tokens.size(), 1);
+		TS_ASSERT_EQUALS(tokens[0].type(), TokenType::Or);
+
+		tokens = Tokenizer::tokenize("between");
+		TS_ASSERT_EQUALS(tokens.size(), 1);
+		TS_ASSERT_EQUALS(tokens[0].type(), TokenType::Between);
+
 		tokens = Tokenizer::tokenize("set");
 		TS_ASSERT_EQUALS(tokens.size(), 1);
 		TS_ASSERT_EQUALS(tokens[0].type(), TokenType::Set);
@@ -236,4 +244,12 @@ public:
 		TS_ASSERT_EQUALS(tokens[6], Token(TokenType::Operator, OperatorChar('!', '=')));
 		TS_ASSERT_EQUALS(tokens[7], Token(5));
 	}
+
+	void testParameter() {
+		auto tokens = Tokenizer::tokenize("SELECT x FROM test_table WHERE x>=?");
+		TS_ASSERT_EQUALS(tokens.size(), 8);
+		TS_ASSERT_EQUALS(tokens[5], Token("x"));
+		TS_ASSERT_EQUALS(tokens[6], Token(TokenType::Operator, OperatorChar('>', '=')));
+		TS_ASSERT_EQUALS(tokens[7], Token(TokenType::Parameter));
+	}
 };
\ No newline at end of file
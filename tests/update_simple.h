@@ -167,4 +167,100 @@ public:
 				1);
 		}
 	}
+
+	void testHashIndexing() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, defaultTestConfig(), { IndexDefinition("z", IndexType::Hash) });
+
+		std::vector<std::unique_ptr<QueryAssignExpression>> sets;
+		sets.emplace_back(std::make_unique<QueryAssignExpression>(
+			"z",
+			std::make_unique<QueryMathExpression>(
+				createColumn("z"),
+				createValue(QueryValue(7)),
+				MathOperator::Add)));
+
+		auto query = createQuery(std::make_unique<QueryUpdateOperation>(
+			"test_table",
+			std::move(sets),
+			std::make_unique<QueryCompareExpression>(
+				createColumn("x"),
+				createValue(QueryValue(500)),
+				CompareOperator::LessThan)
+		));
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+
+		auto& table = databaseEngine->getTable("test_table");
+		auto& underlyingIndex = table.hashIndices()[0]->getUnderlyingStorage<std::int32_t>();
+		TS_ASSERT_EQUALS(underlyingIndex.size(), table.numRows());
+
+		for (std::size_t i = 0; i < table.numRows(); i++) {
+			auto z = table.getColumn("z").getValue(i).getValue<std::int32_t>();
+			auto expectedZ = tableData[i][2].getValue<std::int32_t>() + (i < 500 ? 7 : 0);
+			ASSERT_EQUALS_DB_ENTRY(z, expectedZ, i, 2);
+
+			bool found = false;
+			underlyingIndex.forEachValue(z, [&](std::size_t rowIndex) {
+				found = found || rowIndex == i;
+			});
+			TS_ASSERT(found);
+		}
+	}
+
+	void testIndexUnion() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, optimizeExpressionsTestConfig(), { "x", IndexDefinition("z", IndexType::Hash) });
+
+		auto query = createQuery(databaseEngine->parse("UPDATE test_table SET y = 0.0 - 1.0 WHERE z == 5 OR x == 20"));
+		QueryResult result;
+		databaseEngine->execute(query, result);
+
+		auto& table = databaseEngine->getTable("test_table");
+		for (std::size_t i = 0; i < table.numRows(); i++) {
+			auto y = table.getColumn("y").getValue(i).getValue<float>();
+			auto isUpdated = tableData[i][2].getValue<std::int32_t>() == 5 || i == 20;
+			auto expectedY = isUpdated ? -1.0f : tableData[i][1].getValue<float>();
+			ASSERT_EQUALS_DB_ENTRY(y, expectedY, i, 1);
+		}
+	}
+
+	void testParallel() {
+		auto config = defaultTestConfig();
+		config.parallelism = 4;
+
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData, config, {}, 100000);
+
+		std::vector<std::unique_ptr<QueryAssignExpression>> sets;
+		sets.emplace_back(std::make_unique<QueryAssignExpression>(
+			"y",
+			std::make_unique<QueryMathExpression>(
+				createColumn("y"),
+				createValue(QueryValue(1000.0f)),
+				MathOperator::Add)));
+
+		auto query = createQuery(std::make_unique<QueryUpdateOperation>(
+			"test_table",
+			std::move(sets),
+			std::make_unique<QueryCompareExpression>(
+				createColumn("z"),
+				createValue(QueryValue(500)),
+				CompareOperator::GreaterThan)
+		));
+
+		QueryResult result;
+		databaseEngine->execute(query, result);
+
+		auto& table = databaseEngine->getTable("test_table");
+		for (std::size_t i = 0; i < table.numRows(); i++) {
+			auto expectedY = tableData[i][1].getValue<float>();
+			if (tableData[i][2].getValue<std::int32_t>() > 500) {
+				expectedY += 1000.0f;
+			}
+
+			ASSERT_EQUALS_DB_ENTRY(table.getColumn("y").getValue(i).getValue<float>(), expectedY, i, 1);
+		}
+	}
 };
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+#include <cxxtest/TestSuite.h>
+#include <vector>
+
+#include "../src/execution/virtual_table.h"
+#include "../src/storage.h"
+#include "test_helpers.h"
+
+class VirtualTableTestSuite : public CxxTest::TestSuite {
+public:
+	void testSelection() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+
+		VirtualTable table(databaseEngine->getTable("test_table"));
+		auto& columnX = table.getColumn("x");
+		TS_ASSERT(!table.hasSelection());
+		TS_ASSERT_EQUALS(table.numRows(), tableData.size());
+
+		std::vector<std::size_t> rowIndices { 10, 3, 500, 3 };
+		table.setSelection(rowIndices);
+		TS_ASSERT(table.hasSelection());
+		TS_ASSERT_EQUALS(table.numRows(), rowIndices.size());
+
+		// Only the columns that are used are gathered
+		auto& columnY = table.getColumn("y");
+		TS_ASSERT(!columnX.isMaterialized());
+		TS_ASSERT(!columnY.isMaterialized());
+
+		auto& valuesX = columnX.storage()->getUnderlyingStorage<std::int32_t>();
+		TS_ASSERT(columnX.isMaterialized());
+		TS_ASSERT(!columnY.isMaterialized());
+
+		TS_ASSERT_EQUALS(valuesX.size(), rowIndices.size());
+		for (std::size_t i = 0; i < rowIndices.size(); i++) {
+			TS_ASSERT_EQUALS(valuesX[i], tableData[rowIndices[i]][0].getValue<std::int32_t>());
+		}
+
+		auto& valuesY = columnY.storage()->getUnderlyingStorage<float>();
+		for (std::size_t i = 0; i < rowIndices.size(); i++) {
+			TS_ASSERT_EQUALS(valuesY[i], tableData[rowIndices[i]][1].getValue<float>());
+		}
+	}
+
+	void testNestedSelection() {
+		std::vector<std::vector<QueryValue>> tableData;
+		auto databaseEngine = setupTest(tableData);
+
+		VirtualTable table(databaseEngine->getTable("test_table"));
+		table.setSelection({ 100, 200, 300, 400 });
+		table.setSelection({ 3, 1 });
+		TS_ASSERT_EQUALS(table.numRows(), 2);
+
+		auto& valuesZ = table.getColumn("z").storage()->getUnderlyingStorage<std::int32_t>();
+		TS_ASSERT_EQUALS(valuesZ.size(), 2);
+		TS_ASSERT_EQUALS(valuesZ[0], tableData[400][2].getValue<std::int32_t>());
+		TS_ASSERT_EQUALS(valuesZ[1], tableData[200][2].getValue<std::int32_t>());
+	}
+};
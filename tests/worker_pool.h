@@ -0,0 +1,65 @@
+#pragma once
+#include <cxxtest/TestSuite.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "../src/execution/worker_pool.h"
+
+namespace {
+	// Shares the given number of items between the workers
+	void forEachItem(WorkerPool& pool, std::size_t numWorkers, std::size_t numItems, std::function<void (std::size_t)> applyItem) {
+		std::atomic<std::size_t> nextItem(0);
+		pool.run(numWorkers, [&](std::size_t workerIndex) {
+			for (auto item = nextItem.fetch_add(1); item < numItems; item = nextItem.fetch_add(1)) {
+				applyItem(item);
+			}
+		});
+	}
+}
+
+class WorkerPoolTestSuite : public CxxTest::TestSuite {
+public:
+	void testRun() {
+		WorkerPool pool(3);
+		for (std::size_t numWorkers : { 1, 2, 4, 8 }) {
+			std::vector<std::atomic<int>> counts(10000);
+			forEachItem(pool, numWorkers, counts.size(), [&](std::size_t item) {
+				counts[item]++;
+			});
+
+			for (auto& count : counts) {
+				TS_ASSERT_EQUALS(count.load(), 1);
+			}
+		}
+	}
+
+	void testNested() {
+		WorkerPool pool(2);
+		std::atomic<std::size_t> count(0);
+		forEachItem(pool, 3, 10, [&](std::size_t) {
+			forEachItem(pool, 3, 100, [&](std::size_t) {
+				count++;
+			});
+		});
+
+		TS_ASSERT_EQUALS(count.load(), 1000);
+	}
+
+	void testException() {
+		WorkerPool pool(3);
+		TS_ASSERT_THROWS_ANYTHING(forEachItem(pool, 4, 1000, [&](std::size_t item) {
+			if (item == 500) {
+				throw std::runtime_error("Failed.");
+			}
+		}));
+
+		// The pool is still usable after a worker has thrown
+		std::atomic<std::size_t> count(0);
+		forEachItem(pool, 4, 1000, [&](std::size_t) {
+			count++;
+		});
+
+		TS_ASSERT_EQUALS(count.load(), 1000);
+	}
+};
@@ -0,0 +1,228 @@
+#pragma once
+#include <cxxtest/TestSuite.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <sys/stat.h>
+#include <thread>
+
+#include "../src/write_ahead_log.h"
+#include "test_helpers.h"
+
+class WriteAheadLogTestSuite : public CxxTest::TestSuite {
+private:
+	void execute(DatabaseEngine& databaseEngine, const std::string& text) {
+		QueryResult result;
+		databaseEngine.execute(createQuery(databaseEngine.parse(text)), result);
+	}
+
+	std::vector<std::int32_t> selectX(DatabaseEngine& databaseEngine, const std::string& text) {
+		auto query = createQuery(databaseEngine.parse(text));
+		QueryResult result;
+		databaseEngine.execute(query, result);
+
+		auto& column = result.getColumn<std::int32_t>(0);
+		std::vector<std::int32_t> values(column.begin(), column.end());
+		std::sort(values.begin(), values.end());
+		return values;
+	}
+
+	off_t fileSize(const std::string& path) {
+		struct stat fileStatus;
+		TS_ASSERT_EQUALS(stat(path.c_str(), &fileStatus), 0);
+		return fileStatus.st_size;
+	}
+public:
+	void testReplay() {
+		TemporaryDirectory directory;
+		{
+			auto databaseEngine = openTestDatabase(directory.path);
+			addEmptyTestTable(*databaseEngine);
+			insertTestRows(*databaseEngine, 0, 100);
+			insertTestRows(*databaseEngine, 100, 50);
+			execute(*databaseEngine, "UPDATE test_table SET z = 42 WHERE x < 5");
+		}
+
+		// Nothing has been saved, which makes the log hold all the changes
+		auto openedEngine = openTestDatabase(directory.path);
+		auto& table = openedEngine->getTable("test_table");
+		TS_ASSERT_EQUALS(table.numRows(), 150);
+		TS_ASSERT_EQUALS(table.getColumn("y").getValue(120), QueryValue(120.0f));
+		TS_ASSERT_EQUALS(table.getColumn("z").getValue(3), QueryValue(42));
+		TS_ASSERT_EQUALS(table.getColumn("z").getValue(7), QueryValue(7));
+
+		TS_ASSERT_EQUALS(selectX(*openedEngine, "SELECT x FROM test_table WHERE z == 42"), std::vector<std::int32_t>({ 0, 1, 2, 3, 4 }));
+		TS_ASSERT_EQUALS(selectX(*openedEngine, "SELECT x FROM test_table WHERE x >= 148"), std::vector<std::int32_t>({ 148, 149 }));
+	}
+
+	void testSave() {
+		TemporaryDirectory directory;
+		auto walPath = directory.path + "/wal";
+		{
+			auto databaseEngine = openTestDatabase(directory.path);
+			addEmptyTestTable(*databaseEngine);
+			insertTestRows(*databaseEngine, 0, 100);
+
+			auto walSize = fileSize(walPath);
+			databaseEngine->save(directory.path);
+			TS_ASSERT_LESS_THAN(fileSize(walPath), walSize);
+
+			insertTestRows(*databaseEngine, 100, 10);
+			execute(*databaseEngine, "UPDATE test_table SET z = 42 WHERE x == 105");
+		}
+
+		// Only the changes after saving are applied to the table files
+		auto openedEngine = openTestDatabase(directory.path);
+		auto& table = openedEngine->getTable("test_table");
+		TS_ASSERT_EQUALS(table.numRows(), 110);
+		TS_ASSERT_EQUALS(table.getColumn("x").getValue(109), QueryValue(109));
+		TS_ASSERT_EQUALS(selectX(*openedEngine, "SELECT x FROM test_table WHERE z == 42"), std::vector<std::int32_t>({ 105 }));
+
+		insertTestRows(*openedEngine, 110, 1);
+		auto reopenedEngine = openTestDatabase(directory.path);
+		TS_ASSERT_EQUALS(reopenedEngine->getTable("test_table").numRows(), 111);
+	}
+
+	void testTornRecord() {
+		TemporaryDirectory directory;
+		auto walPath = directory.path + "/wal";
+		off_t validSize = 0;
+		{
+			auto databaseEngine = openTestDatabase(directory.path);
+			addEmptyTestTable(*databaseEngine);
+			insertTestRows(*databaseEngine, 0, 10);
+			validSize = fileSize(walPath);
+			insertTestRows(*databaseEngine, 10, 10);
+		}
+
+		// The last record was being written when the database stopped
+		TS_ASSERT_EQUALS(truncate(walPath.c_str(), fileSize(walPath) - 5), 0);
+		{
+			auto openedEngine = openTestDatabase(directory.path);
+			TS_ASSERT_EQUALS(openedEngine->getTable("test_table").numRows(), 10);
+			TS_ASSERT_EQUALS(fileSize(walPath), validSize);
+			insertTestRows(*openedEngine, 10, 5);
+		}
+
+		auto reopenedEngine = openTestDatabase(directory.path);
+		TS_ASSERT_EQUALS(reopenedEngine->getTable("test_table").numRows(), 15);
+		TS_ASSERT_EQUALS(reopenedEngine->getTable("test_table").getColumn("x").getValue(14), QueryValue(14));
+	}
+
+	void testGroupCommit() {
+		const std::size_t numThreads = 8;
+		TemporaryDirectory directory;
+		WriteAheadLog writeAheadLog(directory.path + "/wal", WalSyncMode::Group, 0);
+		Schema schema("test_table", { ColumnDefinition(0, "x", ColumnType::Int32) }, {});
+
+		// Every writer appends its record before any of them commits, which makes the first sync cover all of them
+		std::mutex mutex;
+		std::condition_variable allAppended;
+		std::size_t numAppended = 0;
+
+		std::vector<std::thread> threads;
+		for (std::size_t threadIndex = 0; threadIndex < numThreads; threadIndex++) {
+			threads.emplace_back([&, threadIndex]() {
+				auto position = writeAheadLog.logCreateTable("table" + std::to_string(threadIndex), schema);
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					numAppended++;
+					allAppended.notify_all();
+					allAppended.wait(lock, [&]() { return numAppended == numThreads; });
+				}
+
+				writeAheadLog.commit(position);
+			});
+		}
+
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		TS_ASSERT_EQUALS(writeAheadLog.numSyncs(), 1);
+		TS_ASSERT_LESS_THAN(writeAheadLog.numSyncs(), numThreads);
+	}
+
+	void testSyncWhileTruncating() {
+		const std::size_t numThreads = 4;
+		const std::size_t numCommits = 50;
+		TemporaryDirectory directory;
+		WriteAheadLog writeAheadLog(directory.path + "/wal", WalSyncMode::EveryStatement, 0);
+		Schema schema("test_table", { ColumnDefinition(0, "x", ColumnType::Int32) }, {});
+
+		// Truncating replaces the file of the log while the statements sync it
+		std::atomic<bool> committed(false);
+		std::thread truncateThread([&]() {
+			while (!committed) {
+				writeAheadLog.truncate(writeAheadLog.position());
+			}
+		});
+
+		std::vector<std::thread> threads;
+		for (std::size_t threadIndex = 0; threadIndex < numThreads; threadIndex++) {
+			threads.emplace_back([&, threadIndex]() {
+				for (std::size_t i = 0; i < numCommits; i++) {
+					auto name = "table" + std::to_string(threadIndex) + "_" + std::to_string(i);
+					writeAheadLog.commit(writeAheadLog.logCreateTable(name, schema));
+				}
+			});
+		}
+
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		committed = true;
+		truncateThread.join();
+
+		TS_ASSERT_EQUALS(writeAheadLog.numSyncs(), numThreads * numCommits);
+		writeAheadLog.truncate(writeAheadLog.position());
+		TS_ASSERT_EQUALS(writeAheadLog.size(), 0);
+	}
+
+	void testSyncModes() {
+		const std::size_t numThreads = 4;
+		const std::int32_t numInserts = 20;
+
+		for (auto syncMode : { WalSyncMode::None, WalSyncMode::Group, WalSyncMode::EveryStatement }) {
+			TemporaryDirectory directory;
+			auto config = defaultTestConfig();
+			config.walSyncMode = syncMode;
+			auto databaseEngine = openTestDatabase(directory.path, config);
+			addEmptyTestTable(*databaseEngine);
+			auto numSyncsBefore = databaseEngine->writeAheadLog()->numSyncs();
+
+			std::vector<std::thread> threads;
+			for (std::size_t threadIndex = 0; threadIndex < numThreads; threadIndex++) {
+				threads.emplace_back([&, threadIndex]() {
+					for (std::int32_t i = 0; i < numInserts; i++) {
+						insertTestRows(*databaseEngine, (std::int32_t)threadIndex * numInserts + i, 1);
+					}
+				});
+			}
+
+			for (auto& thread : threads) {
+				thread.join();
+			}
+
+			auto numCommits = numThreads * numInserts;
+			auto numSyncs = databaseEngine->writeAheadLog()->numSyncs() - numSyncsBefore;
+			switch (syncMode) {
+				case WalSyncMode::None:
+					TS_ASSERT_EQUALS(numSyncs, 0);
+					break;
+				case WalSyncMode::Group:
+					// How many commits share a sync depends on timing here, which testGroupCommit controls
+					TS_ASSERT_LESS_THAN(0, numSyncs);
+					break;
+				case WalSyncMode::EveryStatement:
+					TS_ASSERT_EQUALS(numSyncs, numCommits);
+					break;
+			}
+
+			auto openedEngine = openTestDatabase(directory.path);
+			TS_ASSERT_EQUALS(openedEngine->getTable("test_table").numRows(), numCommits);
+		}
+	}
+};